@@ -0,0 +1,239 @@
+#include "queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Slot header; the element follows it
+typedef struct {
+    _Atomic size_t sequence;
+} Cell;
+
+static Cell* cell_at(const Queue* queue, size_t position) {
+    return (Cell*)(queue->cells + (position & queue->mask) * queue->stride);
+}
+
+static void* cell_data(Cell* cell) {
+    return (uint8_t*)cell + sizeof(Cell);
+}
+
+bool queue_init(Queue* queue, size_t elem_size, size_t capacity) {
+    if (!queue || elem_size == 0 || capacity == 0 || capacity > (SIZE_MAX >> 2)) {
+        return false;
+    }
+
+    size_t slots = 2;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    memset(queue, 0, sizeof(Queue));
+    queue->elem_size = elem_size;
+    queue->stride = (sizeof(Cell) + elem_size + _Alignof(Cell) - 1) & ~(_Alignof(Cell) - 1);
+    queue->mask = slots - 1;
+    queue->cells = calloc(slots, queue->stride);
+    if (!queue->cells) {
+        return false;
+    }
+
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(&cell_at(queue, i)->sequence, i);
+    }
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    return true;
+}
+
+void queue_destroy(Queue* queue) {
+    if (!queue) return;
+
+    free(queue->cells);
+    queue->cells = NULL;
+}
+
+bool queue_push(Queue* queue, const void* elem, size_t size) {
+    if (!queue || !queue->cells || size != queue->elem_size) return false;
+
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    Cell* cell;
+
+    for (;;) {
+        cell = cell_at(queue, pos);
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;    // Full
+        } else {
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    memcpy(cell_data(cell), elem, size);
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+bool queue_pop(Queue* queue, void* elem, size_t size) {
+    if (!queue || !queue->cells || size != queue->elem_size) return false;
+
+    size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    Cell* cell;
+
+    for (;;) {
+        cell = cell_at(queue, pos);
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)(seq - (pos + 1));
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;    // Empty
+        } else {
+            pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    memcpy(elem, cell_data(cell), size);
+    atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+    return true;
+}
+
+// Counts the run of slots from pos whose sequence equals pos + offset,
+// i.e. free slots for a producer (offset 0) or full ones for a consumer (1)
+static size_t ready_run(const Queue* queue, size_t pos, size_t offset, size_t limit) {
+    size_t run = 0;
+    while (run < limit) {
+        size_t seq = atomic_load_explicit(&cell_at(queue, pos + run)->sequence,
+                                          memory_order_acquire);
+        if (seq != pos + run + offset) {
+            break;
+        }
+        run++;
+    }
+    return run;
+}
+
+// A run that was ready before the claim stays ready: no other thread can
+// touch those slots until it moves the same position counter past them
+size_t queue_push_n(Queue* queue, const void* elems, size_t count) {
+    if (!queue || !queue->cells || !elems || count == 0) return 0;
+
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    size_t run;
+
+    for (;;) {
+        run = ready_run(queue, pos, 0, count);
+        if (run == 0) {
+            size_t seq = atomic_load_explicit(&cell_at(queue, pos)->sequence,
+                                              memory_order_acquire);
+            if ((intptr_t)(seq - pos) < 0) {
+                return 0;    // Full
+            }
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + run,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    const uint8_t* src = elems;
+    for (size_t i = 0; i < run; i++) {
+        Cell* cell = cell_at(queue, pos + i);
+        memcpy(cell_data(cell), src + i * queue->elem_size, queue->elem_size);
+        atomic_store_explicit(&cell->sequence, pos + i + 1, memory_order_release);
+    }
+    return run;
+}
+
+size_t queue_pop_n(Queue* queue, void* elems, size_t count) {
+    if (!queue || !queue->cells || !elems || count == 0) return 0;
+
+    size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    size_t run;
+
+    for (;;) {
+        run = ready_run(queue, pos, 1, count);
+        if (run == 0) {
+            size_t seq = atomic_load_explicit(&cell_at(queue, pos)->sequence,
+                                              memory_order_acquire);
+            if ((intptr_t)(seq - (pos + 1)) < 0) {
+                return 0;    // Empty
+            }
+            pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + run,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    uint8_t* dst = elems;
+    for (size_t i = 0; i < run; i++) {
+        Cell* cell = cell_at(queue, pos + i);
+        memcpy(dst + i * queue->elem_size, cell_data(cell), queue->elem_size);
+        atomic_store_explicit(&cell->sequence, pos + i + queue->mask + 1, memory_order_release);
+    }
+    return run;
+}
+
+bool queue_push_sp(Queue* queue, const void* elem, size_t size) {
+    if (!queue || !queue->cells || size != queue->elem_size) return false;
+
+    // Nobody else moves enqueue_pos, so the slot is ours once it is free
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    Cell* cell = cell_at(queue, pos);
+    if (atomic_load_explicit(&cell->sequence, memory_order_acquire) != pos) {
+        return false;    // Full
+    }
+
+    memcpy(cell_data(cell), elem, size);
+    atomic_store_explicit(&queue->enqueue_pos, pos + 1, memory_order_relaxed);
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+void queue_clear(Queue* queue) {
+    if (!queue || !queue->cells) return;
+
+    // Consume in place rather than resetting the counters, which would
+    // race with producers still inside a push
+    size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        size_t run = ready_run(queue, pos, 1, queue->mask + 1);
+        if (run == 0) {
+            break;
+        }
+        if (!atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + run,
+                                                   memory_order_relaxed, memory_order_relaxed)) {
+            continue;
+        }
+        for (size_t i = 0; i < run; i++) {
+            atomic_store_explicit(&cell_at(queue, pos + i)->sequence, pos + i + queue->mask + 1,
+                                  memory_order_release);
+        }
+        pos += run;
+    }
+}
+
+size_t queue_count(const Queue* queue) {
+    if (!queue || !queue->cells) return 0;
+
+    size_t tail = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    size_t count = head - tail;
+    return (intptr_t)count < 0 ? 0 : (count > queue->mask + 1 ? queue->mask + 1 : count);
+}
+
+size_t queue_capacity(const Queue* queue) {
+    return queue && queue->cells ? queue->mask + 1 : 0;
+}
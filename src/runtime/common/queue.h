@@ -0,0 +1,48 @@
+#ifndef CANT_QUEUE_H
+#define CANT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Bounded lock-free MPMC queue of fixed-size elements (Vyukov). Every slot
+// carries a sequence number that says whose turn it is, so producers and
+// consumers only contend on their own position counter. Elements are
+// copied in and out; capacity is rounded up to a power of two.
+
+#define QUEUE_CACHE_LINE 64
+
+typedef struct {
+    uint8_t* cells;
+    size_t mask;
+    size_t elem_size;
+    size_t stride;
+    _Alignas(QUEUE_CACHE_LINE) _Atomic size_t enqueue_pos;
+    _Alignas(QUEUE_CACHE_LINE) _Atomic size_t dequeue_pos;
+} Queue;
+
+bool queue_init(Queue* queue, size_t elem_size, size_t capacity);
+void queue_destroy(Queue* queue);
+
+// size must equal the element size given to queue_init
+bool queue_push(Queue* queue, const void* elem, size_t size);
+bool queue_pop(Queue* queue, void* elem, size_t size);
+
+// Move up to count elements in one claim; return how many moved. Elements
+// are contiguous arrays of elem_size.
+size_t queue_push_n(Queue* queue, const void* elems, size_t count);
+size_t queue_pop_n(Queue* queue, void* elems, size_t count);
+
+// Single-producer push: no CAS, wait-free, for an ISR feeding a task.
+// Only valid when this is the queue's one and only producer.
+bool queue_push_sp(Queue* queue, const void* elem, size_t size);
+
+// Pops everything; producers may keep pushing meanwhile
+void queue_clear(Queue* queue);
+
+// Snapshot; exact only when the queue is quiet
+size_t queue_count(const Queue* queue);
+size_t queue_capacity(const Queue* queue);
+
+#endif // CANT_QUEUE_H
@@ -0,0 +1,434 @@
+#include "event_bus.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#define EVENT_BUS_WORKER 1
+#else
+#define EVENT_BUS_WORKER 0
+#endif
+
+#define CACHE_LINE 64
+
+_Static_assert(EVENT_BUS_MAX_SUBSCRIBERS <= 32, "topic masks are 32 bits wide");
+
+enum {
+    SUB_FREE = 0,
+    SUB_SETUP,
+    SUB_ACTIVE,
+    SUB_CLOSING     // Unsubscribed; storage freed by the next dispatch
+};
+
+// Bounded MPMC queue cell; the payload follows the header
+typedef struct {
+    _Atomic uint32_t sequence;
+    uint16_t type;
+    uint16_t length;
+} Cell;
+
+typedef struct {
+    _Atomic uint32_t state;
+    _Atomic uint32_t publishers;    // Publishers currently inside the queue
+    EventSubscription sub;
+    uint8_t* cells;
+    uint32_t stride;
+    uint32_t mask;
+    _Atomic uint32_t delivered;
+    _Atomic uint32_t dropped;
+    _Alignas(CACHE_LINE) _Atomic uint32_t enqueue_pos;
+    _Alignas(CACHE_LINE) _Atomic uint32_t dequeue_pos;
+} Subscriber;
+
+static Subscriber subscribers[EVENT_BUS_MAX_SUBSCRIBERS];
+static _Atomic uint32_t topic_masks[EVENT_TOPIC_COUNT];
+
+#if EVENT_BUS_WORKER
+static struct {
+    pthread_t thread;
+    sem_t wake;
+    _Atomic bool sleeping;
+    _Atomic bool running;
+} worker;
+#endif
+
+static Cell* cell_at(const Subscriber* s, uint32_t position) {
+    return (Cell*)(s->cells + (position & s->mask) * s->stride);
+}
+
+static bool queue_push(Subscriber* s, uint16_t type, const void* payload, uint16_t length) {
+    uint32_t pos = atomic_load_explicit(&s->enqueue_pos, memory_order_relaxed);
+    Cell* cell;
+
+    for (;;) {
+        cell = cell_at(s, pos);
+        uint32_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;    // Full
+        } else {
+            pos = atomic_load_explicit(&s->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    cell->type = type;
+    cell->length = length;
+    if (length) {
+        memcpy(cell + 1, payload, length);
+    }
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+// Claims the oldest cell; the caller hands it back with queue_release
+static Cell* queue_claim(Subscriber* s, uint32_t* position) {
+    uint32_t pos = atomic_load_explicit(&s->dequeue_pos, memory_order_relaxed);
+
+    for (;;) {
+        Cell* cell = cell_at(s, pos);
+        uint32_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *position = pos;
+                return cell;
+            }
+        } else if (diff < 0) {
+            return NULL;    // Empty
+        } else {
+            pos = atomic_load_explicit(&s->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static void queue_release(Subscriber* s, Cell* cell, uint32_t position) {
+    atomic_store_explicit(&cell->sequence, position + s->mask + 1, memory_order_release);
+}
+
+static bool enqueue_with_policy(Subscriber* s, uint16_t type, const void* payload, uint16_t length) {
+    if (queue_push(s, type, payload, length)) {
+        return true;
+    }
+
+    switch (s->sub.policy) {
+        case EVENT_POLICY_DROP_OLDEST:
+            for (uint32_t attempt = 0; attempt < 4; attempt++) {
+                uint32_t position;
+                Cell* oldest = queue_claim(s, &position);
+                if (oldest) {
+                    queue_release(s, oldest, position);
+                    atomic_fetch_add_explicit(&s->dropped, 1, memory_order_relaxed);
+                }
+                if (queue_push(s, type, payload, length)) {
+                    return true;
+                }
+            }
+            break;
+
+        case EVENT_POLICY_BLOCK:
+            for (uint32_t spin = 0; spin < EVENT_BUS_BLOCK_SPINS; spin++) {
+#if EVENT_BUS_WORKER
+                sched_yield();
+#endif
+                if (queue_push(s, type, payload, length)) {
+                    return true;
+                }
+            }
+            break;
+
+        case EVENT_POLICY_DROP_NEWEST:
+        default:
+            break;
+    }
+
+    atomic_fetch_add_explicit(&s->dropped, 1, memory_order_relaxed);
+    return false;
+}
+
+static void free_subscriber(Subscriber* s) {
+    free(s->cells);
+    s->cells = NULL;
+    atomic_store_explicit(&s->state, SUB_FREE, memory_order_release);
+}
+
+int32_t EventBus_Subscribe(const EventSubscription* subscription) {
+    if (!subscription || !subscription->handler || subscription->topic >= EVENT_TOPIC_COUNT ||
+        subscription->payload_size > EVENT_BUS_MAX_PAYLOAD) {
+        return -1;
+    }
+
+    uint32_t depth = subscription->depth ? subscription->depth : EVENT_BUS_DEFAULT_DEPTH;
+    if (depth & (depth - 1)) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        Subscriber* s = &subscribers[i];
+        uint32_t expected = SUB_FREE;
+        if (!atomic_compare_exchange_strong(&s->state, &expected, SUB_SETUP)) {
+            continue;
+        }
+
+        s->sub = *subscription;
+        s->sub.depth = (uint16_t)depth;
+        s->stride = (uint32_t)((sizeof(Cell) + subscription->payload_size + 7u) & ~7u);
+        s->mask = depth - 1;
+        s->cells = (uint8_t*)malloc((size_t)s->stride * depth);
+        if (!s->cells) {
+            atomic_store(&s->state, SUB_FREE);
+            return -1;
+        }
+
+        for (uint32_t j = 0; j < depth; j++) {
+            atomic_init(&cell_at(s, j)->sequence, j);
+        }
+        atomic_store(&s->enqueue_pos, 0);
+        atomic_store(&s->dequeue_pos, 0);
+        atomic_store(&s->delivered, 0);
+        atomic_store(&s->dropped, 0);
+
+        atomic_store(&s->state, SUB_ACTIVE);
+        atomic_fetch_or(&topic_masks[subscription->topic], 1u << i);
+        return (int32_t)i;
+    }
+    return -1;
+}
+
+void EventBus_Unsubscribe(int32_t id) {
+    if (id < 0 || id >= EVENT_BUS_MAX_SUBSCRIBERS) {
+        return;
+    }
+
+    Subscriber* s = &subscribers[id];
+    uint32_t expected = SUB_ACTIVE;
+    if (atomic_compare_exchange_strong(&s->state, &expected, SUB_CLOSING)) {
+        atomic_fetch_and(&topic_masks[s->sub.topic], ~(1u << id));
+    }
+}
+
+static bool wants(const Subscriber* s, EventTopic topic, uint16_t type) {
+    if (s->sub.topic != topic) {
+        return false;
+    }
+    if (s->sub.type_mask == EVENT_TYPE_ALL) {
+        return true;
+    }
+    return type < 32 && (s->sub.type_mask & (1u << type));
+}
+
+bool EventBus_Publish(EventTopic topic, uint16_t type, const void* payload, uint16_t length) {
+    if (topic >= EVENT_TOPIC_COUNT || (length && !payload)) {
+        return false;
+    }
+
+    uint32_t mask = atomic_load(&topic_masks[topic]);
+    bool delivered_all = true;
+    bool queued = false;
+
+    while (mask) {
+        uint32_t i = (uint32_t)__builtin_ctz(mask);
+        mask &= mask - 1;
+        Subscriber* s = &subscribers[i];
+
+        // Announce ourselves before checking the state so dispatch never
+        // frees a queue a publisher is still writing
+        atomic_fetch_add(&s->publishers, 1);
+        if (atomic_load(&s->state) == SUB_ACTIVE && wants(s, topic, type)) {
+            if (length > s->sub.payload_size) {
+                atomic_fetch_add_explicit(&s->dropped, 1, memory_order_relaxed);
+                delivered_all = false;
+            } else if (enqueue_with_policy(s, type, payload, length)) {
+                queued = true;
+            } else {
+                delivered_all = false;
+            }
+        }
+        atomic_fetch_sub(&s->publishers, 1);
+    }
+
+#if EVENT_BUS_WORKER
+    if (queued && atomic_exchange(&worker.sleeping, false)) {
+        sem_post(&worker.wake);
+    }
+#else
+    (void)queued;
+#endif
+    return delivered_all;
+}
+
+static void reclaim_closed(void) {
+    for (uint32_t i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        Subscriber* s = &subscribers[i];
+        if (atomic_load(&s->state) == SUB_CLOSING && atomic_load(&s->publishers) == 0) {
+            free_subscriber(s);
+        }
+    }
+}
+
+// Runs the handler for the oldest queued event; false when empty
+static bool deliver_next(Subscriber* s) {
+    uint32_t position;
+    Cell* cell = queue_claim(s, &position);
+    if (!cell) {
+        return false;
+    }
+
+    // Copy out and hand the cell back first: a handler that publishes to
+    // its own full queue must find room, not evict behind a held cell
+    _Alignas(8) uint8_t payload[EVENT_BUS_MAX_PAYLOAD];
+    BusEvent event = {
+        .topic = s->sub.topic,
+        .type = cell->type,
+        .length = cell->length,
+        .payload = payload
+    };
+    memcpy(payload, cell + 1, cell->length);
+    queue_release(s, cell, position);
+
+    s->sub.handler(&event, s->sub.context);
+
+    atomic_fetch_add_explicit(&s->delivered, 1, memory_order_relaxed);
+    return true;
+}
+
+uint32_t EventBus_Dispatch(uint32_t max_events) {
+    uint32_t handled = 0;
+    bool progress = true;
+
+    reclaim_closed();
+
+    // Round-robin so one busy subscriber cannot starve the others
+    while (progress && (max_events == 0 || handled < max_events)) {
+        progress = false;
+
+        for (uint32_t i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+            Subscriber* s = &subscribers[i];
+            if (atomic_load_explicit(&s->state, memory_order_acquire) != SUB_ACTIVE) {
+                continue;
+            }
+
+            if (!deliver_next(s)) {
+                continue;
+            }
+            handled++;
+            progress = true;
+            if (max_events && handled >= max_events) {
+                break;
+            }
+        }
+    }
+
+    reclaim_closed();
+    return handled;
+}
+
+uint32_t EventBus_Flush(int32_t id) {
+    if (id < 0 || id >= EVENT_BUS_MAX_SUBSCRIBERS) {
+        return 0;
+    }
+
+    Subscriber* s = &subscribers[id];
+    uint32_t handled = 0;
+    while (atomic_load_explicit(&s->state, memory_order_acquire) == SUB_ACTIVE &&
+           deliver_next(s)) {
+        handled++;
+    }
+    return handled;
+}
+
+#if EVENT_BUS_WORKER
+static void* worker_main(void* arg) {
+    (void)arg;
+
+    while (atomic_load(&worker.running)) {
+        if (EventBus_Dispatch(0)) {
+            continue;
+        }
+
+        // Recheck after announcing the sleep so a concurrent publish is
+        // either seen here or posts the semaphore
+        atomic_store(&worker.sleeping, true);
+        if (EventBus_Dispatch(0)) {
+            atomic_store(&worker.sleeping, false);
+            continue;
+        }
+        sem_wait(&worker.wake);
+    }
+    return NULL;
+}
+#endif
+
+bool EventBus_StartWorker(void) {
+#if EVENT_BUS_WORKER
+    if (atomic_load(&worker.running)) {
+        return true;
+    }
+    if (sem_init(&worker.wake, 0, 0) != 0) {
+        return false;
+    }
+
+    atomic_store(&worker.sleeping, false);
+    atomic_store(&worker.running, true);
+    if (pthread_create(&worker.thread, NULL, worker_main, NULL) != 0) {
+        atomic_store(&worker.running, false);
+        sem_destroy(&worker.wake);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void EventBus_StopWorker(void) {
+#if EVENT_BUS_WORKER
+    if (!atomic_exchange(&worker.running, false)) {
+        return;
+    }
+
+    sem_post(&worker.wake);
+    pthread_join(worker.thread, NULL);
+    sem_destroy(&worker.wake);
+#endif
+}
+
+void EventBus_Deinit(void) {
+    EventBus_StopWorker();
+
+    for (uint32_t topic = 0; topic < EVENT_TOPIC_COUNT; topic++) {
+        atomic_store(&topic_masks[topic], 0);
+    }
+    for (uint32_t i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        if (atomic_load(&subscribers[i].state) != SUB_FREE) {
+            free_subscriber(&subscribers[i]);
+        }
+    }
+}
+
+bool EventBus_GetStats(int32_t id, EventBusStats* stats) {
+    if (id < 0 || id >= EVENT_BUS_MAX_SUBSCRIBERS || !stats) {
+        return false;
+    }
+
+    Subscriber* s = &subscribers[id];
+    if (atomic_load(&s->state) != SUB_ACTIVE) {
+        return false;
+    }
+
+    stats->delivered = atomic_load_explicit(&s->delivered, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&s->dropped, memory_order_relaxed);
+    stats->queued = atomic_load_explicit(&s->enqueue_pos, memory_order_relaxed) -
+                    atomic_load_explicit(&s->dequeue_pos, memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef CANT_EVENT_BUS_H
+#define CANT_EVENT_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Typed publish/subscribe bus. Publishing copies the payload into one
+// bounded lock-free queue per matching subscriber and never calls a
+// handler, so it is safe from interrupts and critical sections. Handlers
+// run later from EventBus_Dispatch, either on the worker thread or from
+// the application's main loop.
+#define EVENT_BUS_MAX_SUBSCRIBERS   32
+#define EVENT_BUS_DEFAULT_DEPTH     32
+#define EVENT_BUS_MAX_PAYLOAD       512     // Handlers get a copy on the dispatch stack
+#define EVENT_BUS_BLOCK_SPINS       10000
+#define EVENT_TYPE_ALL              0xFFFFFFFFu
+
+typedef enum {
+    EVENT_TOPIC_NET = 0,        // type = NetEventType
+    EVENT_TOPIC_LOG,            // type = DiagLogLevel, payload = DiagLogEntry
+    EVENT_TOPIC_DIAG_STATE,     // type = new DiagState, payload = DiagStateTransition
+    EVENT_TOPIC_DIAG_EVENT,     // type = DiagEventType, payload = DiagEventData
+    EVENT_TOPIC_USER,
+    EVENT_TOPIC_COUNT
+} EventTopic;
+
+// What a publisher does when a subscriber's queue is full
+typedef enum {
+    EVENT_POLICY_DROP_NEWEST = 0,   // Discard the event being published
+    EVENT_POLICY_DROP_OLDEST,       // Evict the oldest queued event
+    EVENT_POLICY_BLOCK              // Spin until space, then drop newest
+} EventPolicy;
+
+typedef struct {
+    EventTopic topic;
+    uint16_t type;
+    uint16_t length;
+    const void* payload;    // Valid for the duration of the handler
+} BusEvent;
+
+typedef void (*EventBusHandler)(const BusEvent* event, void* context);
+
+typedef struct {
+    EventTopic topic;
+    uint32_t type_mask;     // Bit n selects type n; EVENT_TYPE_ALL for every type
+    EventBusHandler handler;
+    void* context;
+    uint16_t payload_size;  // Largest payload accepted, up to EVENT_BUS_MAX_PAYLOAD
+    uint16_t depth;         // Queue slots, power of two; 0 = default
+    EventPolicy policy;
+} EventSubscription;
+
+typedef struct {
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t queued;
+} EventBusStats;
+
+// The bus needs no initialisation before first use; Deinit stops the
+// worker and releases every subscription.
+void EventBus_Deinit(void);
+
+// Returns a subscriber id, or -1 when the table is full or the request is
+// invalid. Unsubscribe may be called from a handler.
+int32_t EventBus_Subscribe(const EventSubscription* subscription);
+void EventBus_Unsubscribe(int32_t id);
+
+// Returns false if any subscriber dropped the event
+bool EventBus_Publish(EventTopic topic, uint16_t type, const void* payload, uint16_t length);
+
+// Runs up to max_events handlers (0 = until all queues are empty) and
+// returns how many ran. Use from a single thread.
+uint32_t EventBus_Dispatch(uint32_t max_events);
+
+// Runs the handlers for events already queued to one subscriber on the
+// calling thread, e.g. before unsubscribing. The queue is multi-consumer,
+// so this is safe beside the worker.
+uint32_t EventBus_Flush(int32_t id);
+
+// Dispatch on a dedicated thread, woken by publishers (POSIX only)
+bool EventBus_StartWorker(void);
+void EventBus_StopWorker(void);
+
+bool EventBus_GetStats(int32_t id, EventBusStats* stats);
+
+#endif // CANT_EVENT_BUS_H
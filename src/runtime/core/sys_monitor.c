@@ -27,7 +27,7 @@ void SysMonitor_Init(void) {
 void SysMonitor_Update(void) {
     SystemSnapshot* snap = &history[history_index];
     
-    snap->mem_usage = POOL_NUM_BLOCKS - MemPool_GetFreeBlocks();
+    snap->mem_usage = MemPool_GetTotalBlocks() - MemPool_GetFreeBlocks();
     snap->buf_usage = BufferManager_GetUsage();
     snap->msg_count = get_msg_count();
     snap->errors = WATCHDOG_GetResetCount();
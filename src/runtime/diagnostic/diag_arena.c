@@ -0,0 +1,96 @@
+#include "diag_arena.h"
+#include <string.h>
+#include "../os/critical.h"
+#include "../memory/memory_manager.h"
+
+typedef struct {
+    MemArena arenas[DIAG_ARENA_COUNT];
+    uint8_t buffers[DIAG_ARENA_COUNT][DIAG_ARENA_SIZE] __attribute__((aligned(MEM_ARENA_ALIGNMENT)));
+    uint32_t in_use;                 // Bit per arena
+    uint32_t heap_allocs_at_start;   // Memory_Alloc count when in_flight left zero
+    DiagArenaStats stats;
+    CriticalSection critical;
+} DiagArenaPool;
+
+static DiagArenaPool arena_pool;
+
+MemArena* DiagArena_Acquire(void) {
+    enter_critical(&arena_pool.critical);
+
+    uint32_t free_mask = ~arena_pool.in_use & ((1u << DIAG_ARENA_COUNT) - 1);
+    if (!free_mask) {
+        arena_pool.stats.exhausted++;
+        exit_critical(&arena_pool.critical);
+        return NULL;
+    }
+
+    uint32_t index = __builtin_ctz(free_mask);
+    MemArena* arena = &arena_pool.arenas[index];
+    MemArena_Init(arena, arena_pool.buffers[index], DIAG_ARENA_SIZE);
+    arena_pool.in_use |= (1u << index);
+
+    if (arena_pool.stats.in_flight++ == 0) {
+        arena_pool.heap_allocs_at_start = Memory_GetAllocationCount();
+    }
+    arena_pool.stats.requests++;
+
+    exit_critical(&arena_pool.critical);
+    return arena;
+}
+
+void DiagArena_Release(MemArena* arena) {
+    if (!arena) {
+        return;
+    }
+
+    uint32_t index = (uint32_t)(arena - arena_pool.arenas);
+    if (index >= DIAG_ARENA_COUNT) {
+        return;
+    }
+
+    enter_critical(&arena_pool.critical);
+
+    if (!(arena_pool.in_use & (1u << index))) {
+        exit_critical(&arena_pool.critical);
+        return;
+    }
+
+    arena_pool.stats.allocs += arena->alloc_count;
+    arena_pool.stats.failed_allocs += arena->failed_allocs;
+    if (arena->peak > arena_pool.stats.peak_bytes) {
+        arena_pool.stats.peak_bytes = arena->peak;
+    }
+
+    MemArena_Reset(arena);
+    arena_pool.in_use &= ~(1u << index);
+
+    if (--arena_pool.stats.in_flight == 0) {
+        arena_pool.stats.heap_allocs += Memory_GetAllocationCount() - arena_pool.heap_allocs_at_start;
+    }
+
+    exit_critical(&arena_pool.critical);
+}
+
+void DiagArena_GetStats(DiagArenaStats* stats) {
+    if (!stats) {
+        return;
+    }
+
+    enter_critical(&arena_pool.critical);
+    memcpy(stats, &arena_pool.stats, sizeof(DiagArenaStats));
+
+    // Include allocations made by requests that are still running
+    if (arena_pool.stats.in_flight) {
+        stats->heap_allocs += Memory_GetAllocationCount() - arena_pool.heap_allocs_at_start;
+    }
+    exit_critical(&arena_pool.critical);
+}
+
+void DiagArena_ResetStats(void) {
+    enter_critical(&arena_pool.critical);
+    uint32_t in_flight = arena_pool.stats.in_flight;
+    memset(&arena_pool.stats, 0, sizeof(DiagArenaStats));
+    arena_pool.stats.in_flight = in_flight;
+    arena_pool.heap_allocs_at_start = Memory_GetAllocationCount();
+    exit_critical(&arena_pool.critical);
+}
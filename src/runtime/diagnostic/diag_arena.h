@@ -0,0 +1,29 @@
+#ifndef CANT_DIAG_ARENA_H
+#define CANT_DIAG_ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../memory/mem_arena.h"
+
+#define DIAG_ARENA_COUNT   4       // Requests that may be in flight at once
+#define DIAG_ARENA_SIZE    1024    // Scratch bytes per request
+
+typedef struct {
+    uint32_t requests;         // Arenas handed out
+    uint32_t exhausted;        // Acquire failed, every arena in flight
+    uint32_t allocs;           // Arena allocations across released requests
+    uint32_t failed_allocs;    // Arena allocations that did not fit
+    uint32_t peak_bytes;       // Largest single-request footprint
+    uint32_t in_flight;
+    uint32_t heap_allocs;      // Memory_Alloc calls while any request was in flight
+} DiagArenaStats;
+
+// One arena per in-flight diagnostic request. Release is O(1) and drops
+// everything the request allocated, so handlers never free individually.
+MemArena* DiagArena_Acquire(void);
+void DiagArena_Release(MemArena* arena);
+
+void DiagArena_GetStats(DiagArenaStats* stats);
+void DiagArena_ResetStats(void);
+
+#endif // CANT_DIAG_ARENA_H
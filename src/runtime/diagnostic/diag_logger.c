@@ -1,15 +1,18 @@
 #include "diag_logger.h"
 #include "diag_timer.h"
 #include "../memory/memory_manager.h"
+#include "../core/event_bus.h"
 #include <stdarg.h>
 #include <string.h>
 
 #define MAX_LOG_CALLBACKS 8
-#define LOG_BUFFER_SIZE 32
+#define LOG_QUEUE_DEPTH 32
 
+// Binding between a registered callback and its event bus subscription
 typedef struct {
     DiagLogCallback callback;
     void* context;
+    int32_t subscriber;
     bool active;
 } LogCallback;
 
@@ -18,37 +21,24 @@ typedef struct {
     LogCallback callbacks[MAX_LOG_CALLBACKS];
     uint32_t callback_count;
     uint32_t sequence_number;
-    DiagLogEntry buffer[LOG_BUFFER_SIZE];
-    uint32_t buffer_index;
     bool initialized;
 } LoggerContext;
 
 static LoggerContext logger;
 
 // Internal functions
-static void flush_buffer(void) {
-    if (!logger.initialized) return;
-    
-    for (uint32_t i = 0; i < logger.buffer_index; i++) {
-        DiagLogEntry* entry = &logger.buffer[i];
-        
-        for (uint32_t j = 0; j < logger.callback_count; j++) {
-            if (logger.callbacks[j].active && logger.callbacks[j].callback) {
-                logger.callbacks[j].callback(entry, logger.callbacks[j].context);
-            }
-        }
-    }
-    
-    logger.buffer_index = 0;
+
+// Each subscriber queues its own copy; a slow sink no longer holds up
+// the code that logs
+static void publish_log(const DiagLogEntry* entry) {
+    EventBus_Publish(EVENT_TOPIC_LOG, (uint16_t)entry->level, entry, sizeof(DiagLogEntry));
 }
 
-static void buffer_log(const DiagLogEntry* entry) {
-    if (logger.buffer_index >= LOG_BUFFER_SIZE) {
-        flush_buffer();
+static void dispatch_log(const BusEvent* event, void* context) {
+    LogCallback* cb = (LogCallback*)context;
+    if (cb->active && cb->callback) {
+        cb->callback((const DiagLogEntry*)event->payload, cb->context);
     }
-    
-    memcpy(&logger.buffer[logger.buffer_index], entry, sizeof(DiagLogEntry));
-    logger.buffer_index++;
 }
 
 bool DiagLogger_Init(void) {
@@ -64,7 +54,13 @@ bool DiagLogger_Init(void) {
 void DiagLogger_Deinit(void) {
     if (!logger.initialized) return;
     
-    flush_buffer();
+    // Deliver entries still queued, as the old buffer flush did
+    for (uint32_t i = 0; i < logger.callback_count; i++) {
+        if (logger.callbacks[i].active) {
+            EventBus_Flush(logger.callbacks[i].subscriber);
+            EventBus_Unsubscribe(logger.callbacks[i].subscriber);
+        }
+    }
     memset(&logger, 0, sizeof(LoggerContext));
 }
 
@@ -82,9 +78,8 @@ void DiagLogger_RegisterCallback(DiagLogCallback callback, void* context) {
     
     // Check if callback already registered
     for (uint32_t i = 0; i < logger.callback_count; i++) {
-        if (logger.callbacks[i].callback == callback) {
+        if (logger.callbacks[i].active && logger.callbacks[i].callback == callback) {
             logger.callbacks[i].context = context;
-            logger.callbacks[i].active = true;
             return;
         }
     }
@@ -92,9 +87,22 @@ void DiagLogger_RegisterCallback(DiagLogCallback callback, void* context) {
     // Find free slot
     for (uint32_t i = 0; i < MAX_LOG_CALLBACKS; i++) {
         if (!logger.callbacks[i].active) {
+            // Sequence numbers show a sink where it dropped entries
+            EventSubscription subscription = {
+                .topic = EVENT_TOPIC_LOG,
+                .type_mask = EVENT_TYPE_ALL,
+                .handler = dispatch_log,
+                .context = &logger.callbacks[i],
+                .payload_size = sizeof(DiagLogEntry),
+                .depth = LOG_QUEUE_DEPTH,
+                .policy = EVENT_POLICY_DROP_NEWEST
+            };
+
             logger.callbacks[i].callback = callback;
             logger.callbacks[i].context = context;
-            logger.callbacks[i].active = true;
+            logger.callbacks[i].subscriber = EventBus_Subscribe(&subscription);
+            logger.callbacks[i].active = logger.callbacks[i].subscriber >= 0;
+            if (!logger.callbacks[i].active) return;
             
             if (i >= logger.callback_count) {
                 logger.callback_count = i + 1;
@@ -108,9 +116,8 @@ void DiagLogger_UnregisterCallback(DiagLogCallback callback) {
     if (!logger.initialized || !callback) return;
     
     for (uint32_t i = 0; i < logger.callback_count; i++) {
-        if (logger.callbacks[i].callback == callback) {
-            logger.callbacks[i].callback = NULL;
-            logger.callbacks[i].context = NULL;
+        if (logger.callbacks[i].active && logger.callbacks[i].callback == callback) {
+            EventBus_Unsubscribe(logger.callbacks[i].subscriber);
             logger.callbacks[i].active = false;
             
             // Update callback count if possible
@@ -142,12 +149,7 @@ void DiagLogger_Log(DiagLogLevel level,
     vsnprintf(entry.message, sizeof(entry.message), format, args);
     va_end(args);
     
-    buffer_log(&entry);
-    
-    // Flush immediately for error logs
-    if (level == LOG_LEVEL_ERROR) {
-        flush_buffer();
-    }
+    publish_log(&entry);
 }
 
 void DiagLogger_LogHex(DiagLogLevel level,
@@ -178,10 +180,5 @@ void DiagLogger_LogHex(DiagLogLevel level,
     memcpy(entry.data, data, copy_length);
     entry.data_length = copy_length;
     
-    buffer_log(&entry);
-    
-    // Flush immediately for error logs
-    if (level == LOG_LEVEL_ERROR) {
-        flush_buffer();
-    }
+    publish_log(&entry);
 } 
\ No newline at end of file
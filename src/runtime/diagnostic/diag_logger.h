@@ -38,7 +38,7 @@ typedef struct {
     uint32_t data_length;
 } DiagLogEntry;
 
-// Callback for log entries
+// Callback for log entries, run from EventBus_Dispatch
 typedef void (*DiagLogCallback)(const DiagLogEntry* entry, void* context);
 
 // Logger functions
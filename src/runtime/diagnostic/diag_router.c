@@ -16,7 +16,8 @@ static DiagRouterContext router;
 #endif
 
 // forward declarations
-static void process_route(const DiagRoute* route, const uint8_t* data, uint32_t length);
+static RouteResult route_message(const uint8_t* data, uint32_t length, bool shared);
+static void process_route(const DiagRoute* route, const uint8_t* data, uint32_t length, bool shared);
 static bool validate_message(const uint8_t* data, uint32_t length);
 
 bool DiagRouter_Init(void) {
@@ -108,6 +109,18 @@ RouteResult DiagRouter_RemoveRoute(uint8_t source, uint8_t target) {
 }
 
 RouteResult DiagRouter_HandleMessage(const uint8_t* data, uint32_t length) {
+    return route_message(data, length, false);
+}
+
+// The caller's reference keeps the buffer alive, so no copy is needed
+RouteResult DiagRouter_HandleBuffer(BufferDesc* desc) {
+    if (!desc) {
+        return ROUTE_INVALID_PARAM;
+    }
+    return route_message(BufferDesc_Data(desc), desc->length, true);
+}
+
+static RouteResult route_message(const uint8_t* data, uint32_t length, bool shared) {
     if (!router.initialized || !data || length == 0) {
         return ROUTE_INVALID_PARAM;
     }
@@ -135,7 +148,7 @@ RouteResult DiagRouter_HandleMessage(const uint8_t* data, uint32_t length) {
             route->target_addr == target &&
             (route->service_id == 0xFFFF || route->service_id == service)) {
             
-            process_route(route, data, length);
+            process_route(route, data, length, shared);
             route_found = true;
             // don't break - might have multiple routes
         }
@@ -145,7 +158,12 @@ RouteResult DiagRouter_HandleMessage(const uint8_t* data, uint32_t length) {
 }
 
 // internal stuff
-static void process_route(const DiagRoute* route, const uint8_t* data, uint32_t length) {
+static void process_route(const DiagRoute* route, const uint8_t* data, uint32_t length, bool shared) {
+    if (shared) {
+        DiagCore_HandleMessage(data, length);
+        return;
+    }
+
     // temporary copy to avoid buffer issues
     if (length > TEMP_BUFFER_SIZE) {
         DBG_PRINT("Message too long: %d\n", length);
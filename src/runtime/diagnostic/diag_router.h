@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "../network/buffer_manager.h"
 
 // TODO: make this configurable later
 #define MAX_ROUTES 16
@@ -44,6 +45,7 @@ void DiagRouter_Deinit(void);  // rarely used but keep for now
 RouteResult DiagRouter_AddRoute(uint8_t source, uint8_t target, uint16_t service);
 RouteResult DiagRouter_RemoveRoute(uint8_t source, uint8_t target);
 RouteResult DiagRouter_HandleMessage(const uint8_t* data, uint32_t length);
+RouteResult DiagRouter_HandleBuffer(BufferDesc* desc);  // zero-copy, caller keeps its ref
 
 // helper functions - might make static later
 bool is_route_valid(const DiagRoute* route);
@@ -3,8 +3,14 @@
 #include "diag_error.h"
 #include "../memory/memory_manager.h"
 #include "../diagnostic/logging/diag_logger.h"
+#include "../core/event_bus.h"
 #include <string.h>
 
+// Transitions queued per callback. They are often published from the
+// thread that dispatches them, so a full queue evicts the oldest rather
+// than stall the publisher.
+#define STATE_QUEUE_DEPTH 16
+
 // Maximum number of transitions to keep in history
 #define MAX_TRANSITION_HISTORY 32
 
@@ -25,6 +31,7 @@ static const int8_t state_transition_matrix[][8] = {
 typedef struct {
     DiagStateCallback callback;
     void* context;
+    int32_t subscriber;
     bool active;
 } StateCallback;
 
@@ -94,6 +101,14 @@ void DiagState_Deinit(void) {
     
     notify_state_change(&transition);
     
+    // Deliver what is still queued, the final transition included
+    for (uint32_t i = 0; i < state_machine.callback_count; i++) {
+        if (state_machine.callbacks[i].active) {
+            EventBus_Flush(state_machine.callbacks[i].subscriber);
+            EventBus_Unsubscribe(state_machine.callbacks[i].subscriber);
+        }
+    }
+    
     // Clear all callbacks and custom states
     memset(state_machine.callbacks, 0, sizeof(state_machine.callbacks));
     memset(state_machine.custom_states, 0, sizeof(state_machine.custom_states));
@@ -278,12 +293,14 @@ static DiagState determine_next_state(DiagState current, DiagStateEvent event) {
 }
 
 static void notify_state_change(const DiagStateTransition* transition) {
-    for (uint32_t i = 0; i < state_machine.callback_count; i++) {
-        if (state_machine.callbacks[i].active && 
-            state_machine.callbacks[i].callback) {
-            state_machine.callbacks[i].callback(transition, 
-                                             state_machine.callbacks[i].context);
-        }
+    EventBus_Publish(EVENT_TOPIC_DIAG_STATE, (uint16_t)transition->to_state,
+                     transition, sizeof(DiagStateTransition));
+}
+
+static void dispatch_state_change(const BusEvent* event, void* context) {
+    StateCallback* cb = (StateCallback*)context;
+    if (cb->active && cb->callback) {
+        cb->callback((const DiagStateTransition*)event->payload, cb->context);
     }
 }
 
@@ -294,9 +311,9 @@ bool DiagState_RegisterCallback(DiagStateCallback callback, void* context) {
     
     // Check if callback already registered
     for (uint32_t i = 0; i < state_machine.callback_count; i++) {
-        if (state_machine.callbacks[i].callback == callback) {
+        if (state_machine.callbacks[i].active &&
+            state_machine.callbacks[i].callback == callback) {
             state_machine.callbacks[i].context = context;
-            state_machine.callbacks[i].active = true;
             return true;
         }
     }
@@ -304,8 +321,24 @@ bool DiagState_RegisterCallback(DiagStateCallback callback, void* context) {
     // Find free slot
     for (uint32_t i = 0; i < MAX_STATE_CALLBACKS; i++) {
         if (!state_machine.callbacks[i].active) {
+            EventSubscription subscription = {
+                .topic = EVENT_TOPIC_DIAG_STATE,
+                .type_mask = EVENT_TYPE_ALL,
+                .handler = dispatch_state_change,
+                .context = &state_machine.callbacks[i],
+                .payload_size = sizeof(DiagStateTransition),
+                .depth = STATE_QUEUE_DEPTH,
+                .policy = EVENT_POLICY_DROP_OLDEST
+            };
+            
             state_machine.callbacks[i].callback = callback;
             state_machine.callbacks[i].context = context;
+            state_machine.callbacks[i].subscriber = EventBus_Subscribe(&subscription);
+            if (state_machine.callbacks[i].subscriber < 0) {
+                DIAG_ERROR_SET(ERROR_SYSTEM_RESOURCE_BUSY,
+                              "Event bus has no room for state callback");
+                return false;
+            }
             state_machine.callbacks[i].active = true;
             
             if (i >= state_machine.callback_count) {
@@ -327,7 +360,9 @@ void DiagState_UnregisterCallback(DiagStateCallback callback) {
     }
     
     for (uint32_t i = 0; i < state_machine.callback_count; i++) {
-        if (state_machine.callbacks[i].callback == callback) {
+        if (state_machine.callbacks[i].active &&
+            state_machine.callbacks[i].callback == callback) {
+            EventBus_Unsubscribe(state_machine.callbacks[i].subscriber);
             state_machine.callbacks[i].callback = NULL;
             state_machine.callbacks[i].context = NULL;
             state_machine.callbacks[i].active = false;
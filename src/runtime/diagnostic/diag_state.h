@@ -66,7 +66,8 @@ typedef struct {
     void* data;                   // Event-specific data
 } DiagStateTransition;
 
-// State change callback
+// State change callback. Runs from EventBus_Dispatch after the
+// transition, so transition->data must outlive the dispatch to be used.
 typedef void (*DiagStateCallback)(const DiagStateTransition* transition, void* context);
 
 // Custom state handler
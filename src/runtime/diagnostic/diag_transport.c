@@ -218,6 +218,7 @@ void Diag_Transport_ProcessReceived(const uint8_t* data, uint16_t length) {
                 } else {
                     UDS_Handler_SendNegativeResponse(request.service_id, result);
                 }
+                UDS_Handler_CompleteRequest(&response);
             }
             break;
         }
@@ -277,6 +278,7 @@ void Diag_Transport_ProcessReceived(const uint8_t* data, uint16_t length) {
                 } else {
                     UDS_Handler_SendNegativeResponse(request.service_id, result);
                 }
+                UDS_Handler_CompleteRequest(&response);
                 
                 reset_rx_state();
             } else {
@@ -3,9 +3,11 @@
 #include "../utils/timer.h"
 #include "../os/critical.h"
 #include "../memory/memory_manager.h"
+#include "../core/event_bus.h"
 
 #define MAX_EVENTS 1000
 #define MAX_EVENT_DATA_SIZE 512
+#define EVENT_QUEUE_DEPTH 64
 
 // Internal event storage
 typedef struct {
@@ -16,6 +18,7 @@ typedef struct {
     uint32_t event_data_buffer_size;
     DiagEventConfig config;
     CriticalSection critical;
+    int32_t subscriber;
     bool initialized;
 } EventStorage;
 
@@ -58,6 +61,13 @@ static bool allocate_event_data(DiagEventData* event, uint16_t size) {
     return true;
 }
 
+static void dispatch_event(const BusEvent* event, void* context) {
+    (void)context;
+    if (event_storage.config.event_callback) {
+        event_storage.config.event_callback((const DiagEventData*)event->payload);
+    }
+}
+
 bool Event_Handler_Init(const DiagEventConfig* config) {
     if (!config || config->max_events == 0 || 
         config->max_events > MAX_EVENTS ||
@@ -91,6 +101,20 @@ bool Event_Handler_Init(const DiagEventConfig* config) {
     event_storage.event_count = 0;
     event_storage.max_events = config->max_events;
     event_storage.event_data_buffer_size = total_data_size;
+    event_storage.subscriber = -1;
+
+    // Events stay in storage, so a full queue only costs the notification
+    if (config->event_callback) {
+        EventSubscription subscription = {
+            .topic = EVENT_TOPIC_DIAG_EVENT,
+            .type_mask = EVENT_TYPE_ALL,
+            .handler = dispatch_event,
+            .payload_size = sizeof(DiagEventData),
+            .depth = EVENT_QUEUE_DEPTH,
+            .policy = EVENT_POLICY_DROP_NEWEST
+        };
+        event_storage.subscriber = EventBus_Subscribe(&subscription);
+    }
     event_storage.initialized = true;
 
     exit_critical(&event_storage.critical);
@@ -100,6 +124,10 @@ bool Event_Handler_Init(const DiagEventConfig* config) {
 void Event_Handler_DeInit(void) {
     enter_critical(&event_storage.critical);
 
+    if (event_storage.subscriber >= 0) {
+        EventBus_Unsubscribe(event_storage.subscriber);
+    }
+
     if (event_storage.events) {
         memory_free(event_storage.events);
     }
@@ -120,6 +148,7 @@ bool Event_Handler_ReportEvent(const DiagEventData* event) {
     enter_critical(&event_storage.critical);
 
     // Check if event already exists
+    DiagEventData* stored;
     DiagEventData* existing = find_event(event->event_id);
     if (existing) {
         // Update existing event
@@ -140,6 +169,7 @@ bool Event_Handler_ReportEvent(const DiagEventData* event) {
         }
         
         strncpy(existing->description, event->description, sizeof(existing->description) - 1);
+        stored = existing;
     } else {
         // Add new event
         if (event_storage.event_count >= event_storage.max_events) {
@@ -160,6 +190,7 @@ bool Event_Handler_ReportEvent(const DiagEventData* event) {
         }
 
         event_storage.event_count++;
+        stored = new_event;
     }
 
     // Handle automatic DTC creation if enabled
@@ -170,9 +201,11 @@ bool Event_Handler_ReportEvent(const DiagEventData* event) {
         }
     }
 
-    // Notify callback if registered
-    if (event_storage.config.event_callback) {
-        event_storage.config.event_callback(event);
+    // The callback runs later from EventBus_Dispatch, outside this lock;
+    // its data pointer refers to storage and stays valid until DeInit
+    if (event_storage.subscriber >= 0) {
+        EventBus_Publish(EVENT_TOPIC_DIAG_EVENT, (uint16_t)stored->type,
+                         stored, sizeof(DiagEventData));
     }
 
     exit_critical(&event_storage.critical);
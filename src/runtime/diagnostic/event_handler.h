@@ -38,7 +38,7 @@ typedef struct {
     uint32_t max_event_data_size;
     bool enable_event_logging;
     bool enable_auto_dtc;
-    void (*event_callback)(const DiagEventData* event);
+    void (*event_callback)(const DiagEventData* event);    // Runs from EventBus_Dispatch
 } DiagEventConfig;
 
 // Event Handler API
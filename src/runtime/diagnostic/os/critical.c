@@ -21,9 +21,21 @@ void exit_critical(void) {
 
 #else
 #include <pthread.h>
-static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t mutex;
+static pthread_once_t mutex_once = PTHREAD_ONCE_INIT;
+
+// Recursive like the Windows CRITICAL_SECTION: callers such as net_core
+// raise events and reconnect interfaces while already holding the lock
+static void init_mutex(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
 
 void enter_critical(void) {
+    pthread_once(&mutex_once, init_mutex);
     pthread_mutex_lock(&mutex);
 }
 
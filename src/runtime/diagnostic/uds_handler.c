@@ -4,6 +4,9 @@
 #include "../os/critical.h"
 #include "dtc_manager.h"
 #include "event_handler.h"
+#include "diag_arena.h"
+
+#define UDS_READ_BUFFER_SIZE 256
 
 // Internal state structure
 typedef struct {
@@ -17,6 +20,13 @@ typedef struct {
         bool security_locked;
         bool initialized;
     } state;
+    // Scratch arenas of requests whose response has not been sent yet;
+    // response payloads may point into them
+    struct {
+        const UdsMessage* response;
+        MemArena* arena;
+    } pending[DIAG_ARENA_COUNT];
+    MemArena* request_arena;    // Arena of the request being processed
     CriticalSection critical;
 } UdsHandler;
 
@@ -54,6 +64,43 @@ static bool validate_service_access(UdsServiceId service_id, UdsSessionType sess
     return false;
 }
 
+static MemArena* acquire_request_arena(const UdsMessage* response) {
+    int32_t free_slot = -1;
+
+    for (int32_t i = 0; i < DIAG_ARENA_COUNT; i++) {
+        if (uds_handler.pending[i].response == response) {
+            // The previous response in this buffer was never sent; reuse its arena
+            MemArena_Reset(uds_handler.pending[i].arena);
+            return uds_handler.pending[i].arena;
+        }
+        if (!uds_handler.pending[i].arena && free_slot < 0) {
+            free_slot = i;
+        }
+    }
+
+    if (free_slot < 0) {
+        return NULL;
+    }
+
+    MemArena* arena = DiagArena_Acquire();
+    if (arena) {
+        uds_handler.pending[free_slot].response = response;
+        uds_handler.pending[free_slot].arena = arena;
+    }
+    return arena;
+}
+
+static void release_request_arena(const UdsMessage* response) {
+    for (uint32_t i = 0; i < DIAG_ARENA_COUNT; i++) {
+        if (uds_handler.pending[i].arena && uds_handler.pending[i].response == response) {
+            DiagArena_Release(uds_handler.pending[i].arena);
+            uds_handler.pending[i].response = NULL;
+            uds_handler.pending[i].arena = NULL;
+            return;
+        }
+    }
+}
+
 static uint32_t calculate_key(uint32_t seed) {
     // Example key calculation algorithm (should be more complex in production)
     return ((seed ^ 0x55AA55AA) + 0x12345678) ^ 0xAA55AA55;
@@ -190,9 +237,12 @@ static bool process_read_data_by_identifier(const UdsMessage* request, UdsMessag
     uint16_t data_identifier;
     memcpy(&data_identifier, &request->data[1], 2);
 
-    // Buffer for read data (adjust size as needed)
-    static uint8_t read_buffer[256];
+    // Scratch for read data, dropped with the request arena
+    uint8_t* read_buffer = MemArena_Alloc(uds_handler.request_arena, UDS_READ_BUFFER_SIZE);
     uint16_t read_length = 0;
+    if (!read_buffer) {
+        return false;
+    }
 
     // Read data based on identifier
     switch (data_identifier) {
@@ -224,6 +274,14 @@ static bool process_read_data_by_identifier(const UdsMessage* request, UdsMessag
             return false;
     }
 
+    // Without a caller buffer the payload lives in the arena until it is sent
+    if (!response->data) {
+        response->data = MemArena_Alloc(uds_handler.request_arena, 2 + read_length);
+        if (!response->data) {
+            return false;
+        }
+    }
+
     response->service_id = request->service_id + 0x40;
     memcpy(response->data, &data_identifier, 2);
     memcpy(&response->data[2], read_buffer, read_length);
@@ -261,6 +319,9 @@ bool UDS_Handler_Init(const UdsConfig* config) {
 
 void UDS_Handler_DeInit(void) {
     enter_critical(&uds_handler.critical);
+    for (uint32_t i = 0; i < DIAG_ARENA_COUNT; i++) {
+        DiagArena_Release(uds_handler.pending[i].arena);
+    }
     memset(&uds_handler, 0, sizeof(UdsHandler));
     exit_critical(&uds_handler.critical);
 }
@@ -283,6 +344,13 @@ UdsResponseCode UDS_Handler_ProcessRequest(const UdsMessage* request, UdsMessage
         return UDS_RESPONSE_SERVICE_NOT_SUPPORTED;
     }
 
+    MemArena* arena = acquire_request_arena(response);
+    if (!arena) {
+        exit_critical(&uds_handler.critical);
+        return UDS_RESPONSE_BUSY_REPEAT_REQUEST;
+    }
+    uds_handler.request_arena = arena;
+
     bool result = false;
     switch (request->service_id) {
         case UDS_SID_DIAGNOSTIC_SESSION_CONTROL:
@@ -313,6 +381,13 @@ UdsResponseCode UDS_Handler_ProcessRequest(const UdsMessage* request, UdsMessage
             break;
     }
 
+    uds_handler.request_arena = NULL;
+
+    // Negative responses carry no payload, so nothing can reference the arena
+    if (!result) {
+        release_request_arena(response);
+    }
+
     exit_critical(&uds_handler.critical);
     return result ? UDS_RESPONSE_POSITIVE : UDS_RESPONSE_SERVICE_NOT_SUPPORTED;
 }
@@ -393,9 +468,22 @@ bool UDS_Handler_SendResponse(const UdsMessage* response) {
 
     // Send response using platform-specific communication
     // return platform_send_diagnostic_response(response_buffer, total_length);
+    UDS_Handler_CompleteRequest(response);
     return true; // Placeholder
 }
 
+// Drop the scratch arena of a processed request. Called by SendResponse;
+// transports that send responses themselves must call it once done.
+void UDS_Handler_CompleteRequest(const UdsMessage* response) {
+    if (!uds_handler.state.initialized || !response) {
+        return;
+    }
+
+    enter_critical(&uds_handler.critical);
+    release_request_arena(response);
+    exit_critical(&uds_handler.critical);
+}
+
 bool UDS_Handler_SendNegativeResponse(UdsServiceId service_id, UdsResponseCode response_code) {
     if (!uds_handler.state.initialized) {
         return false;
@@ -48,6 +48,7 @@ typedef enum {
     UDS_RESPONSE_SERVICE_NOT_SUPPORTED = 0x11,
     UDS_RESPONSE_SUBFUNCTION_NOT_SUPPORTED = 0x12,
     UDS_RESPONSE_INCORRECT_LENGTH      = 0x13,
+    UDS_RESPONSE_BUSY_REPEAT_REQUEST   = 0x21,
     UDS_RESPONSE_CONDITIONS_NOT_CORRECT = 0x22,
     UDS_RESPONSE_REQUEST_SEQUENCE_ERROR = 0x24,
     UDS_RESPONSE_REQUEST_OUT_OF_RANGE  = 0x31,
@@ -91,6 +92,7 @@ bool UDS_Handler_IsSecurityUnlocked(uint8_t level);
 void UDS_Handler_ProcessTimeout(void);
 bool UDS_Handler_SendResponse(const UdsMessage* response);
 bool UDS_Handler_SendNegativeResponse(UdsServiceId service_id, UdsResponseCode response_code);
+void UDS_Handler_CompleteRequest(const UdsMessage* response);
 void UDS_Handler_ResetSession(void);
 bool UDS_Handler_IsServiceAllowed(UdsServiceId service_id);
 uint32_t UDS_Handler_GetSessionTimeout(void);
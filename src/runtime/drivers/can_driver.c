@@ -1,9 +1,12 @@
 #include "can_driver.h"
+#include "can_filter.h"
+#include "can_tx_queue.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include "../utils/error.h"
 #include "../os/critical.h"
+#include "../diagnostic/os/timer.h"
 
 // Internal structures
 struct CANDriver {
@@ -15,17 +18,24 @@ struct CANDriver {
     // Hardware registers (platform specific)
     volatile uint32_t* can_base;
     
-    // Message queues
-    Queue tx_queue;
+    // Message queues; TX is ordered by ID and feeds the mailboxes. RX holds
+    // CANClassicFrame, or CANFDFrame when FD is enabled.
+    CANTxQueue* tx_queue;
     Queue rx_queue;
+    size_t rx_frame_size;
     
-    // Filter bank
+    // ISR scratch: one IFLAG1 scan worth of frames
+    union {
+        CANClassicFrame classic[32];
+        CANFDFrame fd[32];
+    } rx_drain;
+    
+    // Filter bank; the ISR matches against the compiled form
     struct {
-        uint32_t* ids;
-        uint32_t* masks;
-        bool* is_extended;
+        CANFilterRule* rules;
         size_t count;
         size_t capacity;
+        CANFilter* compiled;    // NULL accepts everything
     } filters;
     
     // Interrupt handling
@@ -47,6 +57,19 @@ struct CANDriver {
 #define CAN_ESR1    0x20
 #define CAN_IMASK1  0x28
 #define CAN_IFLAG1  0x30
+#define CAN_MB_CS(n) (0x80 + (n) * 0x10)
+
+// Message buffer control/status word
+#define CAN_CS_EDL              0x80000000
+#define CAN_CS_IDE              0x00200000
+#define CAN_CS_RTR              0x00100000
+#define CAN_CS_CODE_MASK        0x0F000000
+#define CAN_CS_CODE_TX_ABORT    0x09000000
+#define CAN_CS_CODE_TX_DATA     0x0C000000
+
+#define CAN_TX_MB_FIRST 8   // TX mailboxes follow the RX ones
+#define CAN_TX_DEPTH    32
+#define CAN_RX_DEPTH    32
 
 // Helper functions
 static bool configure_hardware(CANDriver* driver) {
@@ -102,26 +125,98 @@ static bool configure_hardware(CANDriver* driver) {
     return true;
 }
 
+// FD DLC codes above 8 map to these lengths
+static uint8_t dlc_length(uint32_t dlc) {
+    static const uint8_t lengths[] = { 12, 16, 20, 24, 32, 48, 64 };
+    return dlc <= 8 ? (uint8_t)dlc : lengths[dlc - 9];
+}
+
+// Payload words are big-endian: byte 0 sits in bits 31-24 of the first
+static void read_payload(volatile const uint32_t* words, uint8_t* data, uint8_t length) {
+    for (uint8_t i = 0; i < length; i += 4) {
+        uint32_t word = words[i / 4];
+        for (uint8_t j = 0; j < 4 && i + j < length; j++) {
+            data[i + j] = (uint8_t)(word >> (24 - 8 * j));
+        }
+    }
+}
+
+// Reads one RX mailbox into a compact frame; false when it is filtered out
+static bool read_mailbox(CANDriver* driver, uint32_t index, uint32_t* id, uint8_t* dlc,
+                         uint8_t* flags, uint16_t* time_stamp, uint8_t* data, uint8_t max) {
+    volatile const uint32_t* mb = &driver->can_base[CAN_MB_CS(index)];
+    uint32_t cs = mb[0];    // Reading CS locks the mailbox until the timer is read
+    bool is_extended = (cs & CAN_CS_IDE) != 0;
+    
+    *id = is_extended ? mb[1] & 0x1FFFFFFF : (mb[1] >> 18) & 0x7FF;
+    if (driver->filters.compiled &&
+        can_filter_lookup(driver->filters.compiled, *id, is_extended) == CAN_FILTER_REJECT) {
+        return false;
+    }
+    
+    // Classic frames carry at most 8 bytes whatever the DLC says
+    uint32_t code = (cs >> 16) & 0xF;
+    uint8_t length = (cs & CAN_CS_EDL) ? dlc_length(code) : (uint8_t)(code > 8 ? 8 : code);
+    *dlc = length > max ? max : length;
+    *flags = (is_extended ? CAN_FRAME_EXTENDED : 0) |
+             ((cs & CAN_CS_RTR) ? CAN_FRAME_REMOTE : 0) |
+             ((cs & CAN_CS_EDL) ? CAN_FRAME_FD : 0);
+    *time_stamp = (uint16_t)cs;
+    read_payload(&mb[2], data, *dlc);
+    return true;
+}
+
+// Drains every RX mailbox flagged in IFLAG1 in one scan, hands the frames
+// to the queue in one push and acknowledges all the flags with one write
 static void process_rx_interrupt(CANDriver* driver) {
     assert(driver != NULL);
     
-    uint32_t flags = driver->can_base[CAN_IFLAG1];
+    uint32_t rx_mask = driver->config.rx_mailboxes >= 32 ?
+                       0xFFFFFFFF : (1u << driver->config.rx_mailboxes) - 1;
+    uint32_t pending = driver->can_base[CAN_IFLAG1] & rx_mask;
+    size_t count = 0;
+    
+    if (!pending) return;
+    
+    for (uint32_t bits = pending; bits; bits &= bits - 1) {
+        uint32_t i = (uint32_t)__builtin_ctz(bits);
+        bool kept;
+        
+        if (driver->config.fd_enabled) {
+            CANFDFrame* frame = &driver->rx_drain.fd[count];
+            kept = read_mailbox(driver, i, &frame->id, &frame->dlc, &frame->flags,
+                                &frame->time_stamp, frame->data, 64);
+        } else {
+            CANClassicFrame* frame = &driver->rx_drain.classic[count];
+            kept = read_mailbox(driver, i, &frame->id, &frame->dlc, &frame->flags,
+                                &frame->time_stamp, frame->data, 8);
+        }
+        count += kept;
+    }
     
-    for (uint8_t i = 0; i < driver->config.rx_mailboxes; i++) {
-        if (flags & (1 << i)) {
-            // Read frame from mailbox
-            CANFrame frame;
-            // ... read frame data ...
-            
-            // Add to RX queue
-            if (!queue_push(&driver->rx_queue, &frame, sizeof(frame))) {
-                driver->statistics.overflow_count++;
-            } else {
-                driver->statistics.rx_count++;
-            }
-            
-            // Clear interrupt flag
-            driver->can_base[CAN_IFLAG1] = (1 << i);
+    // Unlock the last mailbox read, then clear the flags we handled
+    (void)driver->can_base[CAN_TIMER];
+    driver->can_base[CAN_IFLAG1] = pending;
+    
+    size_t queued = queue_push_n(&driver->rx_queue, &driver->rx_drain, count);
+    driver->statistics.rx_count += (uint32_t)queued;
+    driver->statistics.overflow_count += (uint32_t)(count - queued);
+}
+
+// Keeps the TX mailboxes holding the most urgent frames. Called with the
+// critical section held.
+static void service_tx_mailboxes(CANDriver* driver) {
+    CANTxCommand command;
+    
+    while (can_tx_queue_next(driver->tx_queue, &command) != CAN_TX_IDLE) {
+        uint32_t cs = CAN_MB_CS(CAN_TX_MB_FIRST + command.mailbox);
+        
+        if (command.action == CAN_TX_LOAD) {
+            // ... write ID and data words ...
+            driver->can_base[cs] = CAN_CS_CODE_TX_DATA | ((uint32_t)command.frame->dlc << 16);
+        } else {
+            // Completes with CODE=ABORT, or INACTIVE if the frame already won the bus
+            driver->can_base[cs] = CAN_CS_CODE_TX_ABORT;
         }
     }
 }
@@ -130,22 +225,27 @@ static void process_tx_interrupt(CANDriver* driver) {
     assert(driver != NULL);
     
     uint32_t flags = driver->can_base[CAN_IFLAG1];
+    uint32_t now = Timer_GetMicroseconds();
     
     for (uint8_t i = 0; i < driver->config.tx_mailboxes; i++) {
-        if (flags & (1 << (i + 8))) {  // TX mailboxes start at bit 8
+        uint32_t bit = 1u << (CAN_TX_MB_FIRST + i);
+        if (!(flags & bit)) continue;
+        
+        uint32_t code = driver->can_base[CAN_MB_CS(CAN_TX_MB_FIRST + i)] & CAN_CS_CODE_MASK;
+        
+        // Clear interrupt flag
+        driver->can_base[CAN_IFLAG1] = bit;
+        
+        if (code == CAN_CS_CODE_TX_ABORT) {
+            can_tx_queue_aborted(driver->tx_queue, i);
+        } else {
             driver->statistics.tx_count++;
-            
-            // Clear interrupt flag
-            driver->can_base[CAN_IFLAG1] = (1 << (i + 8));
-            
-            // Check if more frames to send
-            CANFrame frame;
-            if (queue_pop(&driver->tx_queue, &frame, sizeof(frame))) {
-                // Load next frame into mailbox
-                // ... write frame data ...
-            }
+            can_tx_queue_complete(driver->tx_queue, i, now);
         }
     }
+    
+    // Refill freed mailboxes, or pre-empt one for a more urgent frame
+    service_tx_mailboxes(driver);
 }
 
 // Interrupt handler
@@ -180,23 +280,21 @@ CANDriver* can_create(const CANConfig* config) {
     memcpy(&driver->config, config, sizeof(CANConfig));
     
     // Initialize queues
-    if (!queue_init(&driver->tx_queue, sizeof(CANFrame), 32) ||
-        !queue_init(&driver->rx_queue, sizeof(CANFrame), 32)) {
+    driver->rx_frame_size = config->fd_enabled ? sizeof(CANFDFrame) : sizeof(CANClassicFrame);
+    driver->tx_queue = can_tx_queue_create(CAN_TX_DEPTH, config->tx_mailboxes);
+    if (!driver->tx_queue ||
+        !queue_init(&driver->rx_queue, driver->rx_frame_size, CAN_RX_DEPTH)) {
+        can_tx_queue_destroy(driver->tx_queue);
         free(driver);
         return NULL;
     }
     
     // Initialize filter bank
     driver->filters.capacity = 16;
-    driver->filters.ids = calloc(driver->filters.capacity, sizeof(uint32_t));
-    driver->filters.masks = calloc(driver->filters.capacity, sizeof(uint32_t));
-    driver->filters.is_extended = calloc(driver->filters.capacity, sizeof(bool));
-    
-    if (!driver->filters.ids || !driver->filters.masks || !driver->filters.is_extended) {
-        free(driver->filters.ids);
-        free(driver->filters.masks);
-        free(driver->filters.is_extended);
-        queue_destroy(&driver->tx_queue);
+    driver->filters.rules = calloc(driver->filters.capacity, sizeof(CANFilterRule));
+    
+    if (!driver->filters.rules) {
+        can_tx_queue_destroy(driver->tx_queue);
         queue_destroy(&driver->rx_queue);
         free(driver);
         return NULL;
@@ -217,10 +315,9 @@ void can_destroy(CANDriver* driver) {
     
     can_stop(driver);
     
-    free(driver->filters.ids);
-    free(driver->filters.masks);
-    free(driver->filters.is_extended);
-    queue_destroy(&driver->tx_queue);
+    free(driver->filters.rules);
+    can_filter_destroy(driver->filters.compiled);
+    can_tx_queue_destroy(driver->tx_queue);
     queue_destroy(&driver->rx_queue);
     destroy_critical(&driver->critical);
     
@@ -247,7 +344,7 @@ void can_stop(CANDriver* driver) {
     driver->can_base[CAN_MCR] |= 0x80000000;
     
     // Clear queues
-    queue_clear(&driver->tx_queue);
+    can_tx_queue_clear(driver->tx_queue);
     queue_clear(&driver->rx_queue);
     
     driver->state = CAN_STATE_STOPPED;
@@ -260,24 +357,117 @@ bool can_transmit(CANDriver* driver, const CANFrame* frame, uint32_t timeout_ms)
     
     enter_critical(&driver->critical);
     
-    bool result = queue_push(&driver->tx_queue, frame, sizeof(CANFrame));
+    bool result = can_tx_queue_push(driver->tx_queue, frame, Timer_GetMicroseconds());
     
     if (result) {
-        // Trigger transmission if no active TX
-        if (!driver->interrupts.tx_complete) {
-            // Load frame into empty mailbox
-            // ... write frame data ...
-        }
+        // Load an empty mailbox, or abort a less urgent frame to make room
+        service_tx_mailboxes(driver);
+    } else {
+        driver->statistics.overflow_count++;
     }
     
     exit_critical(&driver->critical);
     return result;
 }
 
+uint32_t can_transmit_batch(CANDriver* driver, const CANFrameBatch* batch, uint32_t timeout_ms) {
+    if (!driver || !batch || driver->state != CAN_STATE_STARTED) return 0;
+    
+    uint32_t now = Timer_GetMicroseconds();
+    uint32_t queued = 0;
+    
+    enter_critical(&driver->critical);
+    
+    for (; queued < batch->count; queued++) {
+        CANFrame frame;
+        can_batch_get(batch, queued, &frame);
+        if (!can_tx_queue_push(driver->tx_queue, &frame, now)) {
+            driver->statistics.overflow_count++;
+            break;
+        }
+    }
+    
+    // One pass over the mailboxes for the whole batch
+    service_tx_mailboxes(driver);
+    
+    exit_critical(&driver->critical);
+    return queued;
+}
+
 bool can_receive(CANDriver* driver, CANFrame* frame, uint32_t timeout_ms) {
     if (!driver || !frame || driver->state != CAN_STATE_STARTED) return false;
     
-    return queue_pop(&driver->rx_queue, frame, sizeof(CANFrame));
+    union {
+        CANClassicFrame classic;
+        CANFDFrame fd;
+    } slot;
+    
+    if (!queue_pop(&driver->rx_queue, &slot, driver->rx_frame_size)) {
+        return false;
+    }
+    
+    if (driver->config.fd_enabled) {
+        can_frame_expand_fd(&slot.fd, frame);
+        frame->timestamp = slot.fd.time_stamp;
+    } else {
+        can_frame_expand(&slot.classic, frame);
+        frame->timestamp = slot.classic.time_stamp;
+    }
+    return true;
+}
+
+static bool store(CANFrameBatch* batch, uint32_t id, uint8_t dlc, uint8_t flags,
+                  uint16_t time_stamp, const uint8_t* data) {
+    if (dlc > batch->payload_size) return false;
+    
+    uint32_t i = batch->count++;
+    batch->timestamps[i] = time_stamp;
+    batch->ids[i] = id;
+    batch->dlcs[i] = dlc;
+    batch->flags[i] = flags;
+    memcpy(can_batch_payload(batch, i), data, dlc);
+    return true;
+}
+
+uint32_t can_receive_batch(CANDriver* driver, CANFrameBatch* batch, uint32_t timeout_ms) {
+    if (!driver || !batch || driver->state != CAN_STATE_STARTED) return 0;
+    
+    // Pops in chunks and spreads each one across the batch arrays
+    union {
+        CANClassicFrame classic[36];
+        CANFDFrame fd[8];
+    } chunk;
+    size_t per_chunk = driver->config.fd_enabled ? 8 : 36;
+    uint32_t dropped = 0;
+    
+    batch->count = 0;
+    while (batch->count < batch->capacity) {
+        size_t want = batch->capacity - batch->count;
+        if (want > per_chunk) want = per_chunk;
+        
+        size_t got = queue_pop_n(&driver->rx_queue, &chunk, want);
+        for (size_t i = 0; i < got; i++) {
+            bool stored;
+            if (driver->config.fd_enabled) {
+                const CANFDFrame* frame = &chunk.fd[i];
+                stored = store(batch, frame->id, frame->dlc, frame->flags,
+                               frame->time_stamp, frame->data);
+            } else {
+                const CANClassicFrame* frame = &chunk.classic[i];
+                stored = store(batch, frame->id, frame->dlc, frame->flags,
+                               frame->time_stamp, frame->data);
+            }
+            dropped += !stored;
+        }
+        if (got < want) break;
+    }
+    
+    if (dropped) {
+        enter_critical(&driver->critical);
+        driver->statistics.overflow_count += dropped;
+        exit_critical(&driver->critical);
+    }
+    return batch->count;
 }
 
 CANState can_get_state(const CANDriver* driver) {
@@ -296,25 +486,52 @@ void can_get_statistics(const CANDriver* driver, CANStats* stats) {
     exit_critical(&driver->critical);
 }
 
-bool can_set_filter(CANDriver* driver, uint32_t id, uint32_t mask, bool is_extended) {
-    if (!driver) return false;
+void can_get_tx_band_statistics(const CANDriver* driver, uint8_t band, CANTxBandStats* stats) {
+    if (!driver || !stats) return;
     
     enter_critical(&driver->critical);
+    can_tx_queue_get_band(driver->tx_queue, band, stats);
+    exit_critical(&driver->critical);
+}
+
+bool can_set_filter(CANDriver* driver, uint32_t id, uint32_t mask, bool is_extended) {
+    if (!driver) return false;
     
-    if (driver->filters.count >= driver->filters.capacity) {
-        exit_critical(&driver->critical);
+    // Build the new rule list and its compiled form off to the side, then
+    // publish both together so the list and count never disagree
+    size_t count = driver->filters.count;
+    size_t capacity = count == driver->filters.capacity ?
+                      driver->filters.capacity * 2 : driver->filters.capacity;
+    CANFilterRule* rules = malloc(capacity * sizeof(CANFilterRule));
+    if (!rules) return false;
+    
+    memcpy(rules, driver->filters.rules, count * sizeof(CANFilterRule));
+    rules[count] = (CANFilterRule){
+        .id = id,
+        .mask = mask,
+        .is_extended = is_extended,
+        .target = 0
+    };
+    CANFilter* compiled = can_filter_compile(rules, count + 1);
+    if (!compiled) {
+        free(rules);
         return false;
     }
     
-    size_t idx = driver->filters.count++;
-    driver->filters.ids[idx] = id;
-    driver->filters.masks[idx] = mask;
-    driver->filters.is_extended[idx] = is_extended;
+    enter_critical(&driver->critical);
+    CANFilterRule* previous_rules = driver->filters.rules;
+    CANFilter* previous = driver->filters.compiled;
+    driver->filters.rules = rules;
+    driver->filters.capacity = capacity;
+    driver->filters.compiled = compiled;
+    driver->filters.count = count + 1;
     
     // Update hardware filters
     // ... configure filter registers ...
     
     exit_critical(&driver->critical);
+    free(previous_rules);
+    can_filter_destroy(previous);
     return true;
 }
 
@@ -322,8 +539,11 @@ void can_clear_filters(CANDriver* driver) {
     if (!driver) return;
     
     enter_critical(&driver->critical);
+    CANFilter* previous = driver->filters.compiled;
+    driver->filters.compiled = NULL;
     driver->filters.count = 0;
     // Reset hardware filters
     driver->can_base[CAN_RXMGMASK] = 0xFFFFFFFF;
     exit_critical(&driver->critical);
+    can_filter_destroy(previous);
 } 
\ No newline at end of file
@@ -4,17 +4,13 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "../common/queue.h"
+#include "can_frame.h"
 
-// CAN frame structure aligned with AUTOSAR
-typedef struct {
-    uint32_t id;
-    uint8_t dlc;
-    bool is_extended;
-    bool is_fd;
-    bool is_remote;
-    uint8_t data[64];  // Support for CAN-FD
-    uint64_t timestamp;
-} CANFrame;
+// Three backends implement this API; link one of them:
+//   can_driver.c    - S32K3 FlexCAN registers
+//   can_socketcan.c - Linux SocketCAN (can0, vcan0, ...)
+//   can_virtual.c   - simulated in-process bus (can_virtual.h)
+// All also need can_frame.c, can_filter.c and can_tx_queue.c.
 
 // CAN controller configuration
 typedef struct {
@@ -26,6 +22,7 @@ typedef struct {
     bool auto_retransmit;
     uint8_t tx_mailboxes;
     uint8_t rx_mailboxes;
+    const char* interface_name;  // SocketCAN netdev; bitrate is set on the link, not here
 } CANConfig;
 
 // CAN controller states
@@ -63,6 +60,17 @@ typedef struct {
     uint8_t rx_error_counter;
 } CANStats;
 
+// Transmit latency per priority band. Bands split on the top 3 ID bits:
+// the J1939 priority for 29-bit IDs, 256-ID ranges for 11-bit IDs.
+#define CAN_TX_BANDS 8
+
+typedef struct {
+    uint32_t sent;
+    uint32_t aborted;       // Pulled out of a mailbox for a more urgent frame
+    uint64_t total_us;
+    uint32_t max_us;
+} CANTxBandStats;
+
 // CAN driver handle
 typedef struct CANDriver CANDriver;
 
@@ -73,9 +81,16 @@ bool can_start(CANDriver* driver);
 void can_stop(CANDriver* driver);
 bool can_transmit(CANDriver* driver, const CANFrame* frame, uint32_t timeout_ms);
 bool can_receive(CANDriver* driver, CANFrame* frame, uint32_t timeout_ms);
+// Refills batch with up to its capacity frames; waits up to timeout_ms
+// only for the first. Frames with more payload than the batch carries
+// (FD frames into a classic batch) are dropped and counted as overflow.
+uint32_t can_receive_batch(CANDriver* driver, CANFrameBatch* batch, uint32_t timeout_ms);
+// Sends the batch in order; returns how many frames were accepted
+uint32_t can_transmit_batch(CANDriver* driver, const CANFrameBatch* batch, uint32_t timeout_ms);
 CANState can_get_state(const CANDriver* driver);
 CANError can_get_last_error(const CANDriver* driver);
 void can_get_statistics(const CANDriver* driver, CANStats* stats);
+void can_get_tx_band_statistics(const CANDriver* driver, uint8_t band, CANTxBandStats* stats);
 bool can_set_filter(CANDriver* driver, uint32_t id, uint32_t mask, bool is_extended);
 void can_clear_filters(CANDriver* driver);
 
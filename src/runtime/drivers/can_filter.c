@@ -0,0 +1,249 @@
+#include "can_filter.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SFF_MASK    0x000007FFu
+#define EFF_MASK    0x1FFFFFFFu
+#define EMPTY_KEY   0xFFFFFFFFu     // Never a 29-bit ID
+#define NO_RULE     0xFFFFFFFFu
+
+typedef struct {
+    uint32_t key;
+    uint16_t rule;
+    uint16_t target;
+} Entry;
+
+// Open-addressed table of (id & mask) -> rule
+typedef struct {
+    Entry* entries;
+    uint32_t slot_mask;
+    uint32_t shift;
+    uint32_t id_mask;
+    uint32_t first_rule;    // Lowest rule in the table; later tables can't beat it
+} Table;
+
+struct CANFilter {
+    uint16_t standard[SFF_MASK + 1];
+    Table exact;
+    Table* groups;          // Sorted by first_rule
+    size_t group_count;
+};
+
+static uint32_t hash(const Table* table, uint32_t key) {
+    return (key * 0x9E3779B1u) >> table->shift;
+}
+
+static bool table_init(Table* table, size_t count, uint32_t id_mask) {
+    uint32_t bits = 2;
+    while ((1u << bits) < count * 2) {
+        bits++;
+    }
+
+    table->entries = malloc(sizeof(Entry) << bits);
+    if (!table->entries) {
+        return false;
+    }
+    for (uint32_t i = 0; i < (1u << bits); i++) {
+        table->entries[i].key = EMPTY_KEY;
+    }
+    table->slot_mask = (1u << bits) - 1;
+    table->shift = 32 - bits;
+    table->id_mask = id_mask;
+    table->first_rule = NO_RULE;
+    return true;
+}
+
+// Keeps whichever rule comes first when a key is inserted twice
+static void table_insert(Table* table, uint32_t key, uint16_t rule, uint16_t target) {
+    uint32_t slot = hash(table, key);
+
+    for (;;) {
+        Entry* entry = &table->entries[slot];
+        if (entry->key == EMPTY_KEY) {
+            *entry = (Entry){ key, rule, target };
+            break;
+        }
+        if (entry->key == key) {
+            if (rule < entry->rule) {
+                entry->rule = rule;
+                entry->target = target;
+            }
+            break;
+        }
+        slot = (slot + 1) & table->slot_mask;
+    }
+
+    if (rule < table->first_rule) {
+        table->first_rule = rule;
+    }
+}
+
+static const Entry* table_find(const Table* table, uint32_t id) {
+    uint32_t key = id & table->id_mask;
+    uint32_t slot = hash(table, key);
+
+    for (;;) {
+        const Entry* entry = &table->entries[slot];
+        if (entry->key == key) return entry;
+        if (entry->key == EMPTY_KEY) return NULL;
+        slot = (slot + 1) & table->slot_mask;
+    }
+}
+
+static uint32_t free_bits(const CANFilterRule* rule) {
+    return ~rule->mask & (rule->is_extended ? EFF_MASK : SFF_MASK);
+}
+
+static bool is_narrow(const CANFilterRule* rule) {
+    return __builtin_popcount(free_bits(rule)) <= CAN_FILTER_EXPAND_BITS;
+}
+
+static int compare_masks(const void* a, const void* b) {
+    const CANFilterRule* x = *(const CANFilterRule* const*)a;
+    const CANFilterRule* y = *(const CANFilterRule* const*)b;
+    uint32_t mx = x->mask & EFF_MASK;
+    uint32_t my = y->mask & EFF_MASK;
+    if (mx != my) return mx < my ? -1 : 1;
+    return x < y ? -1 : (x > y);
+}
+
+static int compare_groups(const void* a, const void* b) {
+    const Table* x = a;
+    const Table* y = b;
+    return x->first_rule < y->first_rule ? -1 : (x->first_rule > y->first_rule);
+}
+
+static bool build_groups(CANFilter* filter, const CANFilterRule* rules, size_t count) {
+    const CANFilterRule** wide = malloc(sizeof(*wide) * (count ? count : 1));
+    size_t wide_count = 0;
+
+    if (!wide) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (rules[i].is_extended && !is_narrow(&rules[i])) {
+            wide[wide_count++] = &rules[i];
+        }
+    }
+    qsort(wide, wide_count, sizeof(*wide), compare_masks);
+
+    size_t groups = 0;
+    for (size_t i = 0; i < wide_count; i++) {
+        if (i == 0 || (wide[i]->mask & EFF_MASK) != (wide[i - 1]->mask & EFF_MASK)) {
+            groups++;
+        }
+    }
+
+    filter->groups = calloc(groups ? groups : 1, sizeof(Table));
+    if (!filter->groups) {
+        free(wide);
+        return false;
+    }
+
+    for (size_t start = 0; start < wide_count; ) {
+        uint32_t mask = wide[start]->mask & EFF_MASK;
+        size_t end = start;
+        while (end < wide_count && (wide[end]->mask & EFF_MASK) == mask) {
+            end++;
+        }
+
+        Table* table = &filter->groups[filter->group_count];
+        if (!table_init(table, end - start, mask)) {
+            free(wide);
+            return false;
+        }
+        filter->group_count++;
+        for (size_t i = start; i < end; i++) {
+            table_insert(table, wide[i]->id & mask, (uint16_t)(wide[i] - rules), wide[i]->target);
+        }
+        start = end;
+    }
+
+    qsort(filter->groups, filter->group_count, sizeof(Table), compare_groups);
+    free(wide);
+    return true;
+}
+
+CANFilter* can_filter_compile(const CANFilterRule* rules, size_t count) {
+    if (count > CAN_FILTER_MAX_RULES || (count && !rules)) return NULL;
+
+    CANFilter* filter = calloc(1, sizeof(CANFilter));
+    if (!filter) return NULL;
+
+    memset(filter->standard, 0xFF, sizeof(filter->standard));
+
+    // Narrow 29-bit rules expand to at most 2^CAN_FILTER_EXPAND_BITS IDs
+    size_t expanded = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (rules[i].is_extended && is_narrow(&rules[i])) {
+            expanded += (size_t)1 << __builtin_popcount(free_bits(&rules[i]));
+        }
+    }
+
+    if (!table_init(&filter->exact, expanded, EFF_MASK) ||
+        !build_groups(filter, rules, count)) {
+        can_filter_destroy(filter);
+        return NULL;
+    }
+
+    // Walk backwards so earlier rules overwrite later ones in the 11-bit table
+    for (size_t i = count; i-- > 0; ) {
+        const CANFilterRule* rule = &rules[i];
+
+        if (rule->is_extended && !is_narrow(rule)) {
+            continue;
+        }
+
+        // Visit every accepted ID by walking the subsets of the free bits
+        uint32_t free = free_bits(rule);
+        uint32_t base = rule->id & rule->mask & (rule->is_extended ? EFF_MASK : SFF_MASK);
+        for (uint32_t sub = free; ; sub = (sub - 1) & free) {
+            if (rule->is_extended) {
+                table_insert(&filter->exact, base | sub, (uint16_t)i, rule->target);
+            } else {
+                filter->standard[base | sub] = rule->target;
+            }
+            if (sub == 0) break;
+        }
+    }
+
+    return filter;
+}
+
+void can_filter_destroy(CANFilter* filter) {
+    if (!filter) return;
+
+    free(filter->exact.entries);
+    for (size_t i = 0; i < filter->group_count; i++) {
+        free(filter->groups[i].entries);
+    }
+    free(filter->groups);
+    free(filter);
+}
+
+uint16_t can_filter_lookup(const CANFilter* filter, uint32_t id, bool is_extended) {
+    if (!filter) return CAN_FILTER_REJECT;
+
+    if (!is_extended) {
+        return filter->standard[id & SFF_MASK];
+    }
+
+    id &= EFF_MASK;
+    const Entry* best = table_find(&filter->exact, id);
+
+    for (size_t i = 0; i < filter->group_count; i++) {
+        const Table* table = &filter->groups[i];
+        if (best && best->rule < table->first_rule) {
+            break;    // No rule in this or any later group comes first
+        }
+
+        const Entry* entry = table_find(table, id);
+        if (entry && (!best || entry->rule < best->rule)) {
+            best = entry;
+        }
+    }
+
+    return best ? best->target : CAN_FILTER_REJECT;
+}
+
+size_t can_filter_mask_groups(const CANFilter* filter) {
+    return filter ? filter->group_count : 0;
+}
@@ -0,0 +1,45 @@
+#ifndef CANT_CAN_FILTER_H
+#define CANT_CAN_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Compiled acceptance filter. A rule set is turned into lookup tables
+// once; each frame then costs one array read (11-bit) or a hash probe per
+// distinct wide mask (29-bit), however many rules there are.
+//
+//   11-bit: a 2048-entry table holds the target of every ID
+//   29-bit: exact IDs, and masks leaving at most CAN_FILTER_EXPAND_BITS
+//           bits free, are expanded into one hash table; wider masks get
+//           a hash table per distinct mask, keyed by (id & mask)
+
+#define CAN_FILTER_REJECT       0xFFFFu
+#define CAN_FILTER_MAX_RULES    0xFFFFu
+#ifndef CAN_FILTER_EXPAND_BITS
+#define CAN_FILTER_EXPAND_BITS  8
+#endif
+
+// A frame matches when (frame id & mask) == (id & mask) and the frame
+// format equals is_extended
+typedef struct {
+    uint32_t id;
+    uint32_t mask;
+    bool is_extended;
+    uint16_t target;    // Handler or queue index; CAN_FILTER_REJECT denies
+} CANFilterRule;
+
+typedef struct CANFilter CANFilter;
+
+// Where rules overlap the earliest one wins. NULL when out of memory or
+// past CAN_FILTER_MAX_RULES.
+CANFilter* can_filter_compile(const CANFilterRule* rules, size_t count);
+void can_filter_destroy(CANFilter* filter);
+
+// Target of the first matching rule, or CAN_FILTER_REJECT
+uint16_t can_filter_lookup(const CANFilter* filter, uint32_t id, bool is_extended);
+
+// Wide-mask groups probed per 29-bit frame, for sizing rule sets
+size_t can_filter_mask_groups(const CANFilter* filter);
+
+#endif // CANT_CAN_FILTER_H
@@ -0,0 +1,104 @@
+#include "can_frame.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t pack_flags(const CANFrame* frame) {
+    return (frame->is_extended ? CAN_FRAME_EXTENDED : 0) |
+           (frame->is_remote ? CAN_FRAME_REMOTE : 0) |
+           (frame->is_fd ? CAN_FRAME_FD : 0);
+}
+
+static void unpack(uint32_t id, uint8_t dlc, uint8_t flags, const uint8_t* data,
+                   CANFrame* out) {
+    out->id = id;
+    out->dlc = dlc;
+    out->is_extended = (flags & CAN_FRAME_EXTENDED) != 0;
+    out->is_remote = (flags & CAN_FRAME_REMOTE) != 0;
+    out->is_fd = (flags & CAN_FRAME_FD) != 0;
+    out->timestamp = 0;
+    memcpy(out->data, data, dlc);
+}
+
+bool can_frame_compact(const CANFrame* frame, CANClassicFrame* out) {
+    if (!frame || !out || frame->is_fd || frame->dlc > 8) return false;
+
+    out->id = frame->id;
+    out->dlc = frame->dlc;
+    out->flags = pack_flags(frame);
+    out->time_stamp = 0;
+    memcpy(out->data, frame->data, sizeof(out->data));
+    return true;
+}
+
+void can_frame_expand(const CANClassicFrame* frame, CANFrame* out) {
+    if (!frame || !out) return;
+
+    unpack(frame->id, frame->dlc > 8 ? 8 : frame->dlc, frame->flags, frame->data, out);
+}
+
+bool can_frame_compact_fd(const CANFrame* frame, CANFDFrame* out) {
+    if (!frame || !out || frame->dlc > 64) return false;
+
+    out->id = frame->id;
+    out->dlc = frame->dlc;
+    out->flags = pack_flags(frame);
+    out->time_stamp = 0;
+    memcpy(out->data, frame->data, frame->dlc);
+    return true;
+}
+
+void can_frame_expand_fd(const CANFDFrame* frame, CANFrame* out) {
+    if (!frame || !out) return;
+
+    unpack(frame->id, frame->dlc > 64 ? 64 : frame->dlc, frame->flags, frame->data, out);
+}
+
+bool can_batch_init(CANFrameBatch* batch, uint32_t capacity, bool fd) {
+    if (!batch || capacity == 0) return false;
+
+    memset(batch, 0, sizeof(*batch));
+    batch->payload_size = fd ? 64 : 8;
+
+    // One block, widest arrays first so each stays aligned
+    size_t per_frame = sizeof(uint64_t) + sizeof(uint32_t) + batch->payload_size + 2;
+    uint8_t* block = malloc(per_frame * capacity);
+    if (!block) return false;
+
+    batch->timestamps = (uint64_t*)block;
+    batch->ids = (uint32_t*)(batch->timestamps + capacity);
+    batch->data = (uint8_t*)(batch->ids + capacity);
+    batch->dlcs = batch->data + (size_t)capacity * batch->payload_size;
+    batch->flags = batch->dlcs + capacity;
+    batch->capacity = capacity;
+    return true;
+}
+
+void can_batch_destroy(CANFrameBatch* batch) {
+    if (!batch) return;
+
+    free(batch->timestamps);
+    memset(batch, 0, sizeof(*batch));
+}
+
+bool can_batch_add(CANFrameBatch* batch, const CANFrame* frame) {
+    if (!batch || !frame || batch->count == batch->capacity ||
+        frame->dlc > batch->payload_size) {
+        return false;
+    }
+
+    uint32_t i = batch->count++;
+    batch->timestamps[i] = frame->timestamp;
+    batch->ids[i] = frame->id;
+    batch->dlcs[i] = frame->dlc;
+    batch->flags[i] = pack_flags(frame);
+    memcpy(can_batch_payload(batch, i), frame->data, frame->dlc);
+    return true;
+}
+
+void can_batch_get(const CANFrameBatch* batch, uint32_t index, CANFrame* frame) {
+    if (!batch || !frame || index >= batch->count) return;
+
+    unpack(batch->ids[index], batch->dlcs[index], batch->flags[index],
+           can_batch_payload(batch, index), frame);
+    frame->timestamp = batch->timestamps[index];
+}
@@ -0,0 +1,79 @@
+#ifndef CANT_CAN_FRAME_H
+#define CANT_CAN_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// CAN frame structure aligned with AUTOSAR
+typedef struct {
+    uint32_t id;
+    uint8_t dlc;
+    bool is_extended;
+    bool is_fd;
+    bool is_remote;
+    uint8_t data[64];  // Support for CAN-FD
+    uint64_t timestamp;  // SocketCAN: ns, hardware clock when the controller has one; S32K3: bit timer
+} CANFrame;
+
+// Compact frames for queues and traces. A classic frame fits in 16 bytes,
+// four to a cache line, where CANFrame needs 80; FD frames are their own
+// type so classic traffic never pays for 64-byte payloads.
+
+#define CAN_FRAME_EXTENDED  0x01
+#define CAN_FRAME_REMOTE    0x02
+#define CAN_FRAME_FD        0x04
+
+typedef struct {
+    uint32_t id;
+    uint8_t dlc;            // Payload bytes, 0-8
+    uint8_t flags;          // CAN_FRAME_*
+    uint16_t time_stamp;    // Controller bit timer at reception, where it has one
+    uint8_t data[8];
+} CANClassicFrame;
+
+typedef struct {
+    uint32_t id;
+    uint8_t dlc;            // Payload bytes, 0-64
+    uint8_t flags;
+    uint16_t time_stamp;
+    uint8_t data[64];
+} CANFDFrame;
+
+_Static_assert(sizeof(CANClassicFrame) == 16, "classic frame must stay 16 bytes");
+
+// False when the frame does not fit: FD, or more than 8 bytes
+bool can_frame_compact(const CANFrame* frame, CANClassicFrame* out);
+void can_frame_expand(const CANClassicFrame* frame, CANFrame* out);
+bool can_frame_compact_fd(const CANFrame* frame, CANFDFrame* out);
+void can_frame_expand_fd(const CANFDFrame* frame, CANFrame* out);
+
+// Structure-of-arrays batch. Filters and routers that only look at IDs walk
+// one dense array; payloads sit apart, payload_size bytes per frame.
+typedef struct {
+    uint64_t* timestamps;
+    uint32_t* ids;
+    uint8_t* dlcs;
+    uint8_t* flags;
+    uint8_t* data;
+    uint32_t payload_size;  // 8, or 64 for an FD batch
+    uint32_t count;
+    uint32_t capacity;
+} CANFrameBatch;
+
+bool can_batch_init(CANFrameBatch* batch, uint32_t capacity, bool fd);
+void can_batch_destroy(CANFrameBatch* batch);
+
+// False when the batch is full or the frame's payload does not fit
+bool can_batch_add(CANFrameBatch* batch, const CANFrame* frame);
+void can_batch_get(const CANFrameBatch* batch, uint32_t index, CANFrame* frame);
+
+static inline uint8_t* can_batch_payload(const CANFrameBatch* batch, uint32_t index) {
+    return batch->data + (size_t)index * batch->payload_size;
+}
+
+static inline void can_batch_clear(CANFrameBatch* batch) {
+    batch->count = 0;
+}
+
+#endif // CANT_CAN_FRAME_H
@@ -0,0 +1,610 @@
+#define _GNU_SOURCE    // memmem
+#include "can_replay.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAX_THREADS         16
+#define MIN_SLICE_BYTES     (64 * 1024)     // Smaller traces parse on one thread
+#define SPIN_NS             100000u         // Paced waits spin for the last 100 us
+#define MAX_SLEEP_NS        1000000u        // ...and sleep at most 1 ms at a time
+
+struct CANTrace {
+    CANFrameBatch frames;
+    size_t skipped;
+};
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    CANFrameBatch* frames;
+    size_t lines;           // Pass 1: upper bound on frames
+    bool has_fd;
+    size_t first_slot;      // Pass 2: where this slice writes
+    size_t parsed;
+} Slice;
+
+typedef struct {
+    uint64_t timestamp;
+    uint32_t id;
+    uint8_t dlc;
+    uint8_t flags;
+    uint8_t data[64];
+} ParsedFrame;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static const char* skip_spaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+static const char* skip_token(const char* p, const char* end) {
+    while (p < end && *p != ' ' && *p != '\t') p++;
+    return p;
+}
+
+static bool token_is(const char* p, const char* end, const char* word) {
+    size_t length = strlen(word);
+    const char* token_end = skip_token(p, end);
+    return (size_t)(token_end - p) == length && memcmp(p, word, length) == 0;
+}
+
+// Seconds with an optional fraction, kept exact to the nanosecond
+static const char* parse_time(const char* p, const char* end, uint64_t* ns) {
+    const char* start = p;
+    uint64_t seconds = 0;
+    uint64_t fraction = 0;
+    int digits = 0;
+
+    while (p < end && is_digit(*p)) {
+        seconds = seconds * 10 + (uint64_t)(*p++ - '0');
+    }
+    if (p == start) return NULL;
+
+    if (p < end && *p == '.') {
+        for (p++; p < end && is_digit(*p); p++) {
+            if (digits < 9) {
+                fraction = fraction * 10 + (uint64_t)(*p - '0');
+                digits++;
+            }
+        }
+    }
+    for (; digits < 9; digits++) {
+        fraction *= 10;
+    }
+
+    *ns = seconds * 1000000000u + fraction;
+    return p;
+}
+
+static const char* parse_hex(const char* p, const char* end, uint32_t* value, size_t* digits) {
+    const char* start = p;
+    uint32_t result = 0;
+
+    while (p < end && hex_value(*p) >= 0 && p - start < 8) {
+        result = (result << 4) | (uint32_t)hex_value(*p++);
+    }
+    *value = result;
+    *digits = (size_t)(p - start);
+    return p;
+}
+
+// (1436509052.249713) can0 123#DEADBEEF
+static bool parse_candump(const char* p, const char* end, ParsedFrame* out) {
+    uint32_t id;
+    size_t digits;
+    size_t max = 8;
+
+    p = parse_time(p + 1, end, &out->timestamp);
+    if (!p || p >= end || *p != ')') return false;
+
+    p = skip_spaces(p + 1, end);
+    p = skip_spaces(skip_token(p, end), end);    // Interface
+    p = parse_hex(p, end, &id, &digits);
+    if (p >= end || *p != '#') return false;
+
+    // Three digits are an 11-bit ID, eight a 29-bit one; error frames
+    // carry CAN_ERR_FLAG above the 29 bits and are skipped
+    if (digits == 3 && id <= 0x7FF) {
+        out->flags = 0;
+    } else if (digits == 8 && id <= 0x1FFFFFFF) {
+        out->flags = CAN_FRAME_EXTENDED;
+    } else {
+        return false;
+    }
+    out->id = id;
+    out->dlc = 0;
+    p++;
+
+    if (p < end && *p == '#') {
+        // FD: one nibble of BRS/ESI flags, then data
+        if (p + 1 >= end || hex_value(p[1]) < 0) return false;
+        out->flags |= CAN_FRAME_FD;
+        max = 64;
+        p += 2;
+    } else if (p < end && (*p == 'R' || *p == 'r')) {
+        out->flags |= CAN_FRAME_REMOTE;
+        if (p + 1 < end && is_digit(p[1])) {
+            out->dlc = (uint8_t)(p[1] - '0');
+        }
+        return out->dlc <= 8;
+    }
+
+    while (p + 1 < end) {
+        if (*p == '.') {
+            p++;
+            continue;
+        }
+        int high = hex_value(p[0]);
+        int low = hex_value(p[1]);
+        if (high < 0 || low < 0) break;
+        if (out->dlc == max) return false;
+        out->data[out->dlc++] = (uint8_t)(high << 4 | low);
+        p += 2;
+    }
+    return true;
+}
+
+static const char* parse_asc_id(const char* p, const char* end, ParsedFrame* out) {
+    size_t digits;
+
+    p = parse_hex(p, end, &out->id, &digits);
+    if (digits == 0) return NULL;
+    if (p < end && (*p == 'x' || *p == 'X')) {
+        out->flags |= CAN_FRAME_EXTENDED;
+        p++;
+    }
+    if (out->id > ((out->flags & CAN_FRAME_EXTENDED) ? 0x1FFFFFFFu : 0x7FFu)) return NULL;
+    return p;
+}
+
+static const char* parse_asc_data(const char* p, const char* end, ParsedFrame* out,
+                                  size_t length) {
+    for (out->dlc = 0; out->dlc < length; out->dlc++) {
+        p = skip_spaces(p, end);
+        if (end - p < 2) return NULL;
+        int high = hex_value(p[0]);
+        int low = hex_value(p[1]);
+        if (high < 0 || low < 0) return NULL;
+        out->data[out->dlc] = (uint8_t)(high << 4 | low);
+        p += 2;
+    }
+    return p;
+}
+
+static bool is_direction(const char* p, const char* end) {
+    return token_is(p, end, "Rx") || token_is(p, end, "Tx");
+}
+
+//    0.010000 1  123             Rx   d 8 01 02 03 04 05 06 07 08
+//    0.020000 CANFD   1 Rx 18DAF110x  1 0 9 12 00 01 ...
+static bool parse_asc(const char* p, const char* end, ParsedFrame* out) {
+    p = parse_time(p, end, &out->timestamp);
+    if (!p) return false;
+    p = skip_spaces(p, end);
+    out->flags = 0;
+
+    if (token_is(p, end, "CANFD")) {
+        p = skip_spaces(skip_token(p, end), end);
+        p = skip_spaces(skip_token(p, end), end);       // Channel
+        if (!is_direction(p, end)) return false;
+        p = parse_asc_id(skip_spaces(skip_token(p, end), end), end, out);
+        if (!p) return false;
+
+        // An optional symbolic name sits before the BRS and ESI bits
+        p = skip_spaces(p, end);
+        if (!token_is(p, end, "0") && !token_is(p, end, "1")) {
+            p = skip_spaces(skip_token(p, end), end);
+        }
+        p = skip_spaces(skip_token(p, end), end);       // BRS
+        p = skip_spaces(skip_token(p, end), end);       // ESI
+        p = skip_spaces(skip_token(p, end), end);       // DLC code
+
+        size_t length = 0;
+        while (p < end && is_digit(*p)) {
+            length = length * 10 + (size_t)(*p++ - '0');
+        }
+        if (length > 64) return false;
+        out->flags |= CAN_FRAME_FD;
+        return parse_asc_data(p, end, out, length) != NULL;
+    }
+
+    if (p >= end || !is_digit(*p)) return false;
+    p = skip_spaces(skip_token(p, end), end);           // Channel
+    p = parse_asc_id(p, end, out);
+    if (!p) return false;
+    p = skip_spaces(p, end);
+    if (!is_direction(p, end)) return false;
+    p = skip_spaces(skip_token(p, end), end);
+
+    bool remote = token_is(p, end, "r");
+    if (!remote && !token_is(p, end, "d")) return false;
+    p = skip_spaces(p + 1, end);
+
+    size_t length = p < end && is_digit(*p) ? (size_t)(*p - '0') : 0;
+    if (length > 8) return false;
+    if (remote) {
+        out->flags |= CAN_FRAME_REMOTE;
+        out->dlc = (uint8_t)length;
+        return true;
+    }
+    return parse_asc_data(p + 1, end, out, length) != NULL;
+}
+
+static bool parse_line(const char* p, const char* end, ParsedFrame* out) {
+    if (end > p && end[-1] == '\r') end--;              // CANalyzer writes CRLF
+    p = skip_spaces(p, end);
+    if (p < end && *p == '(') return parse_candump(p, end, out);
+    if (p < end && is_digit(*p)) return parse_asc(p, end, out);
+    return false;
+}
+
+static void* count_slice(void* arg) {
+    Slice* slice = arg;
+    size_t length = (size_t)(slice->end - slice->begin);
+
+    for (const char* p = slice->begin; p < slice->end; p++) {
+        p = memchr(p, '\n', (size_t)(slice->end - p));
+        if (!p) break;
+        slice->lines++;
+    }
+    if (length && slice->end[-1] != '\n') {
+        slice->lines++;
+    }
+    slice->has_fd = memmem(slice->begin, length, "##", 2) != NULL ||
+                    memmem(slice->begin, length, "CANFD", 5) != NULL;
+    return NULL;
+}
+
+static void* parse_slice(void* arg) {
+    Slice* slice = arg;
+    CANFrameBatch* frames = slice->frames;
+    ParsedFrame frame;
+
+    for (const char* line = slice->begin; line < slice->end; ) {
+        const char* newline = memchr(line, '\n', (size_t)(slice->end - line));
+        const char* line_end = newline ? newline : slice->end;
+
+        if (parse_line(line, line_end, &frame)) {
+            size_t slot = slice->first_slot + slice->parsed++;
+            frames->timestamps[slot] = frame.timestamp;
+            frames->ids[slot] = frame.id;
+            frames->dlcs[slot] = frame.dlc;
+            frames->flags[slot] = frame.flags;
+            memcpy(can_batch_payload(frames, (uint32_t)slot), frame.data, frame.dlc);
+        }
+        line = line_end + 1;
+    }
+    return NULL;
+}
+
+static void run_slices(void* (*work)(void*), Slice* slices, uint32_t count) {
+    pthread_t threads[MAX_THREADS];
+    bool started[MAX_THREADS] = { false };
+
+    for (uint32_t i = 1; i < count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, work, &slices[i]) == 0;
+    }
+    work(&slices[0]);
+    for (uint32_t i = 1; i < count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            work(&slices[i]);
+        }
+    }
+}
+
+// Closes the gaps left by lines that were not frames
+static size_t close_up(CANFrameBatch* frames, const Slice* slices, uint32_t count) {
+    size_t write = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        size_t read = slices[i].first_slot;
+        size_t n = slices[i].parsed;
+        if (write != read && n) {
+            memmove(&frames->timestamps[write], &frames->timestamps[read], n * sizeof(uint64_t));
+            memmove(&frames->ids[write], &frames->ids[read], n * sizeof(uint32_t));
+            memmove(&frames->dlcs[write], &frames->dlcs[read], n);
+            memmove(&frames->flags[write], &frames->flags[read], n);
+            memmove(can_batch_payload(frames, (uint32_t)write),
+                    can_batch_payload(frames, (uint32_t)read), n * frames->payload_size);
+        }
+        write += n;
+    }
+    return write;
+}
+
+CANTrace* can_trace_parse(const char* text, size_t length, uint32_t threads) {
+    if (!text && length) return NULL;
+
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (uint32_t)online : 1;
+    }
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (threads > length / MIN_SLICE_BYTES + 1) threads = (uint32_t)(length / MIN_SLICE_BYTES + 1);
+
+    // Split at line boundaries; a slice may end up empty
+    Slice slices[MAX_THREADS];
+    const char* end = text + length;
+    const char* cursor = text;
+    memset(slices, 0, sizeof(slices));
+    for (uint32_t i = 0; i < threads; i++) {
+        const char* slice_end = i + 1 == threads ? end : text + length / threads * (i + 1);
+        if (slice_end < cursor) slice_end = cursor;
+        if (slice_end < end) {
+            const char* newline = memchr(slice_end, '\n', (size_t)(end - slice_end));
+            slice_end = newline ? newline + 1 : end;
+        }
+        slices[i].begin = cursor;
+        slices[i].end = slice_end;
+        cursor = slice_end;
+    }
+
+    run_slices(count_slice, slices, threads);
+
+    size_t lines = 0;
+    bool has_fd = false;
+    for (uint32_t i = 0; i < threads; i++) {
+        slices[i].first_slot = lines;
+        lines += slices[i].lines;
+        has_fd |= slices[i].has_fd;
+    }
+    if (lines > UINT32_MAX) return NULL;
+
+    CANTrace* trace = calloc(1, sizeof(CANTrace));
+    if (!trace) return NULL;
+    if (!can_batch_init(&trace->frames, lines ? (uint32_t)lines : 1, has_fd)) {
+        free(trace);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < threads; i++) {
+        slices[i].frames = &trace->frames;
+    }
+    run_slices(parse_slice, slices, threads);
+
+    CANFrameBatch* frames = &trace->frames;
+    frames->count = (uint32_t)close_up(frames, slices, threads);
+    trace->skipped = lines - frames->count;
+
+    // Replay schedules from the first frame
+    uint64_t first = frames->count ? frames->timestamps[0] : 0;
+    for (uint32_t i = 0; i < frames->count; i++) {
+        frames->timestamps[i] = frames->timestamps[i] > first ? frames->timestamps[i] - first : 0;
+    }
+    return trace;
+}
+
+CANTrace* can_trace_load(const char* path, uint32_t threads) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return can_trace_parse(NULL, 0, threads);
+    }
+
+    void* text = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED) return NULL;
+
+    // Every thread starts reading at once, each in its own part of the file
+    madvise(text, (size_t)st.st_size, MADV_WILLNEED);
+    CANTrace* trace = can_trace_parse(text, (size_t)st.st_size, threads);
+    munmap(text, (size_t)st.st_size);
+    return trace;
+}
+
+void can_trace_destroy(CANTrace* trace) {
+    if (!trace) return;
+
+    can_batch_destroy(&trace->frames);
+    free(trace);
+}
+
+const CANFrameBatch* can_trace_frames(const CANTrace* trace) {
+    return trace ? &trace->frames : NULL;
+}
+
+size_t can_trace_skipped_lines(const CANTrace* trace) {
+    return trace ? trace->skipped : 0;
+}
+
+typedef struct {
+    CANDriver* driver;
+    const CANReplayConfig* config;
+    CANFrameBatch rx;
+    bool pending;
+    uint64_t pending_since;
+    uint64_t* samples;
+    uint32_t sample_count;
+    uint32_t requests;
+} Replay;
+
+// A view of frames [start, start + count) without copying
+static CANFrameBatch slice_of(const CANFrameBatch* frames, uint32_t start, uint32_t count) {
+    return (CANFrameBatch){
+        .timestamps = frames->timestamps + start,
+        .ids = frames->ids + start,
+        .dlcs = frames->dlcs + start,
+        .flags = frames->flags + start,
+        .data = can_batch_payload(frames, start),
+        .payload_size = frames->payload_size,
+        .count = count,
+        .capacity = count
+    };
+}
+
+// Runs the harness and collects responses
+static void housekeeping(Replay* replay) {
+    const CANReplayConfig* config = replay->config;
+
+    if (config->service) {
+        config->service(config->context);
+    }
+    if (!config->probe) return;
+
+    while (can_receive_batch(replay->driver, &replay->rx, 0) > 0) {
+        uint64_t now = now_ns();
+        for (uint32_t i = 0; i < replay->rx.count; i++) {
+            if (replay->rx.ids[i] == config->response_id && replay->pending) {
+                replay->samples[replay->sample_count++] = now - replay->pending_since;
+                replay->pending = false;
+            }
+        }
+    }
+}
+
+static void wait_until(Replay* replay, uint64_t due) {
+    for (;;) {
+        housekeeping(replay);
+
+        uint64_t now = now_ns();
+        if (now >= due) return;
+
+        uint64_t remaining = due - now;
+        if (remaining > SPIN_NS) {
+            uint64_t sleep = remaining - SPIN_NS;
+            if (sleep > MAX_SLEEP_NS) sleep = MAX_SLEEP_NS;
+            struct timespec ts = { 0, (long)sleep };
+            nanosleep(&ts, NULL);
+        }
+    }
+}
+
+static bool is_response(const Replay* replay, const CANFrameBatch* frames, uint32_t index) {
+    return replay->config->probe && frames->ids[index] == replay->config->response_id;
+}
+
+static int compare_samples(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : (x > y);
+}
+
+bool can_replay_run(const CANTrace* trace, CANDriver* driver,
+                    const CANReplayConfig* config, CANReplayStats* stats) {
+    if (!trace || !driver || !config || !stats) return false;
+    if (config->mode == CAN_REPLAY_SCALED && !(config->speed > 0.0)) return false;
+
+    const CANFrameBatch* frames = &trace->frames;
+    double speed = config->mode == CAN_REPLAY_SCALED ? config->speed : 1.0;
+    uint32_t batch_size = config->batch_size ? config->batch_size : 1;
+    Replay replay = { .driver = driver, .config = config };
+
+    memset(stats, 0, sizeof(*stats));
+    if (config->probe) {
+        uint32_t requests = 0;
+        for (uint32_t i = 0; i < frames->count; i++) {
+            requests += frames->ids[i] == config->request_id;
+        }
+        replay.samples = malloc((requests ? requests : 1) * sizeof(uint64_t));
+        if (!replay.samples || !can_batch_init(&replay.rx, 32, frames->payload_size > 8)) {
+            free(replay.samples);
+            return false;
+        }
+    }
+
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < frames->count; ) {
+        if (is_response(&replay, frames, i)) {
+            i++;
+            continue;
+        }
+
+        uint64_t now;
+        if (config->mode == CAN_REPLAY_UNPACED) {
+            now = now_ns();
+        } else {
+            uint64_t due = start + (uint64_t)((double)frames->timestamps[i] / speed);
+            wait_until(&replay, due);
+            now = now_ns();
+            if (now - due > stats->max_lag_ns) {
+                stats->max_lag_ns = now - due;
+            }
+        }
+
+        // Everything already due goes out in one batch
+        uint32_t count = 1;
+        while (count < batch_size && i + count < frames->count &&
+               !is_response(&replay, frames, i + count) &&
+               (config->mode == CAN_REPLAY_UNPACED ||
+                start + (uint64_t)((double)frames->timestamps[i + count] / speed) <= now)) {
+            count++;
+        }
+
+        CANFrameBatch batch = slice_of(frames, i, count);
+        uint32_t sent = can_transmit_batch(driver, &batch, config->timeout_ms);
+        uint64_t sent_at = now_ns();
+
+        for (uint32_t j = 0; config->probe && j < sent; j++) {
+            if (frames->ids[i + j] == config->request_id) {
+                replay.requests += !replay.pending;
+                replay.pending = true;
+                replay.pending_since = sent_at;
+            }
+        }
+
+        stats->frames_sent += sent;
+        stats->frames_dropped += count - sent;
+        i += count;
+
+        if (config->mode == CAN_REPLAY_UNPACED) {
+            housekeeping(&replay);
+        }
+    }
+    stats->elapsed_ns = now_ns() - start;
+
+    // Give the last request its chance to be answered
+    uint64_t deadline = now_ns() + (uint64_t)config->timeout_ms * 1000000u;
+    while (replay.pending && now_ns() < deadline) {
+        wait_until(&replay, now_ns() + SPIN_NS);
+    }
+
+    stats->frames_per_second = stats->elapsed_ns ?
+        (double)stats->frames_sent * 1e9 / (double)stats->elapsed_ns : 0.0;
+
+    if (config->probe) {
+        stats->requests = replay.requests;
+        stats->responses = replay.sample_count;
+        if (replay.sample_count) {
+            qsort(replay.samples, replay.sample_count, sizeof(uint64_t), compare_samples);
+            stats->latency_p50_ns = replay.samples[(replay.sample_count - 1) * 50 / 100];
+            stats->latency_p99_ns = replay.samples[(replay.sample_count - 1) * 99 / 100];
+            stats->latency_max_ns = replay.samples[replay.sample_count - 1];
+        }
+        free(replay.samples);
+        can_batch_destroy(&replay.rx);
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef CANT_CAN_REPLAY_H
+#define CANT_CAN_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "can_driver.h"
+
+// Trace replay for benchmarks and regression runs (POSIX hosts).
+//
+// Traces are read through a memory mapping and parsed in parallel: the
+// text is split at line boundaries, each thread parses its slice straight
+// into a shared CANFrameBatch, and the slices are closed up afterwards.
+// Lines that are not frames (headers, comments, error frames) are skipped.
+//
+//   candump -l:  (1436509052.249713) can0 123#DEADBEEF
+//                remote 18DAF110#R, FD 321##1AABBCC (flags nibble, then data)
+//   Vector ASC:  0.010000 1  123  Rx  d 8 01 02 03 04 05 06 07 08
+//                0.020000 CANFD 1 Rx 18DAF110x 1 0 9 12 ... (base hex only)
+//
+// Frames are injected through can_transmit_batch(), so any backend works.
+
+typedef struct CANTrace CANTrace;
+
+typedef enum {
+    CAN_REPLAY_REALTIME = 0,    // Trace timing
+    CAN_REPLAY_SCALED,          // Trace timing divided by speed
+    CAN_REPLAY_UNPACED          // As fast as the driver accepts frames
+} CANReplayMode;
+
+typedef struct {
+    CANReplayMode mode;
+    double speed;               // CAN_REPLAY_SCALED: 2.0 replays twice as fast
+    uint32_t batch_size;        // Frames per can_transmit_batch(), at most
+    uint32_t timeout_ms;        // Per batch; frames still refused are dropped
+
+    // End-to-end probe. Each replayed request_id frame (re)starts a timer
+    // that the next response_id frame received on the same driver stops,
+    // so a multi-frame request is timed from its last frame. Recorded
+    // response_id frames are not replayed; the stack under test answers.
+    bool probe;
+    uint32_t request_id;
+    uint32_t response_id;
+
+    // Runs between batches and while waiting, for a harness that drives
+    // the stack in the same thread (isotp_process(), UDS request handling)
+    void (*service)(void* context);
+    void* context;
+} CANReplayConfig;
+
+typedef struct {
+    uint64_t frames_sent;
+    uint64_t frames_dropped;    // Not accepted within timeout_ms
+    uint64_t elapsed_ns;
+    double frames_per_second;
+    uint64_t max_lag_ns;        // Paced modes: worst lateness against schedule
+
+    uint32_t requests;
+    uint32_t responses;
+    uint64_t latency_p50_ns;
+    uint64_t latency_p99_ns;
+    uint64_t latency_max_ns;
+} CANReplayStats;
+
+// threads == 0 uses every online CPU. NULL when the file can't be mapped
+// or memory runs out.
+CANTrace* can_trace_load(const char* path, uint32_t threads);
+CANTrace* can_trace_parse(const char* text, size_t length, uint32_t threads);
+void can_trace_destroy(CANTrace* trace);
+
+// Timestamps are ns from the first frame; FD traces get 64-byte payloads
+const CANFrameBatch* can_trace_frames(const CANTrace* trace);
+size_t can_trace_skipped_lines(const CANTrace* trace);
+
+bool can_replay_run(const CANTrace* trace, CANDriver* driver,
+                    const CANReplayConfig* config, CANReplayStats* stats);
+
+#endif // CANT_CAN_REPLAY_H
@@ -0,0 +1,728 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE    // recvmmsg
+#endif
+#include "can_driver.h"
+#include "can_filter.h"
+#include "can_tx_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/can/error.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+// SocketCAN backend. Frames are read CAN_RX_BATCH at a time with one
+// recvmmsg() and handed out from that batch. Filters run in the kernel
+// until there are more than CAN_KERNEL_FILTERS; past that the kernel
+// passes everything and the compiled filter matches in user space.
+// can_transmit_batch() hands the kernel CAN_TX_BATCH frames per sendmmsg().
+// Transmitted frames go straight to the kernel, whose queueing discipline
+// orders them; the per-band statistics time how long each one waited.
+// One thread receives, any thread may transmit.
+
+#ifndef CAN_RX_BATCH
+#define CAN_RX_BATCH        32
+#endif
+#ifndef CAN_TX_BATCH
+#define CAN_TX_BATCH        32
+#endif
+#define CAN_KERNEL_FILTERS  64
+#define CAN_RX_CONTROL_SIZE (CMSG_SPACE(sizeof(struct scm_timestamping)) + \
+                             CMSG_SPACE(sizeof(uint32_t)))
+
+struct CANDriver {
+    CANConfig config;
+    char interface_name[IFNAMSIZ];
+    int fd;
+    CANState state;
+    CANError last_error;
+    CANStats statistics;
+    CANTxBandStats tx_bands[CAN_TX_BANDS];     // Time until the kernel took the frame
+    uint32_t kernel_drops;      // Last SO_RXQ_OVFL count seen
+
+    // Filter bank
+    CANFilterRule* rules;
+    size_t rule_count;
+    size_t rule_capacity;
+    CANFilter* software_filter;     // Set while the rules outgrow the kernel list
+
+    // Receive batch, owned by the receiving thread
+    struct canfd_frame rx_frames[CAN_RX_BATCH];
+    struct iovec rx_iov[CAN_RX_BATCH];
+    struct mmsghdr rx_msgs[CAN_RX_BATCH];
+    uint8_t rx_control[CAN_RX_BATCH][CAN_RX_CONTROL_SIZE];
+    uint32_t rx_count;
+    uint32_t rx_next;
+
+    pthread_mutex_t lock;
+};
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static uint32_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+static int poll_timeout(uint64_t ms) {
+    return ms > INT_MAX ? INT_MAX : (int)ms;
+}
+
+static bool is_running(CANState state) {
+    return state == CAN_STATE_STARTED || state == CAN_STATE_ERROR_ACTIVE ||
+           state == CAN_STATE_ERROR_PASSIVE;
+}
+
+// CAN FD only has DLCs for these lengths; shorter payloads are zero-padded
+static uint8_t fd_length(uint8_t length) {
+    static const uint8_t lengths[] = { 12, 16, 20, 24, 32, 48, 64 };
+
+    if (length <= 8) return length;
+    for (size_t i = 0; i < sizeof(lengths); i++) {
+        if (length <= lengths[i]) return lengths[i];
+    }
+    return 64;
+}
+
+// Returns the number of bytes to write, 0 when the frame is invalid
+static size_t encode(uint32_t id, uint8_t flags, uint8_t dlc, const uint8_t* data,
+                     struct canfd_frame* out) {
+    bool is_fd = (flags & CAN_FRAME_FD) != 0;
+
+    if (dlc > (is_fd ? 64 : 8)) return 0;
+    if (is_fd && (flags & CAN_FRAME_REMOTE)) return 0;
+
+    memset(out, 0, sizeof(*out));
+    if (flags & CAN_FRAME_EXTENDED) {
+        out->can_id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    } else {
+        out->can_id = id & CAN_SFF_MASK;
+    }
+
+    if (flags & CAN_FRAME_REMOTE) {
+        out->can_id |= CAN_RTR_FLAG;
+        out->len = dlc;    // Requested length, no data
+        return CAN_MTU;
+    }
+
+    out->len = is_fd ? fd_length(dlc) : dlc;
+    memcpy(out->data, data, dlc);
+    return is_fd ? CANFD_MTU : CAN_MTU;
+}
+
+static size_t encode_frame(const CANFrame* frame, struct canfd_frame* out) {
+    uint8_t flags = (frame->is_extended ? CAN_FRAME_EXTENDED : 0) |
+                    (frame->is_remote ? CAN_FRAME_REMOTE : 0) |
+                    (frame->is_fd ? CAN_FRAME_FD : 0);
+    return encode(frame->id, flags, frame->dlc, frame->data, out);
+}
+
+static void decode_frame(const struct canfd_frame* in, size_t size, CANFrame* frame) {
+    frame->is_extended = (in->can_id & CAN_EFF_FLAG) != 0;
+    frame->is_remote = (in->can_id & CAN_RTR_FLAG) != 0;
+    frame->is_fd = size == CANFD_MTU;
+    frame->id = in->can_id & (frame->is_extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+    frame->dlc = in->len > (frame->is_fd ? 64 : 8) ? (frame->is_fd ? 64 : 8) : in->len;
+    if (!frame->is_remote) {
+        memcpy(frame->data, in->data, frame->dlc);
+    }
+}
+
+// False when the payload is wider than the batch carries
+static bool decode_into_batch(const struct canfd_frame* in, size_t size, uint64_t timestamp,
+                              CANFrameBatch* batch, uint32_t index) {
+    bool is_fd = size == CANFD_MTU;
+    bool is_extended = (in->can_id & CAN_EFF_FLAG) != 0;
+    bool is_remote = (in->can_id & CAN_RTR_FLAG) != 0;
+    uint8_t dlc = in->len > (is_fd ? 64 : 8) ? (is_fd ? 64 : 8) : in->len;
+
+    if (dlc > batch->payload_size) return false;
+
+    batch->timestamps[index] = timestamp;
+    batch->ids[index] = in->can_id & (is_extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+    batch->dlcs[index] = dlc;
+    batch->flags[index] = (is_extended ? CAN_FRAME_EXTENDED : 0) |
+                          (is_remote ? CAN_FRAME_REMOTE : 0) | (is_fd ? CAN_FRAME_FD : 0);
+    if (!is_remote) {
+        memcpy(can_batch_payload(batch, index), in->data, dlc);
+    }
+    return true;
+}
+
+// Hardware timestamp when the controller stamps frames, else the kernel's
+// software stamp taken when the frame was queued to the socket
+static uint64_t read_control(CANDriver* driver, struct msghdr* msg) {
+    uint64_t timestamp = 0;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) continue;
+
+        if (cmsg->cmsg_type == SO_TIMESTAMPING) {
+            struct scm_timestamping stamps;
+            memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            const struct timespec* ts = (stamps.ts[2].tv_sec || stamps.ts[2].tv_nsec) ?
+                                        &stamps.ts[2] : &stamps.ts[0];
+            timestamp = (uint64_t)ts->tv_sec * 1000000000u + (uint64_t)ts->tv_nsec;
+        } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+            uint32_t drops;
+            memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+            driver->statistics.overflow_count += drops - driver->kernel_drops;
+            driver->kernel_drops = drops;
+        }
+    }
+    return timestamp;
+}
+
+static void handle_error_frame(CANDriver* driver, const struct canfd_frame* frame) {
+    canid_t error = frame->can_id & CAN_ERR_MASK;
+
+    driver->statistics.error_count++;
+
+    if (error & CAN_ERR_ACK) {
+        driver->last_error = CAN_ERROR_ACK;
+    }
+    if (error & CAN_ERR_PROT) {
+        if (frame->data[2] & CAN_ERR_PROT_STUFF) {
+            driver->last_error = CAN_ERROR_STUFF;
+        } else if (frame->data[2] & CAN_ERR_PROT_FORM) {
+            driver->last_error = CAN_ERROR_FORM;
+        } else if (frame->data[2] & CAN_ERR_PROT_BIT1) {
+            driver->last_error = CAN_ERROR_BIT1;
+        } else if (frame->data[2] & CAN_ERR_PROT_BIT0) {
+            driver->last_error = CAN_ERROR_BIT0;
+        } else if (frame->data[3] == CAN_ERR_PROT_LOC_CRC_SEQ) {
+            driver->last_error = CAN_ERROR_CRC;
+        }
+    }
+    if (error & CAN_ERR_CRTL) {
+        if (frame->data[1] & (CAN_ERR_CRTL_RX_PASSIVE | CAN_ERR_CRTL_TX_PASSIVE)) {
+            driver->state = CAN_STATE_ERROR_PASSIVE;
+        } else if (frame->data[1] & CAN_ERR_CRTL_ACTIVE) {
+            driver->state = CAN_STATE_STARTED;
+        }
+        driver->statistics.tx_error_counter = frame->data[6];
+        driver->statistics.rx_error_counter = frame->data[7];
+    }
+    if (error & CAN_ERR_BUSOFF) {
+        driver->state = CAN_STATE_BUS_OFF;
+        driver->statistics.bus_off_count++;
+    }
+    if (error & CAN_ERR_RESTARTED) {
+        driver->state = CAN_STATE_STARTED;
+    }
+}
+
+// The frame format bit is always compared, so a standard filter never
+// matches an extended frame with the same low bits
+static struct can_filter kernel_filter(const CANFilterRule* rule) {
+    struct can_filter filter;
+    if (rule->is_extended) {
+        filter.can_id = (rule->id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+        filter.can_mask = (rule->mask & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    } else {
+        filter.can_id = rule->id & CAN_SFF_MASK;
+        filter.can_mask = (rule->mask & CAN_SFF_MASK) | CAN_EFF_FLAG;
+    }
+    return filter;
+}
+
+static bool install_filters(CANDriver* driver) {
+    // An empty list would block everything, so no rules, or more than the
+    // kernel list takes, means accept all here
+    struct can_filter filters[CAN_KERNEL_FILTERS] = { { 0, 0 } };
+    size_t count = 1;
+
+    if (driver->fd < 0) return true;    // Installed when the socket opens
+
+    if (driver->rule_count && driver->rule_count <= CAN_KERNEL_FILTERS) {
+        for (size_t i = 0; i < driver->rule_count; i++) {
+            filters[i] = kernel_filter(&driver->rules[i]);
+        }
+        count = driver->rule_count;
+    }
+
+    return setsockopt(driver->fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters,
+                      (socklen_t)(count * sizeof(struct can_filter))) == 0;
+}
+
+static bool accepted(const CANDriver* driver, const struct canfd_frame* frame) {
+    if (!driver->software_filter) return true;
+
+    bool is_extended = (frame->can_id & CAN_EFF_FLAG) != 0;
+    return can_filter_lookup(driver->software_filter, frame->can_id,
+                             is_extended) != CAN_FILTER_REJECT;
+}
+
+static bool enable_fd_frames(CANDriver* driver) {
+    struct ifreq ifr;
+    int enable = 1;
+
+    // The socket option succeeds on any netdev; the MTU says whether the
+    // controller can carry FD frames
+    memset(&ifr, 0, sizeof(ifr));
+    if (snprintf(ifr.ifr_name, IFNAMSIZ, "%s", driver->interface_name) >= IFNAMSIZ) {
+        return false;
+    }
+    if (ioctl(driver->fd, SIOCGIFMTU, &ifr) < 0 || ifr.ifr_mtu != CANFD_MTU) {
+        return false;
+    }
+    return setsockopt(driver->fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) == 0;
+}
+
+static bool open_socket(CANDriver* driver) {
+    struct sockaddr_can addr;
+    int enable = 1;
+    int timestamping = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                       SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    can_err_mask_t errors = CAN_ERR_TX_TIMEOUT | CAN_ERR_CRTL | CAN_ERR_PROT | CAN_ERR_ACK |
+                            CAN_ERR_BUSOFF | CAN_ERR_BUSERROR | CAN_ERR_RESTARTED;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = (int)if_nametoindex(driver->interface_name);
+    if (addr.can_ifindex == 0) {
+        driver->last_error = CAN_ERROR_HARDWARE;
+        return false;
+    }
+
+    driver->fd = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+    if (driver->fd < 0) {
+        driver->last_error = CAN_ERROR_HARDWARE;
+        return false;
+    }
+
+    // Timestamps and drop counts are best effort; frames still arrive
+    // without them
+    setsockopt(driver->fd, SOL_SOCKET, SO_TIMESTAMPING, &timestamping, sizeof(timestamping));
+    setsockopt(driver->fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+    setsockopt(driver->fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errors, sizeof(errors));
+
+    if ((driver->config.fd_enabled && !enable_fd_frames(driver)) ||
+        !install_filters(driver) ||
+        bind(driver->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(driver->fd);
+        driver->fd = -1;
+        driver->last_error = CAN_ERROR_HARDWARE;
+        return false;
+    }
+
+    driver->kernel_drops = 0;
+    driver->rx_count = 0;
+    driver->rx_next = 0;
+    return true;
+}
+
+static void close_socket(CANDriver* driver) {
+    if (driver->fd >= 0) {
+        close(driver->fd);
+        driver->fd = -1;
+    }
+    driver->rx_count = 0;
+    driver->rx_next = 0;
+}
+
+// Refills the batch; waits up to timeout_ms when nothing is queued
+static bool fill_rx_batch(CANDriver* driver, uint32_t timeout_ms) {
+    for (uint32_t i = 0; i < CAN_RX_BATCH; i++) {
+        driver->rx_msgs[i].msg_hdr.msg_controllen = CAN_RX_CONTROL_SIZE;
+        driver->rx_msgs[i].msg_hdr.msg_flags = 0;
+    }
+
+    int received = recvmmsg(driver->fd, driver->rx_msgs, CAN_RX_BATCH, MSG_DONTWAIT, NULL);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && timeout_ms) {
+        struct pollfd pfd = { .fd = driver->fd, .events = POLLIN };
+        if (poll(&pfd, 1, poll_timeout(timeout_ms)) > 0) {
+            received = recvmmsg(driver->fd, driver->rx_msgs, CAN_RX_BATCH, MSG_DONTWAIT, NULL);
+        }
+    }
+
+    if (received <= 0) {
+        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            driver->last_error = CAN_ERROR_HARDWARE;
+        }
+        return false;
+    }
+
+    driver->rx_count = (uint32_t)received;
+    driver->rx_next = 0;
+    return true;
+}
+
+// Driver API implementation
+CANDriver* can_create(const CANConfig* config) {
+    if (!config || !config->interface_name) return NULL;
+    if (strlen(config->interface_name) >= IFNAMSIZ) return NULL;
+
+    CANDriver* driver = calloc(1, sizeof(CANDriver));
+    if (!driver) return NULL;
+
+    memcpy(&driver->config, config, sizeof(CANConfig));
+    strcpy(driver->interface_name, config->interface_name);
+    driver->config.interface_name = driver->interface_name;
+    driver->fd = -1;
+
+    for (uint32_t i = 0; i < CAN_RX_BATCH; i++) {
+        driver->rx_iov[i].iov_base = &driver->rx_frames[i];
+        driver->rx_iov[i].iov_len = sizeof(struct canfd_frame);
+        driver->rx_msgs[i].msg_hdr.msg_iov = &driver->rx_iov[i];
+        driver->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+        driver->rx_msgs[i].msg_hdr.msg_control = driver->rx_control[i];
+    }
+
+    pthread_mutex_init(&driver->lock, NULL);
+    driver->state = CAN_STATE_STOPPED;
+    return driver;
+}
+
+void can_destroy(CANDriver* driver) {
+    if (!driver) return;
+
+    can_stop(driver);
+    can_filter_destroy(driver->software_filter);
+    free(driver->rules);
+    pthread_mutex_destroy(&driver->lock);
+    free(driver);
+}
+
+bool can_start(CANDriver* driver) {
+    if (!driver || driver->state != CAN_STATE_STOPPED) return false;
+
+    pthread_mutex_lock(&driver->lock);
+    bool result = open_socket(driver);
+    if (result) {
+        driver->state = CAN_STATE_STARTED;
+    }
+    pthread_mutex_unlock(&driver->lock);
+    return result;
+}
+
+void can_stop(CANDriver* driver) {
+    if (!driver || driver->state == CAN_STATE_STOPPED) return;
+
+    pthread_mutex_lock(&driver->lock);
+    close_socket(driver);
+    driver->state = CAN_STATE_STOPPED;
+    pthread_mutex_unlock(&driver->lock);
+}
+
+// After a failed send: waits for room and returns true to retry, or counts
+// the failure and returns false once it is fatal or the deadline passed
+static bool wait_for_room(CANDriver* driver, int error, uint64_t deadline) {
+    uint64_t now = now_ms();
+    bool full = error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS;
+
+    if ((!full && error != EINTR) || now >= deadline) {
+        pthread_mutex_lock(&driver->lock);
+        if (full) {
+            driver->statistics.overflow_count++;
+        } else {
+            driver->statistics.error_count++;
+            driver->last_error = CAN_ERROR_HARDWARE;
+        }
+        pthread_mutex_unlock(&driver->lock);
+        return false;
+    }
+
+    // A full netdev queue reports ENOBUFS, which poll() does not wait on;
+    // back off a millisecond at a time until the deadline
+    struct pollfd pfd = { .fd = driver->fd, .events = POLLOUT };
+    poll(&pfd, 1, error == ENOBUFS ? 1 : poll_timeout(deadline - now));
+    return true;
+}
+
+// Called with the lock held
+static void record_sent(CANDriver* driver, uint32_t id, bool is_extended, uint32_t latency) {
+    CANFrame key = { .id = id, .is_extended = is_extended };
+    CANTxBandStats* band = &driver->tx_bands[can_tx_band(&key)];
+
+    driver->statistics.tx_count++;
+    band->sent++;
+    band->total_us += latency;
+    if (latency > band->max_us) {
+        band->max_us = latency;
+    }
+}
+
+bool can_transmit(CANDriver* driver, const CANFrame* frame, uint32_t timeout_ms) {
+    if (!driver || !frame || !is_running(driver->state)) return false;
+
+    struct canfd_frame out;
+    size_t size = encode_frame(frame, &out);
+    if (size == 0 || (size == CANFD_MTU && !driver->config.fd_enabled)) {
+        driver->last_error = CAN_ERROR_SOFTWARE;
+        return false;
+    }
+
+    uint32_t start_us = now_us();
+    uint64_t deadline = now_ms() + timeout_ms;
+    for (;;) {
+        ssize_t sent = send(driver->fd, &out, size, MSG_DONTWAIT);
+        if (sent == (ssize_t)size) break;
+        if (!wait_for_room(driver, sent < 0 ? errno : EIO, deadline)) return false;
+    }
+
+    uint32_t latency = now_us() - start_us;
+    pthread_mutex_lock(&driver->lock);
+    record_sent(driver, frame->id, frame->is_extended, latency);
+    pthread_mutex_unlock(&driver->lock);
+    return true;
+}
+
+uint32_t can_transmit_batch(CANDriver* driver, const CANFrameBatch* batch, uint32_t timeout_ms) {
+    if (!driver || !batch || !is_running(driver->state)) return 0;
+
+    struct canfd_frame frames[CAN_TX_BATCH];
+    struct iovec iov[CAN_TX_BATCH];
+    struct mmsghdr msgs[CAN_TX_BATCH];
+    uint32_t start_us = now_us();
+    uint64_t deadline = now_ms() + timeout_ms;
+    uint32_t sent = 0;
+
+    memset(msgs, 0, sizeof(msgs));
+    while (sent < batch->count) {
+        // Encode up to the first invalid frame; it fails the batch once
+        // everything before it is out
+        uint32_t count = 0;
+        while (count < CAN_TX_BATCH && sent + count < batch->count) {
+            uint32_t i = sent + count;
+            size_t size = encode(batch->ids[i], batch->flags[i], batch->dlcs[i],
+                                 can_batch_payload(batch, i), &frames[count]);
+            if (size == 0 || (size == CANFD_MTU && !driver->config.fd_enabled)) break;
+
+            iov[count] = (struct iovec){ .iov_base = &frames[count], .iov_len = size };
+            msgs[count].msg_hdr.msg_iov = &iov[count];
+            msgs[count].msg_hdr.msg_iovlen = 1;
+            count++;
+        }
+        if (count == 0) {
+            driver->last_error = CAN_ERROR_SOFTWARE;
+            break;
+        }
+
+        int result = sendmmsg(driver->fd, msgs, count, MSG_DONTWAIT);
+        if (result <= 0) {
+            if (!wait_for_room(driver, result < 0 ? errno : EIO, deadline)) break;
+            continue;
+        }
+
+        uint32_t latency = now_us() - start_us;
+        pthread_mutex_lock(&driver->lock);
+        for (int i = 0; i < result; i++) {
+            record_sent(driver, batch->ids[sent + i],
+                        (batch->flags[sent + i] & CAN_FRAME_EXTENDED) != 0, latency);
+        }
+        pthread_mutex_unlock(&driver->lock);
+        sent += (uint32_t)result;
+    }
+
+    return sent;
+}
+
+// Hands out frames from the recvmmsg() batch into frames or, when that is
+// NULL, into batch
+static uint32_t receive(CANDriver* driver, CANFrame* frames, CANFrameBatch* batch,
+                        uint32_t max, uint32_t timeout_ms) {
+    uint32_t count = 0;
+    uint64_t deadline = now_ms() + timeout_ms;
+
+    pthread_mutex_lock(&driver->lock);
+    while (count < max) {
+        if (driver->rx_next == driver->rx_count) {
+            // Only the first frame is worth waiting for
+            uint64_t now = now_ms();
+            uint32_t wait = count == 0 && now < deadline ? (uint32_t)(deadline - now) : 0;
+
+            pthread_mutex_unlock(&driver->lock);
+            bool filled = fill_rx_batch(driver, wait);
+            pthread_mutex_lock(&driver->lock);
+            if (!filled) break;
+            continue;
+        }
+
+        uint32_t index = driver->rx_next++;
+        struct mmsghdr* msg = &driver->rx_msgs[index];
+        uint64_t timestamp = read_control(driver, &msg->msg_hdr);
+
+        if (driver->rx_frames[index].can_id & CAN_ERR_FLAG) {
+            handle_error_frame(driver, &driver->rx_frames[index]);
+            continue;
+        }
+        if ((msg->msg_len != CAN_MTU && msg->msg_len != CANFD_MTU) ||
+            !accepted(driver, &driver->rx_frames[index])) {
+            continue;
+        }
+
+        if (frames) {
+            decode_frame(&driver->rx_frames[index], msg->msg_len, &frames[count]);
+            frames[count].timestamp = timestamp;
+        } else if (!decode_into_batch(&driver->rx_frames[index], msg->msg_len, timestamp,
+                                      batch, count)) {
+            driver->statistics.overflow_count++;
+            continue;
+        }
+        count++;
+    }
+    driver->statistics.rx_count += count;
+    pthread_mutex_unlock(&driver->lock);
+
+    return count;
+}
+
+bool can_receive(CANDriver* driver, CANFrame* frame, uint32_t timeout_ms) {
+    if (!driver || !frame || driver->fd < 0) return false;
+
+    return receive(driver, frame, NULL, 1, timeout_ms) == 1;
+}
+
+uint32_t can_receive_batch(CANDriver* driver, CANFrameBatch* batch, uint32_t timeout_ms) {
+    if (!driver || !batch || driver->fd < 0) return 0;
+
+    batch->count = receive(driver, NULL, batch, batch->capacity, timeout_ms);
+    return batch->count;
+}
+
+CANState can_get_state(const CANDriver* driver) {
+    return driver ? driver->state : CAN_STATE_UNINIT;
+}
+
+CANError can_get_last_error(const CANDriver* driver) {
+    return driver ? driver->last_error : CAN_ERROR_NONE;
+}
+
+void can_get_statistics(const CANDriver* driver, CANStats* stats) {
+    if (!driver || !stats) return;
+
+    pthread_mutex_lock((pthread_mutex_t*)&driver->lock);
+    memcpy(stats, &driver->statistics, sizeof(CANStats));
+    pthread_mutex_unlock((pthread_mutex_t*)&driver->lock);
+}
+
+void can_get_tx_band_statistics(const CANDriver* driver, uint8_t band, CANTxBandStats* stats) {
+    if (!driver || !stats || band >= CAN_TX_BANDS) return;
+
+    pthread_mutex_lock((pthread_mutex_t*)&driver->lock);
+    *stats = driver->tx_bands[band];
+    pthread_mutex_unlock((pthread_mutex_t*)&driver->lock);
+}
+
+bool can_set_filter(CANDriver* driver, uint32_t id, uint32_t mask, bool is_extended) {
+    if (!driver) return false;
+
+    pthread_mutex_lock(&driver->lock);
+
+    if (driver->rule_count == driver->rule_capacity) {
+        size_t capacity = driver->rule_capacity ? driver->rule_capacity * 2 : 16;
+        CANFilterRule* rules = realloc(driver->rules, capacity * sizeof(CANFilterRule));
+        if (!rules) {
+            pthread_mutex_unlock(&driver->lock);
+            return false;
+        }
+        driver->rules = rules;
+        driver->rule_capacity = capacity;
+    }
+
+    driver->rules[driver->rule_count++] = (CANFilterRule){
+        .id = id,
+        .mask = mask,
+        .is_extended = is_extended,
+        .target = 0
+    };
+
+    CANFilter* compiled = NULL;
+    bool result = driver->rule_count <= CAN_KERNEL_FILTERS ||
+                  (compiled = can_filter_compile(driver->rules, driver->rule_count)) != NULL;
+    if (result) {
+        can_filter_destroy(driver->software_filter);
+        driver->software_filter = compiled;
+        result = install_filters(driver);
+    }
+    if (!result) {
+        driver->rule_count--;
+    }
+
+    pthread_mutex_unlock(&driver->lock);
+    return result;
+}
+
+void can_clear_filters(CANDriver* driver) {
+    if (!driver) return;
+
+    pthread_mutex_lock(&driver->lock);
+    driver->rule_count = 0;
+    can_filter_destroy(driver->software_filter);
+    driver->software_filter = NULL;
+    install_filters(driver);
+    pthread_mutex_unlock(&driver->lock);
+}
+
+bool can_enable_fd(CANDriver* driver) {
+    if (!driver) return false;
+
+    pthread_mutex_lock(&driver->lock);
+    bool result = driver->fd < 0 || enable_fd_frames(driver);
+    if (result) {
+        driver->config.fd_enabled = true;
+    }
+    pthread_mutex_unlock(&driver->lock);
+    return result;
+}
+
+bool can_set_bitrate(CANDriver* driver, uint32_t bitrate, uint32_t data_bitrate) {
+    // Bit timing belongs to the netdev ("ip link set can0 type can bitrate ...")
+    (void)driver;
+    (void)bitrate;
+    (void)data_bitrate;
+    return false;
+}
+
+// There is no controller sleep mode to reach from a socket; sleeping
+// releases the socket so the netdev can be taken down
+bool can_enter_sleep(CANDriver* driver) {
+    if (!driver || !is_running(driver->state)) return false;
+
+    pthread_mutex_lock(&driver->lock);
+    close_socket(driver);
+    driver->state = CAN_STATE_SLEEP;
+    pthread_mutex_unlock(&driver->lock);
+    return true;
+}
+
+bool can_exit_sleep(CANDriver* driver) {
+    if (!driver || driver->state != CAN_STATE_SLEEP) return false;
+
+    pthread_mutex_lock(&driver->lock);
+    bool result = open_socket(driver);
+    if (result) {
+        driver->state = CAN_STATE_STARTED;
+    }
+    pthread_mutex_unlock(&driver->lock);
+    return result;
+}
+
+void can_reset(CANDriver* driver) {
+    if (!driver) return;
+
+    pthread_mutex_lock(&driver->lock);
+    bool reopen = driver->fd >= 0;
+    close_socket(driver);
+    memset(&driver->statistics, 0, sizeof(CANStats));
+    driver->last_error = CAN_ERROR_NONE;
+    driver->state = reopen && open_socket(driver) ? CAN_STATE_STARTED : CAN_STATE_STOPPED;
+    pthread_mutex_unlock(&driver->lock);
+}
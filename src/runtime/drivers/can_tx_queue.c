@@ -0,0 +1,252 @@
+#include "can_tx_queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_SLOT     0xFFFFu
+
+typedef struct {
+    uint32_t key;           // can_arbitration_key()
+    uint32_t sequence;      // FIFO order among equal keys
+    uint16_t slot;
+} HeapEntry;
+
+typedef struct {
+    uint16_t slot;          // NO_SLOT when empty
+    bool aborting;
+    HeapEntry entry;        // Kept so an abort re-queues in the original place
+} Mailbox;
+
+struct CANTxQueue {
+    CANFrame* frames;       // capacity + mailboxes slots
+    uint32_t* enqueued_us;
+    uint16_t* free_slots;
+    uint32_t free_count;
+
+    HeapEntry* heap;
+    uint32_t pending;
+    uint32_t capacity;
+    uint32_t sequence;
+
+    Mailbox mailboxes[CAN_TX_MAX_MAILBOXES];
+    uint8_t mailbox_count;
+
+    CANTxBandStats bands[CAN_TX_BANDS];
+};
+
+uint32_t can_arbitration_key(const CANFrame* frame) {
+    uint32_t rtr = frame->is_remote ? 1 : 0;
+
+    if (!frame->is_extended) {
+        return ((frame->id & 0x7FFu) << 21) | (rtr << 20);
+    }
+    // Base ID, SRR and IDE (both recessive), ID extension, RTR
+    uint32_t id = frame->id & 0x1FFFFFFFu;
+    return ((id >> 18) << 21) | (1u << 20) | (1u << 19) | ((id & 0x3FFFFu) << 1) | rtr;
+}
+
+uint8_t can_tx_band(const CANFrame* frame) {
+    return (uint8_t)(can_arbitration_key(frame) >> 29);
+}
+
+// Sequence numbers wrap; only their distance matters
+static bool before(const HeapEntry* a, const HeapEntry* b) {
+    if (a->key != b->key) return a->key < b->key;
+    return (int32_t)(a->sequence - b->sequence) < 0;
+}
+
+static void heap_push(CANTxQueue* queue, HeapEntry entry) {
+    uint32_t i = queue->pending++;
+
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!before(&entry, &queue->heap[parent])) break;
+        queue->heap[i] = queue->heap[parent];
+        i = parent;
+    }
+    queue->heap[i] = entry;
+}
+
+static HeapEntry heap_pop(CANTxQueue* queue) {
+    HeapEntry top = queue->heap[0];
+    HeapEntry last = queue->heap[--queue->pending];
+    uint32_t i = 0;
+
+    for (;;) {
+        uint32_t child = i * 2 + 1;
+        if (child >= queue->pending) break;
+        if (child + 1 < queue->pending && before(&queue->heap[child + 1], &queue->heap[child])) {
+            child++;
+        }
+        if (!before(&queue->heap[child], &last)) break;
+        queue->heap[i] = queue->heap[child];
+        i = child;
+    }
+    queue->heap[i] = last;
+    return top;
+}
+
+static void release(CANTxQueue* queue, Mailbox* mailbox) {
+    queue->free_slots[queue->free_count++] = mailbox->slot;
+    mailbox->slot = NO_SLOT;
+    mailbox->aborting = false;
+}
+
+CANTxQueue* can_tx_queue_create(uint32_t capacity, uint8_t mailboxes) {
+    if (capacity == 0 || mailboxes == 0 || mailboxes > CAN_TX_MAX_MAILBOXES ||
+        capacity + mailboxes > NO_SLOT) {
+        return NULL;
+    }
+
+    CANTxQueue* queue = calloc(1, sizeof(CANTxQueue));
+    if (!queue) return NULL;
+
+    // A frame keeps its slot while it sits in a mailbox, so capacity
+    // frames can be pending on top of a full set of mailboxes
+    uint32_t slots = capacity + mailboxes;
+    queue->frames = malloc(slots * sizeof(CANFrame));
+    queue->enqueued_us = malloc(slots * sizeof(uint32_t));
+    queue->free_slots = malloc(slots * sizeof(uint16_t));
+    queue->heap = malloc(slots * sizeof(HeapEntry));
+
+    if (!queue->frames || !queue->enqueued_us || !queue->free_slots || !queue->heap) {
+        can_tx_queue_destroy(queue);
+        return NULL;
+    }
+
+    queue->capacity = capacity;
+    queue->mailbox_count = mailboxes;
+    can_tx_queue_clear(queue);
+    return queue;
+}
+
+void can_tx_queue_destroy(CANTxQueue* queue) {
+    if (!queue) return;
+
+    free(queue->frames);
+    free(queue->enqueued_us);
+    free(queue->free_slots);
+    free(queue->heap);
+    free(queue);
+}
+
+bool can_tx_queue_push(CANTxQueue* queue, const CANFrame* frame, uint32_t now_us) {
+    if (!queue || !frame || queue->pending >= queue->capacity) return false;
+
+    uint16_t slot = queue->free_slots[--queue->free_count];
+    queue->frames[slot] = *frame;
+    queue->enqueued_us[slot] = now_us;
+
+    heap_push(queue, (HeapEntry){
+        .key = can_arbitration_key(frame),
+        .sequence = queue->sequence++,
+        .slot = slot
+    });
+    return true;
+}
+
+CANTxAction can_tx_queue_next(CANTxQueue* queue, CANTxCommand* command) {
+    if (!queue || !command) return CAN_TX_IDLE;
+
+    command->action = CAN_TX_IDLE;
+    if (queue->pending == 0) return CAN_TX_IDLE;
+
+    const HeapEntry* head = &queue->heap[0];
+    Mailbox* empty = NULL;
+    Mailbox* victim = NULL;
+    bool abort_in_flight = false;
+
+    for (uint8_t i = 0; i < queue->mailbox_count; i++) {
+        Mailbox* mailbox = &queue->mailboxes[i];
+
+        if (mailbox->slot == NO_SLOT) {
+            if (!empty) empty = mailbox;
+            continue;
+        }
+        // Controllers break ties between mailboxes by index, which could
+        // reorder frames with the same ID; hold the next one back instead
+        if (mailbox->entry.key == head->key) return CAN_TX_IDLE;
+
+        if (mailbox->aborting) {
+            abort_in_flight = true;
+        } else if (!victim || before(&victim->entry, &mailbox->entry)) {
+            victim = mailbox;
+        }
+    }
+
+    if (empty) {
+        HeapEntry entry = heap_pop(queue);
+        empty->slot = entry.slot;
+        empty->entry = entry;
+
+        command->action = CAN_TX_LOAD;
+        command->mailbox = (uint8_t)(empty - queue->mailboxes);
+        command->frame = &queue->frames[entry.slot];
+        return CAN_TX_LOAD;
+    }
+
+    // One abort at a time; its mailbox serves the head once it lands
+    if (!abort_in_flight && victim && before(head, &victim->entry)) {
+        victim->aborting = true;
+        command->action = CAN_TX_ABORT;
+        command->mailbox = (uint8_t)(victim - queue->mailboxes);
+        return CAN_TX_ABORT;
+    }
+
+    return CAN_TX_IDLE;
+}
+
+void can_tx_queue_aborted(CANTxQueue* queue, uint8_t mailbox) {
+    if (!queue || mailbox >= queue->mailbox_count) return;
+
+    Mailbox* box = &queue->mailboxes[mailbox];
+    if (box->slot == NO_SLOT) return;
+
+    // The slot stays allocated; the frame goes back with its old sequence
+    queue->bands[box->entry.key >> 29].aborted++;
+    heap_push(queue, box->entry);
+    box->slot = NO_SLOT;
+    box->aborting = false;
+}
+
+void can_tx_queue_complete(CANTxQueue* queue, uint8_t mailbox, uint32_t now_us) {
+    if (!queue || mailbox >= queue->mailbox_count) return;
+
+    Mailbox* box = &queue->mailboxes[mailbox];
+    if (box->slot == NO_SLOT) return;
+
+    CANTxBandStats* band = &queue->bands[box->entry.key >> 29];
+    uint32_t latency = now_us - queue->enqueued_us[box->slot];
+    band->sent++;
+    band->total_us += latency;
+    if (latency > band->max_us) {
+        band->max_us = latency;
+    }
+
+    release(queue, box);
+}
+
+void can_tx_queue_clear(CANTxQueue* queue) {
+    if (!queue) return;
+
+    uint32_t slots = queue->capacity + queue->mailbox_count;
+    for (uint32_t i = 0; i < slots; i++) {
+        queue->free_slots[i] = (uint16_t)(slots - 1 - i);
+    }
+    queue->free_count = slots;
+    queue->pending = 0;
+
+    for (uint8_t i = 0; i < queue->mailbox_count; i++) {
+        queue->mailboxes[i].slot = NO_SLOT;
+        queue->mailboxes[i].aborting = false;
+    }
+}
+
+uint32_t can_tx_queue_pending(const CANTxQueue* queue) {
+    return queue ? queue->pending : 0;
+}
+
+void can_tx_queue_get_band(const CANTxQueue* queue, uint8_t band, CANTxBandStats* stats) {
+    if (!queue || !stats || band >= CAN_TX_BANDS) return;
+
+    *stats = queue->bands[band];
+}
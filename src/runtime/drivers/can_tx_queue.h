@@ -0,0 +1,64 @@
+#ifndef CANT_CAN_TX_QUEUE_H
+#define CANT_CAN_TX_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_driver.h"
+
+// Transmit queue ordered by arbitration priority. Pending frames sit in a
+// min-heap keyed by the arbitration field, so the bus always sees the
+// most urgent frame next; frames with the same ID keep FIFO order.
+//
+// The queue also emulates the controller's TX mailboxes. The driver asks
+// can_tx_queue_next() what to do and reports back from its TX interrupt:
+//
+//   CAN_TX_LOAD   write the frame into the mailbox and request transmission
+//   CAN_TX_ABORT  every mailbox is busy and a more urgent frame is pending;
+//                 abort this mailbox, then report can_tx_queue_aborted()
+//                 (or can_tx_queue_complete() if the frame won the bus first)
+//
+// Not thread safe; call under the driver's lock.
+
+#define CAN_TX_MAX_MAILBOXES    32
+
+typedef enum {
+    CAN_TX_IDLE = 0,
+    CAN_TX_LOAD,
+    CAN_TX_ABORT
+} CANTxAction;
+
+typedef struct {
+    CANTxAction action;
+    uint8_t mailbox;
+    const CANFrame* frame;      // CAN_TX_LOAD only; valid until the mailbox completes
+} CANTxCommand;
+
+typedef struct CANTxQueue CANTxQueue;
+
+CANTxQueue* can_tx_queue_create(uint32_t capacity, uint8_t mailboxes);
+void can_tx_queue_destroy(CANTxQueue* queue);
+
+// False when capacity frames are already pending
+bool can_tx_queue_push(CANTxQueue* queue, const CANFrame* frame, uint32_t now_us);
+
+// Call until it returns CAN_TX_IDLE
+CANTxAction can_tx_queue_next(CANTxQueue* queue, CANTxCommand* command);
+
+// The mailbox was emptied by an abort; its frame goes back in the queue
+void can_tx_queue_aborted(CANTxQueue* queue, uint8_t mailbox);
+void can_tx_queue_complete(CANTxQueue* queue, uint8_t mailbox, uint32_t now_us);
+
+// Drops pending frames and forgets mailbox contents
+void can_tx_queue_clear(CANTxQueue* queue);
+uint32_t can_tx_queue_pending(const CANTxQueue* queue);
+
+// Latency runs from can_tx_queue_push() to completion, in the caller's clock
+void can_tx_queue_get_band(const CANTxQueue* queue, uint8_t band, CANTxBandStats* stats);
+uint8_t can_tx_band(const CANFrame* frame);
+
+// The arbitration field as the bus sees it; the lower key wins. A standard
+// frame beats an extended frame with the same 11-bit base ID, and a data
+// frame beats a remote frame with the same ID.
+uint32_t can_arbitration_key(const CANFrame* frame);
+
+#endif // CANT_CAN_TX_QUEUE_H
@@ -0,0 +1,1073 @@
+#include "can_virtual.h"
+#include "can_filter.h"
+#include "can_tx_queue.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Virtual CAN backend. Every bus keeps one simulated wire: at each idle
+// point the nodes' most urgent mailboxes arbitrate, the winner's frame
+// (or the error frame that destroys it) occupies the wire for its exact
+// bit time, and when it ends the outcome is applied to senders and
+// listeners. Mailboxes are fed from a CANTxQueue per node, as on FlexCAN.
+// One mutex per bus covers the bus and all of its nodes.
+
+#define CAN_BUS_NAME_SIZE       16
+#define CAN_VIRTUAL_TX_DEPTH    64
+#define CAN_VIRTUAL_RX_DEPTH    256
+#define CAN_DEFAULT_BITRATE     500000u
+#define NO_MAILBOX              0xFFu
+
+#define ERROR_FLAG_BITS         6
+#define ERROR_DELIMITER_BITS    8
+#define INTERMISSION_BITS       3
+#define SUSPEND_BITS            8       // Error-passive sender, after each frame
+#define BUS_OFF_RECOVERY_BITS   (128 * 11)
+
+// Bit positions counted from SOF, stuff bits included
+typedef struct {
+    uint32_t total;         // Through intermission
+    uint32_t arbitration;   // Through RTR (RRS on FD)
+    uint32_t fast_from;     // FD data phase runs from here to crc_end
+    uint32_t crc_end;       // Through the CRC delimiter
+} FrameBits;
+
+typedef struct {
+    uint32_t bits;
+    uint16_t crc;
+    uint8_t last;
+    uint8_t run;
+} BitWriter;
+
+typedef struct {
+    uint32_t id;
+    bool is_extended;
+    CANError error;
+    uint32_t remaining;
+} Injection;
+
+struct CANDriver {
+    CANConfig config;
+    char interface_name[CAN_BUS_NAME_SIZE];
+    CANBus* bus;            // NULL once the bus is destroyed
+    uint8_t node;
+    CANState state;
+    CANError last_error;
+    CANStats statistics;
+    uint16_t tec;
+    uint16_t rec;
+    uint64_t ready_ns;      // No arbitration before this: suspend, bus-off
+
+    CANTxQueue* tx_queue;
+    const CANFrame* mailboxes[CAN_TX_MAX_MAILBOXES];
+    uint8_t mailbox_count;
+    uint32_t abort_pending;     // Abort asked while the mailbox was on the wire
+
+    Queue rx_queue;
+
+    // Filter bank
+    CANFilterRule* rules;
+    size_t rule_count;
+    size_t rule_capacity;
+    CANFilter* filter;
+};
+
+struct CANBus {
+    char name[CAN_BUS_NAME_SIZE];
+    CANBusConfig config;
+    CANBus* next;
+    pthread_mutex_t lock;
+
+    uint64_t now_ns;
+    uint64_t stats_from_ns;
+    uint64_t random;
+    CANBusStats stats;
+
+    CANDriver* nodes[CAN_BUS_MAX_NODES];
+    Injection injections[CAN_BUS_MAX_INJECTIONS];
+
+    // The frame on the wire
+    struct {
+        bool active;
+        CANFrame frame;
+        uint32_t senders;                       // Node mask
+        uint8_t mailboxes[CAN_BUS_MAX_NODES];   // Per sender
+        CANError error;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    } wire;
+};
+
+static CANBus* buses;
+static pthread_mutex_t buses_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool is_running(CANState state) {
+    return state == CAN_STATE_STARTED || state == CAN_STATE_ERROR_ACTIVE ||
+           state == CAN_STATE_ERROR_PASSIVE;
+}
+
+// Frame layout
+
+static void put_bit(BitWriter* writer, uint32_t bit, bool crc) {
+    if (crc) {
+        uint32_t next = bit ^ ((writer->crc >> 14) & 1u);
+        writer->crc = (uint16_t)((writer->crc << 1) & 0x7FFFu);
+        if (next) {
+            writer->crc ^= 0x4599u;
+        }
+    }
+
+    writer->bits++;
+    if (writer->run && bit == writer->last) {
+        // Five equal bits take a complementary stuff bit, which starts
+        // the next run
+        if (++writer->run == 5) {
+            writer->bits++;
+            writer->last = (uint8_t)!bit;
+            writer->run = 1;
+        }
+    } else {
+        writer->last = (uint8_t)bit;
+        writer->run = 1;
+    }
+}
+
+static void put_bits(BitWriter* writer, uint32_t value, uint32_t count, bool crc) {
+    while (count--) {
+        put_bit(writer, (value >> count) & 1u, crc);
+    }
+}
+
+// FD payloads round up to the next DLC length
+static uint8_t fd_dlc_code(uint8_t length, uint8_t* padded) {
+    static const uint8_t lengths[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+    uint8_t code = 0;
+
+    while (code < 15 && lengths[code] < length) code++;
+    *padded = lengths[code];
+    return code;
+}
+
+static FrameBits frame_layout(const CANFrame* frame, bool bitrate_switch) {
+    BitWriter writer = { 0 };
+    FrameBits bits;
+    uint32_t rtr = frame->is_remote && !frame->is_fd;
+
+    put_bit(&writer, 0, true);                                  // SOF
+    if (frame->is_extended) {
+        put_bits(&writer, (frame->id >> 18) & 0x7FFu, 11, true);
+        put_bits(&writer, 3, 2, true);                          // SRR, IDE
+        put_bits(&writer, frame->id & 0x3FFFFu, 18, true);
+        put_bit(&writer, rtr, true);
+        bits.arbitration = writer.bits;
+        if (!frame->is_fd) {
+            put_bits(&writer, 0, 2, true);                      // r1, r0
+        }
+    } else {
+        put_bits(&writer, frame->id & 0x7FFu, 11, true);
+        put_bit(&writer, rtr, true);
+        bits.arbitration = writer.bits;
+        put_bit(&writer, 0, true);                              // IDE
+        if (!frame->is_fd) {
+            put_bit(&writer, 0, true);                          // r0
+        }
+    }
+
+    if (!frame->is_fd) {
+        uint8_t length = frame->dlc > 8 ? 8 : frame->dlc;
+        put_bits(&writer, length, 4, true);
+        if (!frame->is_remote) {
+            for (uint8_t i = 0; i < length; i++) {
+                put_bits(&writer, frame->data[i], 8, true);
+            }
+        }
+        uint16_t crc = writer.crc;
+        put_bits(&writer, crc, 15, false);
+        bits.crc_end = writer.bits + 1;
+        bits.fast_from = bits.crc_end;
+    } else {
+        uint8_t padded;
+        uint8_t code = fd_dlc_code(frame->dlc, &padded);
+
+        put_bit(&writer, 1, false);                             // FDF
+        put_bit(&writer, 0, false);                             // res
+        put_bit(&writer, bitrate_switch, false);                // BRS
+        bits.fast_from = writer.bits;
+        put_bit(&writer, 0, false);                             // ESI
+        put_bits(&writer, code, 4, false);
+        for (uint8_t i = 0; i < padded; i++) {
+            put_bits(&writer, i < frame->dlc ? frame->data[i] : 0, 8, false);
+        }
+
+        // Stuff count and CRC carry a fixed stuff bit before the count and
+        // after every fourth bit, whatever their values
+        uint32_t crc_bits = padded > 16 ? 21 : 17;
+        writer.bits += 4 + crc_bits + 1 + (crc_bits + 3) / 4;
+        bits.crc_end = writer.bits + 1;
+        if (!bitrate_switch) {
+            bits.fast_from = bits.crc_end;
+        }
+    }
+
+    bits.total = bits.crc_end + 2 + 7 + INTERMISSION_BITS;        // ACK, delimiter, EOF
+    return bits;
+}
+
+static bool uses_brs(const CANBus* bus, const CANFrame* frame) {
+    return frame->is_fd && bus->config.data_bitrate > bus->config.bitrate;
+}
+
+static uint64_t bits_ns(const CANBus* bus, uint64_t nominal, uint64_t fast) {
+    return nominal * 1000000000u / bus->config.bitrate +
+           fast * 1000000000u / bus->config.data_bitrate;
+}
+
+// Time from SOF to bit position
+static uint64_t time_to(const CANBus* bus, const FrameBits* bits, uint32_t position) {
+    uint32_t fast = 0;
+
+    if (position > bits->fast_from) {
+        fast = (position < bits->crc_end ? position : bits->crc_end) - bits->fast_from;
+    }
+    return bits_ns(bus, position - fast, fast);
+}
+
+// Fault confinement
+
+static void update_state(CANDriver* node) {
+    CANBus* bus = node->bus;
+
+    if (node->tec > 255) {
+        node->state = CAN_STATE_BUS_OFF;
+        node->statistics.bus_off_count++;
+        node->ready_ns = bus->now_ns + bits_ns(bus, BUS_OFF_RECOVERY_BITS, 0);
+    } else if (node->state == CAN_STATE_SLEEP) {
+        // A frame that was on the wire when the node went to sleep
+    } else if (node->tec > 127 || node->rec > 127) {
+        node->state = CAN_STATE_ERROR_PASSIVE;
+    } else {
+        node->state = CAN_STATE_STARTED;
+    }
+    node->statistics.tx_error_counter = (uint8_t)(node->tec > 255 ? 255 : node->tec);
+    node->statistics.rx_error_counter = (uint8_t)(node->rec > 255 ? 255 : node->rec);
+}
+
+static void tx_error(CANDriver* node, CANError error) {
+    node->statistics.error_count++;
+    node->last_error = error;
+    // A passive sender that only missed its ACK keeps its count, so a
+    // lone node never goes bus-off
+    if (error != CAN_ERROR_ACK || node->state != CAN_STATE_ERROR_PASSIVE) {
+        node->tec += 8;
+    }
+    update_state(node);
+}
+
+static void rx_error(CANDriver* node, CANError error) {
+    node->statistics.error_count++;
+    // Listeners see the sender's error flag as a stuff violation
+    node->last_error = error == CAN_ERROR_BIT0 || error == CAN_ERROR_BIT1 ?
+                       CAN_ERROR_STUFF : error;
+    if (node->rec < 255) {
+        node->rec++;
+    }
+    update_state(node);
+}
+
+static bool accepted(const CANDriver* node, const CANFrame* frame) {
+    if (!node->filter) return true;
+
+    return can_filter_lookup(node->filter, frame->id, frame->is_extended) != CAN_FILTER_REJECT;
+}
+
+static void rx_done(CANDriver* node, const CANFrame* frame) {
+    if (node->rec > 127) {
+        node->rec = 127;
+    } else if (node->rec > 0) {
+        node->rec--;
+    }
+    update_state(node);
+
+    if (!accepted(node, frame)) return;
+
+    CANFrame copy = *frame;
+    copy.timestamp = node->bus->now_ns;
+    if (queue_push(&node->rx_queue, &copy, sizeof(copy))) {
+        node->statistics.rx_count++;
+    } else {
+        node->statistics.overflow_count++;
+    }
+}
+
+static void tx_done(CANDriver* node, uint8_t mailbox) {
+    node->mailboxes[mailbox] = NULL;
+    can_tx_queue_complete(node->tx_queue, mailbox, (uint32_t)(node->bus->now_ns / 1000u));
+    node->statistics.tx_count++;
+    if (node->tec > 0) {
+        node->tec--;
+    }
+    update_state(node);
+}
+
+// Arbitration
+
+static bool on_wire(const CANDriver* node, uint8_t mailbox) {
+    const CANBus* bus = node->bus;
+    return bus->wire.active && (bus->wire.senders & (1u << node->node)) &&
+           bus->wire.mailboxes[node->node] == mailbox;
+}
+
+static void service_tx(CANDriver* node) {
+    CANTxCommand command;
+
+    for (;;) {
+        CANTxAction action = can_tx_queue_next(node->tx_queue, &command);
+        if (action == CAN_TX_LOAD) {
+            node->mailboxes[command.mailbox] = command.frame;
+        } else if (action == CAN_TX_ABORT) {
+            // A frame already on the wire finishes first
+            if (on_wire(node, command.mailbox)) {
+                node->abort_pending |= 1u << command.mailbox;
+                continue;
+            }
+            node->mailboxes[command.mailbox] = NULL;
+            can_tx_queue_aborted(node->tx_queue, command.mailbox);
+        } else {
+            break;
+        }
+    }
+}
+
+static bool has_frames(const CANDriver* node) {
+    if (can_tx_queue_pending(node->tx_queue)) return true;
+    for (uint8_t i = 0; i < node->mailbox_count; i++) {
+        if (node->mailboxes[i]) return true;
+    }
+    return false;
+}
+
+static bool same_frame(const CANFrame* a, const CANFrame* b) {
+    if (a->id != b->id || a->is_extended != b->is_extended || a->is_remote != b->is_remote ||
+        a->is_fd != b->is_fd || a->dlc != b->dlc) {
+        return false;
+    }
+    return a->is_remote || memcmp(a->data, b->data, a->dlc) == 0;
+}
+
+static uint64_t next_random(CANBus* bus) {
+    uint64_t x = bus->random;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    bus->random = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+static CANError injected_error(CANBus* bus, const CANFrame* frame) {
+    for (uint32_t i = 0; i < CAN_BUS_MAX_INJECTIONS; i++) {
+        Injection* injection = &bus->injections[i];
+        if (injection->remaining && injection->id == frame->id &&
+            injection->is_extended == frame->is_extended) {
+            injection->remaining--;
+            return injection->error;
+        }
+    }
+    return CAN_ERROR_NONE;
+}
+
+// Where the error flag starts. Errors every node sees at the same bit get
+// one flag; others are seen by one node first and the rest answer it.
+static uint32_t error_position(CANBus* bus, const FrameBits* bits, CANError error,
+                               bool random, bool* everyone) {
+    uint32_t span = bits->crc_end - 1 - bits->arbitration;
+
+    *everyone = true;
+    switch (error) {
+        case CAN_ERROR_ACK:
+            return bits->crc_end + 1;       // After the ACK slot
+        case CAN_ERROR_CRC:
+            return bits->crc_end + 2;       // After the ACK delimiter
+        case CAN_ERROR_FORM:
+            return bits->crc_end;           // The CRC delimiter
+        default:
+            break;
+    }
+
+    *everyone = false;
+    return bits->arbitration + (random ? (uint32_t)(next_random(bus) % span) : span / 2);
+}
+
+static bool start_transfer(CANBus* bus) {
+    uint32_t keys[CAN_BUS_MAX_NODES];
+    uint8_t boxes[CAN_BUS_MAX_NODES];
+    uint32_t contenders = 0;
+
+    for (uint32_t n = 0; n < CAN_BUS_MAX_NODES; n++) {
+        CANDriver* node = bus->nodes[n];
+        if (!node || !is_running(node->state) || node->ready_ns > bus->now_ns) continue;
+
+        service_tx(node);
+        boxes[n] = NO_MAILBOX;
+        for (uint8_t i = 0; i < node->mailbox_count; i++) {
+            if (!node->mailboxes[i]) continue;
+            uint32_t key = can_arbitration_key(node->mailboxes[i]);
+            if (boxes[n] == NO_MAILBOX || key < keys[n]) {
+                keys[n] = key;
+                boxes[n] = i;
+            }
+        }
+        if (boxes[n] != NO_MAILBOX) {
+            contenders |= 1u << n;
+        }
+    }
+    if (!contenders) return false;
+
+    // Wired-AND, MSB first: a node that sends recessive and reads back
+    // dominant has lost and stops sending
+    for (int bit = 31; bit >= 0 && (contenders & (contenders - 1)); bit--) {
+        uint32_t recessive = 0;
+        for (uint32_t n = 0; n < CAN_BUS_MAX_NODES; n++) {
+            if ((contenders & (1u << n)) && (keys[n] >> bit & 1u)) {
+                recessive |= 1u << n;
+            }
+        }
+        if (recessive != contenders) {
+            bus->stats.arbitration_losses += (uint32_t)__builtin_popcount(recessive);
+            contenders &= ~recessive;
+        }
+    }
+
+    // Nodes left with the same ID send together; any difference in the
+    // rest of the frame is a bit error for all of them
+    uint32_t winner = (uint32_t)__builtin_ctz(contenders);
+    bus->wire.frame = *bus->nodes[winner]->mailboxes[boxes[winner]];
+    bus->wire.senders = contenders;
+    bus->wire.error = CAN_ERROR_NONE;
+    for (uint32_t n = 0; n < CAN_BUS_MAX_NODES; n++) {
+        if (!(contenders & (1u << n))) continue;
+        bus->wire.mailboxes[n] = boxes[n];
+        if (!same_frame(&bus->wire.frame, bus->nodes[n]->mailboxes[boxes[n]])) {
+            bus->wire.error = CAN_ERROR_BIT1;
+        }
+    }
+
+    const CANFrame* frame = &bus->wire.frame;
+    bool acked = false;
+    for (uint32_t n = 0; n < CAN_BUS_MAX_NODES; n++) {
+        CANDriver* node = bus->nodes[n];
+        if (node && !(contenders & (1u << n)) && is_running(node->state) &&
+            (!frame->is_fd || node->config.fd_enabled)) {
+            acked = true;
+        }
+    }
+
+    FrameBits bits = frame_layout(frame, uses_brs(bus, frame));
+    bool random = false;
+    if (bus->wire.error == CAN_ERROR_NONE && !acked) {
+        bus->wire.error = CAN_ERROR_ACK;
+    }
+    if (bus->wire.error == CAN_ERROR_NONE) {
+        bus->wire.error = injected_error(bus, frame);
+    }
+    if (bus->wire.error == CAN_ERROR_NONE && bus->config.bit_error_rate > 0.0) {
+        // Per-frame probability, linear in the bit error rate
+        double draw = (double)(next_random(bus) >> 11) * (1.0 / 9007199254740992.0);
+        if (draw < bus->config.bit_error_rate * bits.total) {
+            bus->wire.error = next_random(bus) & 1u ? CAN_ERROR_BIT1 : CAN_ERROR_BIT0;
+            random = true;
+        }
+    }
+
+    uint64_t duration;
+    if (bus->wire.error == CAN_ERROR_NONE) {
+        duration = time_to(bus, &bits, bits.total);
+    } else {
+        bool everyone;
+        uint32_t position = error_position(bus, &bits, bus->wire.error, random, &everyone);
+        uint32_t flags = everyone ? ERROR_FLAG_BITS : 2 * ERROR_FLAG_BITS;
+        duration = time_to(bus, &bits, position) +
+                   bits_ns(bus, flags + ERROR_DELIMITER_BITS + INTERMISSION_BITS, 0);
+    }
+
+    bus->wire.active = true;
+    bus->wire.start_ns = bus->now_ns;
+    bus->wire.end_ns = bus->now_ns + duration;
+    return true;
+}
+
+static void finish_transfer(CANBus* bus) {
+    const CANFrame* frame = &bus->wire.frame;
+    bool failed = bus->wire.error != CAN_ERROR_NONE;
+
+    bus->wire.active = false;
+    bus->stats.busy_ns += bus->wire.end_ns - bus->wire.start_ns;
+    if (failed) {
+        bus->stats.error_frames++;
+    } else {
+        bus->stats.frames++;
+    }
+
+    for (uint32_t n = 0; n < CAN_BUS_MAX_NODES; n++) {
+        CANDriver* node = bus->nodes[n];
+        if (!node) continue;
+
+        if (bus->wire.senders & (1u << n)) {
+            uint8_t mailbox = bus->wire.mailboxes[n];
+            uint32_t abort = node->abort_pending & (1u << mailbox);
+
+            node->abort_pending &= ~abort;
+            if (!failed) {
+                tx_done(node, mailbox);
+            } else {
+                tx_error(node, bus->wire.error);
+                if (abort) {
+                    node->mailboxes[mailbox] = NULL;
+                    can_tx_queue_aborted(node->tx_queue, mailbox);
+                }
+            }
+            if (node->state == CAN_STATE_ERROR_PASSIVE) {
+                node->ready_ns = bus->now_ns + bits_ns(bus, SUSPEND_BITS, 0);
+            }
+        } else if (is_running(node->state) && (!frame->is_fd || node->config.fd_enabled)) {
+            if (!failed) {
+                rx_done(node, frame);
+            } else if (bus->wire.error != CAN_ERROR_ACK) {
+                rx_error(node, bus->wire.error);
+            }
+        }
+    }
+}
+
+static void recover_nodes(CANBus* bus) {
+    for (uint32_t n = 0; n < CAN_BUS_MAX_NODES; n++) {
+        CANDriver* node = bus->nodes[n];
+        if (node && node->state == CAN_STATE_BUS_OFF && node->ready_ns <= bus->now_ns) {
+            node->tec = 0;
+            node->rec = 0;
+            update_state(node);
+        }
+    }
+}
+
+// Earliest time a waiting node may contend again
+static uint64_t next_ready(const CANBus* bus) {
+    uint64_t next = UINT64_MAX;
+
+    for (uint32_t n = 0; n < CAN_BUS_MAX_NODES; n++) {
+        const CANDriver* node = bus->nodes[n];
+        if (!node || node->ready_ns <= bus->now_ns || node->ready_ns >= next) continue;
+        if (node->state == CAN_STATE_BUS_OFF || (is_running(node->state) && has_frames(node))) {
+            next = node->ready_ns;
+        }
+    }
+    return next;
+}
+
+// Runs the next bus event at or before limit; false once the clock has
+// reached limit with nothing left to do
+static bool step(CANBus* bus, uint64_t limit) {
+    if (bus->wire.active) {
+        if (bus->wire.end_ns > limit) {
+            if (limit > bus->now_ns) {
+                bus->now_ns = limit;
+            }
+            return false;
+        }
+        bus->now_ns = bus->wire.end_ns;
+        finish_transfer(bus);
+        return true;
+    }
+
+    recover_nodes(bus);
+    if (start_transfer(bus)) return true;
+
+    uint64_t next = next_ready(bus);
+    if (next <= limit) {
+        bus->now_ns = next;
+        return true;
+    }
+    if (limit > bus->now_ns) {
+        bus->now_ns = limit;
+    }
+    return false;
+}
+
+static uint64_t deadline(const CANBus* bus, uint32_t timeout_ms) {
+    return bus->now_ns + (uint64_t)timeout_ms * 1000000u;
+}
+
+// Node housekeeping, called with the bus lock held
+
+static void leave_wire(CANDriver* node) {
+    CANBus* bus = node->bus;
+    bus->wire.senders &= ~(1u << node->node);
+}
+
+static void flush_tx(CANDriver* node) {
+    can_tx_queue_clear(node->tx_queue);
+    memset(node->mailboxes, 0, sizeof(node->mailboxes));
+    node->abort_pending = 0;
+}
+
+static bool valid_frame(const CANDriver* driver, const CANFrame* frame) {
+    if (frame->dlc > (frame->is_fd ? 64 : 8)) return false;
+    if (frame->is_fd && (frame->is_remote || !driver->config.fd_enabled)) return false;
+    return frame->id <= (frame->is_extended ? 0x1FFFFFFFu : 0x7FFu);
+}
+
+// Queues the frame, running the bus until there is room or the deadline
+static bool enqueue(CANDriver* driver, const CANFrame* frame, uint64_t until) {
+    CANBus* bus = driver->bus;
+
+    if (!valid_frame(driver, frame)) {
+        driver->last_error = CAN_ERROR_SOFTWARE;
+        return false;
+    }
+    for (;;) {
+        if (can_tx_queue_push(driver->tx_queue, frame, (uint32_t)(bus->now_ns / 1000u))) {
+            return true;
+        }
+        if (!step(bus, until)) break;
+    }
+    driver->statistics.overflow_count++;
+    return false;
+}
+
+static void lock(const CANDriver* driver) {
+    if (driver->bus) {
+        pthread_mutex_lock(&driver->bus->lock);
+    }
+}
+
+static void unlock(const CANDriver* driver) {
+    if (driver->bus) {
+        pthread_mutex_unlock(&driver->bus->lock);
+    }
+}
+
+// Bus API implementation
+CANBus* can_bus_create(const char* name, const CANBusConfig* config) {
+    if (!name || strlen(name) >= CAN_BUS_NAME_SIZE) return NULL;
+
+    CANBus* bus = calloc(1, sizeof(CANBus));
+    if (!bus) return NULL;
+
+    strcpy(bus->name, name);
+    if (config) {
+        bus->config = *config;
+    }
+    if (!bus->config.bitrate) {
+        bus->config.bitrate = CAN_DEFAULT_BITRATE;
+    }
+    if (bus->config.data_bitrate < bus->config.bitrate) {
+        bus->config.data_bitrate = bus->config.bitrate;
+    }
+    bus->random = bus->config.seed ? bus->config.seed : 0x9E3779B97F4A7C15ull;
+    pthread_mutex_init(&bus->lock, NULL);
+
+    pthread_mutex_lock(&buses_lock);
+    for (CANBus* other = buses; other; other = other->next) {
+        if (strcmp(other->name, name) == 0) {
+            pthread_mutex_unlock(&buses_lock);
+            pthread_mutex_destroy(&bus->lock);
+            free(bus);
+            return NULL;
+        }
+    }
+    bus->next = buses;
+    buses = bus;
+    pthread_mutex_unlock(&buses_lock);
+    return bus;
+}
+
+void can_bus_destroy(CANBus* bus) {
+    if (!bus) return;
+
+    pthread_mutex_lock(&buses_lock);
+    for (CANBus** link = &buses; *link; link = &(*link)->next) {
+        if (*link == bus) {
+            *link = bus->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&buses_lock);
+
+    pthread_mutex_lock(&bus->lock);
+    for (uint32_t n = 0; n < CAN_BUS_MAX_NODES; n++) {
+        if (bus->nodes[n]) {
+            bus->nodes[n]->bus = NULL;
+            bus->nodes[n]->state = CAN_STATE_STOPPED;
+            bus->nodes[n]->last_error = CAN_ERROR_HARDWARE;
+        }
+    }
+    pthread_mutex_unlock(&bus->lock);
+
+    pthread_mutex_destroy(&bus->lock);
+    free(bus);
+}
+
+uint64_t can_bus_now(const CANBus* bus) {
+    if (!bus) return 0;
+
+    pthread_mutex_lock((pthread_mutex_t*)&bus->lock);
+    uint64_t now = bus->now_ns;
+    pthread_mutex_unlock((pthread_mutex_t*)&bus->lock);
+    return now;
+}
+
+void can_bus_advance(CANBus* bus, uint64_t duration_ns) {
+    if (!bus) return;
+
+    pthread_mutex_lock(&bus->lock);
+    uint64_t until = bus->now_ns + duration_ns;
+    while (step(bus, until)) {}
+    pthread_mutex_unlock(&bus->lock);
+}
+
+bool can_bus_inject_error(CANBus* bus, uint32_t id, bool is_extended, CANError error,
+                          uint32_t count) {
+    if (!bus || count == 0) return false;
+    if (error != CAN_ERROR_STUFF && error != CAN_ERROR_FORM && error != CAN_ERROR_ACK &&
+        error != CAN_ERROR_BIT0 && error != CAN_ERROR_BIT1 && error != CAN_ERROR_CRC) {
+        return false;
+    }
+
+    pthread_mutex_lock(&bus->lock);
+    Injection* slot = NULL;
+    for (uint32_t i = 0; i < CAN_BUS_MAX_INJECTIONS; i++) {
+        Injection* injection = &bus->injections[i];
+        if (injection->remaining && injection->id == id &&
+            injection->is_extended == is_extended && injection->error == error) {
+            slot = injection;
+            break;
+        }
+        if (!injection->remaining && !slot) {
+            slot = injection;
+        }
+    }
+    if (slot) {
+        if (!slot->remaining) {
+            *slot = (Injection){ .id = id, .is_extended = is_extended, .error = error };
+        }
+        slot->remaining += count;
+    }
+    pthread_mutex_unlock(&bus->lock);
+    return slot != NULL;
+}
+
+void can_bus_get_statistics(const CANBus* bus, CANBusStats* stats) {
+    if (!bus || !stats) return;
+
+    pthread_mutex_lock((pthread_mutex_t*)&bus->lock);
+    *stats = bus->stats;
+    stats->elapsed_ns = bus->now_ns - bus->stats_from_ns;
+    pthread_mutex_unlock((pthread_mutex_t*)&bus->lock);
+}
+
+void can_bus_reset_statistics(CANBus* bus) {
+    if (!bus) return;
+
+    pthread_mutex_lock(&bus->lock);
+    memset(&bus->stats, 0, sizeof(bus->stats));
+    bus->stats_from_ns = bus->now_ns;
+    pthread_mutex_unlock(&bus->lock);
+}
+
+uint32_t can_frame_bits(const CANFrame* frame, bool bitrate_switch) {
+    if (!frame) return 0;
+
+    return frame_layout(frame, frame->is_fd && bitrate_switch).total;
+}
+
+uint64_t can_bus_frame_time(const CANBus* bus, const CANFrame* frame) {
+    if (!bus || !frame) return 0;
+
+    FrameBits bits = frame_layout(frame, uses_brs(bus, frame));
+    return time_to(bus, &bits, bits.total);
+}
+
+// Driver API implementation
+CANDriver* can_create(const CANConfig* config) {
+    if (!config || !config->interface_name) return NULL;
+    if (config->tx_mailboxes > CAN_TX_MAX_MAILBOXES) return NULL;
+
+    pthread_mutex_lock(&buses_lock);
+    CANBus* bus = buses;
+    while (bus && strcmp(bus->name, config->interface_name) != 0) {
+        bus = bus->next;
+    }
+    pthread_mutex_unlock(&buses_lock);
+
+    // A node at another bitrate would only ever see errors
+    if (!bus || (config->bitrate && config->bitrate != bus->config.bitrate)) return NULL;
+
+    CANDriver* driver = calloc(1, sizeof(CANDriver));
+    if (!driver) return NULL;
+
+    memcpy(&driver->config, config, sizeof(CANConfig));
+    strcpy(driver->interface_name, bus->name);
+    driver->config.interface_name = driver->interface_name;
+    driver->mailbox_count = config->tx_mailboxes ? config->tx_mailboxes : 1;
+    driver->tx_queue = can_tx_queue_create(CAN_VIRTUAL_TX_DEPTH, driver->mailbox_count);
+
+    if (!driver->tx_queue ||
+        !queue_init(&driver->rx_queue, sizeof(CANFrame), CAN_VIRTUAL_RX_DEPTH)) {
+        can_tx_queue_destroy(driver->tx_queue);
+        free(driver);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&bus->lock);
+    for (uint32_t n = 0; n < CAN_BUS_MAX_NODES && !driver->bus; n++) {
+        if (!bus->nodes[n]) {
+            bus->nodes[n] = driver;
+            driver->bus = bus;
+            driver->node = (uint8_t)n;
+        }
+    }
+    pthread_mutex_unlock(&bus->lock);
+
+    if (!driver->bus) {
+        queue_destroy(&driver->rx_queue);
+        can_tx_queue_destroy(driver->tx_queue);
+        free(driver);
+        return NULL;
+    }
+
+    driver->state = CAN_STATE_STOPPED;
+    return driver;
+}
+
+void can_destroy(CANDriver* driver) {
+    if (!driver) return;
+
+    lock(driver);
+    if (driver->bus) {
+        leave_wire(driver);
+        driver->bus->nodes[driver->node] = NULL;
+    }
+    unlock(driver);
+
+    can_filter_destroy(driver->filter);
+    free(driver->rules);
+    queue_destroy(&driver->rx_queue);
+    can_tx_queue_destroy(driver->tx_queue);
+    free(driver);
+}
+
+bool can_start(CANDriver* driver) {
+    if (!driver || !driver->bus || driver->state != CAN_STATE_STOPPED) return false;
+
+    lock(driver);
+    driver->tec = 0;
+    driver->rec = 0;
+    driver->ready_ns = 0;
+    driver->state = CAN_STATE_STARTED;
+    update_state(driver);
+    unlock(driver);
+    return true;
+}
+
+void can_stop(CANDriver* driver) {
+    if (!driver || driver->state == CAN_STATE_STOPPED) return;
+
+    lock(driver);
+    if (driver->bus) {
+        leave_wire(driver);
+    }
+    flush_tx(driver);
+    queue_clear(&driver->rx_queue);
+    driver->state = CAN_STATE_STOPPED;
+    unlock(driver);
+}
+
+bool can_transmit(CANDriver* driver, const CANFrame* frame, uint32_t timeout_ms) {
+    if (!driver || !frame) return false;
+
+    lock(driver);
+    bool result = driver->bus && is_running(driver->state) &&
+                  enqueue(driver, frame, deadline(driver->bus, timeout_ms));
+    unlock(driver);
+    return result;
+}
+
+uint32_t can_transmit_batch(CANDriver* driver, const CANFrameBatch* batch, uint32_t timeout_ms) {
+    if (!driver || !batch) return 0;
+
+    uint32_t sent = 0;
+    lock(driver);
+    if (driver->bus && is_running(driver->state)) {
+        uint64_t until = deadline(driver->bus, timeout_ms);
+        CANFrame frame;
+        while (sent < batch->count) {
+            can_batch_get(batch, sent, &frame);
+            if (!enqueue(driver, &frame, until)) break;
+            sent++;
+        }
+    }
+    unlock(driver);
+    return sent;
+}
+
+// Waits for the first frame only, then takes what is queued
+static uint32_t receive(CANDriver* driver, CANFrame* frames, CANFrameBatch* batch,
+                        uint32_t max, uint32_t timeout_ms) {
+    uint32_t count = 0;
+    CANFrame frame;
+
+    lock(driver);
+    if (driver->bus) {
+        uint64_t until = deadline(driver->bus, timeout_ms);
+        while (queue_count(&driver->rx_queue) == 0 && step(driver->bus, until)) {}
+    }
+    while (count < max && queue_pop(&driver->rx_queue, &frame, sizeof(frame))) {
+        if (frames) {
+            frames[count++] = frame;
+        } else if (can_batch_add(batch, &frame)) {
+            count++;
+        } else {
+            driver->statistics.overflow_count++;
+        }
+    }
+    unlock(driver);
+    return count;
+}
+
+bool can_receive(CANDriver* driver, CANFrame* frame, uint32_t timeout_ms) {
+    if (!driver || !frame) return false;
+
+    return receive(driver, frame, NULL, 1, timeout_ms) == 1;
+}
+
+uint32_t can_receive_batch(CANDriver* driver, CANFrameBatch* batch, uint32_t timeout_ms) {
+    if (!driver || !batch) return 0;
+
+    can_batch_clear(batch);
+    return receive(driver, NULL, batch, batch->capacity, timeout_ms);
+}
+
+CANState can_get_state(const CANDriver* driver) {
+    return driver ? driver->state : CAN_STATE_UNINIT;
+}
+
+CANError can_get_last_error(const CANDriver* driver) {
+    return driver ? driver->last_error : CAN_ERROR_NONE;
+}
+
+void can_get_statistics(const CANDriver* driver, CANStats* stats) {
+    if (!driver || !stats) return;
+
+    lock(driver);
+    memcpy(stats, &driver->statistics, sizeof(CANStats));
+    unlock(driver);
+}
+
+void can_get_tx_band_statistics(const CANDriver* driver, uint8_t band, CANTxBandStats* stats) {
+    if (!driver || !stats || band >= CAN_TX_BANDS) return;
+
+    lock(driver);
+    can_tx_queue_get_band(driver->tx_queue, band, stats);
+    unlock(driver);
+}
+
+bool can_set_filter(CANDriver* driver, uint32_t id, uint32_t mask, bool is_extended) {
+    if (!driver) return false;
+
+    lock(driver);
+
+    if (driver->rule_count == driver->rule_capacity) {
+        size_t capacity = driver->rule_capacity ? driver->rule_capacity * 2 : 16;
+        CANFilterRule* rules = realloc(driver->rules, capacity * sizeof(CANFilterRule));
+        if (!rules) {
+            unlock(driver);
+            return false;
+        }
+        driver->rules = rules;
+        driver->rule_capacity = capacity;
+    }
+
+    driver->rules[driver->rule_count++] = (CANFilterRule){
+        .id = id,
+        .mask = mask,
+        .is_extended = is_extended,
+        .target = 0
+    };
+
+    CANFilter* compiled = can_filter_compile(driver->rules, driver->rule_count);
+    if (compiled) {
+        can_filter_destroy(driver->filter);
+        driver->filter = compiled;
+    } else {
+        driver->rule_count--;
+    }
+
+    unlock(driver);
+    return compiled != NULL;
+}
+
+void can_clear_filters(CANDriver* driver) {
+    if (!driver) return;
+
+    lock(driver);
+    driver->rule_count = 0;
+    can_filter_destroy(driver->filter);
+    driver->filter = NULL;
+    unlock(driver);
+}
+
+bool can_enable_fd(CANDriver* driver) {
+    if (!driver) return false;
+
+    lock(driver);
+    driver->config.fd_enabled = true;
+    unlock(driver);
+    return true;
+}
+
+// Bit timing belongs to the bus; a node can only confirm it
+bool can_set_bitrate(CANDriver* driver, uint32_t bitrate, uint32_t data_bitrate) {
+    if (!driver || !driver->bus) return false;
+
+    const CANBusConfig* config = &driver->bus->config;
+    return bitrate == config->bitrate &&
+           (data_bitrate == 0 || data_bitrate == config->data_bitrate);
+}
+
+// A sleeping node neither acknowledges nor contends; its queue is kept
+bool can_enter_sleep(CANDriver* driver) {
+    if (!driver || !is_running(driver->state)) return false;
+
+    lock(driver);
+    driver->state = CAN_STATE_SLEEP;
+    unlock(driver);
+    return true;
+}
+
+bool can_exit_sleep(CANDriver* driver) {
+    if (!driver || !driver->bus || driver->state != CAN_STATE_SLEEP) return false;
+
+    lock(driver);
+    driver->state = CAN_STATE_STARTED;
+    update_state(driver);
+    unlock(driver);
+    return true;
+}
+
+void can_reset(CANDriver* driver) {
+    if (!driver) return;
+
+    lock(driver);
+    bool restart = driver->bus && driver->state != CAN_STATE_STOPPED;
+    if (driver->bus) {
+        leave_wire(driver);
+    }
+    flush_tx(driver);
+    queue_clear(&driver->rx_queue);
+    memset(&driver->statistics, 0, sizeof(CANStats));
+    driver->last_error = CAN_ERROR_NONE;
+    driver->tec = 0;
+    driver->rec = 0;
+    driver->ready_ns = 0;
+    driver->state = restart ? CAN_STATE_STARTED : CAN_STATE_STOPPED;
+    unlock(driver);
+}
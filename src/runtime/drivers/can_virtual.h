@@ -0,0 +1,73 @@
+#ifndef CANT_CAN_VIRTUAL_H
+#define CANT_CAN_VIRTUAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_driver.h"
+
+// In-process virtual CAN bus, the third CANDriver backend (can_virtual.c).
+// can_create() attaches a node to the bus whose name is in
+// config->interface_name, so every driver in the process can share one
+// simulated wire.
+//
+// The bus runs on a simulated clock and only moves when told to:
+// can_bus_advance(), or a driver call that waits (can_receive() or a
+// can_transmit() into a full queue advances the clock up to its
+// timeout). Runs are deterministic for a given seed.
+//
+// Modelled per frame:
+//   - arbitration, bit by bit over the ID field, between the most urgent
+//     mailbox of every node; the losers retry at the next idle bus
+//   - exact frame length: stuff bits from the real bit stream (CRC-15
+//     included), FD fixed stuff bits, and the data phase at data_bitrate
+//   - errors: injected per ID or random at bit_error_rate. An error frame
+//     occupies the bus, the senders retransmit, and the error counters
+//     drive error-passive (with its suspend time) and bus-off, which
+//     recovers after 128 x 11 recessive bits
+//   - ACK errors when no other node is listening
+//
+// Timestamps and the per-band TX latencies are in simulated time. Nodes
+// without fd_enabled ignore FD frames instead of destroying them.
+
+#define CAN_BUS_MAX_NODES       32
+#define CAN_BUS_MAX_INJECTIONS  16
+
+typedef struct CANBus CANBus;
+
+typedef struct {
+    uint32_t bitrate;           // 500 kbit/s when 0
+    uint32_t data_bitrate;      // FD data phase; above bitrate turns on BRS
+    double bit_error_rate;      // Random errors, per bit on the wire
+    uint32_t seed;
+} CANBusConfig;
+
+typedef struct {
+    uint64_t elapsed_ns;
+    uint64_t busy_ns;           // Frames, error frames and intermission
+    uint32_t frames;
+    uint32_t error_frames;
+    uint32_t arbitration_losses;    // Per node that backed off
+} CANBusStats;
+
+// NULL when the name is taken or too long for interface_name use
+CANBus* can_bus_create(const char* name, const CANBusConfig* config);
+// Nodes still attached are detached and stop working
+void can_bus_destroy(CANBus* bus);
+
+uint64_t can_bus_now(const CANBus* bus);
+void can_bus_advance(CANBus* bus, uint64_t duration_ns);
+
+// The next count transmissions of the ID fail with error (STUFF, FORM,
+// ACK, BIT0, BIT1 or CRC), detected where that error would be
+bool can_bus_inject_error(CANBus* bus, uint32_t id, bool is_extended, CANError error,
+                          uint32_t count);
+
+// Bus load over a window is busy_ns / elapsed_ns
+void can_bus_get_statistics(const CANBus* bus, CANBusStats* stats);
+void can_bus_reset_statistics(CANBus* bus);
+
+// Bits on the wire from SOF through intermission, stuff bits included
+uint32_t can_frame_bits(const CANFrame* frame, bool bitrate_switch);
+uint64_t can_bus_frame_time(const CANBus* bus, const CANFrame* frame);
+
+#endif // CANT_CAN_VIRTUAL_H
@@ -93,7 +93,7 @@ static void process_rx_interrupt(FlexRayDriver* driver) {
         FlexRayFrame frame;
         // ... copy frame from message buffer ...
         
-        if (!queue_push(&driver->rx_queue, &frame, sizeof(frame))) {
+        if (!queue_push_sp(&driver->rx_queue, &frame, sizeof(frame))) {
             // Handle overflow
         } else {
             driver->statistics.rx_frames++;
@@ -0,0 +1,376 @@
+#include "heap_profiler.h"
+#include "../diagnostic/logging/diag_logger.h"
+#include "../diagnostic/os/critical.h"
+#include "../diagnostic/os/timer.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SAMPLE_TABLE_SIZE   (HEAP_PROFILER_MAX_SAMPLES * 2)
+#define SITE_TABLE_SIZE     (HEAP_PROFILER_MAX_SITES * 2)
+#define MAX_DUMP_SITES      16
+
+typedef struct {
+    const void* ptr;        // NULL marks an empty slot
+    uint32_t site;
+    uint32_t size;
+    uint64_t weight;        // Bytes this sample stands for
+    uint32_t alloc_time;
+} SampleEntry;
+
+typedef struct {
+    HeapSiteStats sites[HEAP_PROFILER_MAX_SITES];
+    uint16_t site_index[SITE_TABLE_SIZE];     // 0 = empty, else site + 1
+    SampleEntry samples[SAMPLE_TABLE_SIZE];
+    uint32_t live_samples;
+    HeapProfilerSummary summary;
+    int64_t bytes_until_sample;
+    uint32_t rng;
+} HeapProfiler;
+
+static HeapProfiler profiler;
+
+static uint32_t log2_bucket(uint64_t value) {
+    uint32_t bucket = 0;
+    while (value && bucket < HEAP_PROFILER_HIST_BUCKETS - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Jittered interval with mean sample_interval; avoids aliasing with
+// allocation patterns that repeat at a fixed byte period
+static uint32_t next_interval(void) {
+    profiler.rng ^= profiler.rng << 13;
+    profiler.rng ^= profiler.rng >> 17;
+    profiler.rng ^= profiler.rng << 5;
+
+    uint32_t interval = profiler.summary.sample_interval;
+    return interval / 2 + profiler.rng % interval + 1;
+}
+
+static uint32_t hash_ptr(const void* ptr) {
+    return (uint32_t)(((uintptr_t)ptr >> 3) * 2654435761u);
+}
+
+static int32_t find_site(const char* file, uint32_t line) {
+    uint32_t slot = (hash_ptr(file) ^ (line * 2246822519u)) & (SITE_TABLE_SIZE - 1);
+
+    for (uint32_t probe = 0; probe < SITE_TABLE_SIZE; probe++) {
+        uint16_t entry = profiler.site_index[slot];
+        if (entry == 0) {
+            if (profiler.summary.site_count >= HEAP_PROFILER_MAX_SITES) {
+                return -1;
+            }
+            uint32_t index = profiler.summary.site_count++;
+            HeapSiteStats* site = &profiler.sites[index];
+            memset(site, 0, sizeof(HeapSiteStats));
+            site->file = file;
+            site->line = line;
+            profiler.site_index[slot] = (uint16_t)(index + 1);
+            return (int32_t)index;
+        }
+
+        HeapSiteStats* site = &profiler.sites[entry - 1];
+        if (site->file == file && site->line == line) {
+            return entry - 1;
+        }
+        slot = (slot + 1) & (SITE_TABLE_SIZE - 1);
+    }
+
+    return -1;
+}
+
+static SampleEntry* find_sample(const void* ptr) {
+    uint32_t slot = hash_ptr(ptr) & (SAMPLE_TABLE_SIZE - 1);
+
+    while (profiler.samples[slot].ptr) {
+        if (profiler.samples[slot].ptr == ptr) {
+            return &profiler.samples[slot];
+        }
+        slot = (slot + 1) & (SAMPLE_TABLE_SIZE - 1);
+    }
+    return NULL;
+}
+
+static SampleEntry* insert_sample(const void* ptr) {
+    uint32_t slot = hash_ptr(ptr) & (SAMPLE_TABLE_SIZE - 1);
+
+    while (profiler.samples[slot].ptr) {
+        slot = (slot + 1) & (SAMPLE_TABLE_SIZE - 1);
+    }
+    profiler.samples[slot].ptr = ptr;
+    return &profiler.samples[slot];
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+static void remove_sample(SampleEntry* entry) {
+    uint32_t hole = (uint32_t)(entry - profiler.samples);
+    uint32_t slot = hole;
+
+    for (;;) {
+        slot = (slot + 1) & (SAMPLE_TABLE_SIZE - 1);
+        if (!profiler.samples[slot].ptr) {
+            break;
+        }
+
+        uint32_t home = hash_ptr(profiler.samples[slot].ptr) & (SAMPLE_TABLE_SIZE - 1);
+        uint32_t dist_slot = (slot - home) & (SAMPLE_TABLE_SIZE - 1);
+        uint32_t dist_hole = (hole - home) & (SAMPLE_TABLE_SIZE - 1);
+        if (dist_hole < dist_slot) {
+            profiler.samples[hole] = profiler.samples[slot];
+            hole = slot;
+        }
+    }
+
+    memset(&profiler.samples[hole], 0, sizeof(SampleEntry));
+}
+
+static uint64_t site_metric(const HeapSiteStats* site, HeapProfileMetric metric) {
+    switch (metric) {
+        case HEAP_PROFILE_CUMULATIVE_BYTES:
+            return site->cumulative_bytes;
+        case HEAP_PROFILE_CUMULATIVE_COUNT:
+            return site->cumulative_count;
+        case HEAP_PROFILE_LIVE_BYTES:
+        default:
+            return site->live_bytes;
+    }
+}
+
+static const char* base_name(const char* path) {
+    const char* name = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            name = p + 1;
+        }
+    }
+    return name;
+}
+
+bool HeapProfiler_OnAlloc(const void* ptr, uint32_t size, const char* file, uint32_t line) {
+    if (!profiler.summary.active) {
+        return false;
+    }
+
+    profiler.bytes_until_sample -= size;
+    if (profiler.bytes_until_sample > 0) {
+        return false;
+    }
+
+    // Large allocations may span several intervals; weight them accordingly
+    uint64_t interval = profiler.summary.sample_interval;
+    uint64_t crossings = 1 + (uint64_t)(-profiler.bytes_until_sample) / interval;
+    profiler.bytes_until_sample += (int64_t)((crossings - 1) * interval) + next_interval();
+    uint64_t weight = crossings * interval;
+
+    profiler.summary.samples_taken++;
+
+    int32_t site_index = find_site(file ? file : "unknown", line);
+    if (site_index < 0) {
+        profiler.summary.samples_dropped++;
+        return false;
+    }
+
+    HeapSiteStats* site = &profiler.sites[site_index];
+    site->cumulative_bytes += weight;
+    site->cumulative_count += (size && weight > size) ? weight / size : 1;
+    site->total_samples++;
+    site->size_histogram[log2_bucket(size >> 4)]++;
+    profiler.summary.cumulative_bytes += weight;
+
+    if (profiler.live_samples >= HEAP_PROFILER_MAX_SAMPLES) {
+        profiler.summary.samples_dropped++;
+        return false;
+    }
+
+    SampleEntry* entry = insert_sample(ptr);
+    entry->site = (uint32_t)site_index;
+    entry->size = size;
+    entry->weight = weight;
+    entry->alloc_time = Timer_GetMilliseconds();
+    profiler.live_samples++;
+
+    site->live_bytes += weight;
+    site->live_samples++;
+    profiler.summary.live_bytes += weight;
+    return true;
+}
+
+void HeapProfiler_OnFree(const void* ptr) {
+    SampleEntry* entry = find_sample(ptr);
+    if (!entry) {
+        return;  // Sampled before the last reset
+    }
+
+    HeapSiteStats* site = &profiler.sites[entry->site];
+    site->live_bytes -= entry->weight;
+    site->live_samples--;
+    site->lifetime_histogram[log2_bucket(Timer_GetMilliseconds() - entry->alloc_time)]++;
+    profiler.summary.live_bytes -= entry->weight;
+    profiler.live_samples--;
+
+    remove_sample(entry);
+}
+
+// Compaction relocated a sampled block; keep its sample under the new address
+void HeapProfiler_OnMove(const void* old_ptr, const void* new_ptr) {
+    SampleEntry* entry = find_sample(old_ptr);
+    if (!entry) {
+        return;
+    }
+
+    SampleEntry saved = *entry;
+    remove_sample(entry);
+    entry = insert_sample(new_ptr);
+    saved.ptr = new_ptr;
+    *entry = saved;
+}
+
+bool HeapProfiler_Start(uint32_t sample_interval_bytes) {
+    if (sample_interval_bytes == 0) {
+        sample_interval_bytes = HEAP_PROFILER_DEFAULT_RATE;
+    }
+
+    enter_critical();
+    profiler.summary.sample_interval = sample_interval_bytes;
+    if (profiler.rng == 0) {
+        profiler.rng = 0x9E3779B9u ^ Timer_GetMicroseconds();
+        if (profiler.rng == 0) {
+            profiler.rng = 1;
+        }
+    }
+    profiler.bytes_until_sample = next_interval();
+    profiler.summary.active = true;
+    exit_critical();
+
+    Logger_Log(LOG_LEVEL_INFO, "HEAPPROF", "Sampling every %u bytes", sample_interval_bytes);
+    return true;
+}
+
+void HeapProfiler_Stop(void) {
+    enter_critical();
+    profiler.summary.active = false;
+    exit_critical();
+}
+
+void HeapProfiler_Reset(void) {
+    enter_critical();
+    bool active = profiler.summary.active;
+    uint32_t interval = profiler.summary.sample_interval;
+    uint32_t rng = profiler.rng;
+
+    memset(&profiler, 0, sizeof(HeapProfiler));
+    profiler.summary.active = active;
+    profiler.summary.sample_interval = interval;
+    profiler.rng = rng;
+    if (active) {
+        profiler.bytes_until_sample = next_interval();
+    }
+    exit_critical();
+}
+
+void HeapProfiler_GetSummary(HeapProfilerSummary* summary) {
+    if (!summary) {
+        return;
+    }
+
+    enter_critical();
+    memcpy(summary, &profiler.summary, sizeof(HeapProfilerSummary));
+    exit_critical();
+}
+
+uint32_t HeapProfiler_GetSites(HeapSiteStats* sites, uint32_t max_sites) {
+    if (!sites || max_sites == 0) {
+        return 0;
+    }
+
+    enter_critical();
+
+    // Keep the top max_sites by live bytes, sorted descending
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < profiler.summary.site_count; i++) {
+        const HeapSiteStats* site = &profiler.sites[i];
+        uint32_t pos = count;
+        while (pos > 0 && sites[pos - 1].live_bytes < site->live_bytes) {
+            pos--;
+        }
+        if (pos >= max_sites) {
+            continue;
+        }
+
+        uint32_t last = (count < max_sites) ? count : max_sites - 1;
+        memmove(&sites[pos + 1], &sites[pos], (last - pos) * sizeof(HeapSiteStats));
+        memcpy(&sites[pos], site, sizeof(HeapSiteStats));
+        if (count < max_sites) {
+            count++;
+        }
+    }
+
+    exit_critical();
+    return count;
+}
+
+bool HeapProfiler_ExportFolded(const char* path, HeapProfileMetric metric) {
+    if (!path) {
+        return false;
+    }
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        Logger_Log(LOG_LEVEL_ERROR, "HEAPPROF", "Cannot open %s", path);
+        return false;
+    }
+
+    // Copy one site at a time so allocators are never blocked on file I/O
+    enter_critical();
+    uint32_t site_count = profiler.summary.site_count;
+    exit_critical();
+
+    for (uint32_t i = 0; i < site_count; i++) {
+        HeapSiteStats site;
+        enter_critical();
+        memcpy(&site, &profiler.sites[i], sizeof(HeapSiteStats));
+        exit_critical();
+
+        uint64_t value = site_metric(&site, metric);
+        if (value == 0) {
+            continue;
+        }
+
+        const char* name = base_name(site.file);
+        fprintf(file, "heap;%s;%s:%u %llu\n", name, name, site.line,
+                (unsigned long long)value);
+    }
+
+    bool ok = (ferror(file) == 0);
+    fclose(file);
+    return ok;
+}
+
+void HeapProfiler_Dump(uint32_t top_n) {
+    HeapSiteStats sites[MAX_DUMP_SITES];
+    HeapProfilerSummary summary;
+
+    if (top_n > MAX_DUMP_SITES) {
+        top_n = MAX_DUMP_SITES;
+    }
+
+    HeapProfiler_GetSummary(&summary);
+    uint32_t count = HeapProfiler_GetSites(sites, top_n);
+
+    Logger_Log(LOG_LEVEL_INFO, "HEAPPROF", "Heap profile (1 sample / %u bytes):",
+               summary.sample_interval);
+    Logger_Log(LOG_LEVEL_INFO, "HEAPPROF", "  Live: ~%llu bytes, Cumulative: ~%llu bytes",
+               (unsigned long long)summary.live_bytes,
+               (unsigned long long)summary.cumulative_bytes);
+    Logger_Log(LOG_LEVEL_INFO, "HEAPPROF", "  Samples: %u taken, %u dropped, %u sites",
+               summary.samples_taken, summary.samples_dropped, summary.site_count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        Logger_Log(LOG_LEVEL_INFO, "HEAPPROF", "  %s:%u live ~%llu bytes, total ~%llu bytes",
+                   base_name(sites[i].file), sites[i].line,
+                   (unsigned long long)sites[i].live_bytes,
+                   (unsigned long long)sites[i].cumulative_bytes);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef CANT_HEAP_PROFILER_H
+#define CANT_HEAP_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HEAP_PROFILER_MAX_SITES      128
+#define HEAP_PROFILER_MAX_SAMPLES    512    // Live sampled allocations tracked
+#define HEAP_PROFILER_HIST_BUCKETS   16     // Log2 buckets
+#define HEAP_PROFILER_DEFAULT_RATE   (64 * 1024)
+
+// Metric exported to folded-stack files
+typedef enum {
+    HEAP_PROFILE_LIVE_BYTES = 0,
+    HEAP_PROFILE_CUMULATIVE_BYTES,
+    HEAP_PROFILE_CUMULATIVE_COUNT
+} HeapProfileMetric;
+
+// Per call-site aggregate. Byte counts are estimates scaled by the sampling
+// interval. Size buckets are log2 bytes starting at 16; lifetime buckets
+// are log2 milliseconds starting at 1.
+typedef struct {
+    const char* file;
+    uint32_t line;
+    uint64_t live_bytes;
+    uint64_t cumulative_bytes;
+    uint64_t cumulative_count;
+    uint32_t live_samples;
+    uint32_t total_samples;
+    uint32_t size_histogram[HEAP_PROFILER_HIST_BUCKETS];
+    uint32_t lifetime_histogram[HEAP_PROFILER_HIST_BUCKETS];
+} HeapSiteStats;
+
+typedef struct {
+    uint32_t sample_interval;
+    uint32_t samples_taken;
+    uint32_t samples_dropped;    // Sample or site table full
+    uint32_t site_count;
+    uint64_t live_bytes;
+    uint64_t cumulative_bytes;
+    bool active;
+} HeapProfilerSummary;
+
+// Profiler control
+bool HeapProfiler_Start(uint32_t sample_interval_bytes);
+void HeapProfiler_Stop(void);
+void HeapProfiler_Reset(void);
+
+// Reporting
+void HeapProfiler_GetSummary(HeapProfilerSummary* summary);
+uint32_t HeapProfiler_GetSites(HeapSiteStats* sites, uint32_t max_sites);
+bool HeapProfiler_ExportFolded(const char* path, HeapProfileMetric metric);
+void HeapProfiler_Dump(uint32_t top_n);
+
+// Allocator hooks, called by memory_manager.c inside its critical section.
+// OnAlloc returns true when the allocation was sampled; only those blocks
+// are flagged MEM_BLOCK_SAMPLED and reported back through OnFree.
+bool HeapProfiler_OnAlloc(const void* ptr, uint32_t size, const char* file, uint32_t line);
+void HeapProfiler_OnFree(const void* ptr);
+void HeapProfiler_OnMove(const void* old_ptr, const void* new_ptr);
+
+#endif // CANT_HEAP_PROFILER_H
\ No newline at end of file
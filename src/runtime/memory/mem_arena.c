@@ -0,0 +1,78 @@
+#include "mem_arena.h"
+#include <string.h>
+
+bool MemArena_Init(MemArena* arena, void* buffer, uint32_t size) {
+    if (!arena || !buffer || size == 0) {
+        return false;
+    }
+
+    // Trim the front so every allocation comes out aligned
+    uintptr_t start = ((uintptr_t)buffer + MEM_ARENA_ALIGNMENT - 1) &
+                      ~(uintptr_t)(MEM_ARENA_ALIGNMENT - 1);
+    uint32_t skew = (uint32_t)(start - (uintptr_t)buffer);
+    if (skew >= size) {
+        return false;
+    }
+
+    memset(arena, 0, sizeof(MemArena));
+    arena->base = (uint8_t*)start;
+    arena->size = size - skew;
+    return true;
+}
+
+void* MemArena_Alloc(MemArena* arena, uint32_t size) {
+    if (!arena || size == 0) {
+        return NULL;
+    }
+
+    uint32_t aligned = (size + MEM_ARENA_ALIGNMENT - 1) & ~(uint32_t)(MEM_ARENA_ALIGNMENT - 1);
+    if (aligned < size || aligned > arena->size - arena->offset) {
+        arena->failed_allocs++;
+        return NULL;
+    }
+
+    void* ptr = arena->base + arena->offset;
+    arena->offset += aligned;
+    arena->alloc_count++;
+    if (arena->offset > arena->peak) {
+        arena->peak = arena->offset;
+    }
+    return ptr;
+}
+
+void* MemArena_Calloc(MemArena* arena, uint32_t count, uint32_t size) {
+    if (count == 0 || size == 0 || count > UINT32_MAX / size) {
+        return NULL;
+    }
+
+    void* ptr = MemArena_Alloc(arena, count * size);
+    if (ptr) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+MemArenaMark MemArena_Mark(const MemArena* arena) {
+    return arena ? arena->offset : 0;
+}
+
+// Drops everything allocated after the mark; earlier allocations stay valid
+void MemArena_Release(MemArena* arena, MemArenaMark mark) {
+    if (arena && mark <= arena->offset) {
+        arena->offset = mark;
+    }
+}
+
+void MemArena_Reset(MemArena* arena) {
+    if (arena) {
+        arena->offset = 0;
+    }
+}
+
+uint32_t MemArena_GetUsed(const MemArena* arena) {
+    return arena ? arena->offset : 0;
+}
+
+uint32_t MemArena_GetRemaining(const MemArena* arena) {
+    return arena ? arena->size - arena->offset : 0;
+}
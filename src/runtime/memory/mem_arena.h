@@ -0,0 +1,35 @@
+#ifndef CANT_MEM_ARENA_H
+#define CANT_MEM_ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MEM_ARENA_ALIGNMENT 8
+
+// Bump-pointer arena over a caller-supplied buffer. Allocation is a pointer
+// increment; memory is only returned in bulk via MemArena_Release/Reset.
+// Not thread-safe: an arena belongs to one request or task at a time.
+typedef struct {
+    uint8_t* base;
+    uint32_t size;
+    uint32_t offset;
+    uint32_t peak;           // High-water mark since init
+    uint32_t alloc_count;
+    uint32_t failed_allocs;
+} MemArena;
+
+// Saved offset for scoped release
+typedef uint32_t MemArenaMark;
+
+bool MemArena_Init(MemArena* arena, void* buffer, uint32_t size);
+void* MemArena_Alloc(MemArena* arena, uint32_t size);
+void* MemArena_Calloc(MemArena* arena, uint32_t count, uint32_t size);
+
+MemArenaMark MemArena_Mark(const MemArena* arena);
+void MemArena_Release(MemArena* arena, MemArenaMark mark);
+void MemArena_Reset(MemArena* arena);
+
+uint32_t MemArena_GetUsed(const MemArena* arena);
+uint32_t MemArena_GetRemaining(const MemArena* arena);
+
+#endif // CANT_MEM_ARENA_H
@@ -2,85 +2,292 @@
 #include "../hardware/timer_hw.h"
 #include <string.h>
 
-static MemBlock blocks[POOL_NUM_BLOCKS] __attribute__((aligned(8)));
-static uint32_t free_blocks = POOL_NUM_BLOCKS;
-static uint32_t peak_usage = 0;
+#define POOL_MAP_WORDS  (POOL_MAX_BLOCKS / 32 + POOL_MAX_CLASSES)
 
-void MemPool_Init(void) {
-    memset(blocks, 0, sizeof(blocks));
-    free_blocks = POOL_NUM_BLOCKS;
-    peak_usage = 0;
+// One 32-bit summary word indexes a class's bitmap words
+_Static_assert(POOL_MAX_BLOCKS <= 32 * 32, "class bitmap exceeds its summary word");
+
+typedef struct {
+    uint8_t* base;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t free_blocks;
+    uint32_t first_block;    // Global index of this class's first block
+    uint32_t* free_map;      // Bit set = block free
+    uint32_t* lease_map;     // Bit set = block leased
+    uint32_t map_words;
+    uint32_t summary;        // Bit w set = free_map[w] has a free block
+} PoolClass;
+
+typedef struct {
+    uint32_t expires;
+    MemPoolLeaseExpired on_expire;
+    void* context;
+} Lease;
+
+static uint8_t arena[POOL_ARENA_SIZE] __attribute__((aligned(8)));
+static uint32_t free_bits[POOL_MAP_WORDS];
+static uint32_t lease_bits[POOL_MAP_WORDS];
+static Lease leases[POOL_MAX_BLOCKS];
+
+static PoolClass classes[POOL_MAX_CLASSES];
+static uint8_t class_count = 0;
+static uint32_t total_blocks = 0;
+static uint32_t free_blocks = 0;
+static MemPoolStats pool_stats;
+
+static const MemPoolClass default_class = { POOL_BLOCK_SIZE, POOL_NUM_BLOCKS };
+
+static PoolClass* find_class(const void* ptr) {
+    const uint8_t* p = (const uint8_t*)ptr;
+    for(uint8_t i = 0; i < class_count; i++) {
+        PoolClass* cls = &classes[i];
+        if(p >= cls->base && p < cls->base + (cls->block_size * cls->block_count)) {
+            return cls;
+        }
+    }
+    return NULL;
 }
 
-void* MemPool_Alloc(void) {
-    static uint32_t last_allocated = 0;
-    uint32_t start = last_allocated;
-    
-    // Try to find next free block starting from last allocation
-    do {
-        if(!blocks[last_allocated].used) {
-            blocks[last_allocated].used = true;
-            blocks[last_allocated].timestamp = TIMER_GetMs();
-            free_blocks--;
-            return blocks[last_allocated].data;
+// Map a pointer to its block index, rejecting foreign and interior pointers
+static bool block_from_ptr(const void* ptr, PoolClass** cls_out, uint32_t* index_out) {
+    PoolClass* cls = find_class(ptr);
+    if(!cls) return false;
+
+    uint32_t offset = (uint32_t)((const uint8_t*)ptr - cls->base);
+    if(offset % cls->block_size) return false;
+
+    *cls_out = cls;
+    *index_out = offset / cls->block_size;
+    return true;
+}
+
+static inline bool block_is_free(const PoolClass* cls, uint32_t index) {
+    return (cls->free_map[index >> 5] >> (index & 31)) & 1u;
+}
+
+static void* take_block(PoolClass* cls, uint32_t* index_out) {
+    if(!cls->summary) return NULL;
+
+    uint32_t word = __builtin_ctz(cls->summary);
+    uint32_t bit = __builtin_ctz(cls->free_map[word]);
+    uint32_t index = (word << 5) | bit;
+
+    cls->free_map[word] &= ~(1u << bit);
+    if(!cls->free_map[word]) {
+        cls->summary &= ~(1u << word);
+    }
+
+    cls->free_blocks--;
+    free_blocks--;
+    pool_stats.alloc_count++;
+
+    uint32_t used = total_blocks - free_blocks;
+    if(used > pool_stats.peak_usage) {
+        pool_stats.peak_usage = used;
+    }
+
+    *index_out = index;
+    return cls->base + (index * cls->block_size);
+}
+
+static void release_block(PoolClass* cls, uint32_t index) {
+    uint32_t word = index >> 5;
+    uint32_t mask = 1u << (index & 31);
+
+    cls->lease_map[word] &= ~mask;
+    cls->free_map[word] |= mask;
+    cls->summary |= (1u << word);
+    cls->free_blocks++;
+    free_blocks++;
+    pool_stats.free_count++;
+}
+
+static PoolClass* class_for_size(uint32_t size) {
+    for(uint8_t i = 0; i < class_count; i++) {
+        if(classes[i].block_size >= size && classes[i].free_blocks > 0) {
+            return &classes[i];
         }
-        last_allocated = (last_allocated + 1) % POOL_NUM_BLOCKS;
-    } while(last_allocated != start);
-    
+    }
     return NULL;
 }
 
-void MemPool_Free(void* ptr) {
-    for(uint32_t i = 0; i < POOL_NUM_BLOCKS; i++) {
-        if(blocks[i].data == ptr) {
-            blocks[i].used = false;
-            free_blocks++;
-            return;
+bool MemPool_InitWithConfig(const MemPoolConfig* config) {
+    if(!config || !config->classes || config->class_count == 0 ||
+       config->class_count > POOL_MAX_CLASSES) {
+        return false;
+    }
+
+    // Validate the whole layout before touching current state
+    uint32_t arena_used = 0;
+    uint32_t block_total = 0;
+    uint32_t words_used = 0;
+    for(uint8_t i = 0; i < config->class_count; i++) {
+        const MemPoolClass* c = &config->classes[i];
+        if(c->block_size == 0 || (c->block_size & 7) ||
+           c->block_count == 0 || c->block_count > POOL_MAX_BLOCKS) {
+            return false;
+        }
+        if(i > 0 && c->block_size <= config->classes[i - 1].block_size) {
+            return false;
+        }
+        arena_used += c->block_size * c->block_count;
+        block_total += c->block_count;
+        words_used += (c->block_count + 31) / 32;
+    }
+    if(arena_used > POOL_ARENA_SIZE || block_total > POOL_MAX_BLOCKS ||
+       words_used > POOL_MAP_WORDS) {
+        return false;
+    }
+
+    memset(classes, 0, sizeof(classes));
+    memset(free_bits, 0, sizeof(free_bits));
+    memset(lease_bits, 0, sizeof(lease_bits));
+    memset(leases, 0, sizeof(leases));
+    memset(&pool_stats, 0, sizeof(pool_stats));
+
+    uint8_t* base = arena;
+    uint32_t first_block = 0;
+    uint32_t word = 0;
+    for(uint8_t i = 0; i < config->class_count; i++) {
+        PoolClass* cls = &classes[i];
+        cls->base = base;
+        cls->block_size = config->classes[i].block_size;
+        cls->block_count = config->classes[i].block_count;
+        cls->free_blocks = cls->block_count;
+        cls->first_block = first_block;
+        cls->free_map = &free_bits[word];
+        cls->lease_map = &lease_bits[word];
+        cls->map_words = (cls->block_count + 31) / 32;
+
+        // Mark every block free; the last word may be partial
+        for(uint32_t w = 0; w < cls->map_words; w++) {
+            uint32_t bits_left = cls->block_count - (w * 32);
+            cls->free_map[w] = (bits_left >= 32) ? 0xFFFFFFFFu : ((1u << bits_left) - 1);
+            cls->summary |= (1u << w);
         }
+
+        base += cls->block_size * cls->block_count;
+        first_block += cls->block_count;
+        word += cls->map_words;
     }
+
+    class_count = config->class_count;
+    total_blocks = block_total;
+    free_blocks = block_total;
+    return true;
 }
 
-uint32_t MemPool_GetFreeBlocks(void) {
-    return free_blocks;
+void MemPool_Init(void) {
+    MemPoolConfig config = { &default_class, 1 };
+    MemPool_InitWithConfig(&config);
 }
 
-void MemPool_GarbageCollect(void) {
-    uint32_t current_time = TIMER_GetMs();
-    uint32_t freed = 0;
-    
-    for(uint32_t i = 0; i < POOL_NUM_BLOCKS; i++) {
-        if(blocks[i].used) {
-            if(current_time - blocks[i].timestamp > 5000) {
-                blocks[i].used = false;
-                free_blocks++;
-                freed++;
-            }
-        }
+void* MemPool_AllocSize(uint32_t size) {
+    uint32_t index;
+    PoolClass* cls = class_for_size(size);
+    void* block = cls ? take_block(cls, &index) : NULL;
+    if(!block) {
+        pool_stats.failed_allocs++;
     }
-    
-    if(freed > 0) {
-        // Compact blocks if significant memory was freed
-        compact_blocks();
+    return block;
+}
+
+void* MemPool_Alloc(void) {
+    return MemPool_AllocSize(POOL_BLOCK_SIZE);
+}
+
+void MemPool_Free(void* ptr) {
+    PoolClass* cls;
+    uint32_t index;
+
+    if(!ptr || !block_from_ptr(ptr, &cls, &index) || block_is_free(cls, index)) {
+        pool_stats.invalid_frees += (ptr != NULL);
+        return;
+    }
+
+    release_block(cls, index);
+}
+
+void* MemPool_AllocLeased(uint32_t size, uint32_t lease_ms,
+                          MemPoolLeaseExpired on_expire, void* context) {
+    uint32_t index;
+    PoolClass* cls = class_for_size(size);
+    void* block = cls ? take_block(cls, &index) : NULL;
+    if(!block) {
+        pool_stats.failed_allocs++;
+        return NULL;
     }
+
+    Lease* lease = &leases[cls->first_block + index];
+    lease->expires = TIMER_GetMs() + lease_ms;
+    lease->on_expire = on_expire;
+    lease->context = context;
+    cls->lease_map[index >> 5] |= (1u << (index & 31));
+
+    return block;
+}
+
+bool MemPool_RenewLease(void* ptr, uint32_t lease_ms) {
+    PoolClass* cls;
+    uint32_t index;
+
+    if(!ptr || !block_from_ptr(ptr, &cls, &index)) return false;
+    if(!((cls->lease_map[index >> 5] >> (index & 31)) & 1u)) return false;
+
+    leases[cls->first_block + index].expires = TIMER_GetMs() + lease_ms;
+    return true;
 }
 
-static void compact_blocks(void) {
-    uint32_t dest = 0;
-    uint32_t src = 0;
-    
-    while(src < POOL_NUM_BLOCKS) {
-        if(blocks[src].used) {
-            if(src != dest) {
-                memcpy(blocks[dest].data, blocks[src].data, POOL_BLOCK_SIZE);
-                blocks[dest].used = true;
-                blocks[dest].timestamp = blocks[src].timestamp;
-                blocks[src].used = false;
+// Reclaim leased blocks whose lease has run out. Unlike the old garbage
+// collector this never touches unleased blocks and never moves live data;
+// each owner is told through its callback before its block is reused.
+uint32_t MemPool_ExpireLeases(void) {
+    uint32_t now = TIMER_GetMs();
+    uint32_t reclaimed = 0;
+
+    for(uint8_t i = 0; i < class_count; i++) {
+        PoolClass* cls = &classes[i];
+        for(uint32_t w = 0; w < cls->map_words; w++) {
+            uint32_t pending = cls->lease_map[w];
+            while(pending) {
+                uint32_t bit = __builtin_ctz(pending);
+                pending &= pending - 1;
+
+                // An earlier callback may have freed or re-leased this block
+                if(!((cls->lease_map[w] >> bit) & 1u)) continue;
+
+                uint32_t index = (w << 5) | bit;
+                Lease* lease = &leases[cls->first_block + index];
+                if((int32_t)(now - lease->expires) < 0) continue;
+
+                void* block = cls->base + (index * cls->block_size);
+                if(lease->on_expire) {
+                    lease->on_expire(block, lease->context);
+                }
+
+                // The callback may already have freed the block
+                if(!block_is_free(cls, index)) {
+                    release_block(cls, index);
+                }
+                pool_stats.leases_expired++;
+                reclaimed++;
             }
-            dest++;
         }
-        src++;
     }
+
+    return reclaimed;
+}
+
+uint32_t MemPool_GetFreeBlocks(void) {
+    return free_blocks;
+}
+
+uint32_t MemPool_GetTotalBlocks(void) {
+    return total_blocks;
 }
 
-static uint32_t alloc_count = 0;
-static uint32_t free_count = 0; 
\ No newline at end of file
+void MemPool_GetStats(MemPoolStats* stats) {
+    if(!stats) return;
+    memcpy(stats, &pool_stats, sizeof(MemPoolStats));
+}
\ No newline at end of file
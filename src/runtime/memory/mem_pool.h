@@ -4,18 +4,53 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Default configuration used by MemPool_Init(): one 64-byte class
 #define POOL_BLOCK_SIZE 64
 #define POOL_NUM_BLOCKS 32
 
+// Limits for MemPool_InitWithConfig()
+#define POOL_MAX_CLASSES       8
+#define POOL_MAX_BLOCKS        256     // Total blocks across all classes
+#define POOL_ARENA_SIZE        (32 * 1024)
+
+typedef struct {
+    uint32_t block_size;     // Bytes, multiple of 8
+    uint32_t block_count;
+} MemPoolClass;
+
 typedef struct {
-    uint8_t data[POOL_BLOCK_SIZE];
-    bool used;
-    uint32_t timestamp;
-} MemBlock;
+    const MemPoolClass* classes;  // Sorted by ascending block_size
+    uint8_t class_count;
+} MemPoolConfig;
+
+// Invoked before a leased block is reclaimed; the owner must drop the pointer
+// and must not allocate from the pool inside the callback
+typedef void (*MemPoolLeaseExpired)(void* block, void* context);
+
+typedef struct {
+    uint32_t alloc_count;
+    uint32_t free_count;
+    uint32_t failed_allocs;
+    uint32_t invalid_frees;
+    uint32_t leases_expired;
+    uint32_t peak_usage;
+} MemPoolStats;
 
 void MemPool_Init(void);
+bool MemPool_InitWithConfig(const MemPoolConfig* config);
+
 void* MemPool_Alloc(void);
+void* MemPool_AllocSize(uint32_t size);
 void MemPool_Free(void* ptr);
+
+// Leased blocks are the only ones MemPool_ExpireLeases() may reclaim
+void* MemPool_AllocLeased(uint32_t size, uint32_t lease_ms,
+                          MemPoolLeaseExpired on_expire, void* context);
+bool MemPool_RenewLease(void* ptr, uint32_t lease_ms);
+uint32_t MemPool_ExpireLeases(void);
+
 uint32_t MemPool_GetFreeBlocks(void);
+uint32_t MemPool_GetTotalBlocks(void);
+void MemPool_GetStats(MemPoolStats* stats);
 
-#endif 
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -1,18 +1,55 @@
 #include "memory_manager.h"
 #include "../diagnostic/logging/diag_logger.h"
 #include "../diagnostic/os/critical.h"
+#include "../diagnostic/os/timer.h"
+#include "heap_profiler.h"
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define GUARD_PATTERN     0xDEADBEEF
 #define ALIGNMENT_MASK    (~(sizeof(void*) - 1))
-#define MIN_BLOCK_SIZE    (sizeof(MemBlock) + sizeof(MemFooter))
-#define BLOCK_OVERHEAD    (sizeof(MemBlock) + sizeof(MemFooter))
+#define FOOTER_SIZE       ((sizeof(MemFooter) + sizeof(void*) - 1) & ALIGNMENT_MASK)
+#define MIN_BLOCK_SIZE    (sizeof(MemBlock) + FOOTER_SIZE)
+#define BLOCK_OVERHEAD    (sizeof(MemBlock) + FOOTER_SIZE)
 #define MAX_POOLS         16
 #define POOL_MIN_BLOCKS   8
+#define HUGE_PAGE_DEFAULT (2u * 1024 * 1024)
+#define COMPACT_DEFAULT_BUDGET  4096
+#define COMPACT_SCAN_LIMIT      256    // Blocks visited per Memory_Compact call
+#define SCAN_TIME_CHECK_MASK    7      // Read the clock every 8 blocks
+
+// TLSF index: 16 second-level lists per power of two, 8-byte granularity
+#define TLSF_SL_LOG2      4
+#define TLSF_SL_COUNT     (1u << TLSF_SL_LOG2)
+#define TLSF_ALIGN_LOG2   3
+#define TLSF_ALIGN        (1u << TLSF_ALIGN_LOG2)
+#define TLSF_FL_SHIFT     (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_SMALL_BLOCK  (1u << TLSF_FL_SHIFT)
+#define TLSF_FL_COUNT     (32 - TLSF_FL_SHIFT + 1)
+
+// Free-list links live in the payload of free heap blocks
+typedef struct {
+    MemBlock* next_free;
+    MemBlock* prev_free;
+} TlsfLinks;
+
+#define MIN_SPLIT_SIZE    ((uint32_t)sizeof(TlsfLinks))
+
+typedef struct {
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[TLSF_FL_COUNT];
+    MemBlock* free_lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+} TlsfIndex;
 
 typedef struct MemoryPool {
-    uint8_t* pool_memory;
+    uint8_t* pool_memory;    // Blocks, then free_list and block_used
+    size_t mapped_size;
     uint32_t block_size;
     uint32_t block_count;
     uint32_t free_blocks;
@@ -20,19 +57,153 @@ typedef struct MemoryPool {
     bool* block_used;
 } MemoryPool;
 
+typedef struct {
+    MemBlock* block;         // NULL while the slot is free
+    uint16_t generation;     // Bumped on free so stale handles are rejected
+    uint16_t pins;
+    uint32_t next_free;
+} HandleSlot;
+
 typedef struct {
     MemConfig config;
     uint8_t* heap_memory;
+    size_t heap_mapped_size;
     MemBlock* first_block;
     MemBlock* last_block;
     MemoryPool pools[MAX_POOLS];
     uint32_t pool_count;
+    TlsfIndex tlsf;
+    HandleSlot* handles;
+    size_t handles_mapped_size;
+    uint32_t handle_free_head;   // Slot index + 1, 0 when exhausted
+    uint32_t heap_epoch;         // Bumped whenever a block header disappears
+    MemBlock* compact_cursor;
+    uint32_t compact_epoch;
+    struct {
+        bool in_pass;
+        MemBlock* block;         // Next heap block; kept valid across merges and moves
+        uint32_t pool;           // Pool position once the heap walk is done
+        uint32_t pool_block;
+        uint32_t heap_bytes;     // Heap start up to the cursor
+        uint32_t pass_us;
+        MemScanStats stats;
+    } scan;
     MemStats stats;
     bool initialized;
 } MemoryManager;
 
 static MemoryManager mem_mgr;
 
+// Monotonic across Init/Deinit and independent of enable_stats
+static uint32_t alloc_events;
+
+static inline bool use_tlsf(void) {
+    return mem_mgr.config.heap_strategy == MEM_ALLOC_TLSF;
+}
+
+static inline TlsfLinks* tlsf_links(MemBlock* block) {
+    return (TlsfLinks*)(block + 1);
+}
+
+static void tlsf_mapping(uint32_t size, uint32_t* fl, uint32_t* sl) {
+    if (size < TLSF_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT);
+    } else {
+        uint32_t msb = 31 - __builtin_clz(size);
+        *sl = (size >> (msb - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = msb - (TLSF_FL_SHIFT - 1);
+    }
+}
+
+static void tlsf_insert(MemBlock* block) {
+    uint32_t fl, sl;
+    tlsf_mapping(block->size, &fl, &sl);
+
+    TlsfLinks* links = tlsf_links(block);
+    links->prev_free = NULL;
+    links->next_free = mem_mgr.tlsf.free_lists[fl][sl];
+    if (links->next_free) {
+        tlsf_links(links->next_free)->prev_free = block;
+    }
+
+    mem_mgr.tlsf.free_lists[fl][sl] = block;
+    mem_mgr.tlsf.fl_bitmap |= (1u << fl);
+    mem_mgr.tlsf.sl_bitmap[fl] |= (1u << sl);
+}
+
+static void tlsf_remove(MemBlock* block) {
+    uint32_t fl, sl;
+    tlsf_mapping(block->size, &fl, &sl);
+
+    TlsfLinks* links = tlsf_links(block);
+    if (links->prev_free) {
+        tlsf_links(links->prev_free)->next_free = links->next_free;
+    } else {
+        mem_mgr.tlsf.free_lists[fl][sl] = links->next_free;
+    }
+    if (links->next_free) {
+        tlsf_links(links->next_free)->prev_free = links->prev_free;
+    }
+
+    if (!mem_mgr.tlsf.free_lists[fl][sl]) {
+        mem_mgr.tlsf.sl_bitmap[fl] &= ~(1u << sl);
+        if (!mem_mgr.tlsf.sl_bitmap[fl]) {
+            mem_mgr.tlsf.fl_bitmap &= ~(1u << fl);
+        }
+    }
+}
+
+// Find a free block of at least size bytes in constant time. The request is
+// rounded up to the next list boundary so any block in that list fits.
+static MemBlock* tlsf_find(uint32_t size) {
+    size = (size + TLSF_ALIGN - 1) & ~(TLSF_ALIGN - 1);
+    if (size >= TLSF_SMALL_BLOCK) {
+        uint32_t round = (1u << (31 - __builtin_clz(size) - TLSF_SL_LOG2)) - 1;
+        if (size > UINT32_MAX - round) {
+            return NULL;
+        }
+        size += round;
+    }
+
+    uint32_t fl, sl;
+    tlsf_mapping(size, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT) {
+        return NULL;
+    }
+
+    uint32_t sl_map = mem_mgr.tlsf.sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        uint32_t fl_map = (fl + 1 < 32) ? (mem_mgr.tlsf.fl_bitmap & (~0u << (fl + 1))) : 0;
+        if (!fl_map) {
+            return NULL;
+        }
+        fl = __builtin_ctz(fl_map);
+        sl_map = mem_mgr.tlsf.sl_bitmap[fl];
+    }
+
+    return mem_mgr.tlsf.free_lists[fl][__builtin_ctz(sl_map)];
+}
+
+// Absorb the physically following block. Callers unlink indexed free
+// blocks from the TLSF lists before their size changes.
+static void merge_with_next(MemBlock* block) {
+    MemBlock* next = block->next;
+    mem_mgr.heap_epoch++;
+    if (mem_mgr.scan.block == next) {
+        // Back onto a block already counted; it is counted again merged
+        mem_mgr.scan.heap_bytes -= block->size + BLOCK_OVERHEAD;
+        mem_mgr.scan.block = block;
+    }
+    block->size += next->size + BLOCK_OVERHEAD;
+    block->next = next->next;
+    if (block->next) {
+        block->next->prev = block;
+    } else {
+        mem_mgr.last_block = block;
+    }
+}
+
 static bool is_valid_block(const MemBlock* block) {
     if (!block) return false;
     if (block < (MemBlock*)mem_mgr.heap_memory) return false;
@@ -46,8 +217,9 @@ static void setup_block_guards(MemBlock* block) {
     if (!mem_mgr.config.enable_guards || !block) return;
     
     block->guard_front = GUARD_PATTERN;
-    MemFooter* footer = (MemFooter*)((uint8_t*)(block + 1) + block->size);
-    footer->guard_back = GUARD_PATTERN;
+    // Pool blocks keep the requested size, so the footer may be unaligned
+    MemFooter footer = { .guard_back = GUARD_PATTERN };
+    memcpy((uint8_t*)(block + 1) + block->size, &footer, sizeof(footer));
 }
 
 static bool check_block_guards(const MemBlock* block) {
@@ -58,8 +230,9 @@ static bool check_block_guards(const MemBlock* block) {
         return false;
     }
     
-    const MemFooter* footer = (const MemFooter*)((const uint8_t*)(block + 1) + block->size);
-    if (footer->guard_back != GUARD_PATTERN) {
+    MemFooter footer;
+    memcpy(&footer, (const uint8_t*)(block + 1) + block->size, sizeof(footer));
+    if (footer.guard_back != GUARD_PATTERN) {
         Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Back guard corrupted at %p", block);
         return false;
     }
@@ -67,6 +240,24 @@ static bool check_block_guards(const MemBlock* block) {
     return true;
 }
 
+// Validate one heap block and its links; returns what is wrong or NULL
+static const char* check_heap_block(const MemBlock* block) {
+    if (!is_valid_block(block)) {
+        return "Invalid block";
+    }
+    if (mem_mgr.config.enable_guards && (block->flags & MEM_BLOCK_USED) && !check_block_guards(block)) {
+        return "Guard check failed";
+    }
+    if (block->next) {
+        if (block->next->prev != block) {
+            return "Broken linked list";
+        }
+    } else if (block != mem_mgr.last_block) {
+        return "Last block mismatch";
+    }
+    return NULL;
+}
+
 static MemoryPool* find_suitable_pool(uint32_t size) {
     for (uint32_t i = 0; i < mem_mgr.pool_count; i++) {
         if (mem_mgr.pools[i].block_size >= size && mem_mgr.pools[i].free_blocks > 0) {
@@ -76,7 +267,7 @@ static MemoryPool* find_suitable_pool(uint32_t size) {
     return NULL;
 }
 
-static void* allocate_from_pool(MemoryPool* pool, const char* file, uint32_t line) {
+static void* allocate_from_pool(MemoryPool* pool, uint32_t size, const char* file, uint32_t line) {
     if (!pool->free_blocks) return NULL;
     
     uint32_t block_index = pool->free_list[--pool->free_blocks];
@@ -84,10 +275,13 @@ static void* allocate_from_pool(MemoryPool* pool, const char* file, uint32_t lin
     
     void* ptr = pool->pool_memory + (block_index * pool->block_size);
     MemBlock* block = (MemBlock*)ptr;
-    block->size = pool->block_size - BLOCK_OVERHEAD;
+    // Requested size, so the back guard sits right after the caller's bytes
+    // and frees balance the usage added at allocation
+    block->size = size;
     block->flags = MEM_BLOCK_POOL | MEM_BLOCK_USED;
     block->file = file;
     block->line = line;
+    block->handle = 0;
     setup_block_guards(block);
     
     return block + 1;
@@ -127,14 +321,15 @@ static MemBlock* find_best_fit(uint32_t size) {
 }
 
 static void split_block(MemBlock* block, uint32_t size) {
+    if (block->size < size + BLOCK_OVERHEAD + MIN_SPLIT_SIZE) return;
     uint32_t remaining = block->size - size - BLOCK_OVERHEAD;
-    if (remaining < MIN_BLOCK_SIZE) return;
     
-    MemBlock* new_block = (MemBlock*)((uint8_t*)(block + 1) + size + sizeof(MemFooter));
-    new_block->size = remaining - BLOCK_OVERHEAD;
+    MemBlock* new_block = (MemBlock*)((uint8_t*)(block + 1) + size + FOOTER_SIZE);
+    new_block->size = remaining;
     new_block->flags = MEM_BLOCK_FREE;
     new_block->file = NULL;
     new_block->line = 0;
+    new_block->handle = 0;
     new_block->next = block->next;
     new_block->prev = block;
     
@@ -146,6 +341,273 @@ static void split_block(MemBlock* block, uint32_t size) {
     
     block->next = new_block;
     block->size = size;
+    
+    if (use_tlsf()) {
+        // Keep free blocks coalesced so the index never holds neighbours
+        if (new_block->next && !(new_block->next->flags & MEM_BLOCK_USED)) {
+            tlsf_remove(new_block->next);
+            merge_with_next(new_block);
+        }
+        tlsf_insert(new_block);
+    }
+}
+
+// Refresh guards and usage after a block changed size without moving
+static void resize_in_place(MemBlock* block, uint32_t old_size) {
+    setup_block_guards(block);
+    if (mem_mgr.config.enable_stats) {
+        mem_mgr.stats.current_usage += block->size - old_size;
+        if (block->size > old_size) {
+            mem_mgr.stats.total_allocated += block->size - old_size;
+        }
+        mem_mgr.stats.peak_usage = (mem_mgr.stats.current_usage > mem_mgr.stats.peak_usage) ? 
+                                   mem_mgr.stats.current_usage : mem_mgr.stats.peak_usage;
+    }
+}
+
+// Round a heap request to the allocator's granularity
+static uint32_t normalize_size(uint32_t size) {
+    if (use_tlsf()) {
+        size = (size + TLSF_ALIGN - 1) & ~(TLSF_ALIGN - 1);
+        return (size < MIN_SPLIT_SIZE) ? MIN_SPLIT_SIZE : size;
+    }
+    return (size + sizeof(void*) - 1) & ALIGNMENT_MASK;
+}
+
+#ifdef __linux__
+// Reads "<key> <n> kB" from a /proc file. With a non-zero address only the
+// smaps entry of the mapping containing it is searched.
+static size_t read_proc_kb(const char* path, const char* key, uintptr_t address) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return 0;
+    }
+
+    char line[256];
+    size_t key_len = strlen(key);
+    size_t value = 0;
+    bool in_range = (address == 0);
+
+    while (fgets(line, sizeof(line), file)) {
+        unsigned long start, end;
+        if (address && sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            if (in_range) {
+                break;  // Past the mapping we wanted
+            }
+            in_range = (address >= start && address < end);
+            continue;
+        }
+        if (in_range && strncmp(line, key, key_len) == 0) {
+            value = strtoul(line + key_len, NULL, 10) * 1024;
+            break;
+        }
+    }
+
+    fclose(file);
+    return value;
+}
+
+static size_t huge_page_size(void) {
+    size_t size = read_proc_kb("/proc/meminfo", "Hugepagesize:", 0);
+    return size ? size : HUGE_PAGE_DEFAULT;
+}
+
+// Maps a region aligned to huge_size so transparent huge pages can back it
+static void* map_thp_aligned(size_t size, size_t huge_size) {
+    size_t span = size + huge_size;
+    uint8_t* raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+
+    uint8_t* aligned = (uint8_t*)(((uintptr_t)raw + huge_size - 1) & ~(uintptr_t)(huge_size - 1));
+    if (aligned > raw) {
+        munmap(raw, aligned - raw);
+    }
+    munmap(aligned + size, (raw + span) - (aligned + size));
+
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+#endif
+
+// Allocates the heap or a pool region. In locked mode the region is mapped
+// with huge pages where possible (explicit hugetlb first, then THP), every
+// page is touched up front and the range is mlocked, so RT paths never take
+// a first-touch fault. Reports the page size that actually backs the region.
+static void* backing_alloc(size_t size, size_t* mapped_size, uint32_t* page_size) {
+    *mapped_size = size;
+    *page_size = 0;
+
+    if (mem_mgr.config.backing != MEM_BACKING_LOCKED) {
+        return malloc(size);
+    }
+
+#ifdef __linux__
+    size_t base_page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t huge_size = huge_page_size();
+    uint8_t* ptr = NULL;
+
+    if (size >= huge_size) {
+        size_t huge_len = (size + huge_size - 1) & ~(huge_size - 1);
+#ifdef MAP_HUGETLB
+        void* map = mmap(NULL, huge_len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (map != MAP_FAILED) {
+            ptr = map;
+            *page_size = (uint32_t)huge_size;
+        }
+#endif
+        if (!ptr) {
+            ptr = map_thp_aligned(huge_len, huge_size);
+        }
+        *mapped_size = huge_len;
+    } else {
+        *mapped_size = (size + base_page - 1) & ~(base_page - 1);
+        void* map = mmap(NULL, *mapped_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ptr = (map != MAP_FAILED) ? map : NULL;
+    }
+
+    if (!ptr) {
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "mmap of %zu bytes failed", *mapped_size);
+        return NULL;
+    }
+
+    // Prefault: one write per base page forces the kernel to back the range now
+    for (size_t offset = 0; offset < *mapped_size; offset += base_page) {
+        ((volatile uint8_t*)ptr)[offset] = 0;
+    }
+
+    if (mlock(ptr, *mapped_size) != 0) {
+        mem_mgr.stats.pages_locked = false;
+        Logger_Log(LOG_LEVEL_WARNING, "MEMORY", "mlock of %zu bytes failed, check RLIMIT_MEMLOCK",
+                   *mapped_size);
+    }
+
+    if (*page_size == 0) {
+        // THP is best effort; ask the kernel what it actually gave us
+        size_t thp_bytes = read_proc_kb("/proc/self/smaps", "AnonHugePages:", (uintptr_t)ptr);
+        *page_size = (uint32_t)((thp_bytes * 2 >= *mapped_size) ? huge_size : base_page);
+    }
+    return ptr;
+#else
+    Logger_Log(LOG_LEVEL_WARNING, "MEMORY", "Locked backing not supported, using malloc");
+    mem_mgr.stats.pages_locked = false;
+    return malloc(size);
+#endif
+}
+
+static void backing_free(void* ptr, size_t mapped_size) {
+    if (!ptr) {
+        return;
+    }
+
+#ifdef __linux__
+    if (mem_mgr.config.backing == MEM_BACKING_LOCKED) {
+        munmap(ptr, mapped_size);
+        return;
+    }
+#endif
+    (void)mapped_size;
+    free(ptr);
+}
+
+static void report_leak(const MemBlock* block) {
+    Logger_Log(LOG_LEVEL_WARNING, "MEMORY", 
+              "Memory leak: %u bytes at %p (allocated in %s:%u)",
+              block->size, (const void*)(block + 1), block->file, block->line);
+}
+
+// Heap path of Memory_Alloc; caller holds the critical section
+static MemBlock* heap_alloc_locked(uint32_t size, const char* file, uint32_t line) {
+    // Align size to allocator granularity
+    size = normalize_size(size);
+    
+    // Find a fitting block: TLSF index lookup or best-fit list walk
+    MemBlock* block = use_tlsf() ? tlsf_find(size) : find_best_fit(size);
+    if (!block) {
+        return NULL;
+    }
+    
+    if (use_tlsf()) {
+        tlsf_remove(block);
+    }
+    
+    // Split block if possible
+    split_block(block, size);
+    
+    // Setup block
+    block->flags = MEM_BLOCK_USED;
+    block->file = file;
+    block->line = line;
+    block->handle = 0;
+    setup_block_guards(block);
+    
+    if (HeapProfiler_OnAlloc(block + 1, block->size, file, line)) {
+        block->flags |= MEM_BLOCK_SAMPLED;
+    }
+    alloc_events++;
+    
+    // Update statistics with the block's real size so frees balance out
+    if (mem_mgr.config.enable_stats) {
+        mem_mgr.stats.total_allocated += block->size;
+        mem_mgr.stats.current_usage += block->size;
+        mem_mgr.stats.allocation_count++;
+        mem_mgr.stats.heap_allocations++;
+        mem_mgr.stats.peak_usage = (mem_mgr.stats.current_usage > mem_mgr.stats.peak_usage) ? 
+                                   mem_mgr.stats.current_usage : mem_mgr.stats.peak_usage;
+    }
+    
+    return block;
+}
+
+// Return a validated heap block to the free lists, coalescing neighbours
+static void heap_free_locked(MemBlock* block) {
+    void* ptr = block + 1;
+    
+    // Update statistics
+    if (mem_mgr.config.enable_stats) {
+        mem_mgr.stats.total_freed += block->size;
+        mem_mgr.stats.current_usage -= block->size;
+        mem_mgr.stats.free_count++;
+    }
+    
+    if (block->flags & MEM_BLOCK_SAMPLED) {
+        HeapProfiler_OnFree(ptr);
+    }
+    
+    // Clear block data (skipped for TLSF to keep free time bounded)
+    if (!use_tlsf()) {
+        memset(ptr, 0, block->size);
+    }
+    block->flags = MEM_BLOCK_FREE;
+    block->file = NULL;
+    block->line = 0;
+    block->handle = 0;
+    
+    // Merge with next block if free
+    if (block->next && !(block->next->flags & MEM_BLOCK_USED)) {
+        if (use_tlsf()) {
+            tlsf_remove(block->next);
+        }
+        merge_with_next(block);
+    }
+    
+    // Merge with previous block if free
+    if (block->prev && !(block->prev->flags & MEM_BLOCK_USED)) {
+        block = block->prev;
+        if (use_tlsf()) {
+            tlsf_remove(block);
+        }
+        merge_with_next(block);
+    }
+    
+    if (use_tlsf()) {
+        tlsf_insert(block);
+    }
 }
 
 bool Memory_Init(const MemConfig* config) {
@@ -157,43 +619,71 @@ bool Memory_Init(const MemConfig* config) {
     memset(&mem_mgr, 0, sizeof(MemoryManager));
     memcpy(&mem_mgr.config, config, sizeof(MemConfig));
     
-    // Allocate heap memory
-    mem_mgr.heap_memory = (uint8_t*)malloc(config->heap_size);
+    // Allocate heap memory; pages_locked is cleared by any region that fails mlock
+    mem_mgr.stats.pages_locked = (config->backing == MEM_BACKING_LOCKED);
+    mem_mgr.heap_memory = (uint8_t*)backing_alloc(config->heap_size, &mem_mgr.heap_mapped_size,
+                                                  &mem_mgr.stats.page_size);
     if (!mem_mgr.heap_memory) {
         Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Failed to allocate heap");
+        memset(&mem_mgr, 0, sizeof(MemoryManager));
         return false;
     }
     
     // Initialize first block
     mem_mgr.first_block = (MemBlock*)mem_mgr.heap_memory;
-    mem_mgr.first_block->size = config->heap_size - BLOCK_OVERHEAD;
+    mem_mgr.first_block->size = (config->heap_size - BLOCK_OVERHEAD) & ALIGNMENT_MASK;
     mem_mgr.first_block->flags = MEM_BLOCK_FREE;
+    mem_mgr.first_block->handle = 0;
     mem_mgr.first_block->next = NULL;
     mem_mgr.first_block->prev = NULL;
     mem_mgr.last_block = mem_mgr.first_block;
     
+    if (use_tlsf()) {
+        tlsf_insert(mem_mgr.first_block);
+    }
+    
+    // Handle table; free slots are chained through next_free
+    if (config->max_handles > 0) {
+        uint32_t count = (config->max_handles < MEM_MAX_HANDLES) ? config->max_handles : MEM_MAX_HANDLES;
+        uint32_t page_size;
+        mem_mgr.handles = (HandleSlot*)backing_alloc(count * sizeof(HandleSlot),
+                                                     &mem_mgr.handles_mapped_size, &page_size);
+        if (!mem_mgr.handles) {
+            Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Failed to allocate handle table");
+            backing_free(mem_mgr.heap_memory, mem_mgr.heap_mapped_size);
+            memset(&mem_mgr, 0, sizeof(MemoryManager));
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            mem_mgr.handles[i].block = NULL;
+            mem_mgr.handles[i].generation = 1;
+            mem_mgr.handles[i].pins = 0;
+            mem_mgr.handles[i].next_free = (i + 1 < count) ? i + 2 : 0;
+        }
+        mem_mgr.config.max_handles = count;
+        mem_mgr.handle_free_head = 1;
+    }
+    
     // Initialize memory pools if configured
     if (config->pool_sizes && config->pool_counts) {
         for (uint32_t i = 0; i < config->pool_count && i < MAX_POOLS; i++) {
             MemoryPool* pool = &mem_mgr.pools[mem_mgr.pool_count];
             uint32_t total_size = config->pool_sizes[i] * config->pool_counts[i];
             
-            pool->pool_memory = (uint8_t*)malloc(total_size);
+            // Blocks and bookkeeping share one region so both are prefaulted together
+            size_t blocks_size = ((size_t)total_size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+            size_t region_size = blocks_size + config->pool_counts[i] * (sizeof(uint32_t) + sizeof(bool));
+            uint32_t page_size;
+            
+            pool->pool_memory = (uint8_t*)backing_alloc(region_size, &pool->mapped_size, &page_size);
             if (!pool->pool_memory) continue;
             
             pool->block_size = config->pool_sizes[i];
             pool->block_count = config->pool_counts[i];
             pool->free_blocks = pool->block_count;
             
-            pool->free_list = (uint32_t*)malloc(pool->block_count * sizeof(uint32_t));
-            pool->block_used = (bool*)malloc(pool->block_count * sizeof(bool));
-            
-            if (!pool->free_list || !pool->block_used) {
-                free(pool->pool_memory);
-                free(pool->free_list);
-                free(pool->block_used);
-                continue;
-            }
+            pool->free_list = (uint32_t*)(pool->pool_memory + blocks_size);
+            pool->block_used = (bool*)(pool->free_list + pool->block_count);
             
             // Initialize free list
             for (uint32_t j = 0; j < pool->block_count; j++) {
@@ -206,13 +696,17 @@ bool Memory_Init(const MemConfig* config) {
     }
     
     mem_mgr.initialized = true;
-    Logger_Log(LOG_LEVEL_INFO, "MEMORY", "Memory manager initialized with %u bytes heap", 
-               config->heap_size);
+    Logger_Log(LOG_LEVEL_INFO, "MEMORY", "Memory manager initialized with %u bytes %s heap", 
+               config->heap_size, use_tlsf() ? "TLSF" : "best-fit");
+    if (config->backing == MEM_BACKING_LOCKED) {
+        Logger_Log(LOG_LEVEL_INFO, "MEMORY", "Heap backed by %u byte pages, %s",
+                   mem_mgr.stats.page_size, mem_mgr.stats.pages_locked ? "locked" : "not locked");
+    }
     return true;
 } 
 
 void* Memory_Alloc(uint32_t size, const char* file, uint32_t line) {
-    if (!mem_mgr.initialized || size == 0) {
+    if (!mem_mgr.initialized || size == 0 || size > mem_mgr.config.heap_size) {
         Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Invalid allocation request");
         return NULL;
     }
@@ -222,8 +716,12 @@ void* Memory_Alloc(uint32_t size, const char* file, uint32_t line) {
     // Try pool allocation first for small sizes
     MemoryPool* pool = find_suitable_pool(size + BLOCK_OVERHEAD);
     if (pool) {
-        void* ptr = allocate_from_pool(pool, file, line);
+        void* ptr = allocate_from_pool(pool, size, file, line);
         if (ptr) {
+            if (HeapProfiler_OnAlloc(ptr, size, file, line)) {
+                (((MemBlock*)ptr) - 1)->flags |= MEM_BLOCK_SAMPLED;
+            }
+            alloc_events++;
             if (mem_mgr.config.enable_stats) {
                 mem_mgr.stats.total_allocated += size;
                 mem_mgr.stats.current_usage += size;
@@ -237,39 +735,14 @@ void* Memory_Alloc(uint32_t size, const char* file, uint32_t line) {
         }
     }
     
-    // Align size to word boundary
-    size = (size + sizeof(void*) - 1) & ALIGNMENT_MASK;
+    MemBlock* block = heap_alloc_locked(size, file, line);
+    exit_critical();
     
-    // Find best fitting block
-    MemBlock* block = find_best_fit(size);
     if (!block) {
-        exit_critical();
         Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "No suitable block found for size %u", size);
         return NULL;
     }
-    
-    // Split block if possible
-    split_block(block, size);
-    
-    // Setup block
-    block->flags = MEM_BLOCK_USED;
-    block->file = file;
-    block->line = line;
-    setup_block_guards(block);
-    
-    // Update statistics
-    if (mem_mgr.config.enable_stats) {
-        mem_mgr.stats.total_allocated += size;
-        mem_mgr.stats.current_usage += size;
-        mem_mgr.stats.allocation_count++;
-        mem_mgr.stats.heap_allocations++;
-        mem_mgr.stats.peak_usage = (mem_mgr.stats.current_usage > mem_mgr.stats.peak_usage) ? 
-                                   mem_mgr.stats.current_usage : mem_mgr.stats.peak_usage;
-    }
-    
-    void* ptr = block + 1;
-    exit_critical();
-    return ptr;
+    return block + 1;
 }
 
 void Memory_Free(void* ptr) {
@@ -285,6 +758,10 @@ void Memory_Free(void* ptr) {
     if (block->flags & MEM_BLOCK_POOL) {
         for (uint32_t i = 0; i < mem_mgr.pool_count; i++) {
             if (free_to_pool(&mem_mgr.pools[i], ptr)) {
+                if (block->flags & MEM_BLOCK_SAMPLED) {
+                    HeapProfiler_OnFree(ptr);
+                    block->flags &= ~MEM_BLOCK_SAMPLED;
+                }
                 if (mem_mgr.config.enable_stats) {
                     mem_mgr.stats.total_freed += block->size;
                     mem_mgr.stats.current_usage -= block->size;
@@ -314,41 +791,13 @@ void Memory_Free(void* ptr) {
         return;
     }
     
-    // Update statistics
-    if (mem_mgr.config.enable_stats) {
-        mem_mgr.stats.total_freed += block->size;
-        mem_mgr.stats.current_usage -= block->size;
-        mem_mgr.stats.free_count++;
-    }
-    
-    // Clear block data
-    memset(ptr, 0, block->size);
-    block->flags = MEM_BLOCK_FREE;
-    block->file = NULL;
-    block->line = 0;
-    
-    // Merge with next block if free
-    if (block->next && !(block->next->flags & MEM_BLOCK_USED)) {
-        block->size += block->next->size + BLOCK_OVERHEAD;
-        block->next = block->next->next;
-        if (block->next) {
-            block->next->prev = block;
-        } else {
-            mem_mgr.last_block = block;
-        }
-    }
-    
-    // Merge with previous block if free
-    if (block->prev && !(block->prev->flags & MEM_BLOCK_USED)) {
-        block->prev->size += block->size + BLOCK_OVERHEAD;
-        block->prev->next = block->next;
-        if (block->next) {
-            block->next->prev = block->prev;
-        } else {
-            mem_mgr.last_block = block->prev;
-        }
+    if (block->flags & MEM_BLOCK_HANDLE) {
+        exit_critical();
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Handle memory at %p must be freed with Memory_FreeHandle", ptr);
+        return;
     }
     
+    heap_free_locked(block);
     exit_critical();
 }
 
@@ -392,7 +841,7 @@ void* Memory_AllocAligned(uint32_t size, uint32_t alignment, const char* file, u
     }
     
     // Calculate aligned address
-    void* aligned = (void*)(((uintptr_t)raw + sizeof(void*) + alignment - 1) & ~(alignment - 1));
+    void* aligned = (void*)(((uintptr_t)raw + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1));
     
     // Store original address before aligned pointer
     *((void**)aligned - 1) = raw;
@@ -442,13 +891,21 @@ void* Memory_Realloc(void* ptr, uint32_t size, const char* file, uint32_t line)
         return NULL;
     }
     
+    if (block->flags & MEM_BLOCK_HANDLE) {
+        exit_critical();
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Handle memory at %p cannot be reallocated", ptr);
+        return NULL;
+    }
+    
     // Align size
-    size = (size + sizeof(void*) - 1) & ALIGNMENT_MASK;
+    size = normalize_size(size);
+    uint32_t old_size = block->size;
     
     // If new size fits in current block
     if (size <= block->size) {
         if (size < block->size) {
             split_block(block, size);
+            resize_in_place(block, old_size);
         }
         exit_critical();
         return ptr;
@@ -458,15 +915,12 @@ void* Memory_Realloc(void* ptr, uint32_t size, const char* file, uint32_t line)
     if (block->next && !(block->next->flags & MEM_BLOCK_USED) && 
         (block->size + block->next->size + BLOCK_OVERHEAD) >= size) {
         
-        block->size += block->next->size + BLOCK_OVERHEAD;
-        block->next = block->next->next;
-        if (block->next) {
-            block->next->prev = block;
-        } else {
-            mem_mgr.last_block = block;
+        if (use_tlsf()) {
+            tlsf_remove(block->next);
         }
-        
+        merge_with_next(block);
         split_block(block, size);
+        resize_in_place(block, old_size);
         exit_critical();
         return ptr;
     }
@@ -534,6 +988,14 @@ void Memory_DumpStats(void) {
     Logger_Log(LOG_LEVEL_INFO, "MEMORY", "  Pool Allocations: %u", stats.pool_allocations);
     Logger_Log(LOG_LEVEL_INFO, "MEMORY", "  Total Frees: %u", stats.free_count);
     Logger_Log(LOG_LEVEL_INFO, "MEMORY", "  Fragmentation: %u%%", stats.fragmentation);
+    if (stats.page_size) {
+        Logger_Log(LOG_LEVEL_INFO, "MEMORY", "  Page Size: %u bytes (%s)", stats.page_size,
+                   stats.pages_locked ? "locked" : "not locked");
+    }
+}
+
+uint32_t Memory_GetAllocationCount(void) {
+    return alloc_events;
 }
 
 bool Memory_CheckIntegrity(void) {
@@ -549,29 +1011,10 @@ bool Memory_CheckIntegrity(void) {
     uint32_t total_size = 0;
     
     while (block && integrity_ok) {
-        // Basic block validation
-        if (!is_valid_block(block)) {
-            Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Invalid block at %p", block);
-            integrity_ok = false;
-            break;
-        }
-        
-        // Check guards for used blocks
-        if ((block->flags & MEM_BLOCK_USED) && !check_block_guards(block)) {
-            Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Guard check failed at %p", block);
-            integrity_ok = false;
-            break;
-        }
-        
-        // Check links
-        if (block->next) {
-            if (block->next->prev != block) {
-                Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Broken linked list at %p", block);
-                integrity_ok = false;
-                break;
-            }
-        } else if (block != mem_mgr.last_block) {
-            Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Last block mismatch at %p", block);
+        // Header, guards and links
+        const char* error = check_heap_block(block);
+        if (error) {
+            Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "%s at %p", error, block);
             integrity_ok = false;
             break;
         }
@@ -633,12 +1076,13 @@ void Memory_Defragment(void) {
         while (block && block->next) {
             if (!(block->flags & MEM_BLOCK_USED) && !(block->next->flags & MEM_BLOCK_USED)) {
                 // Merge adjacent free blocks
-                block->size += block->next->size + BLOCK_OVERHEAD;
-                block->next = block->next->next;
-                if (block->next) {
-                    block->next->prev = block;
-                } else {
-                    mem_mgr.last_block = block;
+                if (use_tlsf()) {
+                    tlsf_remove(block);
+                    tlsf_remove(block->next);
+                }
+                merge_with_next(block);
+                if (use_tlsf()) {
+                    tlsf_insert(block);
                 }
                 merged = true;
             } else {
@@ -651,6 +1095,394 @@ void Memory_Defragment(void) {
     Logger_Log(LOG_LEVEL_INFO, "MEMORY", "Memory defragmentation completed");
 }
 
+static HandleSlot* lookup_handle(MemHandle handle) {
+    uint32_t index = (handle & 0xFFFF) - 1;
+    if (!mem_mgr.handles || index >= mem_mgr.config.max_handles) {
+        return NULL;
+    }
+    
+    HandleSlot* slot = &mem_mgr.handles[index];
+    if (!slot->block || slot->generation != (handle >> 16)) {
+        return NULL;
+    }
+    return slot;
+}
+
+MemHandle Memory_AllocHandle(uint32_t size, const char* file, uint32_t line) {
+    if (!mem_mgr.initialized || size == 0 || size > mem_mgr.config.heap_size) {
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Invalid handle allocation request");
+        return MEM_INVALID_HANDLE;
+    }
+    
+    enter_critical();
+    
+    if (!mem_mgr.handle_free_head) {
+        exit_critical();
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Handle table exhausted");
+        return MEM_INVALID_HANDLE;
+    }
+    
+    // Always heap-backed: pool blocks have fixed addresses
+    MemBlock* block = heap_alloc_locked(size, file, line);
+    if (!block) {
+        exit_critical();
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "No suitable block found for handle of size %u", size);
+        return MEM_INVALID_HANDLE;
+    }
+    
+    uint32_t index = mem_mgr.handle_free_head - 1;
+    HandleSlot* slot = &mem_mgr.handles[index];
+    mem_mgr.handle_free_head = slot->next_free;
+    
+    slot->block = block;
+    slot->pins = 0;
+    block->flags |= MEM_BLOCK_HANDLE;
+    block->handle = index + 1;
+    
+    MemHandle handle = ((uint32_t)slot->generation << 16) | (index + 1);
+    exit_critical();
+    return handle;
+}
+
+void* Memory_Pin(MemHandle handle) {
+    if (!mem_mgr.initialized) {
+        return NULL;
+    }
+    
+    enter_critical();
+    HandleSlot* slot = lookup_handle(handle);
+    void* ptr = NULL;
+    if (slot && slot->pins < UINT16_MAX) {
+        slot->pins++;
+        ptr = slot->block + 1;
+    }
+    exit_critical();
+    return ptr;
+}
+
+void Memory_Unpin(MemHandle handle) {
+    if (!mem_mgr.initialized) {
+        return;
+    }
+    
+    enter_critical();
+    HandleSlot* slot = lookup_handle(handle);
+    if (slot && slot->pins > 0) {
+        slot->pins--;
+    }
+    exit_critical();
+}
+
+void Memory_FreeHandle(MemHandle handle) {
+    if (!mem_mgr.initialized || handle == MEM_INVALID_HANDLE) {
+        return;
+    }
+    
+    enter_critical();
+    
+    HandleSlot* slot = lookup_handle(handle);
+    if (!slot) {
+        exit_critical();
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Invalid or stale handle 0x%08X", handle);
+        return;
+    }
+    
+    if (slot->pins > 0) {
+        exit_critical();
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Handle 0x%08X freed while pinned", handle);
+        return;
+    }
+    
+    MemBlock* block = slot->block;
+    if (!check_block_guards(block)) {
+        exit_critical();
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Memory corruption detected at %p", (void*)(block + 1));
+        return;
+    }
+    
+    heap_free_locked(block);
+    
+    uint32_t index = (uint32_t)(slot - mem_mgr.handles);
+    slot->block = NULL;
+    slot->generation++;
+    slot->next_free = mem_mgr.handle_free_head;
+    mem_mgr.handle_free_head = index + 1;
+    
+    exit_critical();
+}
+
+static bool is_movable(const MemBlock* block) {
+    if ((block->flags & (MEM_BLOCK_USED | MEM_BLOCK_HANDLE)) != (MEM_BLOCK_USED | MEM_BLOCK_HANDLE)) {
+        return false;
+    }
+    return mem_mgr.handles[block->handle - 1].pins == 0;
+}
+
+// Swap a free block with the unpinned handle block that follows it: the
+// payload moves down and the hole moves up, merging with any free space
+// beyond. Returns the hole in its new position.
+static MemBlock* slide_down(MemBlock* hole) {
+    MemBlock* used = hole->next;
+    MemBlock* prev = hole->prev;
+    MemBlock* after = used->next;
+    uint32_t hole_size = hole->size;
+    uint32_t used_size = used->size;
+    void* old_ptr = used + 1;
+    
+    if (use_tlsf()) {
+        tlsf_remove(hole);
+    }
+    
+    // Header, payload and footer move together, so guards stay intact
+    memmove(hole, used, sizeof(MemBlock) + used_size + FOOTER_SIZE);
+    MemBlock* moved = hole;
+    moved->prev = prev;
+    if (mem_mgr.scan.block == used) {
+        // The hole was counted; the moved block and the new hole will be
+        mem_mgr.scan.heap_bytes -= hole_size + BLOCK_OVERHEAD;
+        mem_mgr.scan.block = moved;
+    }
+    
+    MemBlock* new_hole = (MemBlock*)((uint8_t*)(moved + 1) + used_size + FOOTER_SIZE);
+    new_hole->size = hole_size;
+    new_hole->flags = MEM_BLOCK_FREE;
+    new_hole->file = NULL;
+    new_hole->line = 0;
+    new_hole->handle = 0;
+    new_hole->prev = moved;
+    new_hole->next = after;
+    moved->next = new_hole;
+    if (after) {
+        after->prev = new_hole;
+    } else {
+        mem_mgr.last_block = new_hole;
+    }
+    
+    mem_mgr.handles[moved->handle - 1].block = moved;
+    if (moved->flags & MEM_BLOCK_SAMPLED) {
+        HeapProfiler_OnMove(old_ptr, moved + 1);
+    }
+    
+    // The old header is gone even if nothing merges below
+    mem_mgr.heap_epoch++;
+    if (after && !(after->flags & MEM_BLOCK_USED)) {
+        if (use_tlsf()) {
+            tlsf_remove(after);
+        }
+        merge_with_next(new_hole);
+    }
+    
+    if (use_tlsf()) {
+        tlsf_insert(new_hole);
+    }
+    
+    mem_mgr.stats.compacted_blocks++;
+    mem_mgr.stats.compacted_bytes += used_size;
+    return new_hole;
+}
+
+uint32_t Memory_Compact(uint32_t max_bytes) {
+    if (!mem_mgr.initialized || !mem_mgr.handles || max_bytes == 0) {
+        return 0;
+    }
+    
+    enter_critical();
+    
+    // Resume from the saved cursor unless a header it may point at was destroyed
+    MemBlock* block = mem_mgr.compact_cursor;
+    if (!block || mem_mgr.compact_epoch != mem_mgr.heap_epoch) {
+        block = mem_mgr.first_block;
+    }
+    
+    uint32_t moved = 0;
+    uint32_t visited = 0;
+    
+    while (block && visited < COMPACT_SCAN_LIMIT) {
+        visited++;
+        MemBlock* next = block->next;
+        
+        if (!(block->flags & MEM_BLOCK_USED) && next && is_movable(next)) {
+            if (moved + next->size > max_bytes) {
+                if (next->size <= max_bytes) {
+                    break;  // Fits a later call's budget
+                }
+                block = next;  // Never fits, leave it in place
+                continue;
+            }
+            moved += next->size;
+            block = slide_down(block);
+            continue;
+        }
+        
+        block = next;
+    }
+    
+    if (!block) {
+        mem_mgr.stats.compaction_passes++;
+    }
+    mem_mgr.compact_cursor = block;
+    mem_mgr.compact_epoch = mem_mgr.heap_epoch;
+    
+    exit_critical();
+    return moved;
+}
+
+void Memory_CompactTask(void* arg) {
+    uint32_t budget = arg ? *(const uint32_t*)arg : mem_mgr.config.compact_budget;
+    Memory_Compact(budget ? budget : COMPACT_DEFAULT_BUDGET);
+}
+
+static void record_corruption(const MemBlock* block, const char* error) {
+    MemScanStats* stats = &mem_mgr.scan.stats;
+    stats->errors++;
+    
+    // Only a header with an intact front guard has a trustworthy site
+    bool header_ok = (block->guard_front == GUARD_PATTERN);
+    const char* file = header_ok ? block->file : NULL;
+    uint32_t line = header_ok ? block->line : 0;
+    
+    if (!stats->corrupt_block) {
+        stats->corrupt_block = block;
+        stats->corrupt_file = file;
+        stats->corrupt_line = line;
+    }
+    Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "%s at %p (allocated in %s:%u)",
+               error, (const void*)block, file ? file : "unknown", line);
+}
+
+static void finish_scan_pass(void) {
+    MemScanStats* stats = &mem_mgr.scan.stats;
+    stats->passes_completed++;
+    stats->blocks_last_pass = stats->blocks_checked;
+    stats->last_pass_us = mem_mgr.scan.pass_us;
+    stats->blocks_checked = 0;
+    stats->coverage = 100;
+    mem_mgr.scan.in_pass = false;
+}
+
+// Check the block under the cursor and advance. Returns false on corruption.
+static bool scan_step(void) {
+    if (mem_mgr.scan.block) {
+        MemBlock* block = mem_mgr.scan.block;
+        const char* error = check_heap_block(block);
+        if (!error) {
+            mem_mgr.scan.heap_bytes += block->size + BLOCK_OVERHEAD;
+            if (mem_mgr.scan.heap_bytes > mem_mgr.config.heap_size) {
+                error = "Heap size overflow";
+            }
+        }
+        if (error) {
+            record_corruption(block, error);
+            // Links past this block cannot be trusted; continue with the pools
+            mem_mgr.scan.block = NULL;
+            return false;
+        }
+        mem_mgr.scan.block = block->next;
+        return true;
+    }
+    
+    MemoryPool* pool = &mem_mgr.pools[mem_mgr.scan.pool];
+    uint32_t j = mem_mgr.scan.pool_block++;
+    bool ok = true;
+    
+    if (pool->block_used[j] && mem_mgr.config.enable_guards) {
+        MemBlock* block = (MemBlock*)(pool->pool_memory + (j * pool->block_size));
+        if (!check_block_guards(block)) {
+            record_corruption(block, "Pool guard check failed");
+            ok = false;
+        }
+    }
+    if (j < pool->free_blocks && pool->free_list[j] >= pool->block_count) {
+        Logger_Log(LOG_LEVEL_ERROR, "MEMORY", "Invalid pool free list entry: %u", pool->free_list[j]);
+        mem_mgr.scan.stats.errors++;
+        ok = false;
+    }
+    
+    if (mem_mgr.scan.pool_block >= pool->block_count) {
+        mem_mgr.scan.pool++;
+        mem_mgr.scan.pool_block = 0;
+    }
+    return ok;
+}
+
+bool Memory_ScanIncremental(const MemScanBudget* budget) {
+    if (!mem_mgr.initialized) {
+        return false;
+    }
+    
+    uint32_t max_blocks = budget ? budget->max_blocks : 0;
+    uint32_t max_us = budget ? budget->max_us : 0;
+    
+    enter_critical();
+    
+    uint32_t start_us = Timer_GetMicroseconds();
+    uint32_t checked = 0;
+    bool ok = true;
+    
+    if (!mem_mgr.scan.in_pass) {
+        mem_mgr.scan.in_pass = true;
+        mem_mgr.scan.block = mem_mgr.first_block;
+        mem_mgr.scan.pool = 0;
+        mem_mgr.scan.pool_block = 0;
+        mem_mgr.scan.heap_bytes = 0;
+        mem_mgr.scan.pass_us = 0;
+        mem_mgr.scan.stats.blocks_checked = 0;
+    }
+    
+    while (mem_mgr.scan.block || mem_mgr.scan.pool < mem_mgr.pool_count) {
+        if (max_blocks && checked >= max_blocks) {
+            break;
+        }
+        if (max_us && (checked & SCAN_TIME_CHECK_MASK) == 0 && checked > 0 &&
+            Timer_GetMicroseconds() - start_us >= max_us) {
+            break;
+        }
+        
+        ok &= scan_step();
+        checked++;
+    }
+    
+    uint32_t elapsed_us = Timer_GetMicroseconds() - start_us;
+    mem_mgr.scan.pass_us += elapsed_us;
+    mem_mgr.scan.stats.blocks_checked += checked;
+    if (elapsed_us > mem_mgr.scan.stats.max_slice_us) {
+        mem_mgr.scan.stats.max_slice_us = elapsed_us;
+    }
+    
+    if (!mem_mgr.scan.block && mem_mgr.scan.pool >= mem_mgr.pool_count) {
+        finish_scan_pass();
+    } else if (mem_mgr.scan.stats.blocks_last_pass) {
+        uint32_t coverage = mem_mgr.scan.stats.blocks_checked * 100 / mem_mgr.scan.stats.blocks_last_pass;
+        mem_mgr.scan.stats.coverage = (coverage < 100) ? coverage : 99;
+    } else {
+        mem_mgr.scan.stats.coverage = 0;
+    }
+    
+    exit_critical();
+    return ok;
+}
+
+void Memory_ScanTask(void* arg) {
+    const MemScanBudget* budget = arg ? (const MemScanBudget*)arg : &mem_mgr.config.scan_budget;
+    Memory_ScanIncremental(budget);
+}
+
+void Memory_GetScanStats(MemScanStats* stats) {
+    if (!stats) {
+        return;
+    }
+    
+    enter_critical();
+    memcpy(stats, &mem_mgr.scan.stats, sizeof(MemScanStats));
+    exit_critical();
+}
+
+void Memory_ResetScan(void) {
+    enter_critical();
+    memset(&mem_mgr.scan, 0, sizeof(mem_mgr.scan));
+    exit_critical();
+}
+
 void Memory_TrackLeaks(MemoryLeakCallback callback) {
     if (!mem_mgr.initialized || !callback) {
         return;
@@ -698,26 +1530,21 @@ void Memory_Deinit(void) {
         return;
     }
     
-    enter_critical();
-    
     // Report memory leaks if tracking is enabled
     if (mem_mgr.config.enable_tracking) {
-        Memory_TrackLeaks([](const MemBlock* block) {
-            Logger_Log(LOG_LEVEL_WARNING, "MEMORY", 
-                      "Memory leak: %u bytes at %p (allocated in %s:%u)",
-                      block->size, block + 1, block->file, block->line);
-        });
+        Memory_TrackLeaks(report_leak);
     }
     
+    enter_critical();
+    
     // Free memory pools
     for (uint32_t i = 0; i < mem_mgr.pool_count; i++) {
-        free(mem_mgr.pools[i].pool_memory);
-        free(mem_mgr.pools[i].free_list);
-        free(mem_mgr.pools[i].block_used);
+        backing_free(mem_mgr.pools[i].pool_memory, mem_mgr.pools[i].mapped_size);
     }
     
     // Free heap memory
-    free(mem_mgr.heap_memory);
+    backing_free(mem_mgr.handles, mem_mgr.handles_mapped_size);
+    backing_free(mem_mgr.heap_memory, mem_mgr.heap_mapped_size);
     
     // Clear manager state
     memset(&mem_mgr, 0, sizeof(MemoryManager));
@@ -10,6 +10,31 @@
 #define MEM_BLOCK_POOL     0x02
 #define MEM_BLOCK_GUARD    0x04
 #define MEM_BLOCK_ALIGNED  0x08
+#define MEM_BLOCK_SAMPLED  0x10    // Tracked by heap_profiler
+#define MEM_BLOCK_HANDLE   0x20    // Owned by a handle, may be relocated
+
+// Relocatable allocation handle, 0 is never valid
+typedef uint32_t MemHandle;
+#define MEM_INVALID_HANDLE 0
+#define MEM_MAX_HANDLES    0xFFFF
+
+// Heap allocation strategies
+typedef enum {
+    MEM_ALLOC_BEST_FIT = 0,  // Best-fit search over the block list
+    MEM_ALLOC_TLSF           // Two-Level Segregated Fit, O(1) alloc/free
+} MemAllocStrategy;
+
+// Backing store for the heap and pools
+typedef enum {
+    MEM_BACKING_MALLOC = 0,  // Plain malloc, pages faulted in on first touch
+    MEM_BACKING_LOCKED       // Linux: mmap with huge pages when available, prefaulted and mlocked
+} MemBackingMode;
+
+// Work allowed per incremental integrity scan slice; 0 means unlimited
+typedef struct {
+    uint32_t max_blocks;
+    uint32_t max_us;
+} MemScanBudget;
 
 // Memory configuration
 typedef struct {
@@ -20,6 +45,11 @@ typedef struct {
     bool enable_guards;      // Enable memory guards
     bool enable_tracking;    // Enable allocation tracking
     bool enable_stats;       // Enable memory statistics
+    MemAllocStrategy heap_strategy;  // Heap allocator (default best-fit)
+    MemBackingMode backing;          // Heap/pool backing (default malloc)
+    uint32_t max_handles;    // Handle table size, 0 disables handles
+    uint32_t compact_budget; // Bytes moved per Memory_CompactTask run
+    MemScanBudget scan_budget;       // Per Memory_ScanTask run
 } MemConfig;
 
 // Memory statistics
@@ -33,14 +63,36 @@ typedef struct {
     uint32_t pool_allocations;
     uint32_t heap_allocations;
     uint32_t fragmentation;
+    uint32_t page_size;      // Page size backing the heap, 0 for malloc backing
+    bool pages_locked;       // Heap and pools are resident and mlocked
+    uint32_t compacted_blocks;
+    uint32_t compacted_bytes;
+    uint32_t compaction_passes;  // Full sweeps of the heap completed
 } MemStats;
 
+// Incremental integrity scanner metrics
+typedef struct {
+    uint32_t passes_completed;
+    uint32_t blocks_checked;     // In the current pass
+    uint32_t blocks_last_pass;   // Heap and pool blocks covered by the last full pass
+    uint32_t coverage;           // Percent of the current pass done, based on the last pass
+    uint32_t last_pass_us;       // Scan time summed over the slices of the last pass
+    uint32_t max_slice_us;
+    uint32_t errors;
+    // First corruption seen since Memory_ResetScan; site is NULL when the
+    // header itself is damaged and cannot be trusted
+    const void* corrupt_block;
+    const char* corrupt_file;
+    uint32_t corrupt_line;
+} MemScanStats;
+
 // Memory block header
 typedef struct MemBlock {
     uint32_t size;
     uint32_t flags;
     const char* file;
     uint32_t line;
+    uint32_t handle;         // Handle slot + 1 for MEM_BLOCK_HANDLE blocks
     struct MemBlock* next;
     struct MemBlock* prev;
     uint32_t guard_front;
@@ -62,9 +114,31 @@ void* Memory_Calloc(uint32_t count, uint32_t size, const char* file, uint32_t li
 void* Memory_Realloc(void* ptr, uint32_t size, const char* file, uint32_t line);
 void Memory_Free(void* ptr);
 
+// Relocatable allocations. A handle's memory may be moved by the compactor
+// whenever it is not pinned; the pointer from Memory_Pin is valid until the
+// matching Memory_Unpin.
+MemHandle Memory_AllocHandle(uint32_t size, const char* file, uint32_t line);
+void* Memory_Pin(MemHandle handle);
+void Memory_Unpin(MemHandle handle);
+void Memory_FreeHandle(MemHandle handle);
+
+// Incremental compaction: slides unpinned handle blocks down into the holes
+// before them, moving at most max_bytes per call and resuming where the
+// previous call stopped. Returns the bytes moved.
+uint32_t Memory_Compact(uint32_t max_bytes);
+void Memory_CompactTask(void* arg);     // TaskConfig entry, arg: uint32_t* budget or NULL
+
 // Memory statistics and diagnostics
 void Memory_GetStats(MemStats* stats);
+uint32_t Memory_GetAllocationCount(void);   // Cheap counter for hot-path audits
 bool Memory_CheckIntegrity(void);
+
+// Incremental integrity scan: checks up to the budget and resumes from the
+// same place on the next call. Returns false if this slice found corruption.
+bool Memory_ScanIncremental(const MemScanBudget* budget);
+void Memory_ScanTask(void* arg);        // TaskConfig entry, arg: MemScanBudget* or NULL
+void Memory_GetScanStats(MemScanStats* stats);
+void Memory_ResetScan(void);
 void Memory_DumpStats(void);
 void Memory_Defragment(void);
 
@@ -78,5 +152,6 @@ void Memory_TrackLeaks(MemoryLeakCallback callback);
 #define MEMORY_CALLOC(count, size)   Memory_Calloc(count, size, __FILE__, __LINE__)
 #define MEMORY_REALLOC(ptr, size)    Memory_Realloc(ptr, size, __FILE__, __LINE__)
 #define MEMORY_FREE(ptr)             Memory_Free(ptr)
+#define MEMORY_ALLOC_HANDLE(size)    Memory_AllocHandle(size, __FILE__, __LINE__)
 
 #endif // CANT_MEMORY_MANAGER_H 
\ No newline at end of file
@@ -1,92 +1,285 @@
 #include "rt_memory.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <pthread.h>
 
+#define DEPOT_NIL        0xFFFFFFFFu
+#define DEPOT_INDEX(h)   ((uint32_t)((h) & 0xFFFFFFFFu))
+#define DEPOT_TAG(h)     ((uint32_t)((h) >> 32))
+#define DEPOT_HEAD(t, i) (((uint64_t)(t) << 32) | (uint64_t)(i))
+
+// Per-thread block cache. Only the owning thread touches rounds[]; count is
+// atomic so rt_mempool_available() can take a relaxed snapshot.
+typedef struct {
+    RTMemPool* pool;
+    atomic_bool claimed;
+    atomic_size_t count;
+    void* rounds[RT_MEMPOOL_MAG_ROUNDS];
+} __attribute__((aligned(64))) RTMagazine;
+
 struct RTMemPool {
     void* memory;
-    void** free_blocks;
     size_t block_size;
     size_t block_count;
-    size_t free_count;
-    pthread_mutex_t lock;
+    size_t mag_capacity;
+
+    // Lock-free depot: Treiber stack of block indices. The head packs the
+    // top index with a tag that is bumped on every push/pop to defeat ABA.
+    _Atomic uint64_t depot_head __attribute__((aligned(64)));
+    atomic_long depot_count;  // Signed: push/pop adjust it after their CAS
+    _Atomic uint32_t* links;
+
+    RTMagazine* magazines;
+    pthread_key_t mag_key;
 };
 
+// Marks threads that could not claim a magazine so they skip the claim scan
+static RTMagazine no_magazine;
+
+static inline uint32_t block_index(const RTMemPool* pool, const void* ptr) {
+    return (uint32_t)(((const char*)ptr - (const char*)pool->memory) / pool->block_size);
+}
+
+static inline void* block_ptr(const RTMemPool* pool, uint32_t index) {
+    return (char*)pool->memory + ((size_t)index * pool->block_size);
+}
+
+// Push a pre-linked chain first..last (n blocks) with a single CAS
+static void depot_push_chain(RTMemPool* pool, uint32_t first, uint32_t last, size_t n) {
+    uint64_t old_head = atomic_load_explicit(&pool->depot_head, memory_order_acquire);
+    uint64_t new_head;
+
+    do {
+        atomic_store_explicit(&pool->links[last], DEPOT_INDEX(old_head), memory_order_relaxed);
+        new_head = DEPOT_HEAD(DEPOT_TAG(old_head) + 1, first);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->depot_head, &old_head, new_head,
+                                                    memory_order_release,
+                                                    memory_order_acquire));
+
+    atomic_fetch_add_explicit(&pool->depot_count, (long)n, memory_order_relaxed);
+}
+
+// Pop up to max blocks with a single CAS. The walk may read links of blocks
+// that another thread has just taken; the tag check rejects such snapshots.
+static size_t depot_pop_chain(RTMemPool* pool, void** out, size_t max) {
+    uint64_t old_head = atomic_load_explicit(&pool->depot_head, memory_order_acquire);
+
+    for (;;) {
+        uint32_t index = DEPOT_INDEX(old_head);
+        if (index == DEPOT_NIL) {
+            return 0;
+        }
+
+        size_t n = 0;
+        bool stale = false;
+        while (n < max && index != DEPOT_NIL) {
+            if (index >= pool->block_count) {
+                stale = true;
+                break;
+            }
+            out[n++] = block_ptr(pool, index);
+            index = atomic_load_explicit(&pool->links[index], memory_order_relaxed);
+        }
+
+        if (stale) {
+            old_head = atomic_load_explicit(&pool->depot_head, memory_order_acquire);
+            continue;
+        }
+
+        uint64_t new_head = DEPOT_HEAD(DEPOT_TAG(old_head) + 1, index);
+        if (atomic_compare_exchange_weak_explicit(&pool->depot_head, &old_head, new_head,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            atomic_fetch_sub_explicit(&pool->depot_count, (long)n, memory_order_relaxed);
+            return n;
+        }
+    }
+}
+
+// Link rounds[0..n) into a chain and return it to the depot
+static void depot_push_rounds(RTMemPool* pool, void** rounds, size_t n) {
+    if (n == 0) return;
+
+    for (size_t i = 0; i + 1 < n; i++) {
+        atomic_store_explicit(&pool->links[block_index(pool, rounds[i])],
+                              block_index(pool, rounds[i + 1]),
+                              memory_order_relaxed);
+    }
+    depot_push_chain(pool, block_index(pool, rounds[0]),
+                     block_index(pool, rounds[n - 1]), n);
+}
+
+// Thread exit: hand cached blocks back and free the magazine slot
+static void magazine_release(void* arg) {
+    RTMagazine* mag = (RTMagazine*)arg;
+    if (!mag || mag == &no_magazine) return;
+
+    size_t count = atomic_load_explicit(&mag->count, memory_order_relaxed);
+    depot_push_rounds(mag->pool, mag->rounds, count);
+    atomic_store_explicit(&mag->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&mag->claimed, false, memory_order_release);
+}
+
+static RTMagazine* get_magazine(RTMemPool* pool) {
+    RTMagazine* mag = pthread_getspecific(pool->mag_key);
+    if (mag) {
+        return (mag == &no_magazine) ? NULL : mag;
+    }
+
+    if (pool->mag_capacity > 0) {
+        for (size_t i = 0; i < RT_MEMPOOL_MAX_THREADS; i++) {
+            if (!atomic_exchange_explicit(&pool->magazines[i].claimed, true,
+                                          memory_order_acquire)) {
+                mag = &pool->magazines[i];
+                atomic_store_explicit(&mag->count, 0, memory_order_relaxed);
+                pthread_setspecific(pool->mag_key, mag);
+                return mag;
+            }
+        }
+    }
+
+    pthread_setspecific(pool->mag_key, &no_magazine);
+    return NULL;
+}
+
 RTMemPool* rt_mempool_create(size_t block_size, size_t block_count) {
-    RTMemPool* pool = malloc(sizeof(RTMemPool));
+    if (block_size == 0 || block_count == 0 || block_count >= DEPOT_NIL) return NULL;
+
+    RTMemPool* pool = calloc(1, sizeof(RTMemPool));
     if (!pool) return NULL;
-    
+
     // Align block size to cache line
     block_size = (block_size + 63) & ~63;
-    
+
     pool->memory = aligned_alloc(64, block_size * block_count);
     if (!pool->memory) {
         free(pool);
         return NULL;
     }
-    
-    pool->free_blocks = malloc(sizeof(void*) * block_count);
-    if (!pool->free_blocks) {
+
+    pool->links = malloc(sizeof(_Atomic uint32_t) * block_count);
+    pool->magazines = aligned_alloc(64, sizeof(RTMagazine) * RT_MEMPOOL_MAX_THREADS);
+    if (!pool->links || !pool->magazines ||
+        pthread_key_create(&pool->mag_key, magazine_release) != 0) {
+        free(pool->magazines);
+        free(pool->links);
         free(pool->memory);
         free(pool);
         return NULL;
     }
-    
+
     pool->block_size = block_size;
     pool->block_count = block_count;
-    pool->free_count = block_count;
-    
-    // Initialize free block list
+
+    // Cap caching so at least half the pool always stays reachable through
+    // the depot, even with every magazine full. Tiny pools skip caching.
+    pool->mag_capacity = block_count / (2 * RT_MEMPOOL_MAX_THREADS);
+    if (pool->mag_capacity > RT_MEMPOOL_MAG_ROUNDS) {
+        pool->mag_capacity = RT_MEMPOOL_MAG_ROUNDS;
+    }
+    if (pool->mag_capacity < 2) {
+        pool->mag_capacity = 0;
+    }
+
+    for (size_t i = 0; i < RT_MEMPOOL_MAX_THREADS; i++) {
+        pool->magazines[i].pool = pool;
+        atomic_init(&pool->magazines[i].claimed, false);
+        atomic_init(&pool->magazines[i].count, 0);
+    }
+
+    // Initialize depot with every block in address order
     for (size_t i = 0; i < block_count; i++) {
-        pool->free_blocks[i] = (char*)pool->memory + (i * block_size);
+        atomic_init(&pool->links[i], (i + 1 < block_count) ? (uint32_t)(i + 1) : DEPOT_NIL);
     }
-    
-    pthread_mutex_init(&pool->lock, NULL);
-    
+    atomic_init(&pool->depot_head, DEPOT_HEAD(0, 0));
+    atomic_init(&pool->depot_count, (long)block_count);
+
     return pool;
 }
 
 void* rt_mempool_alloc(RTMemPool* pool) {
-    if (!pool || pool->free_count == 0) return NULL;
-    
-    pthread_mutex_lock(&pool->lock);
-    void* block = pool->free_blocks[--pool->free_count];
-    pthread_mutex_unlock(&pool->lock);
-    
+    if (!pool) return NULL;
+
+    RTMagazine* mag = get_magazine(pool);
+    if (!mag) {
+        void* block = NULL;
+        return depot_pop_chain(pool, &block, 1) ? block : NULL;
+    }
+
+    size_t count = atomic_load_explicit(&mag->count, memory_order_relaxed);
+    if (count == 0) {
+        // Refill half a magazine in one depot transaction
+        count = depot_pop_chain(pool, mag->rounds, pool->mag_capacity / 2);
+        if (count == 0) return NULL;
+    }
+
+    void* block = mag->rounds[--count];
+    atomic_store_explicit(&mag->count, count, memory_order_relaxed);
     return block;
 }
 
 void rt_mempool_free(RTMemPool* pool, void* ptr) {
     if (!pool || !ptr) return;
-    
-    // Validate pointer belongs to pool
-    if (ptr < pool->memory || 
-        ptr >= (char*)pool->memory + (pool->block_count * pool->block_size)) {
+
+    // Validate pointer belongs to pool and sits on a block boundary
+    if (ptr < pool->memory ||
+        ptr >= (void*)((char*)pool->memory + (pool->block_count * pool->block_size)) ||
+        ((size_t)((char*)ptr - (char*)pool->memory) % pool->block_size) != 0) {
+        return;
+    }
+
+    RTMagazine* mag = get_magazine(pool);
+    if (!mag) {
+        uint32_t index = block_index(pool, ptr);
+        depot_push_chain(pool, index, index, 1);
         return;
     }
-    
-    pthread_mutex_lock(&pool->lock);
-    if (pool->free_count < pool->block_count) {
-        pool->free_blocks[pool->free_count++] = ptr;
+
+    size_t count = atomic_load_explicit(&mag->count, memory_order_relaxed);
+    if (count == pool->mag_capacity) {
+        // Spill the older half back to the depot in one transaction
+        size_t spill = pool->mag_capacity / 2;
+        depot_push_rounds(pool, mag->rounds, spill);
+        memmove(mag->rounds, mag->rounds + spill, (count - spill) * sizeof(void*));
+        count -= spill;
     }
-    pthread_mutex_unlock(&pool->lock);
+
+    mag->rounds[count++] = ptr;
+    atomic_store_explicit(&mag->count, count, memory_order_relaxed);
+}
+
+void rt_mempool_flush_cache(RTMemPool* pool) {
+    if (!pool) return;
+
+    RTMagazine* mag = pthread_getspecific(pool->mag_key);
+    if (!mag || mag == &no_magazine) return;
+
+    size_t count = atomic_load_explicit(&mag->count, memory_order_relaxed);
+    depot_push_rounds(pool, mag->rounds, count);
+    atomic_store_explicit(&mag->count, 0, memory_order_relaxed);
 }
 
 void rt_mempool_destroy(RTMemPool* pool) {
     if (!pool) return;
-    
-    pthread_mutex_destroy(&pool->lock);
-    free(pool->free_blocks);
+
+    pthread_key_delete(pool->mag_key);
+    free(pool->magazines);
+    free(pool->links);
     free(pool->memory);
     free(pool);
 }
 
 size_t rt_mempool_available(RTMemPool* pool) {
     if (!pool) return 0;
-    
-    pthread_mutex_lock(&pool->lock);
-    size_t count = pool->free_count;
-    pthread_mutex_unlock(&pool->lock);
-    
+
+    // Snapshot: blocks cached in magazines count as available
+    long depot = atomic_load_explicit(&pool->depot_count, memory_order_relaxed);
+    size_t count = (depot > 0) ? (size_t)depot : 0;
+    for (size_t i = 0; i < RT_MEMPOOL_MAX_THREADS; i++) {
+        count += atomic_load_explicit(&pool->magazines[i].count, memory_order_relaxed);
+    }
+
     return count;
-} 
\ No newline at end of file
+}
\ No newline at end of file
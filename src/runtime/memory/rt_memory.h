@@ -4,6 +4,10 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+// Per-thread magazine cache configuration
+#define RT_MEMPOOL_MAX_THREADS   32   // Magazines per pool; extra threads use the depot directly
+#define RT_MEMPOOL_MAG_ROUNDS    32   // Upper bound on blocks cached per thread
+
 typedef struct RTMemPool RTMemPool;
 
 RTMemPool* rt_mempool_create(size_t block_size, size_t block_count);
@@ -12,4 +16,7 @@ void rt_mempool_free(RTMemPool* pool, void* ptr);
 void rt_mempool_destroy(RTMemPool* pool);
 size_t rt_mempool_available(RTMemPool* pool);
 
-#endif // CANT_RT_MEMORY_H 
\ No newline at end of file
+// Return the calling thread's cached blocks to the shared depot
+void rt_mempool_flush_cache(RTMemPool* pool);
+
+#endif // CANT_RT_MEMORY_H
\ No newline at end of file
@@ -1,68 +1,120 @@
 #include "buffer_manager.h"
+#include "../core/critical_section.h"
+#include "../hardware/timer_hw.h"
 #include <string.h>
 
-#define NUM_BUFFERS 8
-#define BUFFER_SIZE 512
+#define BUFFER_STALE_MS 5000
 
-typedef struct {
-    uint8_t data[BUFFER_SIZE];
-    uint32_t length;
-    bool in_use;
-    uint32_t timestamp;
-} Buffer;
-
-static Buffer buffers[NUM_BUFFERS];
+static uint8_t pool[BUFFER_COUNT][BUFFER_SIZE];
+static BufferDesc descs[BUFFER_COUNT];
+static uint16_t free_stack[BUFFER_COUNT];
+static uint32_t free_top = 0;
 static uint32_t alloc_count = 0;
 static uint32_t free_count = 0;
+static uint32_t alloc_failures = 0;
+static uint32_t stale_count = 0;
+static uint32_t peak_usage = 0;
 
 void BufferManager_Init(void) {
-    memset(buffers, 0, sizeof(buffers));
+    memset(descs, 0, sizeof(descs));
+    for(uint32_t i = 0; i < BUFFER_COUNT; i++) {
+        descs[i].data = pool[i];
+        descs[i].index = (uint16_t)i;
+        free_stack[i] = (uint16_t)(BUFFER_COUNT - 1 - i);
+    }
+    free_top = BUFFER_COUNT;
     alloc_count = 0;
     free_count = 0;
+    alloc_failures = 0;
+    stale_count = 0;
+    peak_usage = 0;
 }
 
-uint8_t* BufferManager_Alloc(void) {
-    for(int i = 0; i < NUM_BUFFERS; i++) {
-        if(!buffers[i].in_use) {
-            buffers[i].in_use = true;
-            buffers[i].length = 0;
-            buffers[i].timestamp = TIMER_GetMs();
-            alloc_count++;
-            return buffers[i].data;
-        }
+BufferDesc* BufferManager_AllocDesc(void) {
+    enter_critical();
+
+    if(free_top == 0) {
+        alloc_failures++;
+        exit_critical();
+        return NULL;
+    }
+
+    BufferDesc* desc = &descs[free_stack[--free_top]];
+    alloc_count++;
+    if(BUFFER_COUNT - free_top > peak_usage) {
+        peak_usage = BUFFER_COUNT - free_top;
     }
-    return NULL;
+
+    exit_critical();
+
+    desc->offset = 0;
+    desc->length = 0;
+    desc->refcount = 1;
+    desc->timestamp = TIMER_GetMs();
+    return desc;
 }
 
-void BufferManager_Free(uint8_t* buffer) {
-    for(int i = 0; i < NUM_BUFFERS; i++) {
-        if(buffers[i].data == buffer) {
-            buffers[i].in_use = false;
-            free_count++;
-            return;
-        }
+BufferDesc* BufferManager_Retain(BufferDesc* desc) {
+    if(desc) {
+        __atomic_add_fetch(&desc->refcount, 1, __ATOMIC_RELAXED);
     }
+    return desc;
 }
 
+void BufferManager_Release(BufferDesc* desc) {
+    if(!desc) return;
+
+    // Only the holder of the last reference touches the free stack
+    if(__atomic_sub_fetch(&desc->refcount, 1, __ATOMIC_ACQ_REL) != 0) return;
+
+    enter_critical();
+    free_stack[free_top++] = desc->index;
+    free_count++;
+    exit_critical();
+}
+
+uint8_t* BufferManager_Alloc(void) {
+    BufferDesc* desc = BufferManager_AllocDesc();
+    return desc ? desc->data : NULL;
+}
+
+void BufferManager_Free(uint8_t* buffer) {
+    if(!buffer) return;
+
+    uintptr_t offset = (uintptr_t)buffer - (uintptr_t)pool[0];
+    if(offset >= sizeof(pool) || offset % BUFFER_SIZE != 0) return;
+
+    BufferManager_Release(&descs[offset / BUFFER_SIZE]);
+}
+
+// Buffers are never reclaimed behind a holder's back; long-held ones are
+// only counted so leaks show up in the stats.
 void BufferManager_Process(void) {
     uint32_t current_time = TIMER_GetMs();
-    
-    for(int i = 0; i < NUM_BUFFERS; i++) {
-        if(buffers[i].in_use) {
-            if(current_time - buffers[i].timestamp > 5000) {
-                buffers[i].in_use = false;
-                free_count++;
-            }
+    uint32_t stale = 0;
+
+    for(uint32_t i = 0; i < BUFFER_COUNT; i++) {
+        if(__atomic_load_n(&descs[i].refcount, __ATOMIC_RELAXED) != 0 &&
+           current_time - descs[i].timestamp > BUFFER_STALE_MS) {
+            stale++;
         }
     }
+    stale_count = stale;
 }
 
 uint32_t BufferManager_GetUsage(void) {
-    uint32_t count = 0;
-    for(int i = 0; i < NUM_BUFFERS; i++) {
-        if(buffers[i].in_use) count++;
-    }
-    return count;
+    return BUFFER_COUNT - free_top;
 }
 
-static uint32_t peak_usage = 0; 
\ No newline at end of file
+void BufferManager_GetStats(BufferStats* stats) {
+    if(!stats) return;
+
+    enter_critical();
+    stats->total_allocs = alloc_count;
+    stats->total_frees = free_count;
+    stats->current_usage = BUFFER_COUNT - free_top;
+    stats->peak_usage = peak_usage;
+    stats->alloc_failures = alloc_failures;
+    stats->stale_buffers = stale_count;
+    exit_critical();
+}
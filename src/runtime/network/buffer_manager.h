@@ -4,9 +4,37 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifndef BUFFER_COUNT
+#define BUFFER_COUNT 32
+#endif
+#define BUFFER_SIZE 512
+
+// Shared view of one pool buffer. The holder of each reference calls
+// BufferManager_Release once; the buffer returns to the pool when the last
+// reference drops. offset/length describe the valid bytes and are set by
+// the owner before the buffer is shared.
+typedef struct {
+    uint8_t* data;
+    uint16_t offset;
+    uint16_t length;
+    uint16_t refcount;
+    uint16_t index;
+    uint32_t timestamp;
+} BufferDesc;
+
 void BufferManager_Init(void);
+BufferDesc* BufferManager_AllocDesc(void);
+BufferDesc* BufferManager_Retain(BufferDesc* desc);
+void BufferManager_Release(BufferDesc* desc);
+
+static inline uint8_t* BufferDesc_Data(const BufferDesc* desc) {
+    return desc->data + desc->offset;
+}
+
+// Raw buffer API, kept for single-owner users
 uint8_t* BufferManager_Alloc(void);
 void BufferManager_Free(uint8_t* buffer);
+
 void BufferManager_Process(void);
 uint32_t BufferManager_GetUsage(void);
 
@@ -16,8 +44,10 @@ typedef struct {
     uint32_t total_frees;
     uint32_t current_usage;
     uint32_t peak_usage;
+    uint32_t alloc_failures;
+    uint32_t stale_buffers;    // Held longer than BUFFER_STALE_MS at the last Process
 } BufferStats;
 
 void BufferManager_GetStats(BufferStats* stats);
 
-#endif 
\ No newline at end of file
+#endif
@@ -1,163 +1,236 @@
 #include "message_handler.h"
 #include "network_handler.h"
+#include "stream_framer.h"
+#include "buffer_manager.h"
 #include "../diagnostic/diag_router.h"
 #include "../hardware/timer_hw.h"
+#include "../utils/timer_wheel.h"
 #include <string.h>
 
-#define MAX_PENDING_MSGS 16
 #define MSG_TIMEOUT_MS 150
+#define MSG_WHEEL_TICK_MS 1
+#define MSG_MAX_RETRY_DELAY_MS (INT32_MAX / MSG_WHEEL_TICK_MS)
+#define MSG_SLOT_MASK (MSG_MAX_PENDING - 1)
+#define MSG_NO_SLOT 0xFFFFFFFF
 
+_Static_assert((MSG_MAX_PENDING & MSG_SLOT_MASK) == 0, "MSG_MAX_PENDING must be a power of two");
+
+// The wheel entry comes first so an expired entry is its message
 typedef struct {
-    uint8_t data[256];
+    TimerWheelEntry timer;
+    uint8_t data[MSG_MAX_LENGTH];
     uint32_t length;
-    uint32_t timestamp;
+    uint32_t id;
     uint8_t retries;
     bool active;
 } PendingMessage;
 
-static PendingMessage pending_msgs[MAX_PENDING_MSGS];
-uint8_t rx_buffer[512];
-uint16_t rx_len = 0;
+static PendingMessage pending_msgs[MSG_MAX_PENDING];
+static uint32_t free_slots[MSG_MAX_PENDING];
+static uint32_t free_count = 0;
+static TimerWheel retry_wheel;
+static RetryPolicy retry_policy;
+static StreamFramer rx_framer;
 static uint32_t msg_id = 0;
+static uint32_t tx_count = 0;
+static uint32_t timeout_count = 0;
+static uint8_t last_error = 0;
+static uint32_t error_count = 0; 
+
+static struct {
+    FrameListener callback;
+    void* context;
+} listeners[MSG_MAX_LISTENERS];
+static uint32_t listener_count = 0;
 
 bool msg_handler_init = false;
-uint32_t last_cleanup = 0;
+
+static const RetryPolicy default_policy = {
+    .backoff = RETRY_BACKOFF_LINEAR,
+    .base_ms = 50,
+    .max_ms = 1000,
+    .max_retries = 3
+};
+
+// One copy out of the RX ring; the router and every listener then share
+// the same pool buffer
+static void dispatch_frame(const uint8_t* payload, uint16_t length, void* context) {
+    (void)context;
+    BufferDesc* frame = BufferManager_AllocDesc();
+    if(!frame) {
+        error_count++;
+        DiagRouter_HandleMessage(payload, length);
+        return;
+    }
+
+    memcpy(frame->data, payload, length);
+    frame->length = length;
+
+    DiagRouter_HandleBuffer(frame);
+    for(uint32_t i = 0; i < listener_count; i++) {
+        listeners[i].callback(frame, listeners[i].context);
+    }
+
+    BufferManager_Release(frame);
+}
+
+bool MessageHandler_AddListener(FrameListener listener, void* context) {
+    if(!listener || listener_count >= MSG_MAX_LISTENERS) return false;
+
+    listeners[listener_count].callback = listener;
+    listeners[listener_count].context = context;
+    listener_count++;
+    return true;
+}
 
 bool MessageHandler_Init(void) {
     memset(pending_msgs, 0, sizeof(pending_msgs));
-    rx_len = 0;
+    for(uint32_t i = 0; i < MSG_MAX_PENDING; i++) {
+        free_slots[i] = MSG_MAX_PENDING - 1 - i;
+    }
+    free_count = MSG_MAX_PENDING;
+    timer_wheel_init(&retry_wheel, MSG_WHEEL_TICK_MS, TIMER_GetMs());
+    retry_policy = default_policy;
+    Framer_Init(&rx_framer, dispatch_frame, NULL);
     msg_id = 0;
+    tx_count = 0;
+    timeout_count = 0;
+    listener_count = 0;
     msg_handler_init = true;
     return true;
 }
 
-uint32_t find_free_slot(void) {
-    for(uint32_t i = 0; i < MAX_PENDING_MSGS; i++) {
-        if(!pending_msgs[i].active) return i;
-    }
-    return 0xFFFFFFFF;
+bool MessageHandler_SetRetryPolicy(const RetryPolicy* policy) {
+    if(!policy || !policy->base_ms || policy->max_ms < policy->base_ms) return false;
+    // The wheel orders deadlines by signed difference
+    if(policy->max_ms > MSG_MAX_RETRY_DELAY_MS) return false;
+
+    retry_policy = *policy;
+    return true;
 }
 
-bool MessageHandler_Send(uint8_t* data, uint32_t len) {
-    if(!msg_handler_init || !data || !len) return false;
-    
-    uint32_t slot = find_free_slot();
-    if(slot == 0xFFFFFFFF) {
-        cleanup_old_messages();
-        slot = find_free_slot();
-        if(slot == 0xFFFFFFFF) return false;
+// Delay before the next attempt once `retries` resends have gone out.
+// Saturates at max_ms instead of overflowing, and never drops below one
+// wheel tick, which would reschedule into the bucket being expired
+static uint32_t retry_delay(uint8_t retries) {
+    uint32_t base = retry_policy.base_ms;
+    uint32_t max = retry_policy.max_ms;
+    uint32_t delay;
+
+    switch(retry_policy.backoff) {
+        case RETRY_BACKOFF_FIXED:
+            delay = base;
+            break;
+        case RETRY_BACKOFF_EXPONENTIAL:
+            delay = (retries < 32 && base <= (max >> retries)) ? (base << retries) : max;
+            break;
+        case RETRY_BACKOFF_LINEAR:
+        default:
+            delay = (base <= max / (retries + 1u)) ? base * (retries + 1u) : max;
+            break;
     }
+    if(delay > max) delay = max;
+    return delay < MSG_WHEEL_TICK_MS ? MSG_WHEEL_TICK_MS : delay;
+}
+
+static void release_slot(PendingMessage* msg) {
+    timer_wheel_cancel(&retry_wheel, &msg->timer);
+    msg->active = false;
+    free_slots[free_count++] = (uint32_t)(msg - pending_msgs);
+}
 
+bool MessageHandler_SendTracked(const uint8_t* data, uint32_t len, uint32_t* id) {
+    if(!msg_handler_init || !data || !len || len > MSG_MAX_LENGTH) return false;
+    if(free_count == 0) return false;
+
+    uint32_t slot = free_slots[--free_count];
     PendingMessage* msg = &pending_msgs[slot];
+
+    // The low bits name the slot so an ack finds it without a search
+    msg_id++;
+    msg->id = (msg_id << MSG_SLOT_BITS) | slot;
     memcpy(msg->data, data, len);
     msg->length = len;
-    msg->timestamp = TIMER_GetMs();
     msg->retries = 0;
     msg->active = true;
+    timer_wheel_entry_init(&msg->timer);
+    timer_wheel_schedule(&retry_wheel, &msg->timer, TIMER_GetMs(), retry_delay(0));
+    tx_count++;
 
-    return NetworkHandler_Send(data, len);
+    if(id) *id = msg->id;
+    return NetworkHandler_Send(msg->data, len);
 }
 
-void cleanup_old_messages(void) {
-    uint32_t current_time = TIMER_GetMs();
-    
-    for(uint32_t i = 0; i < MAX_PENDING_MSGS; i++) {
-        if(pending_msgs[i].active) {
-            if((current_time - pending_msgs[i].timestamp) > MSG_TIMEOUT_MS) {
-                pending_msgs[i].active = false;
-            }
-        }
-    }
+bool MessageHandler_Send(uint8_t* data, uint32_t len) {
+    return MessageHandler_SendTracked(data, len, NULL);
+}
+
+bool MessageHandler_Ack(uint32_t id) {
+    if(!msg_handler_init) return false;
+
+    PendingMessage* msg = &pending_msgs[id & MSG_SLOT_MASK];
+    if(!msg->active || msg->id != id) return false;
+
+    release_slot(msg);
+    return true;
 }
 
 void MessageHandler_Process(void) {
     if(!msg_handler_init) return;
     
     uint32_t current_time = TIMER_GetMs();
-    
-    if((current_time - last_cleanup) > 1000) {
-        cleanup_old_messages();
-        last_cleanup = current_time;
-    }
 
-    for(uint32_t i = 0; i < MAX_PENDING_MSGS; i++) {
-        if(pending_msgs[i].active) {
-            uint32_t age = current_time - pending_msgs[i].timestamp;
-            
-            if(age > (50 * (pending_msgs[i].retries + 1))) {
-                if(pending_msgs[i].retries < 3) {
-                    NetworkHandler_Send(pending_msgs[i].data, pending_msgs[i].length);
-                    pending_msgs[i].timestamp = current_time;
-                    pending_msgs[i].retries++;
-                } else {
-                    pending_msgs[i].active = false;
-                }
-            }
+    // Frames queued by MessageHandler_HandleResponse are routed here
+    Framer_Process(&rx_framer);
+
+    // Only messages whose retry deadline has passed are touched
+    TimerWheelEntry* entry;
+    while((entry = timer_wheel_expire(&retry_wheel, current_time)) != NULL) {
+        PendingMessage* msg = (PendingMessage*)entry;
+
+        if(msg->retries < retry_policy.max_retries) {
+            NetworkHandler_Send(msg->data, msg->length);
+            msg->retries++;
+            timer_wheel_schedule(&retry_wheel, &msg->timer, current_time, retry_delay(msg->retries));
+        } else {
+            timeout_count++;
+            release_slot(msg);
         }
     }
 }
 
+// Called from the receive interrupts; only queues the bytes
 void MessageHandler_HandleResponse(uint8_t* data, uint32_t len) {
     if(!msg_handler_init || !data || !len) return;
-    
-    if(rx_len + len > sizeof(rx_buffer)) {
-        rx_len = 0;
-        return;
-    }
-
-    memcpy(&rx_buffer[rx_len], data, len);
-    rx_len += len;
 
-    process_rx_buffer();
-}
-
-static void process_rx_buffer(void) {
-    uint32_t processed = 0;
-    
-    while((rx_len - processed) >= 4) {
-        if(rx_buffer[processed] == 0x55) {
-            uint16_t msg_len = rx_buffer[processed + 1];
-            if((rx_len - processed) >= (msg_len + 4)) {
-                uint8_t checksum = 0;
-                for(uint32_t i = 0; i < msg_len + 2; i++) {
-                    checksum += rx_buffer[processed + i];
-                }
-                
-                if(checksum == rx_buffer[processed + msg_len + 2]) {
-                    DiagRouter_HandleMessage(&rx_buffer[processed + 2], msg_len);
-                    processed += msg_len + 4;
-                } else {
-                    processed++;
-                }
-            } else {
-                break;
-            }
-        } else {
-            processed++;
-        }
-    }
-
-    if(processed > 0) {
-        if(processed < rx_len) {
-            memmove(rx_buffer, &rx_buffer[processed], rx_len - processed);
-            rx_len -= processed;
-        } else {
-            rx_len = 0;
-        }
-    }
+    Framer_Write(&rx_framer, data, len);
 }
 
 uint32_t get_msg_count(void) {
-    uint32_t count = 0;
-    for(uint32_t i = 0; i < MAX_PENDING_MSGS; i++) {
-        if(pending_msgs[i].active) count++;
-    }
-    return count;
+    return MSG_MAX_PENDING - free_count;
 }
 
 bool check_message_timeout(uint32_t timestamp) {
     return (TIMER_GetMs() - timestamp) > MSG_TIMEOUT_MS;
 }
 
-static uint8_t last_error = 0;
-static uint32_t error_count = 0; 
\ No newline at end of file
+void MessageHandler_GetStats(MessageStats* stats) {
+    if(!stats) return;
+
+    FramerStats framer_stats;
+    Framer_GetStats(&rx_framer, &framer_stats);
+
+    stats->rx_count = framer_stats.frames;
+    stats->tx_count = tx_count;
+    stats->error_count = error_count;
+    stats->timeout_count = timeout_count;
+    stats->resync_count = framer_stats.resyncs;
+    stats->overflow_count = framer_stats.overflows;
+}
+
+void MessageHandler_ResetStats(void) {
+    Framer_ResetStats(&rx_framer);
+    tx_count = 0;
+    timeout_count = 0;
+    error_count = 0;
+}
@@ -3,9 +3,40 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "buffer_manager.h"
+
+// In-flight capacity is 1 << MSG_SLOT_BITS; message ids carry the slot
+// in their low bits
+#ifndef MSG_SLOT_BITS
+#define MSG_SLOT_BITS 11
+#endif
+#define MSG_MAX_PENDING (1u << MSG_SLOT_BITS)
+#define MSG_MAX_LENGTH 256
+
+typedef enum {
+    RETRY_BACKOFF_FIXED,
+    RETRY_BACKOFF_LINEAR,         // base_ms * (retries + 1)
+    RETRY_BACKOFF_EXPONENTIAL     // base_ms << retries
+} RetryBackoff;
+
+typedef struct {
+    RetryBackoff backoff;
+    uint32_t base_ms;
+    uint32_t max_ms;              // Cap on any single delay, below 2^31
+    uint8_t max_retries;          // Resends before the message times out
+} RetryPolicy;
 
 bool MessageHandler_Init(void);
+bool MessageHandler_SetRetryPolicy(const RetryPolicy* policy);
 bool MessageHandler_Send(uint8_t* data, uint32_t len);
+bool MessageHandler_SendTracked(const uint8_t* data, uint32_t len, uint32_t* id);
+bool MessageHandler_Ack(uint32_t id);
+
+// Received frames are shared, not copied. A listener that keeps the frame
+// past the call takes its own reference with BufferManager_Retain.
+#define MSG_MAX_LISTENERS 4
+typedef void (*FrameListener)(BufferDesc* frame, void* context);
+bool MessageHandler_AddListener(FrameListener listener, void* context);
 void MessageHandler_Process(void);
 void MessageHandler_HandleResponse(uint8_t* data, uint32_t len);
 uint32_t get_msg_count(void);
@@ -15,6 +46,8 @@ typedef struct {
     uint32_t tx_count;
     uint32_t error_count;
     uint32_t timeout_count;
+    uint32_t resync_count;      // Framer lost sync (garbage or bad checksum)
+    uint32_t overflow_count;    // Received chunks that did not fit the RX ring
 } MessageStats;
 
 void MessageHandler_GetStats(MessageStats* stats);
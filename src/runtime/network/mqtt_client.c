@@ -0,0 +1,672 @@
+#include "mqtt_client.h"
+#include "../diagnostic/logging/diag_logger.h"
+#include "../diagnostic/os/critical.h"
+#include "../diagnostic/os/timer.h"
+#include <string.h>
+
+#define INFLIGHT_MASK   (MQTT_MAX_INFLIGHT - 1)
+#define QUEUE_MASK      (MQTT_TX_QUEUE_SIZE - 1)
+#define HEADER_MAX      (1 + 4 + 2 + MQTT_TOPIC_MAX + 2)
+#define MAX_REMAINING   268435455u    // Four length bytes
+#define GENERATIONS     (0xFFFFu >> MQTT_INFLIGHT_BITS)
+
+_Static_assert((MQTT_TX_QUEUE_SIZE & QUEUE_MASK) == 0, "queue size must be a power of two");
+_Static_assert(MQTT_INFLIGHT_BITS < 16, "packet ids are 16 bits");
+
+// Fixed header packet types
+#define PKT_CONNECT     0x10
+#define PKT_CONNACK     0x20
+#define PKT_PUBLISH     0x30
+#define PKT_PUBACK      0x40
+#define PKT_SUBSCRIBE   0x82    // Flags 0010 are mandatory
+#define PKT_SUBACK      0x90
+#define PKT_PINGREQ     0xC0
+#define PKT_PINGRESP    0xD0
+#define PKT_DISCONNECT  0xE0
+
+#define PUBLISH_DUP     0x08
+#define PUBLISH_RETAIN  0x01
+
+typedef struct {
+    const char* topic;
+    const uint8_t* payload;
+    uint32_t length;
+    uint16_t topic_length;
+    uint16_t packet_id;     // 0 for QoS 0
+    uint8_t flags;          // PUBLISH fixed header flags
+} Pending;
+
+typedef struct {
+    Pending publish;
+    uint32_t sent_ms;
+    bool active;
+    bool queued;            // Waiting in the TX queue for its (re)send
+} Inflight;
+
+static struct {
+    MQTTConfig config;
+    MqttClientOptions options;
+    MqttState state;
+
+    Pending queue[MQTT_TX_QUEUE_SIZE];
+    uint32_t queue_head;
+    uint32_t queue_tail;
+
+    // Packet ids are (generation << MQTT_INFLIGHT_BITS) | slot, so a PUBACK
+    // finds its slot without a search. Generation 0 is left to SUBSCRIBE.
+    Inflight inflight[MQTT_MAX_INFLIGHT];
+    uint16_t free_slots[MQTT_MAX_INFLIGHT];
+    uint32_t free_count;
+    uint32_t inflight_count;
+    uint16_t generation;
+    uint16_t subscribe_id;
+
+    uint8_t headers[MQTT_BATCH_MAX][HEADER_MAX];
+    uint8_t rx[MQTT_RX_BUFFER_SIZE];
+    uint32_t rx_length;
+    uint32_t rx_skip;       // Bytes left of a packet too large to keep
+    uint32_t rx_epoch;      // Bumped whenever the receive state is reset
+
+    uint32_t last_tx_ms;
+    uint32_t ping_sent_ms;
+    bool ping_outstanding;
+    MqttStats stats;
+    bool initialized;
+} mqtt;
+
+static uint32_t encode_length(uint8_t* out, uint32_t length) {
+    uint32_t count = 0;
+    do {
+        uint8_t byte = length & 0x7F;
+        length >>= 7;
+        out[count++] = byte | (length ? 0x80 : 0);
+    } while (length);
+    return count;
+}
+
+// Returns 1 when decoded, 0 when more bytes are needed, -1 if malformed
+static int decode_length(const uint8_t* data, uint32_t available,
+                         uint32_t* length, uint32_t* used) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i >= available) {
+            return 0;
+        }
+        value |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80)) {
+            *length = value;
+            *used = i + 1;
+            return 1;
+        }
+    }
+    return -1;
+}
+
+static uint8_t* put_u16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)(value >> 8);
+    out[1] = (uint8_t)value;
+    return out + 2;
+}
+
+static uint8_t* put_string(uint8_t* out, const char* text, uint16_t length) {
+    out = put_u16(out, length);
+    memcpy(out, text, length);
+    return out + length;
+}
+
+static uint16_t get_u16(const uint8_t* data) {
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static void reset_receive(void) {
+    mqtt.rx_length = 0;
+    mqtt.rx_skip = 0;
+    mqtt.rx_epoch++;
+}
+
+static bool send_segments(const NetIoVec* iov, uint32_t count, bool more) {
+    NetMessageV message = {
+        .iov = iov,
+        .iov_count = count,
+        .protocol = NET_PROTO_TCP,
+        .flags = more ? NET_MSG_FLAG_MORE : 0
+    };
+    if (!Net_SendMessageV(&message)) {
+        return false;
+    }
+    mqtt.last_tx_ms = Timer_GetMilliseconds();
+    return true;
+}
+
+static bool send_packet(const uint8_t* data, uint32_t length) {
+    NetIoVec iov = { data, length };
+    return send_segments(&iov, 1, false);
+}
+
+static void lose_session(const char* reason) {
+    Logger_Log(LOG_LEVEL_WARNING, "MQTT", "Session lost: %s", reason);
+    mqtt.state = MQTT_STATE_DISCONNECTED;
+    mqtt.ping_outstanding = false;
+    reset_receive();
+}
+
+static bool queue_push(const Pending* pending) {
+    if (mqtt.queue_head - mqtt.queue_tail >= MQTT_TX_QUEUE_SIZE) {
+        return false;
+    }
+    mqtt.queue[mqtt.queue_head & QUEUE_MASK] = *pending;
+    mqtt.queue_head++;
+    return true;
+}
+
+// A queued QoS 1 resend whose PUBACK arrived meanwhile must not go out:
+// its payload may already be back with the caller
+static bool still_wanted(const Pending* pending) {
+    if (!pending->packet_id) {
+        return true;
+    }
+    const Inflight* slot = &mqtt.inflight[pending->packet_id & INFLIGHT_MASK];
+    return slot->active && slot->publish.packet_id == pending->packet_id;
+}
+
+static uint32_t encode_publish_header(uint8_t* out, const Pending* pending) {
+    uint32_t remaining = 2 + pending->topic_length + (pending->packet_id ? 2 : 0) +
+                         pending->length;
+    uint8_t* cursor = out;
+
+    *cursor++ = PKT_PUBLISH | pending->flags;
+    cursor += encode_length(cursor, remaining);
+    cursor = put_string(cursor, pending->topic, pending->topic_length);
+    if (pending->packet_id) {
+        cursor = put_u16(cursor, pending->packet_id);
+    }
+    return (uint32_t)(cursor - out);
+}
+
+static void requeue_inflight(void) {
+    for (uint32_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        Inflight* slot = &mqtt.inflight[i];
+        if (slot->active && !slot->queued) {
+            slot->publish.flags |= PUBLISH_DUP;
+            if (!queue_push(&slot->publish)) {
+                break;    // The rest go on the next retry pass
+            }
+            slot->queued = true;
+            mqtt.stats.retransmits++;
+        }
+    }
+}
+
+bool MqttClient_Init(const MQTTConfig* config, const MqttClientOptions* options) {
+    if (!config || !config->client_id[0]) {
+        return false;
+    }
+    if (config->use_ssl) {
+        Logger_Log(LOG_LEVEL_ERROR, "MQTT", "TLS is not supported");
+        return false;
+    }
+
+    enter_critical();
+
+    memset(&mqtt, 0, sizeof(mqtt));
+    memcpy(&mqtt.config, config, sizeof(MQTTConfig));
+    if (options) {
+        memcpy(&mqtt.options, options, sizeof(MqttClientOptions));
+    }
+    if (!mqtt.options.inflight_window || mqtt.options.inflight_window > MQTT_MAX_INFLIGHT) {
+        mqtt.options.inflight_window = MQTT_MAX_INFLIGHT;
+    }
+
+    for (uint32_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        mqtt.free_slots[i] = (uint16_t)(MQTT_MAX_INFLIGHT - 1 - i);
+    }
+    mqtt.free_count = MQTT_MAX_INFLIGHT;
+    mqtt.initialized = true;
+
+    exit_critical();
+
+    Logger_Log(LOG_LEVEL_INFO, "MQTT", "Client %s initialized", config->client_id);
+    return true;
+}
+
+void MqttClient_Deinit(void) {
+    enter_critical();
+    if (mqtt.state != MQTT_STATE_DISCONNECTED) {
+        MqttClient_Disconnect();
+    }
+    memset(&mqtt, 0, sizeof(mqtt));
+    exit_critical();
+}
+
+bool MqttClient_Connect(void) {
+    if (!mqtt.initialized) {
+        return false;
+    }
+
+    uint16_t id_length = (uint16_t)strnlen(mqtt.config.client_id, sizeof(mqtt.config.client_id));
+    uint16_t user_length = (uint16_t)strnlen(mqtt.config.username, sizeof(mqtt.config.username));
+    uint16_t pass_length = (uint16_t)strnlen(mqtt.config.password, sizeof(mqtt.config.password));
+    uint8_t packet[16 + sizeof(mqtt.config.client_id) + sizeof(mqtt.config.username) +
+                   sizeof(mqtt.config.password)];
+
+    uint8_t flags = mqtt.config.clean_session ? 0x02 : 0;
+    uint32_t remaining = 10 + 2 + id_length;
+    if (user_length) {
+        flags |= 0x80;
+        remaining += 2 + user_length;
+    }
+    if (pass_length) {
+        flags |= 0x40;
+        remaining += 2 + pass_length;
+    }
+
+    uint8_t* cursor = packet;
+    *cursor++ = PKT_CONNECT;
+    cursor += encode_length(cursor, remaining);
+    cursor = put_string(cursor, "MQTT", 4);
+    *cursor++ = 4;    // Protocol level 3.1.1
+    *cursor++ = flags;
+    cursor = put_u16(cursor, mqtt.config.keep_alive_interval);
+    cursor = put_string(cursor, mqtt.config.client_id, id_length);
+    if (user_length) {
+        cursor = put_string(cursor, mqtt.config.username, user_length);
+    }
+    if (pass_length) {
+        cursor = put_string(cursor, mqtt.config.password, pass_length);
+    }
+
+    enter_critical();
+
+    // Publishes written but not acknowledged go again once CONNACK is in
+    reset_receive();
+    mqtt.ping_outstanding = false;
+
+    bool sent = send_packet(packet, (uint32_t)(cursor - packet));
+    mqtt.state = sent ? MQTT_STATE_CONNECTING : MQTT_STATE_DISCONNECTED;
+
+    exit_critical();
+
+    if (!sent) {
+        Logger_Log(LOG_LEVEL_ERROR, "MQTT", "Failed to send CONNECT");
+    }
+    return sent;
+}
+
+void MqttClient_Disconnect(void) {
+    const uint8_t packet[] = { PKT_DISCONNECT, 0 };
+
+    enter_critical();
+    if (mqtt.state == MQTT_STATE_CONNECTED) {
+        MqttClient_Flush();
+        send_packet(packet, sizeof(packet));
+    }
+    mqtt.state = MQTT_STATE_DISCONNECTED;
+    mqtt.ping_outstanding = false;
+    reset_receive();
+    exit_critical();
+}
+
+MqttState MqttClient_GetState(void) {
+    return mqtt.state;
+}
+
+bool MqttClient_Publish(const MqttPublish* publish, uint16_t* packet_id) {
+    if (!mqtt.initialized || !publish || !publish->topic || publish->qos > 1 ||
+        (publish->length && !publish->payload)) {
+        return false;
+    }
+
+    size_t topic_length = strnlen(publish->topic, MQTT_TOPIC_MAX + 1);
+    if (topic_length == 0 || topic_length > MQTT_TOPIC_MAX ||
+        strpbrk(publish->topic, "+#") ||
+        publish->length > MAX_REMAINING - HEADER_MAX) {
+        return false;
+    }
+
+    Pending pending = {
+        .topic = publish->topic,
+        .payload = publish->payload,
+        .length = publish->length,
+        .topic_length = (uint16_t)topic_length,
+        .flags = (uint8_t)((publish->qos << 1) | (publish->retain ? PUBLISH_RETAIN : 0))
+    };
+
+    enter_critical();
+
+    if (mqtt.queue_head - mqtt.queue_tail >= MQTT_TX_QUEUE_SIZE) {
+        exit_critical();
+        return false;
+    }
+
+    if (publish->qos == 1) {
+        if (mqtt.inflight_count >= mqtt.options.inflight_window || !mqtt.free_count) {
+            mqtt.stats.window_full++;
+            exit_critical();
+            return false;
+        }
+
+        uint32_t slot = mqtt.free_slots[--mqtt.free_count];
+        if (++mqtt.generation > GENERATIONS) {
+            mqtt.generation = 1;
+        }
+        pending.packet_id = (uint16_t)((mqtt.generation << MQTT_INFLIGHT_BITS) | slot);
+
+        Inflight* entry = &mqtt.inflight[slot];
+        entry->publish = pending;
+        entry->active = true;
+        entry->queued = true;
+        mqtt.inflight_count++;
+    }
+
+    queue_push(&pending);
+    if (packet_id) {
+        *packet_id = pending.packet_id;
+    }
+
+    exit_critical();
+    return true;
+}
+
+bool MqttClient_Subscribe(const char* topic, uint8_t qos, uint16_t* packet_id) {
+    if (!topic || mqtt.state != MQTT_STATE_CONNECTED) {
+        return false;
+    }
+
+    size_t topic_length = strnlen(topic, MQTT_TOPIC_MAX + 1);
+    if (topic_length == 0 || topic_length > MQTT_TOPIC_MAX) {
+        return false;
+    }
+
+    uint8_t packet[HEADER_MAX + 1];
+    uint8_t* cursor = packet;
+
+    enter_critical();
+
+    if (++mqtt.subscribe_id >= MQTT_MAX_INFLIGHT) {
+        mqtt.subscribe_id = 1;
+    }
+    uint16_t id = mqtt.subscribe_id;
+
+    *cursor++ = PKT_SUBSCRIBE;
+    cursor += encode_length(cursor, (uint32_t)(2 + 2 + topic_length + 1));
+    cursor = put_u16(cursor, id);
+    cursor = put_string(cursor, topic, (uint16_t)topic_length);
+    *cursor++ = qos > 1 ? 1 : qos;    // QoS 2 is not handled
+
+    bool sent = send_packet(packet, (uint32_t)(cursor - packet));
+
+    exit_critical();
+
+    if (sent && packet_id) {
+        *packet_id = id;
+    }
+    return sent;
+}
+
+bool MqttClient_Flush(void) {
+    if (mqtt.state != MQTT_STATE_CONNECTED) {
+        return false;
+    }
+
+    enter_critical();
+
+    bool result = true;
+    while (mqtt.queue_tail != mqtt.queue_head) {
+        NetIoVec iov[NET_MAX_IOV];
+        uint32_t segments = 0;
+        uint32_t packets = 0;
+        uint32_t position = mqtt.queue_tail;
+
+        while (position != mqtt.queue_head && packets < MQTT_BATCH_MAX) {
+            const Pending* pending = &mqtt.queue[position & QUEUE_MASK];
+            position++;
+            if (!still_wanted(pending)) {
+                continue;
+            }
+
+            uint8_t* header = mqtt.headers[packets++];
+            iov[segments].data = header;
+            iov[segments++].length = encode_publish_header(header, pending);
+            if (pending->length) {
+                iov[segments].data = pending->payload;
+                iov[segments++].length = pending->length;
+            }
+        }
+
+        // Later batches follow at once, so let TCP fill the segment
+        if (packets && !send_segments(iov, segments, position != mqtt.queue_head)) {
+            result = false;
+            break;    // Socket backlog full; retry on the next Process
+        }
+
+        uint32_t now = Timer_GetMilliseconds();
+        for (; mqtt.queue_tail != position; mqtt.queue_tail++) {
+            const Pending* pending = &mqtt.queue[mqtt.queue_tail & QUEUE_MASK];
+            if (pending->packet_id && still_wanted(pending)) {
+                Inflight* slot = &mqtt.inflight[pending->packet_id & INFLIGHT_MASK];
+                slot->queued = false;
+                slot->sent_ms = now;
+            }
+        }
+
+        if (packets) {
+            mqtt.stats.published += packets;
+            mqtt.stats.batches++;
+        }
+    }
+
+    exit_critical();
+    return result;
+}
+
+static void handle_puback(uint16_t packet_id) {
+    Inflight* slot = &mqtt.inflight[packet_id & INFLIGHT_MASK];
+    if (!slot->active || slot->publish.packet_id != packet_id) {
+        return;    // Duplicate ack or a SUBSCRIBE id
+    }
+
+    slot->active = false;
+    mqtt.free_slots[mqtt.free_count++] = (uint16_t)(packet_id & INFLIGHT_MASK);
+    mqtt.inflight_count--;
+    mqtt.stats.delivered++;
+
+    if (mqtt.options.on_delivered) {
+        mqtt.options.on_delivered(packet_id, mqtt.options.context);
+    }
+}
+
+static bool handle_publish(uint8_t flags, const uint8_t* body, uint32_t length) {
+    uint8_t qos = (flags >> 1) & 0x03;
+    if (length < 2 || qos > 1) {
+        return false;
+    }
+
+    uint16_t topic_length = get_u16(body);
+    uint32_t offset = 2u + topic_length + (qos ? 2u : 0u);
+    if (offset > length) {
+        return false;
+    }
+
+    mqtt.stats.received++;
+    if (mqtt.options.on_message) {
+        mqtt.options.on_message((const char*)body + 2, topic_length, body + offset,
+                                length - offset, mqtt.options.context);
+    }
+
+    if (qos == 1) {
+        uint8_t ack[4] = { PKT_PUBACK, 2 };
+        memcpy(&ack[2], body + 2 + topic_length, 2);
+        send_packet(ack, sizeof(ack));
+    }
+    return true;
+}
+
+static bool handle_packet(uint8_t type, const uint8_t* body, uint32_t length) {
+    switch (type & 0xF0) {
+        case PKT_CONNACK:
+            if (length != 2) {
+                return false;
+            }
+            if (body[1] != 0) {
+                Logger_Log(LOG_LEVEL_ERROR, "MQTT", "Broker refused connection: %u", body[1]);
+                mqtt.state = MQTT_STATE_DISCONNECTED;
+                return true;
+            }
+            mqtt.state = MQTT_STATE_CONNECTED;
+            requeue_inflight();
+            Logger_Log(LOG_LEVEL_INFO, "MQTT", "Connected");
+            return true;
+
+        case PKT_PUBACK:
+            if (length != 2) {
+                return false;
+            }
+            handle_puback(get_u16(body));
+            return true;
+
+        case PKT_PUBLISH:
+            return handle_publish(type & 0x0F, body, length);
+
+        case PKT_SUBACK:
+            if (length < 3) {
+                return false;
+            }
+            if (body[2] == 0x80) {
+                Logger_Log(LOG_LEVEL_WARNING, "MQTT", "Subscription %u refused", get_u16(body));
+            }
+            return true;
+
+        case PKT_PINGRESP:
+            mqtt.ping_outstanding = false;
+            return true;
+
+        default:
+            return false;    // Nothing else is valid from a broker to this client
+    }
+}
+
+static void parse_received(void) {
+    uint32_t offset = 0;
+    uint32_t epoch = mqtt.rx_epoch;
+
+    while (offset < mqtt.rx_length) {
+        uint32_t available = mqtt.rx_length - offset;
+
+        if (mqtt.rx_skip) {
+            uint32_t skip = available < mqtt.rx_skip ? available : mqtt.rx_skip;
+            mqtt.rx_skip -= skip;
+            offset += skip;
+            continue;
+        }
+
+        const uint8_t* packet = &mqtt.rx[offset];
+        uint32_t remaining;
+        uint32_t used;
+        int status = decode_length(packet + 1, available - 1, &remaining, &used);
+        if (status == 0) {
+            break;
+        }
+        if (status < 0) {
+            mqtt.stats.protocol_errors++;
+            lose_session("malformed packet");
+            return;
+        }
+
+        uint32_t total = 1 + used + remaining;
+        if (total > MQTT_RX_BUFFER_SIZE) {
+            mqtt.stats.protocol_errors++;
+            mqtt.rx_skip = total;
+            continue;
+        }
+        if (available < total) {
+            break;
+        }
+
+        if (!handle_packet(packet[0], packet + 1 + used, remaining)) {
+            mqtt.stats.protocol_errors++;
+            lose_session("unexpected packet");
+            return;
+        }
+        if (epoch != mqtt.rx_epoch) {
+            return;    // A callback reconnected or disconnected
+        }
+        offset += total;
+    }
+
+    memmove(mqtt.rx, &mqtt.rx[offset], mqtt.rx_length - offset);
+    mqtt.rx_length -= offset;
+}
+
+static void receive(void) {
+    while (mqtt.rx_length < MQTT_RX_BUFFER_SIZE) {
+        NetMessage message = {
+            .data = &mqtt.rx[mqtt.rx_length],
+            .length = MQTT_RX_BUFFER_SIZE - mqtt.rx_length,
+            .protocol = NET_PROTO_TCP
+        };
+        if (!Net_ReceiveMessage(&message)) {
+            break;
+        }
+        mqtt.rx_length += message.length;
+        parse_received();
+    }
+}
+
+static void run_timers(uint32_t now) {
+    uint32_t keep_alive_ms = (uint32_t)mqtt.config.keep_alive_interval * 1000;
+
+    if (mqtt.state == MQTT_STATE_CONNECTED && keep_alive_ms) {
+        if (mqtt.ping_outstanding && now - mqtt.ping_sent_ms >= keep_alive_ms) {
+            lose_session("no PINGRESP");
+            return;
+        }
+        if (!mqtt.ping_outstanding && now - mqtt.last_tx_ms >= keep_alive_ms) {
+            const uint8_t ping[] = { PKT_PINGREQ, 0 };
+            if (send_packet(ping, sizeof(ping))) {
+                mqtt.ping_outstanding = true;
+                mqtt.ping_sent_ms = now;
+            }
+        }
+    }
+
+    if (mqtt.state != MQTT_STATE_CONNECTED || !mqtt.options.retry_interval_ms) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        Inflight* slot = &mqtt.inflight[i];
+        if (slot->active && !slot->queued &&
+            now - slot->sent_ms >= mqtt.options.retry_interval_ms) {
+            slot->publish.flags |= PUBLISH_DUP;
+            if (!queue_push(&slot->publish)) {
+                break;
+            }
+            slot->queued = true;
+            mqtt.stats.retransmits++;
+        }
+    }
+}
+
+void MqttClient_Process(void) {
+    if (!mqtt.initialized || mqtt.state == MQTT_STATE_DISCONNECTED) {
+        return;
+    }
+
+    enter_critical();
+    receive();
+    run_timers(Timer_GetMilliseconds());
+    MqttClient_Flush();
+    exit_critical();
+}
+
+uint32_t MqttClient_GetInflightCount(void) {
+    return mqtt.inflight_count;
+}
+
+void MqttClient_GetStats(MqttStats* stats) {
+    if (stats) {
+        enter_critical();
+        memcpy(stats, &mqtt.stats, sizeof(MqttStats));
+        exit_critical();
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef CANT_MQTT_CLIENT_H
+#define CANT_MQTT_CLIENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "net_protocol.h"
+
+// MQTT 3.1.1 client on the net_core TCP stream. Publishes are queued and
+// written in batches: each packet is a header segment plus the caller's
+// payload, and a whole batch goes out in one vectored send. QoS 1
+// publishes stay in an in-flight window until the broker's PUBACK.
+
+// In-flight capacity is 1 << MQTT_INFLIGHT_BITS; packet ids carry the
+// slot in their low bits
+#ifndef MQTT_INFLIGHT_BITS
+#define MQTT_INFLIGHT_BITS  5
+#endif
+#define MQTT_MAX_INFLIGHT   (1u << MQTT_INFLIGHT_BITS)
+#define MQTT_TX_QUEUE_SIZE  64      // Queued publishes, power of two
+#define MQTT_BATCH_MAX      (NET_MAX_IOV / 2)
+#define MQTT_TOPIC_MAX      128
+#define MQTT_RX_BUFFER_SIZE 1024    // Largest packet accepted from the broker
+
+typedef enum {
+    MQTT_STATE_DISCONNECTED = 0,
+    MQTT_STATE_CONNECTING,          // CONNECT sent, waiting for CONNACK
+    MQTT_STATE_CONNECTED
+} MqttState;
+
+// Payload and topic are not copied. They must stay valid until the batch
+// holding them is written (QoS 0) or until on_delivered (QoS 1).
+typedef struct {
+    const char* topic;
+    const uint8_t* payload;
+    uint32_t length;
+    uint8_t qos;                    // 0 or 1
+    bool retain;
+} MqttPublish;
+
+typedef void (*MqttDeliveredCallback)(uint16_t packet_id, void* context);
+typedef void (*MqttMessageCallback)(const char* topic, uint16_t topic_length,
+                                    const uint8_t* payload, uint32_t length, void* context);
+
+typedef struct {
+    uint8_t inflight_window;        // QoS 1 publishes awaiting PUBACK, 0 = MQTT_MAX_INFLIGHT
+    uint32_t retry_interval_ms;     // Resend unacknowledged publishes, 0 = only on reconnect
+    MqttDeliveredCallback on_delivered;
+    MqttMessageCallback on_message;
+    void* context;
+} MqttClientOptions;
+
+typedef struct {
+    uint32_t published;             // PUBLISH packets written
+    uint32_t delivered;             // QoS 1 publishes acknowledged
+    uint32_t retransmits;
+    uint32_t batches;               // Vectored writes carrying publishes
+    uint32_t window_full;           // QoS 1 publishes refused by the window
+    uint32_t received;              // PUBLISH packets from the broker
+    uint32_t protocol_errors;
+} MqttStats;
+
+// Uses client_id, username, password, keep_alive_interval and
+// clean_session from the config. TLS (use_ssl) is not supported.
+bool MqttClient_Init(const MQTTConfig* config, const MqttClientOptions* options);
+void MqttClient_Deinit(void);
+
+// Sends CONNECT over the connected TCP interface. Publishes still in
+// flight are resent with DUP once the session is back.
+bool MqttClient_Connect(void);
+void MqttClient_Disconnect(void);
+MqttState MqttClient_GetState(void);
+
+// Queues a publish. A QoS 1 publish gets a packet id, or false when the
+// in-flight window or the queue is full.
+bool MqttClient_Publish(const MqttPublish* publish, uint16_t* packet_id);
+bool MqttClient_Subscribe(const char* topic, uint8_t qos, uint16_t* packet_id);
+
+// Writes queued publishes now instead of at the next Process
+bool MqttClient_Flush(void);
+
+// Parses bytes the stack has received, runs keep-alive and retransmit
+// timers and flushes the queue. Call after Net_Process/Net_Wait.
+void MqttClient_Process(void);
+
+uint32_t MqttClient_GetInflightCount(void);
+void MqttClient_GetStats(MqttStats* stats);
+
+#endif // CANT_MQTT_CLIENT_H
@@ -16,12 +16,32 @@ bool NetBuffer_Init(NetBuffer* buffer, uint32_t size) {
     }
 
     buffer->size = size;
+    buffer->mode = NET_BUFFER_LOCKED;
+    buffer->mask = 0;
     NetBuffer_Reset(buffer);
     
     Logger_Log(LOG_LEVEL_DEBUG, "NETBUF", "Initialized buffer of size %u", size);
     return true;
 }
 
+bool NetBuffer_InitSpsc(NetBuffer* buffer, uint32_t size) {
+    // Free-running indices need a power of two no larger than half the
+    // index range so head - tail never aliases
+    if (!buffer || size == 0 || (size & (size - 1)) || size > 0x80000000u) {
+        Logger_Log(LOG_LEVEL_ERROR, "NETBUF", "SPSC size %u is not a power of two", size);
+        return false;
+    }
+
+    if (!NetBuffer_Init(buffer, size)) {
+        return false;
+    }
+
+    buffer->mode = NET_BUFFER_SPSC;
+    buffer->mask = size - 1;
+    NetBuffer_Reset(buffer);
+    return true;
+}
+
 void NetBuffer_Deinit(NetBuffer* buffer) {
     if (!buffer) {
         return;
@@ -37,8 +57,16 @@ void NetBuffer_Deinit(NetBuffer* buffer) {
     buffer->write_index = 0;
     buffer->count = 0;
     buffer->overflow = false;
+    buffer->mode = NET_BUFFER_LOCKED;
+    buffer->mask = 0;
+    atomic_store_explicit(&buffer->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&buffer->tail, 0, memory_order_relaxed);
+    buffer->reserved = 0;
+    buffer->peeked = 0;
 }
 
+// Stale bytes are never readable, so the ring is not cleared. In SPSC mode
+// both sides must be idle while the buffer is reset.
 void NetBuffer_Reset(NetBuffer* buffer) {
     if (!buffer) {
         return;
@@ -48,17 +76,83 @@ void NetBuffer_Reset(NetBuffer* buffer) {
     buffer->write_index = 0;
     buffer->count = 0;
     buffer->overflow = false;
-    
-    if (buffer->data) {
-        memset(buffer->data, 0, buffer->size);
+
+    atomic_store_explicit(&buffer->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&buffer->tail, 0, memory_order_relaxed);
+    buffer->reserved = 0;
+    buffer->peeked = 0;
+}
+
+// SPSC helpers. The producer owns head and publishes data with a release
+// store; the consumer owns tail and hands space back the same way. Each
+// side loads the other's index with acquire so the copied bytes are
+// ordered against the index update.
+static inline uint32_t spsc_used(const NetBuffer* buffer) {
+    uint32_t tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+    return head - tail;
+}
+
+static void spsc_copy_out(const NetBuffer* buffer, uint32_t tail, uint8_t* data, uint32_t length) {
+    uint32_t offset = tail & buffer->mask;
+    uint32_t first_chunk = buffer->size - offset;
+    if (length <= first_chunk) {
+        memcpy(data, buffer->data + offset, length);
+    } else {
+        memcpy(data, buffer->data + offset, first_chunk);
+        memcpy(data + first_chunk, buffer->data, length - first_chunk);
     }
 }
 
+static bool spsc_write(NetBuffer* buffer, const uint8_t* data, uint32_t length) {
+    uint32_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+
+    if (length > buffer->size - (head - tail)) {
+        // No logging here: the producer may be an ISR
+        __atomic_store_n(&buffer->overflow, true, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    uint32_t offset = head & buffer->mask;
+    uint32_t first_chunk = buffer->size - offset;
+    if (length <= first_chunk) {
+        memcpy(buffer->data + offset, data, length);
+    } else {
+        memcpy(buffer->data + offset, data, first_chunk);
+        memcpy(buffer->data, data + first_chunk, length - first_chunk);
+    }
+
+    // A copying write supersedes any outstanding reservation
+    buffer->reserved = 0;
+    atomic_store_explicit(&buffer->head, head + length, memory_order_release);
+    return true;
+}
+
+static bool spsc_read(NetBuffer* buffer, uint8_t* data, uint32_t length) {
+    uint32_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+
+    if (length > head - tail) {
+        return false;
+    }
+
+    spsc_copy_out(buffer, tail, data, length);
+
+    buffer->peeked = 0;
+    atomic_store_explicit(&buffer->tail, tail + length, memory_order_release);
+    return true;
+}
+
 bool NetBuffer_Write(NetBuffer* buffer, const uint8_t* data, uint32_t length) {
     if (!buffer || !buffer->data || !data || length == 0) {
         return false;
     }
 
+    if (buffer->mode == NET_BUFFER_SPSC) {
+        return spsc_write(buffer, data, length);
+    }
+
     enter_critical();
 
     if (length > NetBuffer_GetFree(buffer)) {
@@ -95,6 +189,10 @@ bool NetBuffer_Read(NetBuffer* buffer, uint8_t* data, uint32_t length) {
         return false;
     }
 
+    if (buffer->mode == NET_BUFFER_SPSC) {
+        return spsc_read(buffer, data, length);
+    }
+
     enter_critical();
 
     if (length > buffer->count) {
@@ -129,6 +227,16 @@ bool NetBuffer_Peek(const NetBuffer* buffer, uint8_t* data, uint32_t length) {
         return false;
     }
 
+    if (buffer->mode == NET_BUFFER_SPSC) {
+        uint32_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        if (length > head - tail) {
+            return false;
+        }
+        spsc_copy_out(buffer, tail, data, length);
+        return true;
+    }
+
     enter_critical();
 
     if (length > buffer->count) {
@@ -149,10 +257,76 @@ bool NetBuffer_Peek(const NetBuffer* buffer, uint8_t* data, uint32_t length) {
     return true;
 }
 
+uint32_t NetBuffer_Reserve(NetBuffer* buffer, uint8_t** region) {
+    if (!buffer || !buffer->data || !region || buffer->mode != NET_BUFFER_SPSC) {
+        return 0;
+    }
+
+    uint32_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+    uint32_t free_bytes = buffer->size - (head - tail);
+    uint32_t offset = head & buffer->mask;
+    uint32_t span = buffer->size - offset;
+
+    if (span > free_bytes) {
+        span = free_bytes;
+    }
+
+    *region = buffer->data + offset;
+    buffer->reserved = span;
+    return span;
+}
+
+bool NetBuffer_Commit(NetBuffer* buffer, uint32_t length) {
+    if (!buffer || buffer->mode != NET_BUFFER_SPSC || length > buffer->reserved) {
+        return false;
+    }
+
+    // The rest of the reservation stays valid and starts at the new head
+    uint32_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    buffer->reserved -= length;
+    atomic_store_explicit(&buffer->head, head + length, memory_order_release);
+    return true;
+}
+
+uint32_t NetBuffer_PeekContiguous(NetBuffer* buffer, const uint8_t** region) {
+    if (!buffer || !buffer->data || !region || buffer->mode != NET_BUFFER_SPSC) {
+        return 0;
+    }
+
+    uint32_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+    uint32_t used = head - tail;
+    uint32_t offset = tail & buffer->mask;
+    uint32_t span = buffer->size - offset;
+
+    if (span > used) {
+        span = used;
+    }
+
+    *region = buffer->data + offset;
+    buffer->peeked = span;
+    return span;
+}
+
+bool NetBuffer_Release(NetBuffer* buffer, uint32_t length) {
+    if (!buffer || buffer->mode != NET_BUFFER_SPSC || length > buffer->peeked) {
+        return false;
+    }
+
+    uint32_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+    buffer->peeked -= length;
+    atomic_store_explicit(&buffer->tail, tail + length, memory_order_release);
+    return true;
+}
+
 uint32_t NetBuffer_GetAvailable(const NetBuffer* buffer) {
     if (!buffer) {
         return 0;
     }
+    if (buffer->mode == NET_BUFFER_SPSC) {
+        return spsc_used(buffer);
+    }
     return buffer->count;
 }
 
@@ -160,26 +334,26 @@ uint32_t NetBuffer_GetFree(const NetBuffer* buffer) {
     if (!buffer) {
         return 0;
     }
-    return buffer->size - buffer->count;
+    return buffer->size - NetBuffer_GetAvailable(buffer);
 }
 
 bool NetBuffer_IsEmpty(const NetBuffer* buffer) {
     if (!buffer) {
         return true;
     }
-    return buffer->count == 0;
+    return NetBuffer_GetAvailable(buffer) == 0;
 }
 
 bool NetBuffer_IsFull(const NetBuffer* buffer) {
     if (!buffer) {
         return true;
     }
-    return buffer->count >= buffer->size;
+    return NetBuffer_GetAvailable(buffer) >= buffer->size;
 }
 
 bool NetBuffer_HasOverflowed(const NetBuffer* buffer) {
     if (!buffer) {
         return false;
     }
-    return buffer->overflow;
+    return __atomic_load_n(&buffer->overflow, __ATOMIC_RELAXED);
 } 
\ No newline at end of file
@@ -3,6 +3,14 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+
+#define NET_BUFFER_CACHE_LINE 64
+
+typedef enum {
+    NET_BUFFER_LOCKED = 0,   // Any number of writers/readers, global critical section
+    NET_BUFFER_SPSC          // One producer, one consumer, lock-free
+} NetBufferMode;
 
 typedef struct {
     uint8_t* data;
@@ -11,9 +19,20 @@ typedef struct {
     uint32_t write_index;
     uint32_t count;
     bool overflow;
+
+    // SPSC mode only. Indices run freely and are masked on access, so the
+    // size must be a power of two. Each index is written by one side only
+    // and sits on its own cache line.
+    NetBufferMode mode;
+    uint32_t mask;
+    _Atomic uint32_t head __attribute__((aligned(NET_BUFFER_CACHE_LINE)));
+    uint32_t reserved;       // Producer-private: bytes handed out by Reserve
+    _Atomic uint32_t tail __attribute__((aligned(NET_BUFFER_CACHE_LINE)));
+    uint32_t peeked;         // Consumer-private: bytes handed out by PeekContiguous
 } NetBuffer;
 
 bool NetBuffer_Init(NetBuffer* buffer, uint32_t size);
+bool NetBuffer_InitSpsc(NetBuffer* buffer, uint32_t size);
 void NetBuffer_Deinit(NetBuffer* buffer);
 void NetBuffer_Reset(NetBuffer* buffer);
 
@@ -21,10 +40,20 @@ bool NetBuffer_Write(NetBuffer* buffer, const uint8_t* data, uint32_t length);
 bool NetBuffer_Read(NetBuffer* buffer, uint8_t* data, uint32_t length);
 bool NetBuffer_Peek(const NetBuffer* buffer, uint8_t* data, uint32_t length);
 
+// Zero-copy access, SPSC mode only. Reserve hands the producer the largest
+// contiguous free span (it stops at the end of the ring); the bytes become
+// visible to the consumer on Commit. PeekContiguous hands the consumer the
+// largest contiguous readable span; Release returns it to the producer.
+// Both return the span length, 0 when nothing is available.
+uint32_t NetBuffer_Reserve(NetBuffer* buffer, uint8_t** region);
+bool NetBuffer_Commit(NetBuffer* buffer, uint32_t length);
+uint32_t NetBuffer_PeekContiguous(NetBuffer* buffer, const uint8_t** region);
+bool NetBuffer_Release(NetBuffer* buffer, uint32_t length);
+
 uint32_t NetBuffer_GetAvailable(const NetBuffer* buffer);
 uint32_t NetBuffer_GetFree(const NetBuffer* buffer);
 bool NetBuffer_IsEmpty(const NetBuffer* buffer);
 bool NetBuffer_IsFull(const NetBuffer* buffer);
 bool NetBuffer_HasOverflowed(const NetBuffer* buffer);
 
-#endif // CANT_NET_BUFFER_H 
\ No newline at end of file
+#endif // CANT_NET_BUFFER_H 
@@ -5,51 +5,96 @@
 #include "../diagnostic/logging/diag_logger.h"
 #include "../diagnostic/os/critical.h"
 #include "../diagnostic/os/timer.h"
+#include "../core/event_bus.h"
+#include <stdlib.h>
 #include <string.h>
 
 #define MAX_INTERFACES 8
 #define MAX_CALLBACKS_PER_EVENT 8
+#define NET_WAIT_IDLE_MS 10    // Net_Wait sleep when no socket is open
 
+// Binding between a registered callback and its event bus subscription
 typedef struct {
     NetEventCallback callback;
     void* context;
+    int32_t subscriber;
     bool active;
 } EventCallback;
 
-typedef struct {
-    NetInterfaceConfig config;
-    NetConnectionState state;
-    NetStatistics stats;
-    uint32_t last_heartbeat;
-    bool active;
-} InterfaceContext;
+typedef union {
+    NetInterfaceType type;
+    NetMessage message;
+    NetMessageV message_v;
+} NetEventPayload;
 
 typedef struct {
     NetManagerConfig config;
     InterfaceContext interfaces[MAX_INTERFACES];
     EventCallback callbacks[NET_EVENT_ERROR + 1][MAX_CALLBACKS_PER_EVENT];
-    NetBuffer rx_buffer;
-    NetBuffer tx_buffer;
+    NetBuffer rx_buffer;     // Stream bytes drained from readable sockets
     bool initialized;
 } NetworkManager;
 
 static NetworkManager net_mgr;
 
-static void trigger_event(NetEventType event, void* data) {
+// Queues a copy of the payload for each subscriber; callbacks run later
+// from EventBus_Dispatch, outside the critical section
+static void trigger_event(NetEventType event, const void* data, uint16_t length) {
     if (!net_mgr.initialized) {
         return;
     }
 
-    enter_critical();
-    
-    for (uint32_t i = 0; i < MAX_CALLBACKS_PER_EVENT; i++) {
-        EventCallback* cb = &net_mgr.callbacks[event][i];
-        if (cb->active && cb->callback) {
-            cb->callback(event, data, cb->context);
+    EventBus_Publish(EVENT_TOPIC_NET, (uint16_t)event, data, length);
+}
+
+static void dispatch_event(const BusEvent* event, void* context) {
+    EventCallback* cb = (EventCallback*)context;
+    if (cb->active && cb->callback) {
+        cb->callback((NetEventType)event->type, (void*)event->payload, cb->context);
+    }
+}
+
+static NetHistogram* latency_histogram(InterfaceContext* ctx, NetProtocolType protocol,
+                                       NetDirection direction) {
+    if (!ctx->latency || protocol >= NET_PROTO_COUNT) {
+        return NULL;
+    }
+    return &ctx->latency[protocol * NET_DIR_COUNT + direction];
+}
+
+static void record_latency(InterfaceContext* ctx, NetProtocolType protocol,
+                           NetDirection direction, uint64_t start_ns) {
+    NetHistogram* histogram = latency_histogram(ctx, protocol, direction);
+    if (histogram) {
+        NetHistogram_Record(histogram, NetStats_Now() - start_ns);
+    }
+}
+
+// Only stream sends queue behind the socket
+static void sample_tx_queue(InterfaceContext* ctx, NetProtocolType protocol) {
+    if (protocol == NET_PROTO_TCP) {
+        uint32_t depth = NetInterface_GetTxBacklog(ctx->config.type, protocol);
+        if (depth > ctx->tx_queue_peak) {
+            ctx->tx_queue_peak = depth;
+        }
+    }
+}
+
+// Received data is charged from the readiness edge that announced it, so
+// a burst read in several calls counts from its first arrival
+static void mark_rx_ready(InterfaceContext* ctx, NetProtocolType protocol) {
+    if (ctx->latency && !ctx->rx_ready_ns[protocol]) {
+        ctx->rx_ready_ns[protocol] = NetStats_Now();
+    }
+}
+
+static void record_rx(InterfaceContext* ctx, NetProtocolType protocol, bool drained) {
+    if (ctx->rx_ready_ns[protocol]) {
+        record_latency(ctx, protocol, NET_DIR_RX, ctx->rx_ready_ns[protocol]);
+        if (drained) {
+            ctx->rx_ready_ns[protocol] = 0;
         }
     }
-    
-    exit_critical();
 }
 
 bool Net_Init(const NetManagerConfig* config) {
@@ -60,10 +105,19 @@ bool Net_Init(const NetManagerConfig* config) {
     memset(&net_mgr, 0, sizeof(NetworkManager));
     memcpy(&net_mgr.config, config, sizeof(NetManagerConfig));
 
-    // Initialize buffers
-    if (!NetBuffer_Init(&net_mgr.rx_buffer, config->rx_buffer_size) ||
-        !NetBuffer_Init(&net_mgr.tx_buffer, config->tx_buffer_size)) {
-        Net_Deinit();
+    if (net_mgr.config.batch_depth == 0) {
+        net_mgr.config.batch_depth = NET_BATCH_DEFAULT;
+    } else if (net_mgr.config.batch_depth > NET_BATCH_MAX) {
+        net_mgr.config.batch_depth = NET_BATCH_MAX;
+    }
+
+    // Sockets are drained straight into ring memory, which needs a
+    // power-of-two SPSC buffer
+    uint32_t rx_size = 1;
+    while (rx_size < config->rx_buffer_size && rx_size < 0x80000000u) {
+        rx_size <<= 1;
+    }
+    if (!NetBuffer_InitSpsc(&net_mgr.rx_buffer, rx_size)) {
         return false;
     }
 
@@ -81,12 +135,20 @@ void Net_Deinit(void) {
     for (uint32_t i = 0; i < MAX_INTERFACES; i++) {
         if (net_mgr.interfaces[i].active) {
             Net_Disconnect(net_mgr.interfaces[i].config.type);
+            free(net_mgr.interfaces[i].latency);
+        }
+    }
+
+    for (uint32_t event = 0; event <= NET_EVENT_ERROR; event++) {
+        for (uint32_t i = 0; i < MAX_CALLBACKS_PER_EVENT; i++) {
+            if (net_mgr.callbacks[event][i].active) {
+                EventBus_Unsubscribe(net_mgr.callbacks[event][i].subscriber);
+            }
         }
     }
 
     // Free buffers
     NetBuffer_Deinit(&net_mgr.rx_buffer);
-    NetBuffer_Deinit(&net_mgr.tx_buffer);
 
     Logger_Log(LOG_LEVEL_INFO, "NETWORK", "Network manager deinitialized");
     memset(&net_mgr, 0, sizeof(NetworkManager));
@@ -120,6 +182,13 @@ bool Net_AddInterface(const NetInterfaceConfig* config) {
     ctx->state = NET_STATE_DISCONNECTED;
     ctx->active = true;
 
+    if (net_mgr.config.enable_statistics) {
+        ctx->latency = (NetHistogram*)calloc(NET_PROTO_COUNT * NET_DIR_COUNT, sizeof(NetHistogram));
+        if (!ctx->latency) {
+            Logger_Log(LOG_LEVEL_WARNING, "NETWORK", "No memory for latency histograms");
+        }
+    }
+
     Logger_Log(LOG_LEVEL_INFO, "NETWORK", "Added interface: %s", config->name);
 
     exit_critical();
@@ -154,6 +223,7 @@ bool Net_RemoveInterface(NetInterfaceType type) {
 
     Logger_Log(LOG_LEVEL_INFO, "NETWORK", "Removed interface: %s", 
                ctx->config.name);
+    free(ctx->latency);
     memset(ctx, 0, sizeof(InterfaceContext));
 
     exit_critical();
@@ -187,6 +257,7 @@ bool Net_Connect(NetInterfaceType type) {
     }
 
     // Initialize interface-specific connection
+    NetCounters_Add(&ctx->counters, NET_COUNTER_CONNECTION_ATTEMPTS, 1);
     bool success = false;
     switch (type) {
         case NET_IF_ETHERNET:
@@ -207,14 +278,15 @@ bool Net_Connect(NetInterfaceType type) {
 
     if (success) {
         ctx->state = NET_STATE_CONNECTED;
-        ctx->stats.successful_connections++;
+        NetCounters_Add(&ctx->counters, NET_COUNTER_SUCCESSFUL_CONNECTIONS, 1);
         ctx->last_heartbeat = Timer_GetMilliseconds();
-        trigger_event(NET_EVENT_CONNECTED, ctx);
+        NetProtocol_OnConnected(ctx);
+        trigger_event(NET_EVENT_CONNECTED, &ctx->config.type, sizeof(NetInterfaceType));
         Logger_Log(LOG_LEVEL_INFO, "NETWORK", "Connected interface: %s", 
                   ctx->config.name);
     } else {
         ctx->state = NET_STATE_ERROR;
-        ctx->stats.errors++;
+        NetCounters_Add(&ctx->counters, NET_COUNTER_ERRORS, 1);
         Logger_Log(LOG_LEVEL_ERROR, "NETWORK", "Failed to connect interface: %s", 
                   ctx->config.name);
     }
@@ -265,13 +337,14 @@ bool Net_Disconnect(NetInterfaceType type) {
 
     if (success) {
         ctx->state = NET_STATE_DISCONNECTED;
-        ctx->stats.disconnections++;
-        trigger_event(NET_EVENT_DISCONNECTED, ctx);
+        NetCounters_Add(&ctx->counters, NET_COUNTER_DISCONNECTIONS, 1);
+        NetProtocol_OnDisconnected(ctx);
+        trigger_event(NET_EVENT_DISCONNECTED, &ctx->config.type, sizeof(NetInterfaceType));
         Logger_Log(LOG_LEVEL_INFO, "NETWORK", "Disconnected interface: %s", 
                   ctx->config.name);
     } else {
         ctx->state = NET_STATE_ERROR;
-        ctx->stats.errors++;
+        NetCounters_Add(&ctx->counters, NET_COUNTER_ERRORS, 1);
         Logger_Log(LOG_LEVEL_ERROR, "NETWORK", 
                   "Failed to disconnect interface: %s", ctx->config.name);
     }
@@ -280,6 +353,35 @@ bool Net_Disconnect(NetInterfaceType type) {
     return success;
 }
 
+// Find a connected interface that carries the given protocol
+static InterfaceContext* find_interface_for_protocol(NetProtocolType protocol) {
+    for (uint32_t i = 0; i < MAX_INTERFACES; i++) {
+        InterfaceContext* ctx = &net_mgr.interfaces[i];
+        if (!ctx->active || ctx->state != NET_STATE_CONNECTED) {
+            continue;
+        }
+
+        // Match protocol to interface type
+        switch (protocol) {
+            case NET_PROTO_TCP:
+            case NET_PROTO_UDP:
+                if (ctx->config.type == NET_IF_ETHERNET ||
+                    ctx->config.type == NET_IF_WIFI) {
+                    return ctx;
+                }
+                break;
+            case NET_PROTO_CAN:
+                if (ctx->config.type == NET_IF_CAN) {
+                    return ctx;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return NULL;
+}
+
 bool Net_SendMessage(const NetMessage* message) {
     if (!net_mgr.initialized || !message || !message->data || !message->length) {
         return false;
@@ -287,94 +389,230 @@ bool Net_SendMessage(const NetMessage* message) {
 
     enter_critical();
 
-    // Find appropriate interface for protocol
-    InterfaceContext* ctx = NULL;
-    for (uint32_t i = 0; i < MAX_INTERFACES; i++) {
-        if (net_mgr.interfaces[i].active && 
-            net_mgr.interfaces[i].state == NET_STATE_CONNECTED) {
-            // Match protocol to interface type
-            switch (message->protocol) {
-                case NET_PROTO_TCP:
-                case NET_PROTO_UDP:
-                    if (net_mgr.interfaces[i].config.type == NET_IF_ETHERNET ||
-                        net_mgr.interfaces[i].config.type == NET_IF_WIFI) {
-                        ctx = &net_mgr.interfaces[i];
-                    }
-                    break;
-                case NET_PROTO_CAN:
-                    if (net_mgr.interfaces[i].config.type == NET_IF_CAN) {
-                        ctx = &net_mgr.interfaces[i];
-                    }
-                    break;
-                default:
-                    break;
-            }
-            if (ctx) break;
-        }
-    }
-
+    InterfaceContext* ctx = find_interface_for_protocol(message->protocol);
     if (!ctx) {
         exit_critical();
         return false;
     }
 
-    // Add message to TX buffer
-    if (!NetBuffer_Write(&net_mgr.tx_buffer, message->data, message->length)) {
-        exit_critical();
-        return false;
-    }
-
-    // Send using protocol-specific handler
+    // Send using protocol-specific handler; bytes the socket cannot take
+    // yet are queued by the interface backend
+    uint64_t start_ns = ctx->latency ? NetStats_Now() : 0;
     bool success = NetProtocol_SendMessage(message, ctx);
     if (success) {
-        ctx->stats.bytes_sent += message->length;
-        ctx->stats.packets_sent++;
-        trigger_event(NET_EVENT_DATA_SENT, (void*)message);
+        record_latency(ctx, message->protocol, NET_DIR_TX, start_ns);
+        sample_tx_queue(ctx, message->protocol);
+        NetCounters_Add(&ctx->counters, NET_COUNTER_BYTES_SENT, message->length);
+        NetCounters_Add(&ctx->counters, NET_COUNTER_PACKETS_SENT, 1);
+        trigger_event(NET_EVENT_DATA_SENT, message, sizeof(NetMessage));
     } else {
-        ctx->stats.errors++;
+        NetCounters_Add(&ctx->counters, NET_COUNTER_ERRORS, 1);
     }
 
     exit_critical();
     return success;
 }
 
-bool Net_ReceiveMessage(NetMessage* message) {
-    if (!net_mgr.initialized || !message) {
+// Segments go straight to the socket layer; unlike Net_SendMessage nothing
+// is staged in the TX buffer, so headers and payload are never copied
+bool Net_SendMessageV(const NetMessageV* message) {
+    if (!net_mgr.initialized || !message || !message->iov ||
+        message->iov_count == 0 || message->iov_count > NET_MAX_IOV) {
+        return false;
+    }
+
+    uint32_t length = 0;
+    for (uint32_t i = 0; i < message->iov_count; i++) {
+        if (message->iov[i].length && !message->iov[i].data) {
+            return false;
+        }
+        length += (uint32_t)message->iov[i].length;
+    }
+    if (!length) {
         return false;
     }
 
     enter_critical();
 
-    // Check RX buffer for data
-    uint32_t available = NetBuffer_GetAvailable(&net_mgr.rx_buffer);
-    if (!available) {
+    InterfaceContext* ctx = find_interface_for_protocol(message->protocol);
+    if (!ctx) {
         exit_critical();
         return false;
     }
 
-    // Read message from buffer
-    if (!NetBuffer_Read(&net_mgr.rx_buffer, message->data, available)) {
-        exit_critical();
+    uint64_t start_ns = ctx->latency ? NetStats_Now() : 0;
+    bool success = NetProtocol_SendMessageV(message, ctx);
+    if (success) {
+        record_latency(ctx, message->protocol, NET_DIR_TX, start_ns);
+        sample_tx_queue(ctx, message->protocol);
+        NetCounters_Add(&ctx->counters, NET_COUNTER_BYTES_SENT, length);
+        NetCounters_Add(&ctx->counters, NET_COUNTER_PACKETS_SENT, 1);
+        trigger_event(NET_EVENT_DATA_SENT, message, sizeof(NetMessageV));
+    } else {
+        NetCounters_Add(&ctx->counters, NET_COUNTER_ERRORS, 1);
+    }
+
+    exit_critical();
+    return success;
+}
+
+// On input message->length is the capacity of message->data (0 = unbounded
+// for stream data). UDP returns one datagram; other protocols return the
+// stream bytes buffered so far.
+bool Net_ReceiveMessage(NetMessage* message) {
+    if (!net_mgr.initialized || !message || !message->data) {
         return false;
     }
 
-    message->length = available;
+    enter_critical();
+
+    uint32_t received = 0;
+    InterfaceContext* ctx = find_interface_for_protocol(message->protocol);
+
+    if (message->protocol == NET_PROTO_UDP) {
+        int32_t length = -1;
+        if (ctx && message->length) {
+            length = NetInterface_Receive(ctx->config.type, NET_PROTO_UDP,
+                                          message->data, message->length);
+        }
+        if (length <= 0) {
+            if (ctx) {
+                ctx->rx_ready_ns[NET_PROTO_UDP] = 0;    // Drained
+            }
+            exit_critical();
+            return false;
+        }
+        received = (uint32_t)length;
+        record_rx(ctx, NET_PROTO_UDP, false);
+    } else {
+        received = NetBuffer_GetAvailable(&net_mgr.rx_buffer);
+        if (message->length && received > message->length) {
+            received = message->length;
+        }
+        if (!received || !NetBuffer_Read(&net_mgr.rx_buffer, message->data, received)) {
+            exit_critical();
+            return false;
+        }
+        if (ctx) {
+            record_rx(ctx, NET_PROTO_TCP, NetBuffer_IsEmpty(&net_mgr.rx_buffer));
+            // The drain stopped at a full buffer; let it resume
+            if (NetInterface_IsReadable(ctx->config.type, NET_PROTO_TCP)) {
+                NetInterface_Wake();
+            }
+        }
+    }
+
+    message->length = received;
     message->timestamp = Timer_GetMilliseconds();
 
-    // Update statistics for the appropriate interface
-    for (uint32_t i = 0; i < MAX_INTERFACES; i++) {
-        if (net_mgr.interfaces[i].active && 
-            net_mgr.interfaces[i].state == NET_STATE_CONNECTED) {
-            net_mgr.interfaces[i].stats.bytes_received += available;
-            net_mgr.interfaces[i].stats.packets_received++;
+    if (ctx) {
+        NetCounters_Add(&ctx->counters, NET_COUNTER_BYTES_RECEIVED, received);
+        NetCounters_Add(&ctx->counters, NET_COUNTER_PACKETS_RECEIVED, 1);
+    }
+
+    exit_critical();
+    return true;
+}
+
+uint32_t Net_ReceiveMessages(NetMessage* messages, uint32_t max_messages) {
+    if (!net_mgr.initialized || !messages || max_messages == 0) {
+        return 0;
+    }
+
+    enter_critical();
+
+    InterfaceContext* ctx = find_interface_for_protocol(NET_PROTO_UDP);
+    uint32_t received = 0;
+    uint32_t now = Timer_GetMilliseconds();
+
+    while (ctx && received < max_messages) {
+        uint32_t chunk = max_messages - received;
+        if (chunk > net_mgr.config.batch_depth) {
+            chunk = net_mgr.config.batch_depth;
+        }
+
+        int32_t count = NetInterface_ReceiveBatch(ctx->config.type, NET_PROTO_UDP,
+                                                  &messages[received], chunk);
+        if (count <= 0) {
+            ctx->rx_ready_ns[NET_PROTO_UDP] = 0;
             break;
         }
+
+        uint64_t bytes = 0;
+        for (int32_t i = 0; i < count; i++) {
+            NetMessage* message = &messages[received + i];
+            message->protocol = NET_PROTO_UDP;
+            message->timestamp = now;
+            bytes += message->length;
+        }
+        NetCounters_Add(&ctx->counters, NET_COUNTER_BYTES_RECEIVED, bytes);
+        NetCounters_Add(&ctx->counters, NET_COUNTER_PACKETS_RECEIVED, (uint32_t)count);
+        received += (uint32_t)count;
+
+        // One sample per batch call
+        bool drained = (uint32_t)count < chunk;
+        record_rx(ctx, NET_PROTO_UDP, drained);
+        if (drained) {
+            break;    // Socket drained
+        }
     }
 
-    trigger_event(NET_EVENT_DATA_RECEIVED, (void*)message);
+    exit_critical();
+    return received;
+}
+
+uint32_t Net_SendMessages(const NetMessage* messages, uint32_t count) {
+    if (!net_mgr.initialized || !messages || count == 0) {
+        return 0;
+    }
+
+    enter_critical();
+
+    InterfaceContext* ctx = find_interface_for_protocol(NET_PROTO_UDP);
+    uint32_t sent = 0;
+
+    while (ctx && sent < count) {
+        uint32_t chunk = count - sent;
+        if (chunk > net_mgr.config.batch_depth) {
+            chunk = net_mgr.config.batch_depth;
+        }
+
+        // Only a run of UDP datagrams can go out in one call
+        for (uint32_t i = 0; i < chunk; i++) {
+            if (messages[sent + i].protocol != NET_PROTO_UDP) {
+                chunk = i;
+                break;
+            }
+        }
+        if (chunk == 0) {
+            break;
+        }
+
+        uint64_t start_ns = ctx->latency ? NetStats_Now() : 0;
+        int32_t result = NetProtocol_SendBatch(&messages[sent], chunk, ctx);
+        if (result <= 0) {
+            NetCounters_Add(&ctx->counters, NET_COUNTER_ERRORS, 1);
+            break;
+        }
+
+        // One sample per batch call
+        record_latency(ctx, NET_PROTO_UDP, NET_DIR_TX, start_ns);
+
+        uint64_t bytes = 0;
+        for (int32_t i = 0; i < result; i++) {
+            bytes += messages[sent + i].length;
+        }
+        NetCounters_Add(&ctx->counters, NET_COUNTER_BYTES_SENT, bytes);
+        NetCounters_Add(&ctx->counters, NET_COUNTER_PACKETS_SENT, (uint32_t)result);
+        sent += (uint32_t)result;
+
+        if ((uint32_t)result < chunk) {
+            break;    // Socket buffer full
+        }
+    }
 
     exit_critical();
-    return true;
+    return sent;
 }
 
 void Net_RegisterCallback(NetEventType event, NetEventCallback callback, 
@@ -389,9 +627,22 @@ void Net_RegisterCallback(NetEventType event, NetEventCallback callback,
     for (uint32_t i = 0; i < MAX_CALLBACKS_PER_EVENT; i++) {
         EventCallback* cb = &net_mgr.callbacks[event][i];
         if (!cb->active) {
+            EventSubscription subscription = {
+                .topic = EVENT_TOPIC_NET,
+                .type_mask = 1u << event,
+                .handler = dispatch_event,
+                .context = cb,
+                .payload_size = sizeof(NetEventPayload),
+                .policy = EVENT_POLICY_DROP_OLDEST
+            };
+
             cb->callback = callback;
             cb->context = context;
-            cb->active = true;
+            cb->subscriber = EventBus_Subscribe(&subscription);
+            cb->active = cb->subscriber >= 0;
+            if (!cb->active) {
+                Logger_Log(LOG_LEVEL_ERROR, "NETWORK", "No event bus slot for callback");
+            }
             break;
         }
     }
@@ -409,7 +660,8 @@ void Net_UnregisterCallback(NetEventType event, NetEventCallback callback) {
     for (uint32_t i = 0; i < MAX_CALLBACKS_PER_EVENT; i++) {
         EventCallback* cb = &net_mgr.callbacks[event][i];
         if (cb->active && cb->callback == callback) {
-            memset(cb, 0, sizeof(EventCallback));
+            EventBus_Unsubscribe(cb->subscriber);
+            cb->active = false;
             break;
         }
     }
@@ -432,6 +684,17 @@ NetConnectionState Net_GetState(NetInterfaceType type) {
     return NET_STATE_ERROR;
 }
 
+static InterfaceContext* find_interface(NetInterfaceType type) {
+    for (uint32_t i = 0; i < MAX_INTERFACES; i++) {
+        if (net_mgr.interfaces[i].active && 
+            net_mgr.interfaces[i].config.type == type) {
+            return &net_mgr.interfaces[i];
+        }
+    }
+    return NULL;
+}
+
+// Counters are summed here rather than on the data path
 void Net_GetStatistics(NetInterfaceType type, NetStatistics* stats) {
     if (!net_mgr.initialized || !stats) {
         return;
@@ -439,17 +702,148 @@ void Net_GetStatistics(NetInterfaceType type, NetStatistics* stats) {
 
     enter_critical();
 
-    for (uint32_t i = 0; i < MAX_INTERFACES; i++) {
-        if (net_mgr.interfaces[i].active && 
-            net_mgr.interfaces[i].config.type == type) {
-            memcpy(stats, &net_mgr.interfaces[i].stats, sizeof(NetStatistics));
-            break;
+    InterfaceContext* ctx = find_interface(type);
+    if (ctx) {
+        uint64_t totals[NET_COUNTER_COUNT];
+        NetCounters_Sum(&ctx->counters, totals);
+
+        stats->bytes_sent = totals[NET_COUNTER_BYTES_SENT];
+        stats->bytes_received = totals[NET_COUNTER_BYTES_RECEIVED];
+        stats->packets_sent = totals[NET_COUNTER_PACKETS_SENT];
+        stats->packets_received = totals[NET_COUNTER_PACKETS_RECEIVED];
+        stats->errors = totals[NET_COUNTER_ERRORS];
+        stats->connection_attempts = totals[NET_COUNTER_CONNECTION_ATTEMPTS];
+        stats->successful_connections = totals[NET_COUNTER_SUCCESSFUL_CONNECTIONS];
+        stats->disconnections = totals[NET_COUNTER_DISCONNECTIONS];
+
+        stats->rx_queue_bytes = NetBuffer_GetAvailable(&net_mgr.rx_buffer);
+        stats->rx_queue_peak = ctx->rx_queue_peak;
+        stats->tx_queue_bytes = NetInterface_GetTxBacklog(type, NET_PROTO_TCP);
+        if (stats->tx_queue_bytes > ctx->tx_queue_peak) {
+            ctx->tx_queue_peak = stats->tx_queue_bytes;
+        }
+        stats->tx_queue_peak = ctx->tx_queue_peak;
+    }
+
+    exit_critical();
+}
+
+void Net_ResetStatistics(NetInterfaceType type) {
+    if (!net_mgr.initialized) {
+        return;
+    }
+
+    enter_critical();
+
+    InterfaceContext* ctx = find_interface(type);
+    if (ctx) {
+        NetCounters_Reset(&ctx->counters);
+        for (uint32_t i = 0; ctx->latency && i < NET_PROTO_COUNT * NET_DIR_COUNT; i++) {
+            NetHistogram_Reset(&ctx->latency[i]);
         }
+        ctx->rx_queue_peak = 0;
+        ctx->tx_queue_peak = 0;
     }
 
     exit_critical();
 }
 
+bool Net_GetLatency(NetInterfaceType type, NetProtocolType protocol,
+                    NetDirection direction, NetLatencySummary* summary) {
+    if (!net_mgr.initialized || !summary || protocol >= NET_PROTO_COUNT ||
+        direction >= NET_DIR_COUNT) {
+        return false;
+    }
+
+    enter_critical();
+
+    InterfaceContext* ctx = find_interface(type);
+    NetHistogram* histogram = ctx ? latency_histogram(ctx, protocol, direction) : NULL;
+    if (histogram) {
+        NetHistogram_Summarize(histogram, summary);
+    }
+
+    exit_critical();
+    return histogram != NULL;
+}
+
+// Drain readable stream sockets into the RX buffer and raise
+// NET_EVENT_DATA_RECEIVED. Datagrams stay queued in their socket until
+// Net_ReceiveMessage takes them, so UDP readiness is only reported.
+static void dispatch_received(InterfaceContext* ctx, uint32_t now) {
+    NetInterfaceType type = ctx->config.type;
+    uint32_t drained = 0;
+
+    while (NetInterface_IsReadable(type, NET_PROTO_TCP)) {
+        uint8_t* region;
+        uint32_t span = NetBuffer_Reserve(&net_mgr.rx_buffer, &region);
+        if (!span) {
+            break;    // RX buffer full; Net_ReceiveMessage wakes the poller
+        }
+
+        int32_t length = NetInterface_Receive(type, NET_PROTO_TCP, region, span);
+        if (length <= 0) {
+            break;
+        }
+        NetBuffer_Commit(&net_mgr.rx_buffer, (uint32_t)length);
+        drained += (uint32_t)length;
+    }
+
+    if (drained) {
+        uint32_t depth = NetBuffer_GetAvailable(&net_mgr.rx_buffer);
+        if (depth > ctx->rx_queue_peak) {
+            ctx->rx_queue_peak = depth;
+        }
+        mark_rx_ready(ctx, NET_PROTO_TCP);
+
+        NetMessage info = {
+            .protocol = NET_PROTO_TCP,
+            .length = NetBuffer_GetAvailable(&net_mgr.rx_buffer),
+            .timestamp = now
+        };
+        trigger_event(NET_EVENT_DATA_RECEIVED, &info, sizeof(info));
+    }
+
+    if (NetInterface_IsReadable(type, NET_PROTO_UDP)) {
+        mark_rx_ready(ctx, NET_PROTO_UDP);
+
+        NetMessage info = {
+            .protocol = NET_PROTO_UDP,
+            .timestamp = now
+        };
+        trigger_event(NET_EVENT_DATA_RECEIVED, &info, sizeof(info));
+    }
+}
+
+// Milliseconds until the next heartbeat or reconnect attempt is due
+static uint32_t next_deadline_ms(uint32_t now, uint32_t limit_ms) {
+    uint32_t wait_ms = limit_ms;
+
+    for (uint32_t i = 0; i < MAX_INTERFACES; i++) {
+        InterfaceContext* ctx = &net_mgr.interfaces[i];
+        uint32_t interval;
+
+        if (!ctx->active) {
+            continue;
+        }
+        if (ctx->state == NET_STATE_CONNECTED && net_mgr.config.heartbeat_interval_ms) {
+            interval = net_mgr.config.heartbeat_interval_ms;
+        } else if (ctx->state == NET_STATE_DISCONNECTED && ctx->config.auto_connect) {
+            interval = ctx->config.reconnect_interval_ms;
+        } else {
+            continue;
+        }
+
+        uint32_t elapsed = now - ctx->last_heartbeat;
+        uint32_t remaining = (elapsed >= interval) ? 0 : interval - elapsed;
+        if (remaining < wait_ms) {
+            wait_ms = remaining;
+        }
+    }
+
+    return wait_ms;
+}
+
 void Net_Process(void) {
     if (!net_mgr.initialized) {
         return;
@@ -485,6 +879,15 @@ void Net_Process(void) {
 
             // Process received data
             NetProtocol_ProcessReceived(ctx);
+            dispatch_received(ctx, current_time);
+
+            // A peer that closed its end takes the interface down
+            if (!NetInterface_IsConnected(ctx->config.type)) {
+                Logger_Log(LOG_LEVEL_WARNING, "NETWORK", "Interface %s lost its peer",
+                          ctx->config.name);
+                Net_Disconnect(ctx->config.type);
+                ctx->last_heartbeat = current_time;
+            }
         }
         // Handle auto-reconnect
         else if (ctx->state == NET_STATE_DISCONNECTED && 
@@ -496,4 +899,29 @@ void Net_Process(void) {
     }
 
     exit_critical();
-} 
\ No newline at end of file
+}
+
+bool Net_Wait(uint32_t timeout_ms) {
+    if (!net_mgr.initialized) {
+        return false;
+    }
+
+    enter_critical();
+    uint32_t wait_ms = next_deadline_ms(Timer_GetMilliseconds(), timeout_ms);
+    exit_critical();
+
+    // The lock is not held while blocked so other threads can still send
+    int32_t poll_ms = (wait_ms == NET_WAIT_FOREVER) ? -1 : (int32_t)(wait_ms & 0x7FFFFFFF);
+    int events = NetInterface_Wait(poll_ms);
+    if (events < 0 && wait_ms) {
+        // Nothing to wait on; sleep briefly instead of spinning
+        Timer_DelayMilliseconds(wait_ms < NET_WAIT_IDLE_MS ? wait_ms : NET_WAIT_IDLE_MS);
+    }
+
+    Net_Process();
+    return events > 0;
+}
+
+void Net_Wake(void) {
+    NetInterface_Wake();
+}
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "../platform/hardware/socket_io.h"
+#include "net_stats.h"
 
 // Network interface types
 typedef enum {
@@ -44,29 +46,48 @@ typedef struct {
     void* interface_config;  // Interface specific configuration
 } NetInterfaceConfig;
 
-// Network statistics
+// Network statistics. Counters are summed from per-CPU shards when read;
+// gauges are the current queue depth in bytes and its high-water mark.
 typedef struct {
-    uint32_t bytes_sent;
-    uint32_t bytes_received;
-    uint32_t packets_sent;
-    uint32_t packets_received;
-    uint32_t errors;
-    uint32_t connection_attempts;
-    uint32_t successful_connections;
-    uint32_t disconnections;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t packets_sent;
+    uint64_t packets_received;
+    uint64_t errors;
+    uint64_t connection_attempts;
+    uint64_t successful_connections;
+    uint64_t disconnections;
+    uint32_t rx_queue_bytes;      // Stream bytes buffered for Net_ReceiveMessage
+    uint32_t rx_queue_peak;
+    uint32_t tx_queue_bytes;      // Stream bytes waiting for the socket
+    uint32_t tx_queue_peak;
 } NetStatistics;
 
+typedef enum {
+    NET_DIR_TX = 0,    // Time spent handing a message to the transport
+    NET_DIR_RX,        // Time from data arriving to the application taking it
+    NET_DIR_COUNT
+} NetDirection;
+
 // Network manager configuration
 typedef struct {
     uint32_t max_interfaces;
     uint32_t max_connections;
-    uint32_t rx_buffer_size;
-    uint32_t tx_buffer_size;
+    uint32_t rx_buffer_size;     // Rounded up to a power of two
+    uint32_t tx_buffer_size;     // Sends are queued per socket, not here
     bool enable_statistics;
     bool auto_reconnect;
     uint32_t heartbeat_interval_ms;
+    uint32_t batch_depth;        // Datagrams per batched syscall, 0 = NET_BATCH_DEFAULT
 } NetManagerConfig;
 
+#define NET_BATCH_DEFAULT   32
+#define NET_BATCH_MAX       64
+
+// Message flags
+#define NET_MSG_FLAG_MORE       0x0001   // More data follows at once; TCP holds the segment back
+#define NET_MSG_FLAG_TRUNCATED  0x0002   // Received datagram did not fit the buffer
+
 // Network message structure
 typedef struct {
     uint32_t id;
@@ -77,6 +98,22 @@ typedef struct {
     uint32_t flags;
 } NetMessage;
 
+// Scatter-gather segment. Protocol headers and payload stay in their own
+// buffers and are handed to the socket layer as separate segments.
+typedef IoSegment_t NetIoVec;
+
+#define NET_MAX_IOV IO_MAX_SEGMENTS
+
+// Vectored network message
+typedef struct {
+    uint32_t id;
+    const NetIoVec* iov;
+    uint32_t iov_count;
+    NetProtocolType protocol;
+    uint32_t timestamp;
+    uint32_t flags;
+} NetMessageV;
+
 // Network event types
 typedef enum {
     NET_EVENT_CONNECTED = 0,
@@ -86,7 +123,11 @@ typedef enum {
     NET_EVENT_ERROR
 } NetEventType;
 
-// Network event callback
+// Network event callback. Callbacks run from EventBus_Dispatch, not from
+// the call that raised the event. data points to a copy made at that time:
+// the NetInterfaceType for CONNECTED/DISCONNECTED, a NetMessage for
+// DATA_RECEIVED and a NetMessage or NetMessageV for DATA_SENT. Buffers the
+// copy points to belong to the sender and may be gone by then.
 typedef void (*NetEventCallback)(NetEventType event, void* data, void* context);
 
 // Network interface operations
@@ -100,14 +141,36 @@ bool Net_Connect(NetInterfaceType type);
 bool Net_Disconnect(NetInterfaceType type);
 
 bool Net_SendMessage(const NetMessage* message);
+// NET_EVENT_DATA_SENT for a vectored send passes the NetMessageV
+bool Net_SendMessageV(const NetMessageV* message);
 bool Net_ReceiveMessage(NetMessage* message);
 
+// UDP bursts, batch_depth datagrams per syscall. Each message's data and
+// length describe its buffer; received messages get the datagram length.
+// Both return the number of datagrams moved. Batched sends raise no
+// NET_EVENT_DATA_SENT.
+uint32_t Net_ReceiveMessages(NetMessage* messages, uint32_t max_messages);
+uint32_t Net_SendMessages(const NetMessage* messages, uint32_t count);
+
 void Net_RegisterCallback(NetEventType event, NetEventCallback callback, void* context);
 void Net_UnregisterCallback(NetEventType event, NetEventCallback callback);
 
 NetConnectionState Net_GetState(NetInterfaceType type);
 void Net_GetStatistics(NetInterfaceType type, NetStatistics* stats);
+void Net_ResetStatistics(NetInterfaceType type);
+
+// Latency histograms are kept when enable_statistics is set. Returns false
+// if the interface is unknown or statistics are disabled.
+bool Net_GetLatency(NetInterfaceType type, NetProtocolType protocol,
+                    NetDirection direction, NetLatencySummary* summary);
 
 void Net_Process(void);
 
+// Sleep until socket readiness, Net_Wake or the next heartbeat/reconnect
+// deadline, whichever comes first, then run Net_Process. Returns true when
+// woken by an event rather than the timeout.
+#define NET_WAIT_FOREVER 0xFFFFFFFFu
+bool Net_Wait(uint32_t timeout_ms);
+void Net_Wake(void);
+
 #endif // CANT_NET_CORE_H 
\ No newline at end of file
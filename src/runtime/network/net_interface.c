@@ -1,4 +1,5 @@
 #include "net_interface.h"
+#include "net_socket.h"
 #include "../diagnostic/logging/diag_logger.h"
 #include "../diagnostic/os/critical.h"
 #include "../platform/hardware/ethernet.h"
@@ -23,6 +24,20 @@ bool NetInterface_ConnectEthernet(const NetInterfaceConfig* config) {
     EthernetConfig* eth_config = (EthernetConfig*)config->interface_config;
     memcpy(&ethernet_config, eth_config, sizeof(EthernetConfig));
 
+#if NET_SOCKET_BACKEND
+    // The host kernel owns the NIC; open the configured transports instead
+    bool result = NetSocket_Init();
+    if (result && ethernet_config.open_tcp) {
+        result = NetSocket_Open(NET_SOCKET_TCP, config->address, config->port, 0);
+    }
+    if (result && ethernet_config.open_udp) {
+        result = NetSocket_Open(NET_SOCKET_UDP, config->address, config->port,
+                                ethernet_config.udp_local_port);
+    }
+    if (!result) {
+        NetSocket_Deinit();
+    }
+#else
     // Initialize Ethernet hardware
     EthernetInit_t init_params = {
         .mac_address = ethernet_config.mac_address,
@@ -37,6 +52,7 @@ bool NetInterface_ConnectEthernet(const NetInterfaceConfig* config) {
     if (result) {
         result = Ethernet_Start();
     }
+#endif
 
     exit_critical();
 
@@ -51,8 +67,13 @@ bool NetInterface_ConnectEthernet(const NetInterfaceConfig* config) {
 
 bool NetInterface_DisconnectEthernet(const NetInterfaceConfig* config) {
     enter_critical();
+#if NET_SOCKET_BACKEND
+    NetSocket_Deinit();
+    bool result = true;
+#else
     bool result = Ethernet_Stop();
     Ethernet_Deinit();
+#endif
     exit_critical();
 
     if (result) {
@@ -207,6 +228,112 @@ bool NetInterface_DisconnectCAN(const NetInterfaceConfig* config) {
     return result;
 }
 
+static bool socket_kind(NetProtocolType protocol, NetSocketKind* kind) {
+    switch (protocol) {
+        case NET_PROTO_TCP:
+            *kind = NET_SOCKET_TCP;
+            return true;
+        case NET_PROTO_UDP:
+            *kind = NET_SOCKET_UDP;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool socket_backed(NetInterfaceType type, NetProtocolType protocol, NetSocketKind* kind) {
+    return NET_SOCKET_BACKEND && type == NET_IF_ETHERNET && socket_kind(protocol, kind);
+}
+
+// No critical section: the socket layer serialises concurrent sends itself
+bool NetInterface_SendV(NetInterfaceType type, NetProtocolType protocol,
+                        const NetIoVec* iov, uint32_t iov_count, uint32_t flags) {
+    if (!iov || iov_count == 0) {
+        return false;
+    }
+
+    NetSocketKind kind;
+    if (socket_backed(type, protocol, &kind)) {
+        return NetSocket_Send(kind, iov, iov_count, (flags & NET_MSG_FLAG_MORE) != 0);
+    }
+
+    switch (type) {
+        case NET_IF_ETHERNET:
+            return Ethernet_SendV(iov, iov_count);
+        case NET_IF_WIFI:
+            return WiFi_SendV(iov, iov_count);
+        default:
+            Logger_Log(LOG_LEVEL_ERROR, "NETIF", "Vectored send not supported on interface %d", type);
+            return false;
+    }
+}
+
+int32_t NetInterface_Receive(NetInterfaceType type, NetProtocolType protocol,
+                             uint8_t* data, uint32_t max_length) {
+    NetSocketKind kind;
+    if (!socket_backed(type, protocol, &kind)) {
+        return -1;
+    }
+    return NetSocket_Receive(kind, data, max_length);
+}
+
+int32_t NetInterface_ReceiveBatch(NetInterfaceType type, NetProtocolType protocol,
+                                  NetMessage* messages, uint32_t count) {
+    NetSocketKind kind;
+    if (protocol != NET_PROTO_UDP || !socket_backed(type, protocol, &kind)) {
+        return -1;
+    }
+    return NetSocket_ReceiveBatch(kind, messages, count);
+}
+
+int32_t NetInterface_SendBatch(NetInterfaceType type, NetProtocolType protocol,
+                               const NetMessage* messages, uint32_t count) {
+    NetSocketKind kind;
+    if (protocol != NET_PROTO_UDP || !messages) {
+        return -1;
+    }
+    if (socket_backed(type, protocol, &kind)) {
+        return NetSocket_SendBatch(kind, messages, count);
+    }
+
+    // No batching syscall on this interface; send one by one
+    int32_t sent = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        NetIoVec iov = { messages[i].data, messages[i].length };
+        if (!NetInterface_SendV(type, protocol, &iov, 1, 0)) {
+            break;
+        }
+        sent++;
+    }
+    return sent;
+}
+
+bool NetInterface_IsReadable(NetInterfaceType type, NetProtocolType protocol) {
+    NetSocketKind kind;
+    return socket_backed(type, protocol, &kind) && NetSocket_IsReadable(kind);
+}
+
+uint32_t NetInterface_GetTxBacklog(NetInterfaceType type, NetProtocolType protocol) {
+    NetSocketKind kind;
+    return socket_backed(type, protocol, &kind) ? NetSocket_GetBacklog(kind) : 0;
+}
+
+bool NetInterface_IsConnected(NetInterfaceType type) {
+    if (!NET_SOCKET_BACKEND || type != NET_IF_ETHERNET) {
+        return true;
+    }
+    return (!ethernet_config.open_tcp || NetSocket_IsOpen(NET_SOCKET_TCP)) &&
+           (!ethernet_config.open_udp || NetSocket_IsOpen(NET_SOCKET_UDP));
+}
+
+int NetInterface_Wait(int32_t timeout_ms) {
+    return NetSocket_Poll(timeout_ms);
+}
+
+void NetInterface_Wake(void) {
+    NetSocket_Wake();
+}
+
 bool NetInterface_GetEthernetStatus(uint32_t* link_speed, bool* link_up) {
     if (!link_speed || !link_up) {
         return false;
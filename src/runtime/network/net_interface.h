@@ -13,6 +13,11 @@ typedef struct {
     char subnet_mask[16];
     char gateway[16];
     char dns_server[16];
+
+    // Socket backend: transports opened towards the interface address:port
+    bool open_tcp;
+    bool open_udp;
+    uint16_t udp_local_port;    // 0 picks an ephemeral port
 } EthernetConfig;
 
 // WiFi specific configuration
@@ -58,6 +63,30 @@ bool NetInterface_DisconnectCellular(const NetInterfaceConfig* config);
 bool NetInterface_ConnectCAN(const NetInterfaceConfig* config);
 bool NetInterface_DisconnectCAN(const NetInterfaceConfig* config);
 
+// Data path of a connected interface. Flags are NET_MSG_FLAG_*.
+bool NetInterface_SendV(NetInterfaceType type, NetProtocolType protocol,
+                        const NetIoVec* iov, uint32_t iov_count, uint32_t flags);
+int32_t NetInterface_Receive(NetInterfaceType type, NetProtocolType protocol,
+                             uint8_t* data, uint32_t max_length);
+bool NetInterface_IsReadable(NetInterfaceType type, NetProtocolType protocol);
+
+// Bytes accepted for sending but not yet taken by the transport
+uint32_t NetInterface_GetTxBacklog(NetInterfaceType type, NetProtocolType protocol);
+
+// Datagram batches; see NetSocket_ReceiveBatch/NetSocket_SendBatch
+int32_t NetInterface_ReceiveBatch(NetInterfaceType type, NetProtocolType protocol,
+                                  NetMessage* messages, uint32_t count);
+int32_t NetInterface_SendBatch(NetInterfaceType type, NetProtocolType protocol,
+                               const NetMessage* messages, uint32_t count);
+
+// False once a transport of the interface has been closed by its peer
+bool NetInterface_IsConnected(NetInterfaceType type);
+
+// Readiness wait across all socket-backed interfaces (-1 = forever).
+// Returns the number of events, or -1 when no interface can be waited on.
+int NetInterface_Wait(int32_t timeout_ms);
+void NetInterface_Wake(void);
+
 // Interface Status Functions
 bool NetInterface_GetEthernetStatus(uint32_t* link_speed, bool* link_up);
 bool NetInterface_GetWiFiStatus(int8_t* signal_strength, uint8_t* channel);
@@ -1,5 +1,6 @@
 #include "net_protocol.h"
 #include "net_interface.h"
+#include "mqtt_client.h"
 #include "../diagnostic/logging/diag_logger.h"
 #include "../diagnostic/os/critical.h"
 #include "../diagnostic/os/timer.h"
@@ -23,17 +24,24 @@ typedef struct {
     bool initialized;
 } CANContext;
 
-typedef struct {
-    MQTTConfig config;
-    uint32_t last_ping;
-    bool connected;
-} MQTTContext;
-
 // Protocol contexts
 static TCPContext tcp_context;
 static UDPContext udp_context;
 static CANContext can_context;
-static MQTTContext mqtt_context;
+
+static void tcp_track_result(bool result, InterfaceContext* ctx) {
+    if (result) {
+        tcp_context.retry_count = 0;
+    } else {
+        tcp_context.retry_count++;
+        if (tcp_context.retry_count >= tcp_context.config.max_retries) {
+            Logger_Log(LOG_LEVEL_ERROR, "NETPROTO", 
+                      "TCP max retries reached, disconnecting");
+            tcp_context.connected = false;
+            ctx->state = NET_STATE_DISCONNECTED;
+        }
+    }
+}
 
 bool NetProtocol_InitTCP(const TCPConfig* config) {
     if (!config) {
@@ -77,16 +85,13 @@ bool NetProtocol_InitCAN(const CANConfig* config) {
     return true;
 }
 
+// The MQTT engine lives in mqtt_client.c and rides on the TCP stream;
+// this keeps the protocol table entry point for it
 bool NetProtocol_InitMQTT(const MQTTConfig* config) {
-    if (!config) {
+    if (!MqttClient_Init(config, NULL)) {
         return false;
     }
 
-    enter_critical();
-    memset(&mqtt_context, 0, sizeof(MQTTContext));
-    memcpy(&mqtt_context.config, config, sizeof(MQTTConfig));
-    exit_critical();
-
     Logger_Log(LOG_LEVEL_INFO, "NETPROTO", "MQTT protocol initialized");
     return true;
 }
@@ -119,6 +124,93 @@ bool NetProtocol_SendMessage(const NetMessage* message, void* interface_context)
     return result;
 }
 
+void NetProtocol_OnConnected(void* interface_context) {
+    InterfaceContext* ctx = (InterfaceContext*)interface_context;
+    if (!ctx) {
+        return;
+    }
+
+    switch (ctx->config.type) {
+        case NET_IF_ETHERNET:
+        case NET_IF_WIFI:
+            tcp_context.connected = true;
+            tcp_context.retry_count = 0;
+            tcp_context.last_keepalive = Timer_GetMilliseconds();
+            udp_context.socket_open = true;
+            break;
+        case NET_IF_CAN:
+            can_context.initialized = true;
+            break;
+        default:
+            break;
+    }
+}
+
+void NetProtocol_OnDisconnected(void* interface_context) {
+    InterfaceContext* ctx = (InterfaceContext*)interface_context;
+    if (!ctx) {
+        return;
+    }
+
+    switch (ctx->config.type) {
+        case NET_IF_ETHERNET:
+        case NET_IF_WIFI:
+            tcp_context.connected = false;
+            udp_context.socket_open = false;
+            break;
+        case NET_IF_CAN:
+            can_context.initialized = false;
+            break;
+        default:
+            break;
+    }
+}
+
+// Vectored sends are passed to the interface as-is. Only the socket
+// protocols support them; CAN and MQTT frame their own payloads.
+bool NetProtocol_SendMessageV(const NetMessageV* message, void* interface_context) {
+    if (!message || !interface_context) {
+        return false;
+    }
+
+    InterfaceContext* ctx = (InterfaceContext*)interface_context;
+    bool result = false;
+
+    switch (message->protocol) {
+        case NET_PROTO_TCP:
+            if (!tcp_context.connected) {
+                return false;
+            }
+            result = NetInterface_SendV(ctx->config.type, message->protocol,
+                                        message->iov, message->iov_count, message->flags);
+            tcp_track_result(result, ctx);
+            break;
+        case NET_PROTO_UDP:
+            if (!udp_context.socket_open) {
+                return false;
+            }
+            result = NetInterface_SendV(ctx->config.type, message->protocol,
+                                        message->iov, message->iov_count, message->flags);
+            break;
+        default:
+            Logger_Log(LOG_LEVEL_ERROR, "NETPROTO", 
+                      "Vectored send not supported for protocol: %d", message->protocol);
+            break;
+    }
+
+    return result;
+}
+
+// Batches are UDP only; a stream has no datagram boundaries to batch on
+int32_t NetProtocol_SendBatch(const NetMessage* messages, uint32_t count, void* interface_context) {
+    if (!messages || !interface_context || !udp_context.socket_open) {
+        return -1;
+    }
+
+    InterfaceContext* ctx = (InterfaceContext*)interface_context;
+    return NetInterface_SendBatch(ctx->config.type, NET_PROTO_UDP, messages, count);
+}
+
 bool NetProtocol_ProcessReceived(void* interface_context) {
     if (!interface_context) {
         return false;
@@ -151,21 +243,6 @@ bool NetProtocol_ProcessReceived(void* interface_context) {
             }
             break;
 
-        case NET_IF_CELLULAR:
-            // Process MQTT ping
-            if (mqtt_context.connected) {
-                if (current_time - mqtt_context.last_ping >= 
-                    mqtt_context.config.keep_alive_interval * 1000) {
-                    NetMessage ping = {
-                        .protocol = NET_PROTO_MQTT,
-                        .length = 0
-                    };
-                    NetProtocol_HandleMQTT(&ping, interface_context);
-                    mqtt_context.last_ping = current_time;
-                }
-            }
-            break;
-
         default:
             break;
     }
@@ -179,23 +256,10 @@ bool NetProtocol_HandleTCP(const NetMessage* message, void* interface_context) {
     }
 
     InterfaceContext* ctx = (InterfaceContext*)interface_context;
-    bool result = false;
-
-    // Implementation specific TCP handling
-    // This would typically involve socket operations
+    NetIoVec iov = { message->data, message->length };
+    bool result = NetInterface_SendV(ctx->config.type, NET_PROTO_TCP, &iov, 1, message->flags);
     
-    if (result) {
-        tcp_context.retry_count = 0;
-    } else {
-        tcp_context.retry_count++;
-        if (tcp_context.retry_count >= tcp_context.config.max_retries) {
-            Logger_Log(LOG_LEVEL_ERROR, "NETPROTO", 
-                      "TCP max retries reached, disconnecting");
-            tcp_context.connected = false;
-            ctx->state = NET_STATE_DISCONNECTED;
-        }
-    }
-
+    tcp_track_result(result, ctx);
     return result;
 }
 
@@ -204,10 +268,9 @@ bool NetProtocol_HandleUDP(const NetMessage* message, void* interface_context) {
         return false;
     }
 
-    // Implementation specific UDP handling
-    // This would typically involve datagram socket operations
-
-    return true;
+    InterfaceContext* ctx = (InterfaceContext*)interface_context;
+    NetIoVec iov = { message->data, message->length };
+    return NetInterface_SendV(ctx->config.type, NET_PROTO_UDP, &iov, 1, message->flags);
 }
 
 bool NetProtocol_HandleCAN(const NetMessage* message, void* interface_context) {
@@ -221,13 +284,13 @@ bool NetProtocol_HandleCAN(const NetMessage* message, void* interface_context) {
     return true;
 }
 
+// MQTT packets need a topic, which NetMessage cannot carry; publishes go
+// through MqttClient_Publish and keep-alive through MqttClient_Process
 bool NetProtocol_HandleMQTT(const NetMessage* message, void* interface_context) {
-    if (!message || !interface_context || !mqtt_context.connected) {
+    if (!message || !interface_context) {
         return false;
     }
 
-    // Implementation specific MQTT handling
-    // This would typically involve MQTT client operations
-
-    return true;
+    Logger_Log(LOG_LEVEL_WARNING, "NETPROTO", "Use MqttClient_Publish for MQTT messages");
+    return false;
 } 
\ No newline at end of file
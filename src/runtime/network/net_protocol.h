@@ -5,6 +5,19 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Per-interface state owned by net_core.c and handed to the protocol handlers
+typedef struct {
+    NetInterfaceConfig config;
+    NetConnectionState state;
+    NetCounters counters;
+    NetHistogram* latency;                  // [protocol][direction], NULL without statistics
+    uint64_t rx_ready_ns[NET_PROTO_COUNT];  // When unread data arrived, 0 = none
+    uint32_t rx_queue_peak;
+    uint32_t tx_queue_peak;
+    uint32_t last_heartbeat;
+    bool active;
+} InterfaceContext;
+
 // Protocol-specific configuration structures
 typedef struct {
     uint16_t local_port;
@@ -48,7 +61,13 @@ bool NetProtocol_InitUDP(const UDPConfig* config);
 bool NetProtocol_InitCAN(const CANConfig* config);
 bool NetProtocol_InitMQTT(const MQTTConfig* config);
 
+// Link state hooks, called by net_core when an interface connects or drops
+void NetProtocol_OnConnected(void* interface_context);
+void NetProtocol_OnDisconnected(void* interface_context);
+
 bool NetProtocol_SendMessage(const NetMessage* message, void* interface_context);
+bool NetProtocol_SendMessageV(const NetMessageV* message, void* interface_context);
+int32_t NetProtocol_SendBatch(const NetMessage* messages, uint32_t count, void* interface_context);
 bool NetProtocol_ProcessReceived(void* interface_context);
 
 bool NetProtocol_HandleTCP(const NetMessage* message, void* interface_context);
@@ -0,0 +1,541 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE    // recvmmsg/sendmmsg
+#endif
+#include "net_socket.h"
+#include "net_buffer.h"
+#include "../diagnostic/logging/diag_logger.h"
+#include "../diagnostic/os/critical.h"
+#include <string.h>
+
+#if NET_SOCKET_BACKEND
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define WAKE_TAG    NET_SOCKET_COUNT
+#define MAX_EVENTS  8
+
+typedef struct {
+    int fd;
+    bool connecting;     // TCP connect still in flight
+    bool readable;       // Edge seen, socket not yet drained
+    bool closed;         // Peer closed or socket error
+    NetBuffer backlog;   // TCP bytes the kernel could not take yet
+} SocketState;
+
+static struct {
+    int epoll_fd;
+    int wake_fd;
+    SocketState sockets[NET_SOCKET_COUNT];
+    bool initialized;
+} backend;
+
+static bool make_address(const char* address, uint16_t port, struct sockaddr_in* addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+
+    if (!address) {
+        addr->sin_addr.s_addr = htonl(INADDR_ANY);
+        return true;
+    }
+    return inet_pton(AF_INET, address, &addr->sin_addr) == 1;
+}
+
+static bool valid_socket(NetSocketKind kind) {
+    return backend.initialized && kind < NET_SOCKET_COUNT &&
+           backend.sockets[kind].fd >= 0;
+}
+
+// Push queued TCP bytes out. The whole backlog goes out corked so the
+// chunks on either side of the ring wrap leave as full segments.
+static void flush_backlog(SocketState* s) {
+    if (NetBuffer_IsEmpty(&s->backlog)) {
+        return;
+    }
+
+    int flag = 1;
+    setsockopt(s->fd, IPPROTO_TCP, TCP_CORK, &flag, sizeof(flag));
+
+    const uint8_t* region;
+    uint32_t span;
+    while ((span = NetBuffer_PeekContiguous(&s->backlog, &region)) > 0) {
+        ssize_t sent = send(s->fd, region, span, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                s->closed = true;
+            }
+            break;
+        }
+
+        NetBuffer_Release(&s->backlog, (uint32_t)sent);
+        if ((uint32_t)sent < span) {
+            break;    // Socket buffer full; the next writable edge resumes
+        }
+    }
+
+    flag = 0;
+    setsockopt(s->fd, IPPROTO_TCP, TCP_CORK, &flag, sizeof(flag));
+}
+
+static bool send_stream(SocketState* s, const NetIoVec* iov, uint32_t iov_count, bool more) {
+    size_t total = 0;
+    for (uint32_t i = 0; i < iov_count; i++) {
+        total += iov[i].length;
+    }
+    if (total == 0) {
+        return true;
+    }
+
+    // Refuse up front rather than send a message that cannot be completed
+    if (total > NetBuffer_GetFree(&s->backlog)) {
+        Logger_Log(LOG_LEVEL_WARNING, "NETSOCK", "TCP backlog full, dropping %u bytes",
+                   (uint32_t)total);
+        return false;
+    }
+
+    // Queued bytes go first; new data joins the queue behind them. A send
+    // on a socket still connecting just reports EAGAIN until it is up.
+    size_t sent = 0;
+    if (NetBuffer_IsEmpty(&s->backlog)) {
+        struct iovec vec[NET_MAX_IOV];
+        memcpy(vec, iov, iov_count * sizeof(struct iovec));
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = vec;
+        msg.msg_iovlen = iov_count;
+
+        ssize_t result;
+        do {
+            result = sendmsg(s->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT | (more ? MSG_MORE : 0));
+        } while (result < 0 && errno == EINTR);
+
+        if (result < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK &&
+                !(s->connecting && errno == ENOTCONN)) {
+                s->closed = true;
+                return false;
+            }
+            result = 0;
+        } else {
+            s->connecting = false;
+        }
+        sent = (size_t)result;
+    }
+
+    // Queue whatever the kernel did not take
+    for (uint32_t i = 0; i < iov_count; i++) {
+        size_t length = iov[i].length;
+        if (sent >= length) {
+            sent -= length;
+            continue;
+        }
+        NetBuffer_Write(&s->backlog, (const uint8_t*)iov[i].data + sent,
+                        (uint32_t)(length - sent));
+        sent = 0;
+    }
+
+    return true;
+}
+
+static bool send_datagram(SocketState* s, const NetIoVec* iov, uint32_t iov_count) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = (struct iovec*)iov;
+    msg.msg_iovlen = iov_count;
+
+    ssize_t result;
+    do {
+        result = sendmsg(s->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    } while (result < 0 && errno == EINTR);
+
+    // A datagram that would block is dropped, never queued
+    return result >= 0;
+}
+
+bool NetSocket_Init(void) {
+    if (backend.initialized) {
+        return true;
+    }
+
+    memset(&backend, 0, sizeof(backend));
+    for (uint32_t i = 0; i < NET_SOCKET_COUNT; i++) {
+        backend.sockets[i].fd = -1;
+    }
+
+    backend.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    backend.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (backend.epoll_fd < 0 || backend.wake_fd < 0) {
+        Logger_Log(LOG_LEVEL_ERROR, "NETSOCK", "Failed to create epoll instance");
+        if (backend.epoll_fd >= 0) close(backend.epoll_fd);
+        if (backend.wake_fd >= 0) close(backend.wake_fd);
+        return false;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN | EPOLLET, .data.u32 = WAKE_TAG };
+    epoll_ctl(backend.epoll_fd, EPOLL_CTL_ADD, backend.wake_fd, &event);
+
+    backend.initialized = true;
+    return true;
+}
+
+void NetSocket_Deinit(void) {
+    if (!backend.initialized) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < NET_SOCKET_COUNT; i++) {
+        NetSocket_Close((NetSocketKind)i);
+    }
+
+    close(backend.wake_fd);
+    close(backend.epoll_fd);
+    backend.initialized = false;
+}
+
+bool NetSocket_Open(NetSocketKind kind, const char* address, uint16_t port,
+                    uint16_t local_port) {
+    if (!backend.initialized || kind >= NET_SOCKET_COUNT) {
+        return false;
+    }
+
+    struct sockaddr_in remote;
+    if ((kind == NET_SOCKET_TCP || address) && !make_address(address, port, &remote)) {
+        Logger_Log(LOG_LEVEL_ERROR, "NETSOCK", "Invalid address: %s", address ? address : "(null)");
+        return false;
+    }
+
+    NetSocket_Close(kind);
+    SocketState* s = &backend.sockets[kind];
+
+    int type = (kind == NET_SOCKET_TCP) ? SOCK_STREAM : SOCK_DGRAM;
+    s->fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s->fd < 0) {
+        Logger_Log(LOG_LEVEL_ERROR, "NETSOCK", "Socket creation failed");
+        return false;
+    }
+
+    struct epoll_event event = { .data.u32 = kind };
+    bool ok = true;
+
+    if (kind == NET_SOCKET_TCP) {
+        int flag = 1;
+        setsockopt(s->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+        ok = NetBuffer_InitSpsc(&s->backlog, NET_SOCKET_BACKLOG_SIZE);
+        if (ok && connect(s->fd, (struct sockaddr*)&remote, sizeof(remote)) < 0) {
+            ok = (errno == EINPROGRESS);
+            s->connecting = ok;
+        }
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    } else {
+        struct sockaddr_in local;
+        make_address(NULL, local_port, &local);
+        ok = bind(s->fd, (struct sockaddr*)&local, sizeof(local)) == 0;
+        if (ok && address) {
+            ok = connect(s->fd, (struct sockaddr*)&remote, sizeof(remote)) == 0;
+        }
+        event.events = EPOLLIN | EPOLLET;
+    }
+
+    if (ok) {
+        ok = epoll_ctl(backend.epoll_fd, EPOLL_CTL_ADD, s->fd, &event) == 0;
+    }
+
+    if (!ok) {
+        Logger_Log(LOG_LEVEL_ERROR, "NETSOCK", "Failed to open %s socket to %s:%u",
+                   kind == NET_SOCKET_TCP ? "TCP" : "UDP", address ? address : "*", port);
+        NetSocket_Close(kind);
+        return false;
+    }
+
+    return true;
+}
+
+void NetSocket_Close(NetSocketKind kind) {
+    if (!backend.initialized || kind >= NET_SOCKET_COUNT) {
+        return;
+    }
+
+    enter_critical();
+
+    SocketState* s = &backend.sockets[kind];
+    if (s->fd >= 0) {
+        close(s->fd);
+    }
+    if (s->backlog.data) {
+        NetBuffer_Deinit(&s->backlog);
+    }
+    memset(s, 0, sizeof(SocketState));
+    s->fd = -1;
+
+    exit_critical();
+}
+
+bool NetSocket_IsOpen(NetSocketKind kind) {
+    return valid_socket(kind) && !backend.sockets[kind].closed;
+}
+
+bool NetSocket_Send(NetSocketKind kind, const NetIoVec* iov, uint32_t iov_count,
+                    bool more) {
+    if (!NetSocket_IsOpen(kind) || !iov || iov_count == 0 || iov_count > NET_MAX_IOV) {
+        return false;
+    }
+
+    enter_critical();
+
+    SocketState* s = &backend.sockets[kind];
+    bool result = (kind == NET_SOCKET_TCP) ? send_stream(s, iov, iov_count, more)
+                                           : send_datagram(s, iov, iov_count);
+
+    exit_critical();
+    return result;
+}
+
+int32_t NetSocket_Receive(NetSocketKind kind, uint8_t* data, uint32_t max_length) {
+    if (!valid_socket(kind) || !data || max_length == 0) {
+        return -1;
+    }
+
+    // Held across recv so a readable edge handled by Poll cannot be
+    // overwritten by a stale "drained" result
+    enter_critical();
+
+    SocketState* s = &backend.sockets[kind];
+    ssize_t received;
+    do {
+        received = recv(s->fd, data, max_length, MSG_DONTWAIT);
+    } while (received < 0 && errno == EINTR);
+
+    int32_t result;
+    if (received > 0) {
+        result = (int32_t)received;
+    } else if (received == 0 && kind == NET_SOCKET_UDP) {
+        result = 0;   // Empty datagram
+    } else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        s->readable = false;
+        result = 0;
+    } else {
+        // Orderly shutdown or a hard error; UDP errors (ICMP) are not fatal
+        s->readable = false;
+        s->closed = (kind == NET_SOCKET_TCP);
+        result = -1;
+    }
+
+    exit_critical();
+    return result;
+}
+
+int32_t NetSocket_ReceiveBatch(NetSocketKind kind, NetMessage* messages, uint32_t count) {
+    if (kind != NET_SOCKET_UDP || !valid_socket(kind) || !messages || count == 0) {
+        return -1;
+    }
+    if (count > NET_SOCKET_MAX_BATCH) {
+        count = NET_SOCKET_MAX_BATCH;
+    }
+
+    struct mmsghdr headers[NET_SOCKET_MAX_BATCH];
+    struct iovec iov[NET_SOCKET_MAX_BATCH];
+    memset(headers, 0, count * sizeof(struct mmsghdr));
+    for (uint32_t i = 0; i < count; i++) {
+        iov[i].iov_base = messages[i].data;
+        iov[i].iov_len = messages[i].length;
+        headers[i].msg_hdr.msg_iov = &iov[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    enter_critical();
+
+    SocketState* s = &backend.sockets[kind];
+    int received;
+    do {
+        received = recvmmsg(s->fd, headers, count, MSG_DONTWAIT, NULL);
+    } while (received < 0 && errno == EINTR);
+
+    if (received < 0) {
+        bool drained = (errno == EAGAIN || errno == EWOULDBLOCK);
+        s->readable = false;
+        exit_critical();
+        return drained ? 0 : -1;
+    }
+
+    // A short batch means the queue ran dry; later datagrams raise a new edge
+    if ((uint32_t)received < count) {
+        s->readable = false;
+    }
+
+    exit_critical();
+
+    for (int i = 0; i < received; i++) {
+        messages[i].length = headers[i].msg_len;
+        messages[i].flags = (headers[i].msg_hdr.msg_flags & MSG_TRUNC) ? NET_MSG_FLAG_TRUNCATED : 0;
+    }
+    return received;
+}
+
+int32_t NetSocket_SendBatch(NetSocketKind kind, const NetMessage* messages, uint32_t count) {
+    if (kind != NET_SOCKET_UDP || !NetSocket_IsOpen(kind) || !messages || count == 0) {
+        return -1;
+    }
+    if (count > NET_SOCKET_MAX_BATCH) {
+        count = NET_SOCKET_MAX_BATCH;
+    }
+
+    struct mmsghdr headers[NET_SOCKET_MAX_BATCH];
+    struct iovec iov[NET_SOCKET_MAX_BATCH];
+    memset(headers, 0, count * sizeof(struct mmsghdr));
+    for (uint32_t i = 0; i < count; i++) {
+        iov[i].iov_base = messages[i].data;
+        iov[i].iov_len = messages[i].length;
+        headers[i].msg_hdr.msg_iov = &iov[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent;
+    do {
+        sent = sendmmsg(backend.sockets[kind].fd, headers, count, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+
+    // Datagrams that would block are dropped, as with NetSocket_Send
+    if (sent < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    return sent;
+}
+
+uint32_t NetSocket_GetBacklog(NetSocketKind kind) {
+    return valid_socket(kind) ? NetBuffer_GetAvailable(&backend.sockets[kind].backlog) : 0;
+}
+
+bool NetSocket_IsReadable(NetSocketKind kind) {
+    return valid_socket(kind) && backend.sockets[kind].readable;
+}
+
+int NetSocket_Poll(int32_t timeout_ms) {
+    if (!backend.initialized) {
+        return -1;
+    }
+
+    // Edge-triggered: a socket left undrained does not signal again, and
+    // Poll cannot drain it itself, so it still blocks. Whoever left the
+    // data behind calls NetSocket_Wake once it can take more.
+    struct epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(backend.epoll_fd, events, MAX_EVENTS, timeout_ms);
+    if (count < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+
+    enter_critical();
+
+    for (int i = 0; i < count; i++) {
+        uint32_t tag = events[i].data.u32;
+        if (tag == WAKE_TAG) {
+            uint64_t value;
+            ssize_t drained = read(backend.wake_fd, &value, sizeof(value));
+            (void)drained;
+            continue;
+        }
+
+        SocketState* s = &backend.sockets[tag];
+        if (s->fd < 0) {
+            continue;
+        }
+
+        // recv reports hangups and errors, so they count as readable
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            s->readable = true;
+        }
+
+        if (events[i].events & EPOLLOUT) {
+            if (s->connecting) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(s->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                s->connecting = false;
+                if (error) {
+                    Logger_Log(LOG_LEVEL_ERROR, "NETSOCK", "TCP connect failed: %s", strerror(error));
+                    s->closed = true;
+                    continue;
+                }
+            }
+            flush_backlog(s);
+        }
+    }
+
+    exit_critical();
+    return count;
+}
+
+void NetSocket_Wake(void) {
+    if (!backend.initialized) {
+        return;
+    }
+
+    uint64_t value = 1;
+    ssize_t written = write(backend.wake_fd, &value, sizeof(value));
+    (void)written;
+}
+
+#else
+
+bool NetSocket_Init(void) {
+    return false;
+}
+
+void NetSocket_Deinit(void) {
+}
+
+bool NetSocket_Open(NetSocketKind kind, const char* address, uint16_t port,
+                    uint16_t local_port) {
+    return false;
+}
+
+void NetSocket_Close(NetSocketKind kind) {
+}
+
+bool NetSocket_IsOpen(NetSocketKind kind) {
+    return false;
+}
+
+bool NetSocket_Send(NetSocketKind kind, const NetIoVec* iov, uint32_t iov_count,
+                    bool more) {
+    return false;
+}
+
+int32_t NetSocket_Receive(NetSocketKind kind, uint8_t* data, uint32_t max_length) {
+    return -1;
+}
+
+int32_t NetSocket_ReceiveBatch(NetSocketKind kind, NetMessage* messages, uint32_t count) {
+    return -1;
+}
+
+int32_t NetSocket_SendBatch(NetSocketKind kind, const NetMessage* messages, uint32_t count) {
+    return -1;
+}
+
+uint32_t NetSocket_GetBacklog(NetSocketKind kind) {
+    return 0;
+}
+
+bool NetSocket_IsReadable(NetSocketKind kind) {
+    return false;
+}
+
+int NetSocket_Poll(int32_t timeout_ms) {
+    return -1;
+}
+
+void NetSocket_Wake(void) {
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef CANT_NET_SOCKET_H
+#define CANT_NET_SOCKET_H
+
+#include "net_core.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Linux socket backend for NET_IF_ETHERNET: non-blocking TCP/UDP sockets
+// multiplexed on one edge-triggered epoll instance. Other platforms keep
+// the blocking platform/hardware drivers.
+#if defined(__linux__)
+#define NET_SOCKET_BACKEND 1
+#else
+#define NET_SOCKET_BACKEND 0
+#endif
+
+#define NET_SOCKET_BACKLOG_SIZE (64 * 1024)   // Unsent TCP bytes, power of two
+#define NET_SOCKET_MAX_BATCH    64            // Datagrams per recvmmsg/sendmmsg
+
+typedef enum {
+    NET_SOCKET_TCP = 0,
+    NET_SOCKET_UDP,
+    NET_SOCKET_COUNT
+} NetSocketKind;
+
+bool NetSocket_Init(void);
+void NetSocket_Deinit(void);
+
+// TCP connects to address:port without blocking. UDP binds local_port
+// (0 = ephemeral) and, when address is set, connects to address:port.
+bool NetSocket_Open(NetSocketKind kind, const char* address, uint16_t port,
+                    uint16_t local_port);
+void NetSocket_Close(NetSocketKind kind);
+bool NetSocket_IsOpen(NetSocketKind kind);
+
+// TCP bytes the socket cannot take right now are queued and flushed on the
+// next writable edge; `more` corks the segment until the burst ends. A UDP
+// datagram that would block is dropped.
+bool NetSocket_Send(NetSocketKind kind, const NetIoVec* iov, uint32_t iov_count,
+                    bool more);
+
+// Returns bytes read, 0 once the socket is drained, -1 if it closed
+int32_t NetSocket_Receive(NetSocketKind kind, uint8_t* data, uint32_t max_length);
+
+// UDP only: one recvmmsg/sendmmsg call for up to NET_SOCKET_MAX_BATCH
+// datagrams. On receive each message's length is its buffer capacity on
+// input and the datagram size on output. Both return the number of
+// datagrams moved, 0 when the socket is drained or full, -1 on error.
+int32_t NetSocket_ReceiveBatch(NetSocketKind kind, NetMessage* messages, uint32_t count);
+int32_t NetSocket_SendBatch(NetSocketKind kind, const NetMessage* messages, uint32_t count);
+
+// TCP bytes queued behind a full socket
+uint32_t NetSocket_GetBacklog(NetSocketKind kind);
+
+// Set by a readable edge and cleared when Receive drains the socket
+bool NetSocket_IsReadable(NetSocketKind kind);
+
+// Blocks until a socket becomes ready, NetSocket_Wake is called or the
+// timeout (ms, -1 = forever) expires. Returns the number of events
+// handled. Readiness is edge-triggered: data left undrained raises no new
+// event, so a caller that stops early wakes the poller when it resumes.
+int NetSocket_Poll(int32_t timeout_ms);
+void NetSocket_Wake(void);
+
+#endif // CANT_NET_SOCKET_H
@@ -0,0 +1,156 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE    // sched_getcpu
+#endif
+#include "net_stats.h"
+#include "../diagnostic/os/timer.h"
+#include <string.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+_Static_assert((NET_STATS_SHARDS & (NET_STATS_SHARDS - 1)) == 0, "shard count must be a power of two");
+_Static_assert(NET_HIST_MAX_BITS < 64, "histogram range must fit 64 bits");
+
+static uint32_t current_shard(void) {
+#if defined(__linux__) && NET_STATS_SHARDS > 1
+    // A migration between lookup and add only costs a shared cache line
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : (uint32_t)cpu & (NET_STATS_SHARDS - 1);
+#else
+    return 0;
+#endif
+}
+
+void NetCounters_Add(NetCounters* counters, NetCounter counter, uint64_t value) {
+    atomic_fetch_add_explicit(&counters->shards[current_shard()].value[counter], value,
+                              memory_order_relaxed);
+}
+
+void NetCounters_Sum(const NetCounters* counters, uint64_t totals[NET_COUNTER_COUNT]) {
+    memset(totals, 0, sizeof(uint64_t) * NET_COUNTER_COUNT);
+    for (uint32_t shard = 0; shard < NET_STATS_SHARDS; shard++) {
+        for (uint32_t i = 0; i < NET_COUNTER_COUNT; i++) {
+            totals[i] += atomic_load_explicit(&counters->shards[shard].value[i],
+                                              memory_order_relaxed);
+        }
+    }
+}
+
+void NetCounters_Reset(NetCounters* counters) {
+    for (uint32_t shard = 0; shard < NET_STATS_SHARDS; shard++) {
+        for (uint32_t i = 0; i < NET_COUNTER_COUNT; i++) {
+            atomic_store_explicit(&counters->shards[shard].value[i], 0, memory_order_relaxed);
+        }
+    }
+}
+
+uint32_t NetHistogram_BucketIndex(uint64_t value) {
+    const uint64_t limit = (1ull << NET_HIST_MAX_BITS) - 1;
+    if (value > limit) {
+        value = limit;
+    }
+
+    uint32_t msb = 63u - (uint32_t)__builtin_clzll(value | 1u);
+    uint32_t shift = msb > NET_HIST_SUB_BITS ? msb - NET_HIST_SUB_BITS : 0;
+    return shift * NET_HIST_SUB_COUNT + (uint32_t)(value >> shift);
+}
+
+uint64_t NetHistogram_BucketUpper(uint32_t index) {
+    uint32_t shift = index < 2 * NET_HIST_SUB_COUNT ? 0 : (index >> NET_HIST_SUB_BITS) - 1;
+    uint64_t sub = index - shift * NET_HIST_SUB_COUNT;
+    return ((sub + 1) << shift) - 1;
+}
+
+void NetHistogram_Record(NetHistogram* histogram, uint64_t value) {
+    atomic_fetch_add_explicit(&histogram->buckets[NetHistogram_BucketIndex(value)], 1,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum, value, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while (value > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max, &max, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void NetHistogram_Reset(NetHistogram* histogram) {
+    for (uint32_t i = 0; i < NET_HIST_BUCKETS; i++) {
+        atomic_store_explicit(&histogram->buckets[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&histogram->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->sum, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->max, 0, memory_order_relaxed);
+}
+
+// Buckets keep changing while they are read; percentiles come from one
+// copy so they agree with each other
+static uint64_t snapshot(const NetHistogram* histogram, uint32_t counts[NET_HIST_BUCKETS]) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < NET_HIST_BUCKETS; i++) {
+        counts[i] = atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        total += counts[i];
+    }
+    return total;
+}
+
+static uint64_t value_at(const uint32_t counts[NET_HIST_BUCKETS], uint64_t total,
+                         uint64_t max, double percentile) {
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    } else if (rank > total) {
+        rank = total;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < NET_HIST_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            uint64_t upper = NetHistogram_BucketUpper(i);
+            return (max && upper > max) ? max : upper;
+        }
+    }
+    return max;
+}
+
+uint64_t NetHistogram_Percentile(const NetHistogram* histogram, double percentile) {
+    uint32_t counts[NET_HIST_BUCKETS];
+    uint64_t total = snapshot(histogram, counts);
+    return value_at(counts, total, atomic_load_explicit(&histogram->max, memory_order_relaxed),
+                    percentile);
+}
+
+void NetHistogram_Summarize(const NetHistogram* histogram, NetLatencySummary* summary) {
+    uint32_t counts[NET_HIST_BUCKETS];
+    uint64_t total = snapshot(histogram, counts);
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+
+    memset(summary, 0, sizeof(NetLatencySummary));
+    if (total == 0) {
+        return;
+    }
+
+    summary->count = total;
+    summary->mean_ns = atomic_load_explicit(&histogram->sum, memory_order_relaxed) / total;
+    summary->p50_ns = value_at(counts, total, max, 50.0);
+    summary->p90_ns = value_at(counts, total, max, 90.0);
+    summary->p99_ns = value_at(counts, total, max, 99.0);
+    summary->p999_ns = value_at(counts, total, max, 99.9);
+    summary->max_ns = max;
+}
+
+uint64_t NetStats_Now(void) {
+    uint64_t ticks = Timer_GetHighResCounter();
+    uint64_t frequency = Timer_GetHighResFrequency();
+
+    if (frequency == 1000000000ull || frequency == 0) {
+        return ticks;
+    }
+    return ticks / frequency * 1000000000ull + ticks % frequency * 1000000000ull / frequency;
+}
@@ -0,0 +1,89 @@
+#ifndef CANT_NET_STATS_H
+#define CANT_NET_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#define NET_STATS_CACHE_LINE 64
+
+// Counter shards; each CPU adds to its own cache line and readers sum
+// them. Single-core targets need only one.
+#ifndef NET_STATS_SHARDS
+#if defined(__linux__)
+#define NET_STATS_SHARDS 16
+#else
+#define NET_STATS_SHARDS 1
+#endif
+#endif
+
+// Log-linear (HDR style) buckets: values below 2^(SUB_BITS+1) get a bucket
+// each, every power of two above that is split into 2^SUB_BITS buckets,
+// which bounds the relative error at 1/2^SUB_BITS. Values at or above
+// 2^MAX_BITS land in the top bucket.
+#ifndef NET_HIST_SUB_BITS
+#define NET_HIST_SUB_BITS   4
+#endif
+#define NET_HIST_SUB_COUNT  (1u << NET_HIST_SUB_BITS)
+#define NET_HIST_MAX_BITS   34      // Nanoseconds: ~17 s
+#define NET_HIST_BUCKETS    ((NET_HIST_MAX_BITS - NET_HIST_SUB_BITS + 1) * NET_HIST_SUB_COUNT)
+
+typedef enum {
+    NET_COUNTER_BYTES_SENT = 0,
+    NET_COUNTER_BYTES_RECEIVED,
+    NET_COUNTER_PACKETS_SENT,
+    NET_COUNTER_PACKETS_RECEIVED,
+    NET_COUNTER_ERRORS,
+    NET_COUNTER_CONNECTION_ATTEMPTS,
+    NET_COUNTER_SUCCESSFUL_CONNECTIONS,
+    NET_COUNTER_DISCONNECTIONS,
+    NET_COUNTER_COUNT
+} NetCounter;
+
+typedef struct {
+    _Alignas(NET_STATS_CACHE_LINE) _Atomic uint64_t value[NET_COUNTER_COUNT];
+} NetCounterShard;
+
+typedef struct {
+    NetCounterShard shards[NET_STATS_SHARDS];
+} NetCounters;
+
+// Buckets are shared and bumped with relaxed atomics; concurrent samples
+// rarely hit the same bucket, so per-CPU copies are not worth the memory.
+typedef struct {
+    _Atomic uint32_t buckets[NET_HIST_BUCKETS];
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum;
+    _Atomic uint64_t max;
+} NetHistogram;
+
+typedef struct {
+    uint64_t count;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} NetLatencySummary;
+
+// Lock-free; safe from any thread
+void NetCounters_Add(NetCounters* counters, NetCounter counter, uint64_t value);
+void NetCounters_Sum(const NetCounters* counters, uint64_t totals[NET_COUNTER_COUNT]);
+void NetCounters_Reset(NetCounters* counters);
+
+void NetHistogram_Record(NetHistogram* histogram, uint64_t value);
+void NetHistogram_Reset(NetHistogram* histogram);
+
+// Percentiles report the top of their bucket, never more than the max
+uint64_t NetHistogram_Percentile(const NetHistogram* histogram, double percentile);
+void NetHistogram_Summarize(const NetHistogram* histogram, NetLatencySummary* summary);
+
+// Bucket mapping, exposed for tests
+uint32_t NetHistogram_BucketIndex(uint64_t value);
+uint64_t NetHistogram_BucketUpper(uint32_t index);
+
+// Monotonic nanoseconds for latency samples
+uint64_t NetStats_Now(void);
+
+#endif // CANT_NET_STATS_H
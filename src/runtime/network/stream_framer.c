@@ -0,0 +1,214 @@
+#include "stream_framer.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FRAMER_SIMD_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FRAMER_SIMD_NEON 1
+#endif
+
+#define RING_MASK (FRAMER_RING_SIZE - 1)
+
+_Static_assert((FRAMER_RING_SIZE & RING_MASK) == 0, "ring size must be a power of two");
+_Static_assert(FRAMER_RING_SIZE >= 2 * FRAME_MAX_SIZE, "ring must hold two max frames");
+
+// Offset of the first sync byte in data, or length if there is none
+static uint32_t find_sync(const uint8_t* data, uint32_t length) {
+    uint32_t i = 0;
+
+#if defined(FRAMER_SIMD_SSE2)
+    const __m128i sync = _mm_set1_epi8((char)FRAME_SYNC_BYTE);
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, sync));
+        if (mask) {
+            return i + (uint32_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+#elif defined(FRAMER_SIMD_NEON)
+    const uint8x16_t sync = vdupq_n_u8(FRAME_SYNC_BYTE);
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t match = vceqq_u8(vld1q_u8(data + i), sync);
+        // Narrow each lane to a nibble so the 16 results fit one 64-bit word
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+        if (mask) {
+            return i + (uint32_t)(__builtin_ctzll(mask) >> 2);
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        if (data[i] == FRAME_SYNC_BYTE) {
+            return i;
+        }
+    }
+    return length;
+}
+
+uint8_t Framer_Checksum(const uint8_t* data, uint32_t length) {
+    uint32_t i = 0;
+    uint8_t sum = 0;
+
+#if defined(FRAMER_SIMD_SSE2)
+    // Lane-wise byte adds wrap mod 256, which is what the checksum wants
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        acc = _mm_add_epi8(acc, _mm_loadu_si128((const __m128i*)(data + i)));
+    }
+    __m128i halves = _mm_sad_epu8(acc, _mm_setzero_si128());
+    sum = (uint8_t)(_mm_cvtsi128_si32(halves) + _mm_cvtsi128_si32(_mm_srli_si128(halves, 8)));
+#elif defined(FRAMER_SIMD_NEON)
+    uint8x16_t acc = vdupq_n_u8(0);
+    for (; i + 16 <= length; i += 16) {
+        acc = vaddq_u8(acc, vld1q_u8(data + i));
+    }
+    uint64x2_t halves = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(acc)));
+    sum = (uint8_t)(vgetq_lane_u64(halves, 0) + vgetq_lane_u64(halves, 1));
+#endif
+
+    for (; i < length; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+void Framer_Init(StreamFramer* framer, FrameCallback callback, void* context) {
+    memset(framer, 0, sizeof(StreamFramer));
+    framer->callback = callback;
+    framer->context = context;
+}
+
+void Framer_Reset(StreamFramer* framer) {
+    atomic_store_explicit(&framer->tail, atomic_load_explicit(&framer->head, memory_order_acquire),
+                          memory_order_release);
+    framer->hunting = false;
+}
+
+uint32_t Framer_Write(StreamFramer* framer, const uint8_t* data, uint32_t length) {
+    if (!framer || !data || length == 0) {
+        return 0;
+    }
+
+    uint32_t head = atomic_load_explicit(&framer->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&framer->tail, memory_order_acquire);
+    uint32_t space = FRAMER_RING_SIZE - (head - tail);
+    uint32_t count = length < space ? length : space;
+
+    if (count < length) {
+        framer->stats.overflows++;
+        framer->stats.bytes_dropped += length - count;
+    }
+
+    uint32_t offset = head & RING_MASK;
+    uint32_t first = FRAMER_RING_SIZE - offset;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(&framer->ring[offset], data, first);
+    memcpy(framer->ring, data + first, count - first);
+
+    atomic_store_explicit(&framer->head, head + count, memory_order_release);
+    return count;
+}
+
+static uint8_t ring_at(const StreamFramer* framer, uint32_t position) {
+    return framer->ring[position & RING_MASK];
+}
+
+// Sum over a ring span that may wrap the end
+static uint8_t ring_checksum(const StreamFramer* framer, uint32_t position, uint32_t length) {
+    uint32_t offset = position & RING_MASK;
+    uint32_t first = FRAMER_RING_SIZE - offset;
+    if (first >= length) {
+        return Framer_Checksum(&framer->ring[offset], length);
+    }
+    return (uint8_t)(Framer_Checksum(&framer->ring[offset], first) +
+                     Framer_Checksum(framer->ring, length - first));
+}
+
+static void lose_sync(StreamFramer* framer) {
+    if (!framer->hunting) {
+        framer->hunting = true;
+        framer->stats.resyncs++;
+    }
+}
+
+uint32_t Framer_Process(StreamFramer* framer) {
+    if (!framer) {
+        return 0;
+    }
+
+    uint32_t head = atomic_load_explicit(&framer->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&framer->tail, memory_order_relaxed);
+    uint32_t delivered = 0;
+
+    while (head - tail >= FRAME_OVERHEAD) {
+        uint32_t available = head - tail;
+
+        if (ring_at(framer, tail) != FRAME_SYNC_BYTE) {
+            lose_sync(framer);
+
+            // Scan the contiguous span up to the ring end or the data end
+            uint32_t offset = tail & RING_MASK;
+            uint32_t span = FRAMER_RING_SIZE - offset;
+            if (span > available) {
+                span = available;
+            }
+            uint32_t skip = find_sync(&framer->ring[offset], span);
+            framer->stats.bytes_skipped += skip;
+            tail += skip;
+            continue;
+        }
+
+        uint32_t payload_length = ring_at(framer, tail + 1);
+        if (available < payload_length + FRAME_OVERHEAD) {
+            break;    // Wait for the rest of the frame
+        }
+
+        if (ring_checksum(framer, tail, payload_length + 2) !=
+            ring_at(framer, tail + payload_length + 2)) {
+            // Not a real frame start; hunt from the next byte
+            lose_sync(framer);
+            framer->stats.bytes_skipped++;
+            tail++;
+            continue;
+        }
+
+        uint32_t offset = (tail + 2) & RING_MASK;
+        const uint8_t* payload = &framer->ring[offset];
+        if (offset + payload_length > FRAMER_RING_SIZE) {
+            uint32_t first = FRAMER_RING_SIZE - offset;
+            memcpy(framer->scratch, payload, first);
+            memcpy(&framer->scratch[first], framer->ring, payload_length - first);
+            payload = framer->scratch;
+        }
+
+        if (framer->callback) {
+            framer->callback(payload, (uint16_t)payload_length, framer->context);
+        }
+
+        tail += payload_length + FRAME_OVERHEAD;
+        framer->hunting = false;
+        framer->stats.frames++;
+        delivered++;
+    }
+
+    // Give the space back once the callbacks are done with the ring
+    atomic_store_explicit(&framer->tail, tail, memory_order_release);
+    return delivered;
+}
+
+void Framer_GetStats(const StreamFramer* framer, FramerStats* stats) {
+    if (framer && stats) {
+        memcpy(stats, &framer->stats, sizeof(FramerStats));
+    }
+}
+
+void Framer_ResetStats(StreamFramer* framer) {
+    if (framer) {
+        memset(&framer->stats, 0, sizeof(FramerStats));
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef CANT_STREAM_FRAMER_H
+#define CANT_STREAM_FRAMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Frame layout: sync (0x55), payload length, payload, checksum, trailer.
+// The checksum is the byte sum of sync, length and payload.
+#define FRAME_SYNC_BYTE       0x55
+#define FRAME_OVERHEAD        4
+#define FRAME_MAX_PAYLOAD     255
+#define FRAME_MAX_SIZE        (FRAME_MAX_PAYLOAD + FRAME_OVERHEAD)
+#define FRAMER_RING_SIZE      2048    // Power of two, several max frames
+
+typedef void (*FrameCallback)(const uint8_t* payload, uint16_t length, void* context);
+
+typedef struct {
+    uint32_t frames;
+    uint32_t resyncs;          // Lost alignment: garbage or bad checksum
+    uint32_t bytes_skipped;    // Discarded while hunting for sync
+    uint32_t overflows;        // Writes that did not fit the ring
+    uint32_t bytes_dropped;    // Bytes lost to overflows
+} FramerStats;
+
+// One producer (Framer_Write, ISR safe) and one consumer (Framer_Process).
+// Frames are parsed in place; only a payload that wraps the ring end is
+// copied to scratch before the callback.
+typedef struct {
+    uint8_t ring[FRAMER_RING_SIZE];
+    uint8_t scratch[FRAME_MAX_PAYLOAD];
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    bool hunting;
+    FrameCallback callback;
+    void* context;
+    FramerStats stats;
+} StreamFramer;
+
+void Framer_Init(StreamFramer* framer, FrameCallback callback, void* context);
+void Framer_Reset(StreamFramer* framer);    // Drops queued bytes; consumer side
+
+// Queues bytes; whatever does not fit is dropped and counted. Returns the
+// number of bytes queued.
+uint32_t Framer_Write(StreamFramer* framer, const uint8_t* data, uint32_t length);
+
+// Delivers every complete frame queued so far. Returns the frame count.
+uint32_t Framer_Process(StreamFramer* framer);
+
+void Framer_GetStats(const StreamFramer* framer, FramerStats* stats);
+void Framer_ResetStats(StreamFramer* framer);
+
+// Exposed for tests and other checksum users
+uint8_t Framer_Checksum(const uint8_t* data, uint32_t length);
+
+#endif // CANT_STREAM_FRAMER_H
@@ -128,6 +128,19 @@ bool Ethernet_Send(const uint8_t* data, uint32_t length) {
     return (uint32_t)sent == length;
 }
 
+bool Ethernet_SendV(const IoSegment_t* segments, uint32_t count) {
+    if (!eth_ctx.initialized || !eth_ctx.running || !segments || count == 0) {
+        return false;
+    }
+
+    if (!Socket_SendV(eth_ctx.socket, segments, count)) {
+        Logger_Log(LOG_LEVEL_ERROR, "ETH", "Vectored send failed");
+        return false;
+    }
+
+    return true;
+}
+
 bool Ethernet_Receive(uint8_t* data, uint32_t* length) {
     if (!eth_ctx.initialized || !eth_ctx.running || !data || !length || *length == 0) {
         return false;
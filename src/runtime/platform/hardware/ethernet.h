@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "socket_io.h"
 
 typedef struct {
     char* mac_address;
@@ -21,6 +22,7 @@ bool Ethernet_GetStatus(uint32_t* link_speed, bool* link_up);
 
 // Data transmission
 bool Ethernet_Send(const uint8_t* data, uint32_t length);
+bool Ethernet_SendV(const IoSegment_t* segments, uint32_t count);
 bool Ethernet_Receive(uint8_t* data, uint32_t* length);
 
 #endif // CANT_PLATFORM_ETHERNET_H 
\ No newline at end of file
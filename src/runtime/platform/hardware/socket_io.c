@@ -0,0 +1,79 @@
+#include "socket_io.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+
+bool Socket_SendV(int socket, const IoSegment_t* segments, uint32_t count) {
+    if (!segments || count == 0 || count > IO_MAX_SEGMENTS) {
+        return false;
+    }
+
+    WSABUF buffers[IO_MAX_SEGMENTS];
+    DWORD total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        buffers[i].buf = (CHAR*)segments[i].data;
+        buffers[i].len = (ULONG)segments[i].length;
+        total += buffers[i].len;
+    }
+
+    // Blocking WSASend only returns once every buffer has been queued
+    DWORD sent = 0;
+    if (WSASend((SOCKET)socket, buffers, count, &sent, 0, NULL, NULL) != 0) {
+        return false;
+    }
+    return sent == total;
+}
+
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+
+_Static_assert(sizeof(IoSegment_t) == sizeof(struct iovec), "IoSegment_t must match struct iovec");
+_Static_assert(offsetof(IoSegment_t, data) == offsetof(struct iovec, iov_base), "IoSegment_t must match struct iovec");
+_Static_assert(offsetof(IoSegment_t, length) == offsetof(struct iovec, iov_len), "IoSegment_t must match struct iovec");
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+bool Socket_SendV(int socket, const IoSegment_t* segments, uint32_t count) {
+    if (!segments || count == 0 || count > IO_MAX_SEGMENTS) {
+        return false;
+    }
+
+    // Only the descriptors are copied so partial writes can trim them
+    struct iovec iov[IO_MAX_SEGMENTS];
+    memcpy(iov, segments, count * sizeof(struct iovec));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+
+    while (msg.msg_iovlen > 0) {
+        ssize_t sent = sendmsg(socket, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        // Drop fully written segments, then trim the one cut short
+        size_t remaining = (size_t)sent;
+        while (msg.msg_iovlen > 0 && remaining >= msg.msg_iov->iov_len) {
+            remaining -= msg.msg_iov->iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if (msg.msg_iovlen > 0) {
+            msg.msg_iov->iov_base = (uint8_t*)msg.msg_iov->iov_base + remaining;
+            msg.msg_iov->iov_len -= remaining;
+        }
+    }
+
+    return true;
+}
+#endif
@@ -0,0 +1,21 @@
+#ifndef CANT_PLATFORM_SOCKET_IO_H
+#define CANT_PLATFORM_SOCKET_IO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define IO_MAX_SEGMENTS 16
+
+// One scatter-gather segment. Laid out like POSIX struct iovec so segment
+// arrays reach sendmsg() without touching the data they describe.
+typedef struct {
+    const void* data;
+    size_t length;
+} IoSegment_t;
+
+// Send all segments in order as one stream write (or one datagram).
+// Partial writes resume mid-segment.
+bool Socket_SendV(int socket, const IoSegment_t* segments, uint32_t count);
+
+#endif // CANT_PLATFORM_SOCKET_IO_H
@@ -136,6 +136,19 @@ bool WiFi_Send(const uint8_t* data, uint32_t length) {
     return (uint32_t)sent == length;
 }
 
+bool WiFi_SendV(const IoSegment_t* segments, uint32_t count) {
+    if (!wifi_ctx.initialized || !wifi_ctx.connected || !segments || count == 0) {
+        return false;
+    }
+
+    if (!Socket_SendV(wifi_ctx.socket, segments, count)) {
+        Logger_Log(LOG_LEVEL_ERROR, "WIFI", "Vectored send failed");
+        return false;
+    }
+
+    return true;
+}
+
 bool WiFi_Receive(uint8_t* data, uint32_t* length) {
     if (!wifi_ctx.initialized || !wifi_ctx.connected || !data || !length || 
         *length == 0) {
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "socket_io.h"
 
 typedef struct {
     char* ssid;
@@ -22,6 +23,7 @@ bool WiFi_GetStatus(int8_t* signal_strength, uint8_t* channel);
 
 // Data transmission
 bool WiFi_Send(const uint8_t* data, uint32_t length);
+bool WiFi_SendV(const IoSegment_t* segments, uint32_t count);
 bool WiFi_Receive(uint8_t* data, uint32_t* length);
 
 #endif // CANT_PLATFORM_WIFI_H 
\ No newline at end of file
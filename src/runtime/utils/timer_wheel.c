@@ -0,0 +1,97 @@
+#include "timer_wheel.h"
+#include <stddef.h>
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+_Static_assert((TIMER_WHEEL_SLOTS & SLOT_MASK) == 0, "slot count must be a power of two");
+
+static uint32_t tick_of(const TimerWheel* wheel, uint32_t now_ms) {
+    return (now_ms - wheel->start_ms) / wheel->tick_ms;
+}
+
+static void unlink_entry(TimerWheelEntry* entry) {
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->next = NULL;
+    entry->prev = NULL;
+}
+
+void timer_wheel_init(TimerWheel* wheel, uint32_t tick_ms, uint32_t now_ms) {
+    for (uint32_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        wheel->buckets[i].next = &wheel->buckets[i];
+        wheel->buckets[i].prev = &wheel->buckets[i];
+    }
+    wheel->tick_ms = tick_ms ? tick_ms : 1;
+    wheel->start_ms = now_ms;
+    wheel->current = 0;
+    wheel->count = 0;
+}
+
+void timer_wheel_entry_init(TimerWheelEntry* entry) {
+    entry->next = NULL;
+    entry->prev = NULL;
+    entry->expires = 0;
+}
+
+void timer_wheel_schedule(TimerWheel* wheel, TimerWheelEntry* entry,
+                          uint32_t now_ms, uint32_t delay_ms) {
+    if (timer_wheel_is_scheduled(entry)) {
+        timer_wheel_cancel(wheel, entry);
+    }
+
+    // Round up so an entry never fires before its delay has passed
+    uint32_t expires = tick_of(wheel, now_ms) + (delay_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+    if ((int32_t)(expires - wheel->current) < 0) {
+        expires = wheel->current;
+    }
+    entry->expires = expires;
+
+    TimerWheelEntry* head = &wheel->buckets[expires & SLOT_MASK];
+    entry->next = head;
+    entry->prev = head->prev;
+    head->prev->next = entry;
+    head->prev = entry;
+    wheel->count++;
+}
+
+void timer_wheel_cancel(TimerWheel* wheel, TimerWheelEntry* entry) {
+    if (timer_wheel_is_scheduled(entry)) {
+        unlink_entry(entry);
+        wheel->count--;
+    }
+}
+
+bool timer_wheel_is_scheduled(const TimerWheelEntry* entry) {
+    return entry->next != NULL;
+}
+
+TimerWheelEntry* timer_wheel_expire(TimerWheel* wheel, uint32_t now_ms) {
+    uint32_t target = tick_of(wheel, now_ms);
+
+    if (wheel->count == 0) {
+        wheel->current = target;
+        return NULL;
+    }
+
+    // After a long gap one pass over every bucket is enough, as entries
+    // are compared against the target tick rather than the bucket's tick
+    if (target - wheel->current >= TIMER_WHEEL_SLOTS && (int32_t)(target - wheel->current) > 0) {
+        wheel->current = target - SLOT_MASK;
+    }
+
+    while ((int32_t)(target - wheel->current) >= 0) {
+        TimerWheelEntry* head = &wheel->buckets[wheel->current & SLOT_MASK];
+        for (TimerWheelEntry* entry = head->next; entry != head; entry = entry->next) {
+            if ((int32_t)(entry->expires - target) <= 0) {
+                unlink_entry(entry);
+                wheel->count--;
+                return entry;
+            }
+        }
+        if (wheel->current == target) {
+            break;
+        }
+        wheel->current++;
+    }
+    return NULL;
+}
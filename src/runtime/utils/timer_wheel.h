@@ -0,0 +1,38 @@
+#ifndef CANT_TIMER_WHEEL_H
+#define CANT_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Hashed timing wheel. Entries are intrusive, so scheduling and cancelling
+// are O(1) and never allocate. Delays longer than one revolution
+// (TIMER_WHEEL_SLOTS ticks) stay in their bucket for later rounds.
+#define TIMER_WHEEL_SLOTS   256    // Power of two
+
+typedef struct TimerWheelEntry {
+    struct TimerWheelEntry* next;
+    struct TimerWheelEntry* prev;
+    uint32_t expires;    // Absolute tick
+} TimerWheelEntry;
+
+typedef struct {
+    TimerWheelEntry buckets[TIMER_WHEEL_SLOTS];    // List heads
+    uint32_t tick_ms;
+    uint32_t start_ms;
+    uint32_t current;    // Next tick to expire
+    uint32_t count;
+} TimerWheel;
+
+// Timer wheel API
+void timer_wheel_init(TimerWheel* wheel, uint32_t tick_ms, uint32_t now_ms);
+void timer_wheel_entry_init(TimerWheelEntry* entry);
+void timer_wheel_schedule(TimerWheel* wheel, TimerWheelEntry* entry,
+                          uint32_t now_ms, uint32_t delay_ms);
+void timer_wheel_cancel(TimerWheel* wheel, TimerWheelEntry* entry);
+bool timer_wheel_is_scheduled(const TimerWheelEntry* entry);
+
+// Unlinks and returns one entry due at now_ms, or NULL once none are left.
+// Call in a loop; an entry may be rescheduled before the next call.
+TimerWheelEntry* timer_wheel_expire(TimerWheel* wheel, uint32_t now_ms);
+
+#endif // CANT_TIMER_WHEEL_H
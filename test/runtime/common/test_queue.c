@@ -0,0 +1,195 @@
+#include "unity.h"
+#include "common/queue.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define STRESS_THREADS  4
+#define STRESS_ITEMS    50000u
+
+typedef struct {
+    uint32_t producer;
+    uint32_t sequence;
+} Item;
+
+static Queue queue;
+
+void setUp(void) {
+    memset(&queue, 0, sizeof(queue));
+}
+
+void tearDown(void) {
+    queue_destroy(&queue);
+}
+
+void test_Queue_InitRoundsCapacity(void) {
+    TEST_ASSERT_FALSE(queue_init(&queue, 0, 8));
+    TEST_ASSERT_FALSE(queue_init(&queue, sizeof(uint32_t), 0));
+
+    TEST_ASSERT_TRUE(queue_init(&queue, sizeof(uint32_t), 20));
+    TEST_ASSERT_EQUAL_UINT32(32, queue_capacity(&queue));
+    TEST_ASSERT_EQUAL_UINT32(0, queue_count(&queue));
+}
+
+void test_Queue_FifoFullAndEmpty(void) {
+    uint32_t value;
+
+    TEST_ASSERT_TRUE(queue_init(&queue, sizeof(uint32_t), 4));
+    TEST_ASSERT_FALSE(queue_pop(&queue, &value, sizeof(value)));
+
+    // Wrap the ring several times
+    for (uint32_t round = 0; round < 3; round++) {
+        for (uint32_t i = 0; i < 4; i++) {
+            value = round * 10 + i;
+            TEST_ASSERT_TRUE(queue_push(&queue, &value, sizeof(value)));
+        }
+        TEST_ASSERT_FALSE(queue_push(&queue, &value, sizeof(value)));
+        TEST_ASSERT_EQUAL_UINT32(4, queue_count(&queue));
+
+        for (uint32_t i = 0; i < 4; i++) {
+            TEST_ASSERT_TRUE(queue_pop(&queue, &value, sizeof(value)));
+            TEST_ASSERT_EQUAL_UINT32(round * 10 + i, value);
+        }
+        TEST_ASSERT_FALSE(queue_pop(&queue, &value, sizeof(value)));
+    }
+}
+
+void test_Queue_RejectsWrongElementSize(void) {
+    uint64_t value = 1;
+
+    TEST_ASSERT_TRUE(queue_init(&queue, sizeof(uint32_t), 4));
+    TEST_ASSERT_FALSE(queue_push(&queue, &value, sizeof(value)));
+    TEST_ASSERT_FALSE(queue_pop(&queue, &value, sizeof(value)));
+}
+
+void test_Queue_BatchPushAndPop(void) {
+    uint32_t in[10];
+    uint32_t out[10];
+
+    for (uint32_t i = 0; i < 10; i++) {
+        in[i] = 100 + i;
+    }
+
+    TEST_ASSERT_TRUE(queue_init(&queue, sizeof(uint32_t), 8));
+
+    // A batch larger than the free space moves what fits
+    TEST_ASSERT_EQUAL_UINT32(8, queue_push_n(&queue, in, 10));
+    TEST_ASSERT_EQUAL_UINT32(0, queue_push_n(&queue, in, 1));
+
+    TEST_ASSERT_EQUAL_UINT32(3, queue_pop_n(&queue, out, 3));
+    TEST_ASSERT_EQUAL_MEMORY(in, out, 3 * sizeof(uint32_t));
+
+    // Wraps around the end of the ring
+    TEST_ASSERT_EQUAL_UINT32(2, queue_push_n(&queue, &in[8], 2));
+    TEST_ASSERT_EQUAL_UINT32(7, queue_pop_n(&queue, out, 10));
+    TEST_ASSERT_EQUAL_MEMORY(&in[3], out, 7 * sizeof(uint32_t));
+    TEST_ASSERT_EQUAL_UINT32(0, queue_pop_n(&queue, out, 10));
+}
+
+void test_Queue_SingleProducerPush(void) {
+    uint32_t value;
+
+    TEST_ASSERT_TRUE(queue_init(&queue, sizeof(uint32_t), 2));
+    for (uint32_t i = 0; i < 2; i++) {
+        TEST_ASSERT_TRUE(queue_push_sp(&queue, &i, sizeof(i)));
+    }
+    TEST_ASSERT_FALSE(queue_push_sp(&queue, &value, sizeof(value)));
+
+    TEST_ASSERT_TRUE(queue_pop(&queue, &value, sizeof(value)));
+    TEST_ASSERT_EQUAL_UINT32(0, value);
+    TEST_ASSERT_TRUE(queue_push_sp(&queue, &value, sizeof(value)));
+    TEST_ASSERT_EQUAL_UINT32(2, queue_count(&queue));
+}
+
+void test_Queue_Clear(void) {
+    uint32_t value = 7;
+
+    TEST_ASSERT_TRUE(queue_init(&queue, sizeof(uint32_t), 8));
+    for (uint32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(queue_push(&queue, &value, sizeof(value)));
+    }
+
+    queue_clear(&queue);
+    TEST_ASSERT_EQUAL_UINT32(0, queue_count(&queue));
+    TEST_ASSERT_FALSE(queue_pop(&queue, &value, sizeof(value)));
+
+    // Still usable at full capacity afterwards
+    TEST_ASSERT_EQUAL_UINT32(8, queue_push_n(&queue, (uint32_t[8]){ 0 }, 8));
+}
+
+static void* stress_producer(void* arg) {
+    Item item = { .producer = (uint32_t)(uintptr_t)arg };
+    Item batch[4];
+
+    while (item.sequence < STRESS_ITEMS) {
+        // Alternate single and batch pushes so both paths race each other
+        if (item.sequence & 1) {
+            uint32_t n = 0;
+            for (; n < 4 && item.sequence + n < STRESS_ITEMS; n++) {
+                batch[n] = (Item){ item.producer, item.sequence + n };
+            }
+            size_t pushed = queue_push_n(&queue, batch, n);
+            item.sequence += (uint32_t)pushed;
+            if (pushed == 0) {
+                sched_yield();
+            }
+        } else if (queue_push(&queue, &item, sizeof(item))) {
+            item.sequence++;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static _Atomic uint32_t consumed;
+static uint64_t consumer_sums[STRESS_THREADS];
+
+static void* stress_consumer(void* arg) {
+    uint32_t index = (uint32_t)(uintptr_t)arg;
+    uint32_t last[STRESS_THREADS];
+    Item items[8];
+
+    memset(last, 0xFF, sizeof(last));
+    while (atomic_load(&consumed) < STRESS_THREADS * STRESS_ITEMS) {
+        size_t count = (index & 1) ? queue_pop_n(&queue, items, 8)
+                                   : queue_pop(&queue, items, sizeof(Item));
+        for (size_t i = 0; i < count; i++) {
+            // Each producer's items reach any one consumer in order
+            TEST_ASSERT_TRUE(last[items[i].producer] == UINT32_MAX ||
+                             items[i].sequence > last[items[i].producer]);
+            last[items[i].producer] = items[i].sequence;
+            consumer_sums[index] += items[i].sequence;
+        }
+        if (count == 0) {
+            sched_yield();
+        }
+        atomic_fetch_add(&consumed, (uint32_t)count);
+    }
+    return NULL;
+}
+
+void test_Queue_ConcurrentProducersAndConsumers(void) {
+    pthread_t producers[STRESS_THREADS];
+    pthread_t consumers[STRESS_THREADS];
+    uint64_t total = 0;
+
+    TEST_ASSERT_TRUE(queue_init(&queue, sizeof(Item), 64));
+    atomic_store(&consumed, 0);
+    memset(consumer_sums, 0, sizeof(consumer_sums));
+
+    for (uintptr_t i = 0; i < STRESS_THREADS; i++) {
+        pthread_create(&consumers[i], NULL, stress_consumer, (void*)i);
+        pthread_create(&producers[i], NULL, stress_producer, (void*)i);
+    }
+    for (uint32_t i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+        total += consumer_sums[i];
+    }
+
+    // Every item exactly once
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)STRESS_THREADS * STRESS_ITEMS * (STRESS_ITEMS - 1) / 2,
+                             total);
+    TEST_ASSERT_EQUAL_UINT32(0, queue_count(&queue));
+}
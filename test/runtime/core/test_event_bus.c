@@ -0,0 +1,227 @@
+#include "unity.h"
+#include "core/event_bus.h"
+#include <pthread.h>
+#include <string.h>
+
+#define PRODUCERS           4
+#define EVENTS_PER_PRODUCER 5000
+
+typedef struct {
+    uint32_t count;
+    uint32_t last_value;
+    uint32_t sum;
+} Received;
+
+static Received received;
+
+static void record_event(const BusEvent* event, void* context) {
+    Received* r = (Received*)context;
+    uint32_t value;
+
+    memcpy(&value, event->payload, sizeof(value));
+    r->count++;
+    r->last_value = value;
+    r->sum += value;
+}
+
+static int32_t subscribe(EventPolicy policy, uint16_t depth, uint32_t type_mask) {
+    EventSubscription subscription = {
+        .topic = EVENT_TOPIC_USER,
+        .type_mask = type_mask,
+        .handler = record_event,
+        .context = &received,
+        .payload_size = sizeof(uint32_t),
+        .depth = depth,
+        .policy = policy
+    };
+    return EventBus_Subscribe(&subscription);
+}
+
+static void publish(uint32_t value) {
+    EventBus_Publish(EVENT_TOPIC_USER, 0, &value, sizeof(value));
+}
+
+void setUp(void) {
+    memset(&received, 0, sizeof(received));
+}
+
+void tearDown(void) {
+    EventBus_Deinit();
+}
+
+void test_EventBus_DeliversOnDispatchOnly(void) {
+    TEST_ASSERT_TRUE(subscribe(EVENT_POLICY_DROP_NEWEST, 8, EVENT_TYPE_ALL) >= 0);
+
+    publish(7);
+    TEST_ASSERT_EQUAL_UINT32(0, received.count);
+
+    TEST_ASSERT_EQUAL_UINT32(1, EventBus_Dispatch(0));
+    TEST_ASSERT_EQUAL_UINT32(1, received.count);
+    TEST_ASSERT_EQUAL_UINT32(7, received.last_value);
+}
+
+void test_EventBus_FiltersByType(void) {
+    TEST_ASSERT_TRUE(subscribe(EVENT_POLICY_DROP_NEWEST, 8, 1u << 2) >= 0);
+
+    uint32_t value = 1;
+    EventBus_Publish(EVENT_TOPIC_USER, 1, &value, sizeof(value));
+    EventBus_Publish(EVENT_TOPIC_USER, 2, &value, sizeof(value));
+    EventBus_Publish(EVENT_TOPIC_LOG, 2, &value, sizeof(value));
+
+    EventBus_Dispatch(0);
+    TEST_ASSERT_EQUAL_UINT32(1, received.count);
+}
+
+void test_EventBus_DropNewestKeepsFirst(void) {
+    int32_t id = subscribe(EVENT_POLICY_DROP_NEWEST, 4, EVENT_TYPE_ALL);
+    EventBusStats stats;
+
+    for (uint32_t i = 1; i <= 6; i++) {
+        publish(i);
+    }
+    EventBus_Dispatch(0);
+
+    TEST_ASSERT_EQUAL_UINT32(4, received.count);
+    TEST_ASSERT_EQUAL_UINT32(4, received.last_value);
+    TEST_ASSERT_TRUE(EventBus_GetStats(id, &stats));
+    TEST_ASSERT_EQUAL_UINT32(2, stats.dropped);
+}
+
+void test_EventBus_DropOldestKeepsLatest(void) {
+    int32_t id = subscribe(EVENT_POLICY_DROP_OLDEST, 4, EVENT_TYPE_ALL);
+    EventBusStats stats;
+
+    for (uint32_t i = 1; i <= 6; i++) {
+        publish(i);
+    }
+    EventBus_Dispatch(0);
+
+    TEST_ASSERT_EQUAL_UINT32(4, received.count);
+    TEST_ASSERT_EQUAL_UINT32(6, received.last_value);
+    TEST_ASSERT_EQUAL_UINT32(3 + 4 + 5 + 6, received.sum);
+    TEST_ASSERT_TRUE(EventBus_GetStats(id, &stats));
+    TEST_ASSERT_EQUAL_UINT32(2, stats.dropped);
+}
+
+static void republish(const BusEvent* event, void* context) {
+    uint32_t value;
+
+    record_event(event, context);
+    memcpy(&value, event->payload, sizeof(value));
+    if (value == 100) {
+        for (uint32_t i = 1; i <= 6; i++) {
+            publish(i);
+        }
+    }
+}
+
+void test_EventBus_HandlerPublishesToOwnFullQueue(void) {
+    EventSubscription subscription = {
+        .topic = EVENT_TOPIC_USER,
+        .type_mask = EVENT_TYPE_ALL,
+        .handler = republish,
+        .context = &received,
+        .payload_size = sizeof(uint32_t),
+        .depth = 4,
+        .policy = EVENT_POLICY_DROP_OLDEST
+    };
+    int32_t id = EventBus_Subscribe(&subscription);
+    EventBusStats stats;
+
+    for (uint32_t i = 100; i < 104; i++) {
+        publish(i);
+    }
+    EventBus_Dispatch(0);
+
+    // The cell being handled is free again, so the handler's events
+    // displace older ones and the latest four survive
+    TEST_ASSERT_EQUAL_UINT32(5, received.count);
+    TEST_ASSERT_EQUAL_UINT32(6, received.last_value);
+    TEST_ASSERT_EQUAL_UINT32(100 + 3 + 4 + 5 + 6, received.sum);
+    TEST_ASSERT_TRUE(EventBus_GetStats(id, &stats));
+    TEST_ASSERT_EQUAL_UINT32(5, stats.dropped);
+}
+
+void test_EventBus_UnsubscribeStopsDelivery(void) {
+    int32_t id = subscribe(EVENT_POLICY_DROP_NEWEST, 8, EVENT_TYPE_ALL);
+
+    publish(1);
+    EventBus_Unsubscribe(id);
+    publish(2);
+
+    TEST_ASSERT_EQUAL_UINT32(0, EventBus_Dispatch(0));
+    TEST_ASSERT_EQUAL_UINT32(0, received.count);
+
+    // The slot is reusable once dispatch has reclaimed it
+    TEST_ASSERT_EQUAL_INT32(id, subscribe(EVENT_POLICY_DROP_NEWEST, 8, EVENT_TYPE_ALL));
+}
+
+void test_EventBus_FlushBeforeUnsubscribe(void) {
+    int32_t id = subscribe(EVENT_POLICY_DROP_NEWEST, 8, EVENT_TYPE_ALL);
+    Received other = { 0 };
+    EventSubscription subscription = {
+        .topic = EVENT_TOPIC_USER,
+        .type_mask = EVENT_TYPE_ALL,
+        .handler = record_event,
+        .context = &other,
+        .payload_size = sizeof(uint32_t)
+    };
+    TEST_ASSERT_TRUE(EventBus_Subscribe(&subscription) >= 0);
+
+    publish(1);
+    publish(2);
+
+    // Only the flushed subscriber's handlers run
+    TEST_ASSERT_EQUAL_UINT32(2, EventBus_Flush(id));
+    EventBus_Unsubscribe(id);
+    TEST_ASSERT_EQUAL_UINT32(2, received.count);
+    TEST_ASSERT_EQUAL_UINT32(2, received.last_value);
+    TEST_ASSERT_EQUAL_UINT32(0, other.count);
+
+    TEST_ASSERT_EQUAL_UINT32(2, EventBus_Dispatch(0));
+    TEST_ASSERT_EQUAL_UINT32(2, other.count);
+    TEST_ASSERT_EQUAL_UINT32(2, received.count);
+    TEST_ASSERT_EQUAL_UINT32(0, EventBus_Flush(id));
+}
+
+void test_EventBus_RejectsOversizedPayload(void) {
+    TEST_ASSERT_TRUE(subscribe(EVENT_POLICY_DROP_NEWEST, 8, EVENT_TYPE_ALL) >= 0);
+
+    uint64_t wide = 1;
+    TEST_ASSERT_FALSE(EventBus_Publish(EVENT_TOPIC_USER, 0, &wide, sizeof(wide)));
+    TEST_ASSERT_EQUAL_UINT32(0, EventBus_Dispatch(0));
+}
+
+static void* producer(void* arg) {
+    uint32_t base = (uint32_t)(uintptr_t)arg;
+    for (uint32_t i = 0; i < EVENTS_PER_PRODUCER; i++) {
+        publish(base + i);
+    }
+    return NULL;
+}
+
+void test_EventBus_WorkerDrainsConcurrentProducers(void) {
+    pthread_t threads[PRODUCERS];
+    uint32_t expected = 0;
+    EventBusStats stats;
+
+    int32_t id = subscribe(EVENT_POLICY_BLOCK, 256, EVENT_TYPE_ALL);
+    TEST_ASSERT_TRUE(EventBus_StartWorker());
+
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        pthread_create(&threads[p], NULL, producer, (void*)(uintptr_t)(p * EVENTS_PER_PRODUCER));
+        for (uint32_t i = 0; i < EVENTS_PER_PRODUCER; i++) {
+            expected += p * EVENTS_PER_PRODUCER + i;
+        }
+    }
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        pthread_join(threads[p], NULL);
+    }
+    EventBus_StopWorker();
+    EventBus_Dispatch(0);
+
+    TEST_ASSERT_TRUE(EventBus_GetStats(id, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(PRODUCERS * EVENTS_PER_PRODUCER, received.count);
+    TEST_ASSERT_EQUAL_UINT32(expected, received.sum);
+}
@@ -0,0 +1,132 @@
+#include "unity.h"
+#include "drivers/can_filter.h"
+#include <stdlib.h>
+#include <string.h>
+
+static CANFilter* filter;
+
+// Reference: first matching rule in order
+static uint16_t linear_lookup(const CANFilterRule* rules, size_t count,
+                              uint32_t id, bool is_extended) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t width = rules[i].is_extended ? 0x1FFFFFFFu : 0x7FFu;
+        if (rules[i].is_extended == is_extended &&
+            ((id ^ rules[i].id) & rules[i].mask & width) == 0) {
+            return rules[i].target;
+        }
+    }
+    return CAN_FILTER_REJECT;
+}
+
+static uint32_t next_random(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+void setUp(void) {
+    filter = NULL;
+}
+
+void tearDown(void) {
+    can_filter_destroy(filter);
+}
+
+void test_CANFilter_EmptySetRejects(void) {
+    filter = can_filter_compile(NULL, 0);
+    TEST_ASSERT_NOT_NULL(filter);
+    TEST_ASSERT_EQUAL_UINT16(CAN_FILTER_REJECT, can_filter_lookup(filter, 0x123, false));
+    TEST_ASSERT_EQUAL_UINT16(CAN_FILTER_REJECT, can_filter_lookup(filter, 0x123, true));
+}
+
+void test_CANFilter_StandardIds(void) {
+    const CANFilterRule rules[] = {
+        { .id = 0x7DF, .mask = 0x7FF, .target = 1 },            // OBD functional
+        { .id = 0x7E0, .mask = 0x7F8, .target = 2 },            // 0x7E0..0x7E7
+        { .id = 0x100, .mask = 0x700, .target = 3 }             // 0x100..0x1FF
+    };
+
+    filter = can_filter_compile(rules, 3);
+    TEST_ASSERT_EQUAL_UINT16(1, can_filter_lookup(filter, 0x7DF, false));
+    TEST_ASSERT_EQUAL_UINT16(2, can_filter_lookup(filter, 0x7E5, false));
+    TEST_ASSERT_EQUAL_UINT16(3, can_filter_lookup(filter, 0x1AB, false));
+    TEST_ASSERT_EQUAL_UINT16(CAN_FILTER_REJECT, can_filter_lookup(filter, 0x7E8, false));
+
+    // Format is part of the match
+    TEST_ASSERT_EQUAL_UINT16(CAN_FILTER_REJECT, can_filter_lookup(filter, 0x7DF, true));
+}
+
+void test_CANFilter_ExtendedExactAndMasked(void) {
+    const CANFilterRule rules[] = {
+        { .id = 0x18DAF110, .mask = 0x1FFFFFFF, .is_extended = true, .target = 4 },
+        { .id = 0x18FEF100, .mask = 0x03FFFF00, .is_extended = true, .target = 5 },  // J1939 PGN
+        { .id = 0x0CF00400, .mask = 0x1FFFFF00, .is_extended = true, .target = 6 }   // Narrow
+    };
+
+    filter = can_filter_compile(rules, 3);
+    TEST_ASSERT_EQUAL_UINT32(1, can_filter_mask_groups(filter));
+
+    TEST_ASSERT_EQUAL_UINT16(4, can_filter_lookup(filter, 0x18DAF110, true));
+    TEST_ASSERT_EQUAL_UINT16(5, can_filter_lookup(filter, 0x1CFEF1AA, true));
+    TEST_ASSERT_EQUAL_UINT16(5, can_filter_lookup(filter, 0x00FEF101, true));
+    TEST_ASSERT_EQUAL_UINT16(6, can_filter_lookup(filter, 0x0CF004FE, true));
+    TEST_ASSERT_EQUAL_UINT16(CAN_FILTER_REJECT, can_filter_lookup(filter, 0x0CF00500, true));
+    TEST_ASSERT_EQUAL_UINT16(CAN_FILTER_REJECT, can_filter_lookup(filter, 0x110, false));
+}
+
+void test_CANFilter_FirstRuleWins(void) {
+    const CANFilterRule rules[] = {
+        { .id = 0x18FEF100, .mask = 0x1FFFFFFF, .is_extended = true, .target = CAN_FILTER_REJECT },
+        { .id = 0x00FEF100, .mask = 0x03FFFF00, .is_extended = true, .target = 7 },
+        { .id = 0x18FEF1AA, .mask = 0x1FFFFFFF, .is_extended = true, .target = 8 },
+        { .id = 0x123, .mask = 0x7FF, .target = 9 },
+        { .id = 0x100, .mask = 0x700, .target = 10 }
+    };
+
+    filter = can_filter_compile(rules, 5);
+
+    // An earlier deny rule blocks what a later rule would accept
+    TEST_ASSERT_EQUAL_UINT16(CAN_FILTER_REJECT, can_filter_lookup(filter, 0x18FEF100, true));
+    // The masked rule comes before the exact one
+    TEST_ASSERT_EQUAL_UINT16(7, can_filter_lookup(filter, 0x18FEF1AA, true));
+    TEST_ASSERT_EQUAL_UINT16(9, can_filter_lookup(filter, 0x123, false));
+    TEST_ASSERT_EQUAL_UINT16(10, can_filter_lookup(filter, 0x124, false));
+}
+
+void test_CANFilter_MatchesLinearScan(void) {
+    static const uint32_t masks[] = {
+        0x1FFFFFFF, 0x1FFFFFF0, 0x1FFFFF00, 0x03FFFF00, 0x00FFFF00, 0x1FFF0000
+    };
+    CANFilterRule rules[500];
+    uint32_t state = 0x2545F491u;
+
+    for (uint32_t i = 0; i < 500; i++) {
+        bool is_extended = next_random(&state) & 1;
+        rules[i].is_extended = is_extended;
+        rules[i].target = (uint16_t)(i % 97);
+        if (is_extended) {
+            // Few distinct high bits so masked rules overlap exact ones
+            rules[i].id = (next_random(&state) & 0x0003FFFF) | 0x18F00000;
+            rules[i].mask = masks[next_random(&state) % 6];
+        } else {
+            rules[i].id = next_random(&state) & 0x7FF;
+            rules[i].mask = 0x7FF << (next_random(&state) % 4);
+        }
+    }
+
+    filter = can_filter_compile(rules, 500);
+    TEST_ASSERT_NOT_NULL(filter);
+
+    for (uint32_t i = 0; i < 200000; i++) {
+        bool is_extended = next_random(&state) & 1;
+        uint32_t id = is_extended ? (next_random(&state) & 0x0003FFFF) | 0x18F00000
+                                  : next_random(&state) & 0x7FF;
+        if (i & 1) {
+            id = rules[i % 500].id ^ (next_random(&state) & 0x0F);
+            is_extended = rules[i % 500].is_extended;
+        }
+        TEST_ASSERT_EQUAL_UINT16(linear_lookup(rules, 500, id, is_extended),
+                                 can_filter_lookup(filter, id, is_extended));
+    }
+}
@@ -0,0 +1,104 @@
+#include "unity.h"
+#include "drivers/can_frame.h"
+#include <string.h>
+
+static CANFrameBatch batch;
+
+static CANFrame make_frame(uint32_t id, bool is_extended, uint8_t length) {
+    CANFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.is_extended = is_extended;
+    frame.dlc = length;
+    for (uint8_t i = 0; i < length; i++) {
+        frame.data[i] = (uint8_t)(0xA0 + i);
+    }
+    return frame;
+}
+
+void setUp(void) {
+    memset(&batch, 0, sizeof(batch));
+}
+
+void tearDown(void) {
+    can_batch_destroy(&batch);
+}
+
+void test_CANFrame_CompactRoundTrip(void) {
+    CANFrame frame = make_frame(0x18DAF110, true, 8);
+    CANClassicFrame compact;
+    CANFrame expanded;
+
+    frame.is_remote = true;
+    TEST_ASSERT_TRUE(can_frame_compact(&frame, &compact));
+    TEST_ASSERT_EQUAL_UINT8(CAN_FRAME_EXTENDED | CAN_FRAME_REMOTE, compact.flags);
+
+    can_frame_expand(&compact, &expanded);
+    TEST_ASSERT_EQUAL_HEX32(0x18DAF110, expanded.id);
+    TEST_ASSERT_EQUAL_UINT8(8, expanded.dlc);
+    TEST_ASSERT_TRUE(expanded.is_extended);
+    TEST_ASSERT_TRUE(expanded.is_remote);
+    TEST_ASSERT_FALSE(expanded.is_fd);
+    TEST_ASSERT_EQUAL_MEMORY(frame.data, expanded.data, 8);
+}
+
+void test_CANFrame_CompactRejectsFd(void) {
+    CANFrame frame = make_frame(0x123, false, 12);
+    CANClassicFrame compact;
+    CANFDFrame fd;
+    CANFrame expanded;
+
+    frame.is_fd = true;
+    TEST_ASSERT_FALSE(can_frame_compact(&frame, &compact));
+
+    TEST_ASSERT_TRUE(can_frame_compact_fd(&frame, &fd));
+    can_frame_expand_fd(&fd, &expanded);
+    TEST_ASSERT_TRUE(expanded.is_fd);
+    TEST_ASSERT_EQUAL_UINT8(12, expanded.dlc);
+    TEST_ASSERT_EQUAL_MEMORY(frame.data, expanded.data, 12);
+}
+
+void test_CANFrameBatch_AddAndGet(void) {
+    CANFrame frame;
+
+    TEST_ASSERT_TRUE(can_batch_init(&batch, 3, false));
+    TEST_ASSERT_EQUAL_UINT32(8, batch.payload_size);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        frame = make_frame(0x100 + i, false, (uint8_t)(i + 1));
+        frame.timestamp = 1000 + i;
+        TEST_ASSERT_TRUE(can_batch_add(&batch, &frame));
+    }
+    TEST_ASSERT_FALSE(can_batch_add(&batch, &frame));
+    TEST_ASSERT_EQUAL_UINT32(3, batch.count);
+
+    // Arrays line up by index
+    TEST_ASSERT_EQUAL_HEX32(0x101, batch.ids[1]);
+    TEST_ASSERT_EQUAL_UINT8(2, batch.dlcs[1]);
+    TEST_ASSERT_EQUAL_UINT64(1001, batch.timestamps[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xA1, can_batch_payload(&batch, 1)[1]);
+
+    can_batch_get(&batch, 2, &frame);
+    TEST_ASSERT_EQUAL_HEX32(0x102, frame.id);
+    TEST_ASSERT_EQUAL_UINT8(3, frame.dlc);
+    TEST_ASSERT_EQUAL_UINT64(1002, frame.timestamp);
+
+    can_batch_clear(&batch);
+    TEST_ASSERT_EQUAL_UINT32(0, batch.count);
+}
+
+void test_CANFrameBatch_PayloadWidth(void) {
+    CANFrame frame = make_frame(0x321, false, 64);
+    CANFrame out;
+
+    frame.is_fd = true;
+    TEST_ASSERT_TRUE(can_batch_init(&batch, 4, false));
+    TEST_ASSERT_FALSE(can_batch_add(&batch, &frame));
+    can_batch_destroy(&batch);
+
+    TEST_ASSERT_TRUE(can_batch_init(&batch, 4, true));
+    TEST_ASSERT_TRUE(can_batch_add(&batch, &frame));
+    TEST_ASSERT_EQUAL_UINT8(CAN_FRAME_FD, batch.flags[0]);
+    can_batch_get(&batch, 0, &out);
+    TEST_ASSERT_EQUAL_MEMORY(frame.data, out.data, 64);
+}
@@ -0,0 +1,266 @@
+#include "unity.h"
+#include "drivers/can_replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+
+// Parsing runs anywhere; replay needs vcan0 like the SocketCAN tests:
+//   ip link add dev vcan0 type vcan && ip link set vcan0 mtu 72 up
+
+static CANTrace* trace;
+static CANDriver* player;
+static CANDriver* listener;
+static bool have_vcan;
+
+// Stand-in for the stack under test: answers every 0x7E0 request
+static struct {
+    uint32_t requests_seen;
+    uint32_t others_seen;
+} responder;
+
+static const char candump_log[] =
+    "(1436509052.249713) can0 123#DEADBEEF\n"
+    "(1436509052.250713) can0 18DAF110#0210.01\n"
+    "(1436509052.251713) can0 7DF#R\n"
+    "(1436509052.252713) can0 321##1000102030405060708090A0B\n"
+    "(1436509052.253713) can0 20000004#0000000000000000\n"     // Error frame
+    "garbage line\n"
+    "(1436509052.254713) can0 0C8#";
+
+static const char asc_log[] =
+    "date Wed Jun 12 10:00:00 am 2024\r\n"
+    "base hex  timestamps absolute\r\n"
+    "Begin Triggerblock Wed Jun 12 10:00:00 am 2024\r\n"
+    "   0.000000 Start of measurement\r\n"
+    "   1.500000 1  123             Rx   d 8 01 02 03 04 05 06 07 08\r\n"
+    "   1.510000 1  18DAF110x       Tx   d 3 02 10 03\r\n"
+    "   1.520000 1  7DF             Rx   r\r\n"
+    "   1.530000 1  ErrorFrame\r\n"
+    "   1.540000 CANFD   1 Rx        321  Engine  1 0 9 12 00 01 02 03 04 05 06 07 08 09 0a 0b\r\n"
+    "End TriggerBlock\r\n";
+
+static void parse(const char* text) {
+    trace = can_trace_parse(text, strlen(text), 1);
+    TEST_ASSERT_NOT_NULL(trace);
+}
+
+static CANDriver* open_driver(void) {
+    CANConfig config = { .interface_name = "vcan0" };
+    CANDriver* driver = can_create(&config);
+    TEST_ASSERT_NOT_NULL(driver);
+    TEST_ASSERT_TRUE(can_start(driver));
+    return driver;
+}
+
+static void answer_requests(void* context) {
+    CANFrame frame;
+    (void)context;
+
+    while (can_receive(listener, &frame, 0)) {
+        if (frame.id != 0x7E0) {
+            responder.others_seen++;
+            continue;
+        }
+        responder.requests_seen++;
+
+        CANFrame response;
+        memset(&response, 0, sizeof(response));
+        response.id = 0x7E8;
+        response.dlc = 3;
+        response.data[0] = 0x02;
+        response.data[1] = frame.data[1] + 0x40;
+        response.data[2] = frame.data[2];
+        can_transmit(listener, &response, 10);
+    }
+}
+
+void setUp(void) {
+    trace = NULL;
+    player = NULL;
+    listener = NULL;
+    memset(&responder, 0, sizeof(responder));
+    have_vcan = if_nametoindex("vcan0") != 0;
+    if (have_vcan) {
+        player = open_driver();
+        listener = open_driver();
+    }
+}
+
+void tearDown(void) {
+    can_trace_destroy(trace);
+    can_destroy(player);
+    can_destroy(listener);
+}
+
+void test_CANReplay_ParsesCandumpLog(void) {
+    parse(candump_log);
+    const CANFrameBatch* frames = can_trace_frames(trace);
+
+    TEST_ASSERT_EQUAL_UINT32(5, frames->count);
+    TEST_ASSERT_EQUAL_UINT32(2, can_trace_skipped_lines(trace));
+    TEST_ASSERT_EQUAL_UINT32(64, frames->payload_size);
+
+    TEST_ASSERT_EQUAL_HEX32(0x123, frames->ids[0]);
+    TEST_ASSERT_EQUAL_UINT8(4, frames->dlcs[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xEF, can_batch_payload(frames, 0)[3]);
+    TEST_ASSERT_EQUAL_UINT64(0, frames->timestamps[0]);
+
+    TEST_ASSERT_EQUAL_HEX32(0x18DAF110, frames->ids[1]);
+    TEST_ASSERT_EQUAL_UINT8(CAN_FRAME_EXTENDED, frames->flags[1]);
+    TEST_ASSERT_EQUAL_UINT8(3, frames->dlcs[1]);
+    TEST_ASSERT_EQUAL_UINT64(1000000, frames->timestamps[1]);
+
+    TEST_ASSERT_EQUAL_UINT8(CAN_FRAME_REMOTE, frames->flags[2]);
+
+    TEST_ASSERT_EQUAL_UINT8(CAN_FRAME_FD, frames->flags[3]);
+    TEST_ASSERT_EQUAL_UINT8(12, frames->dlcs[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x0B, can_batch_payload(frames, 3)[11]);
+
+    // No data and no trailing newline
+    TEST_ASSERT_EQUAL_HEX32(0x0C8, frames->ids[4]);
+    TEST_ASSERT_EQUAL_UINT8(0, frames->dlcs[4]);
+    TEST_ASSERT_EQUAL_UINT64(5000000, frames->timestamps[4]);
+}
+
+void test_CANReplay_ParsesAsc(void) {
+    parse(asc_log);
+    const CANFrameBatch* frames = can_trace_frames(trace);
+
+    TEST_ASSERT_EQUAL_UINT32(4, frames->count);
+
+    TEST_ASSERT_EQUAL_HEX32(0x123, frames->ids[0]);
+    TEST_ASSERT_EQUAL_UINT8(8, frames->dlcs[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x08, can_batch_payload(frames, 0)[7]);
+
+    TEST_ASSERT_EQUAL_HEX32(0x18DAF110, frames->ids[1]);
+    TEST_ASSERT_EQUAL_UINT8(CAN_FRAME_EXTENDED, frames->flags[1]);
+    TEST_ASSERT_EQUAL_UINT64(10000000, frames->timestamps[1]);
+
+    TEST_ASSERT_EQUAL_UINT8(CAN_FRAME_REMOTE, frames->flags[2]);
+
+    TEST_ASSERT_EQUAL_HEX32(0x321, frames->ids[3]);
+    TEST_ASSERT_EQUAL_UINT8(CAN_FRAME_FD, frames->flags[3]);
+    TEST_ASSERT_EQUAL_UINT8(12, frames->dlcs[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x0B, can_batch_payload(frames, 3)[11]);
+}
+
+void test_CANReplay_ParallelParseMatchesSerial(void) {
+    size_t lines = 50000;
+    char* text = malloc(lines * 48);
+    size_t length = 0;
+    TEST_ASSERT_NOT_NULL(text);
+
+    for (size_t i = 0; i < lines; i++) {
+        if (i % 97 == 0) {
+            length += (size_t)sprintf(text + length, "# comment %zu\n", i);
+        } else {
+            length += (size_t)sprintf(text + length, "(%zu.%06zu) can0 %03zX#%08zX\n",
+                                      1000 + i / 1000, i % 1000 * 1000, i & 0x7FF, i);
+        }
+    }
+
+    CANTrace* serial = can_trace_parse(text, length, 1);
+    trace = can_trace_parse(text, length, 4);
+    TEST_ASSERT_NOT_NULL(serial);
+    TEST_ASSERT_NOT_NULL(trace);
+
+    const CANFrameBatch* a = can_trace_frames(serial);
+    const CANFrameBatch* b = can_trace_frames(trace);
+    TEST_ASSERT_EQUAL_UINT32(lines - (lines + 96) / 97, a->count);
+    TEST_ASSERT_EQUAL_UINT32(a->count, b->count);
+    TEST_ASSERT_EQUAL_MEMORY(a->ids, b->ids, a->count * sizeof(uint32_t));
+    TEST_ASSERT_EQUAL_MEMORY(a->timestamps, b->timestamps, a->count * sizeof(uint64_t));
+    TEST_ASSERT_EQUAL_MEMORY(a->data, b->data, a->count * a->payload_size);
+
+    can_trace_destroy(serial);
+    free(text);
+}
+
+void test_CANReplay_LoadsMappedFile(void) {
+    char path[] = "/tmp/can_replay_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    TEST_ASSERT_EQUAL_INT((int)strlen(candump_log), (int)write(fd, candump_log, strlen(candump_log)));
+    close(fd);
+
+    trace = can_trace_load(path, 0);
+    unlink(path);
+    TEST_ASSERT_NOT_NULL(trace);
+    TEST_ASSERT_EQUAL_UINT32(5, can_trace_frames(trace)->count);
+
+    TEST_ASSERT_NULL(can_trace_load("/nonexistent/trace.log", 0));
+}
+
+void test_CANReplay_PacesAtScaledSpeed(void) {
+    char text[2048];
+    size_t length = 0;
+    CANReplayStats stats;
+
+    if (!have_vcan) TEST_IGNORE_MESSAGE("vcan0 not available");
+
+    // 20 frames over 95 ms
+    for (int i = 0; i < 20; i++) {
+        length += (size_t)sprintf(text + length, "(100.%06d) can0 %03X#%02X\n", i * 5000, 0x100 + i, i);
+    }
+    parse(text);
+
+    CANReplayConfig config = {
+        .mode = CAN_REPLAY_SCALED,
+        .speed = 2.0,
+        .batch_size = 8,
+        .timeout_ms = 10
+    };
+    TEST_ASSERT_TRUE(can_replay_run(trace, player, &config, &stats));
+    TEST_ASSERT_EQUAL_UINT64(20, stats.frames_sent);
+    TEST_ASSERT_TRUE(stats.elapsed_ns >= 47000000u);
+    TEST_ASSERT_TRUE(stats.elapsed_ns < 200000000u);
+
+    for (int i = 0; i < 20; i++) {
+        CANFrame frame;
+        TEST_ASSERT_TRUE(can_receive(listener, &frame, 100));
+        TEST_ASSERT_EQUAL_HEX32(0x100 + i, frame.id);
+    }
+
+    config.mode = CAN_REPLAY_UNPACED;
+    TEST_ASSERT_TRUE(can_replay_run(trace, player, &config, &stats));
+    TEST_ASSERT_EQUAL_UINT64(20, stats.frames_sent);
+    TEST_ASSERT_TRUE(stats.elapsed_ns < 40000000u);
+    TEST_ASSERT_TRUE(stats.frames_per_second > 0.0);
+}
+
+void test_CANReplay_ProbesRequestLatency(void) {
+    CANReplayStats stats;
+
+    if (!have_vcan) TEST_IGNORE_MESSAGE("vcan0 not available");
+
+    // Recorded tester session: requests on 0x7E0, the ECU's answers on 0x7E8
+    parse("(0.000) can0 7E0#0210030000000000\n"
+          "(0.001) can0 7E8#0250030000000000\n"
+          "(0.002) can0 123#01\n"
+          "(0.010) can0 7E0#023E000000000000\n"
+          "(0.011) can0 7E8#027E000000000000\n"
+          "(0.020) can0 7E0#0322F19000000000\n"
+          "(0.021) can0 7E8#0362F19000000000\n");
+
+    CANReplayConfig config = {
+        .mode = CAN_REPLAY_REALTIME,
+        .batch_size = 4,
+        .timeout_ms = 100,
+        .probe = true,
+        .request_id = 0x7E0,
+        .response_id = 0x7E8,
+        .service = answer_requests
+    };
+    TEST_ASSERT_TRUE(can_replay_run(trace, player, &config, &stats));
+
+    // Recorded responses stay off the bus; the responder answers instead
+    TEST_ASSERT_EQUAL_UINT64(4, stats.frames_sent);
+    TEST_ASSERT_EQUAL_UINT32(3, responder.requests_seen);
+    TEST_ASSERT_EQUAL_UINT32(1, responder.others_seen);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.requests);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.responses);
+    TEST_ASSERT_TRUE(stats.latency_p50_ns > 0);
+    TEST_ASSERT_TRUE(stats.latency_max_ns >= stats.latency_p99_ns);
+}
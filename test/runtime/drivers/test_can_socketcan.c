@@ -0,0 +1,216 @@
+#include "unity.h"
+#include "drivers/can_driver.h"
+#include <string.h>
+#include <net/if.h>
+
+// Runs against vcan0:
+//   ip link add dev vcan0 type vcan && ip link set vcan0 mtu 72 up
+// Frames one socket sends on a vcan are seen by every other socket on it,
+// so one driver transmits and a second receives.
+
+static CANDriver* tx;
+static CANDriver* rx;
+static bool have_vcan;
+
+static CANDriver* open_driver(bool fd_enabled) {
+    CANConfig config = {
+        .fd_enabled = fd_enabled,
+        .interface_name = "vcan0"
+    };
+    CANDriver* driver = can_create(&config);
+    TEST_ASSERT_NOT_NULL(driver);
+    TEST_ASSERT_TRUE(can_start(driver));
+    return driver;
+}
+
+static CANFrame make_frame(uint32_t id, bool is_extended, uint8_t length) {
+    CANFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.is_extended = is_extended;
+    frame.dlc = length;
+    for (uint8_t i = 0; i < length; i++) {
+        frame.data[i] = (uint8_t)(id + i);
+    }
+    return frame;
+}
+
+void setUp(void) {
+    have_vcan = if_nametoindex("vcan0") != 0;
+    tx = NULL;
+    rx = NULL;
+    if (have_vcan) {
+        tx = open_driver(false);
+        rx = open_driver(false);
+    }
+}
+
+void tearDown(void) {
+    can_destroy(tx);
+    can_destroy(rx);
+}
+
+void test_SocketCAN_RejectsMissingInterface(void) {
+    CANConfig config = { .interface_name = "nocan9" };
+    CANDriver* driver = can_create(&config);
+
+    TEST_ASSERT_NOT_NULL(driver);
+    TEST_ASSERT_FALSE(can_start(driver));
+    TEST_ASSERT_EQUAL(CAN_STATE_STOPPED, can_get_state(driver));
+    TEST_ASSERT_EQUAL(CAN_ERROR_HARDWARE, can_get_last_error(driver));
+    can_destroy(driver);
+
+    config.interface_name = NULL;
+    TEST_ASSERT_NULL(can_create(&config));
+}
+
+void test_SocketCAN_Loopback(void) {
+    CANFrame sent = make_frame(0x123, false, 8);
+    CANFrame extended = make_frame(0x18DAF110, true, 3);
+    CANFrame received;
+
+    if (!have_vcan) TEST_IGNORE_MESSAGE("vcan0 not available");
+
+    TEST_ASSERT_TRUE(can_transmit(tx, &sent, 10));
+    TEST_ASSERT_TRUE(can_transmit(tx, &extended, 10));
+
+    TEST_ASSERT_TRUE(can_receive(rx, &received, 100));
+    TEST_ASSERT_EQUAL_HEX32(0x123, received.id);
+    TEST_ASSERT_FALSE(received.is_extended);
+    TEST_ASSERT_FALSE(received.is_fd);
+    TEST_ASSERT_EQUAL_UINT8(8, received.dlc);
+    TEST_ASSERT_EQUAL_MEMORY(sent.data, received.data, 8);
+    TEST_ASSERT_TRUE(received.timestamp != 0);
+
+    uint64_t first = received.timestamp;
+    TEST_ASSERT_TRUE(can_receive(rx, &received, 100));
+    TEST_ASSERT_EQUAL_HEX32(0x18DAF110, received.id);
+    TEST_ASSERT_TRUE(received.is_extended);
+    TEST_ASSERT_EQUAL_UINT8(3, received.dlc);
+    TEST_ASSERT_TRUE(received.timestamp >= first);
+
+    // The sender does not see its own frames
+    TEST_ASSERT_FALSE(can_receive(tx, &received, 0));
+}
+
+void test_SocketCAN_ReceivesInBatches(void) {
+    CANFrameBatch out;
+    CANFrameBatch in;
+    CANStats stats;
+    uint32_t total = 0;
+
+    if (!have_vcan) TEST_IGNORE_MESSAGE("vcan0 not available");
+
+    TEST_ASSERT_TRUE(can_batch_init(&out, 100, false));
+    TEST_ASSERT_TRUE(can_batch_init(&in, 32, false));
+    for (uint32_t i = 0; i < 100; i++) {
+        CANFrame frame = make_frame(0x200 + i, false, 4);
+        TEST_ASSERT_TRUE(can_batch_add(&out, &frame));
+    }
+    TEST_ASSERT_EQUAL_UINT32(100, can_transmit_batch(tx, &out, 10));
+
+    uint32_t calls = 0;
+    while (total < 100) {
+        uint32_t count = can_receive_batch(rx, &in, 100);
+        TEST_ASSERT_TRUE(count > 0);
+        TEST_ASSERT_EQUAL_UINT32(count, in.count);
+        for (uint32_t i = 0; i < count; i++) {
+            TEST_ASSERT_EQUAL_HEX32(0x200 + total + i, in.ids[i]);
+            TEST_ASSERT_EQUAL_UINT8(4, in.dlcs[i]);
+            TEST_ASSERT_EQUAL_MEMORY(out.data + (total + i) * 8, can_batch_payload(&in, i), 4);
+            TEST_ASSERT_TRUE(in.timestamps[i] != 0);
+        }
+        total += count;
+        calls++;
+    }
+    TEST_ASSERT_TRUE(calls < 100);
+    can_batch_destroy(&out);
+    can_batch_destroy(&in);
+
+    can_get_statistics(rx, &stats);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.rx_count);
+    can_get_statistics(tx, &stats);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.tx_count);
+}
+
+void test_SocketCAN_KernelFilters(void) {
+    CANFrame match = make_frame(0x105, false, 1);
+    CANFrame other = make_frame(0x205, false, 1);
+    CANFrame extended = make_frame(0x105, true, 1);
+    CANFrame received;
+
+    if (!have_vcan) TEST_IGNORE_MESSAGE("vcan0 not available");
+
+    TEST_ASSERT_TRUE(can_set_filter(rx, 0x100, 0x7F0, false));
+    TEST_ASSERT_TRUE(can_transmit(tx, &other, 10));
+    TEST_ASSERT_TRUE(can_transmit(tx, &extended, 10));
+    TEST_ASSERT_TRUE(can_transmit(tx, &match, 10));
+
+    TEST_ASSERT_TRUE(can_receive(rx, &received, 100));
+    TEST_ASSERT_EQUAL_HEX32(0x105, received.id);
+    TEST_ASSERT_FALSE(received.is_extended);
+    TEST_ASSERT_FALSE(can_receive(rx, &received, 20));
+
+    can_clear_filters(rx);
+    TEST_ASSERT_TRUE(can_transmit(tx, &other, 10));
+    TEST_ASSERT_TRUE(can_receive(rx, &received, 100));
+    TEST_ASSERT_EQUAL_HEX32(0x205, received.id);
+}
+
+void test_SocketCAN_FdFrames(void) {
+    CANFrame frame = make_frame(0x321, false, 26);
+    CANFrame received;
+
+    if (!have_vcan) TEST_IGNORE_MESSAGE("vcan0 not available");
+
+    frame.is_fd = true;
+    TEST_ASSERT_FALSE(can_transmit(tx, &frame, 10));
+    TEST_ASSERT_EQUAL(CAN_ERROR_SOFTWARE, can_get_last_error(tx));
+
+    if (!can_enable_fd(tx) || !can_enable_fd(rx)) {
+        TEST_IGNORE_MESSAGE("vcan0 MTU is not CANFD_MTU");
+    }
+
+    // 26 bytes has no FD DLC and goes out padded to 32
+    TEST_ASSERT_TRUE(can_transmit(tx, &frame, 10));
+    TEST_ASSERT_TRUE(can_receive(rx, &received, 100));
+    TEST_ASSERT_TRUE(received.is_fd);
+    TEST_ASSERT_EQUAL_UINT8(32, received.dlc);
+    TEST_ASSERT_EQUAL_MEMORY(frame.data, received.data, 26);
+    TEST_ASSERT_EQUAL_UINT8(0, received.data[31]);
+
+    // A classic batch has no room for the payload
+    CANFrameBatch batch;
+    CANStats stats;
+    TEST_ASSERT_TRUE(can_batch_init(&batch, 4, false));
+    TEST_ASSERT_TRUE(can_transmit(tx, &frame, 10));
+    TEST_ASSERT_EQUAL_UINT32(0, can_receive_batch(rx, &batch, 100));
+    can_get_statistics(rx, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.overflow_count);
+    can_batch_destroy(&batch);
+}
+
+void test_SocketCAN_FiltersBeyondKernelList(void) {
+    CANFrame frame;
+    CANFrame received;
+
+    if (!have_vcan) TEST_IGNORE_MESSAGE("vcan0 not available");
+
+    // More rules than CAN_RAW_FILTER is given; the rest match in user space
+    for (uint32_t i = 0; i < 200; i++) {
+        TEST_ASSERT_TRUE(can_set_filter(rx, 0x18DA0000 | (i << 8), 0x1FFFFFFF, true));
+    }
+
+    frame = make_frame(0x18DA0500, true, 2);
+    TEST_ASSERT_TRUE(can_transmit(tx, &frame, 10));
+    frame = make_frame(0x18DA0501, true, 2);
+    TEST_ASSERT_TRUE(can_transmit(tx, &frame, 10));
+    frame = make_frame(0x18DAC700, true, 2);
+    TEST_ASSERT_TRUE(can_transmit(tx, &frame, 10));
+
+    TEST_ASSERT_TRUE(can_receive(rx, &received, 100));
+    TEST_ASSERT_EQUAL_HEX32(0x18DA0500, received.id);
+    TEST_ASSERT_TRUE(can_receive(rx, &received, 100));
+    TEST_ASSERT_EQUAL_HEX32(0x18DAC700, received.id);
+    TEST_ASSERT_FALSE(can_receive(rx, &received, 20));
+}
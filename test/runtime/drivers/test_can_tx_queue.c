@@ -0,0 +1,173 @@
+#include "unity.h"
+#include "drivers/can_tx_queue.h"
+#include <string.h>
+
+static CANTxQueue* queue;
+
+static CANFrame make_frame(uint32_t id, bool is_extended, uint8_t tag) {
+    CANFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.is_extended = is_extended;
+    frame.dlc = 1;
+    frame.data[0] = tag;
+    return frame;
+}
+
+static void push(uint32_t id, uint8_t tag, uint32_t now_us) {
+    CANFrame frame = make_frame(id, false, tag);
+    TEST_ASSERT_TRUE(can_tx_queue_push(queue, &frame, now_us));
+}
+
+// Expects a load and returns the mailbox
+static uint8_t expect_load(uint32_t id, uint8_t tag) {
+    CANTxCommand command;
+    TEST_ASSERT_EQUAL_INT(CAN_TX_LOAD, can_tx_queue_next(queue, &command));
+    TEST_ASSERT_EQUAL_HEX32(id, command.frame->id);
+    TEST_ASSERT_EQUAL_UINT8(tag, command.frame->data[0]);
+    return command.mailbox;
+}
+
+static void expect_idle(void) {
+    CANTxCommand command;
+    TEST_ASSERT_EQUAL_INT(CAN_TX_IDLE, can_tx_queue_next(queue, &command));
+}
+
+void setUp(void) {
+    queue = NULL;
+}
+
+void tearDown(void) {
+    can_tx_queue_destroy(queue);
+}
+
+void test_CANTxQueue_ArbitrationKey(void) {
+    CANFrame standard = make_frame(0x100, false, 0);
+    CANFrame remote = make_frame(0x100, false, 0);
+    CANFrame extended = make_frame(0x100u << 18, true, 0);
+    CANFrame lower_extended = make_frame((0x0FFu << 18) | 0x3FFFF, true, 0);
+    remote.is_remote = true;
+
+    // Data before remote, standard before extended with the same base ID
+    TEST_ASSERT_TRUE(can_arbitration_key(&standard) < can_arbitration_key(&remote));
+    TEST_ASSERT_TRUE(can_arbitration_key(&remote) < can_arbitration_key(&extended));
+    // A lower base ID wins whatever the format
+    TEST_ASSERT_TRUE(can_arbitration_key(&lower_extended) < can_arbitration_key(&standard));
+
+    // J1939 priority 6 and the top of the 11-bit range share the last bands
+    CANFrame j1939 = make_frame(0x18FEF100, true, 0);
+    CANFrame top = make_frame(0x7FF, false, 0);
+    TEST_ASSERT_EQUAL_UINT8(6, can_tx_band(&j1939));
+    TEST_ASSERT_EQUAL_UINT8(7, can_tx_band(&top));
+}
+
+void test_CANTxQueue_OrdersByIdThenFifo(void) {
+    queue = can_tx_queue_create(8, 1);
+    TEST_ASSERT_NOT_NULL(queue);
+
+    push(0x300, 1, 0);
+    push(0x100, 2, 0);
+    push(0x200, 3, 0);
+    push(0x100, 4, 0);
+
+    static const uint32_t ids[] = { 0x100, 0x100, 0x200, 0x300 };
+    static const uint8_t tags[] = { 2, 4, 3, 1 };
+    for (int i = 0; i < 4; i++) {
+        uint8_t mailbox = expect_load(ids[i], tags[i]);
+        expect_idle();
+        can_tx_queue_complete(queue, mailbox, 0);
+    }
+    expect_idle();
+    TEST_ASSERT_EQUAL_UINT32(0, can_tx_queue_pending(queue));
+}
+
+void test_CANTxQueue_RejectsWhenFull(void) {
+    queue = can_tx_queue_create(2, 1);
+    CANFrame frame = make_frame(0x123, false, 0);
+
+    TEST_ASSERT_TRUE(can_tx_queue_push(queue, &frame, 0));
+    TEST_ASSERT_TRUE(can_tx_queue_push(queue, &frame, 0));
+    TEST_ASSERT_FALSE(can_tx_queue_push(queue, &frame, 0));
+
+    // A frame moved into a mailbox frees its place in the queue
+    expect_load(0x123, 0);
+    TEST_ASSERT_TRUE(can_tx_queue_push(queue, &frame, 0));
+}
+
+void test_CANTxQueue_PreemptsLeastUrgentMailbox(void) {
+    queue = can_tx_queue_create(8, 2);
+    CANTxCommand command;
+
+    push(0x700, 1, 0);
+    push(0x701, 2, 0);
+    uint8_t first = expect_load(0x700, 1);
+    uint8_t second = expect_load(0x701, 2);
+
+    // Both mailboxes busy: the urgent frame evicts 0x701, not 0x700
+    push(0x010, 3, 0);
+    TEST_ASSERT_EQUAL_INT(CAN_TX_ABORT, can_tx_queue_next(queue, &command));
+    TEST_ASSERT_EQUAL_UINT8(second, command.mailbox);
+    expect_idle();    // Nothing more until the abort lands
+
+    can_tx_queue_aborted(queue, second);
+    TEST_ASSERT_EQUAL_UINT8(second, expect_load(0x010, 3));
+
+    // The aborted frame goes out once a mailbox frees up
+    can_tx_queue_complete(queue, first, 0);
+    expect_load(0x701, 2);
+
+    CANTxBandStats stats;
+    can_tx_queue_get_band(queue, 7, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.aborted);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.sent);
+}
+
+void test_CANTxQueue_AbortLosesRace(void) {
+    queue = can_tx_queue_create(8, 1);
+    CANTxCommand command;
+
+    push(0x400, 1, 0);
+    uint8_t mailbox = expect_load(0x400, 1);
+    push(0x001, 2, 0);
+    TEST_ASSERT_EQUAL_INT(CAN_TX_ABORT, can_tx_queue_next(queue, &command));
+
+    // The frame went out before the abort took effect; it isn't re-queued
+    can_tx_queue_complete(queue, mailbox, 5);
+    expect_load(0x001, 2);
+    TEST_ASSERT_EQUAL_UINT32(0, can_tx_queue_pending(queue));
+}
+
+void test_CANTxQueue_HoldsBackSameId(void) {
+    queue = can_tx_queue_create(8, 2);
+
+    push(0x100, 1, 0);
+    push(0x100, 2, 0);
+    push(0x200, 3, 0);
+
+    // Two mailboxes with one ID could go out in either order
+    uint8_t mailbox = expect_load(0x100, 1);
+    expect_idle();
+    can_tx_queue_complete(queue, mailbox, 0);
+    expect_load(0x100, 2);
+    expect_load(0x200, 3);
+}
+
+void test_CANTxQueue_BandLatency(void) {
+    queue = can_tx_queue_create(8, 1);
+    CANTxBandStats stats;
+
+    push(0x050, 1, 100);
+    push(0x7F0, 2, 100);
+    can_tx_queue_complete(queue, expect_load(0x050, 1), 110);
+    can_tx_queue_complete(queue, expect_load(0x7F0, 2), 400);
+
+    can_tx_queue_get_band(queue, 0, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.sent);
+    TEST_ASSERT_EQUAL_UINT32(10, stats.max_us);
+    TEST_ASSERT_EQUAL_UINT64(10, stats.total_us);
+
+    can_tx_queue_get_band(queue, 7, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.sent);
+    TEST_ASSERT_EQUAL_UINT32(300, stats.max_us);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.aborted);
+}
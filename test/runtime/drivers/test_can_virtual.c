@@ -0,0 +1,267 @@
+#include "unity.h"
+#include "drivers/can_virtual.h"
+#include "drivers/can_tx_queue.h"
+#include <string.h>
+
+#define BIT_NS  2000u       // 500 kbit/s
+
+static CANBus* bus;
+static CANDriver* nodes[3];
+
+static CANFrame make_frame(uint32_t id, bool is_extended, uint8_t dlc, uint8_t fill) {
+    CANFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.is_extended = is_extended;
+    frame.dlc = dlc;
+    memset(frame.data, fill, dlc);
+    return frame;
+}
+
+static CANDriver* open_node(bool fd_enabled) {
+    CANConfig config = {
+        .interface_name = "vbus0",
+        .fd_enabled = fd_enabled,
+        .tx_mailboxes = 3
+    };
+    CANDriver* driver = can_create(&config);
+    TEST_ASSERT_NOT_NULL(driver);
+    TEST_ASSERT_TRUE(can_start(driver));
+    return driver;
+}
+
+static void send(CANDriver* node, uint32_t id, bool is_extended, uint8_t tag) {
+    CANFrame frame = make_frame(id, is_extended, 8, tag);
+    TEST_ASSERT_TRUE(can_transmit(node, &frame, 0));
+}
+
+void setUp(void) {
+    CANBusConfig config = { .bitrate = 500000, .data_bitrate = 2000000 };
+    bus = can_bus_create("vbus0", &config);
+    TEST_ASSERT_NOT_NULL(bus);
+    for (int i = 0; i < 3; i++) {
+        nodes[i] = NULL;
+    }
+}
+
+void tearDown(void) {
+    for (int i = 0; i < 3; i++) {
+        can_destroy(nodes[i]);
+    }
+    can_bus_destroy(bus);
+}
+
+void test_CANVirtual_FrameLength(void) {
+    CANFrame zeros = make_frame(0x000, false, 8, 0x00);
+    CANFrame mixed = make_frame(0x555, false, 8, 0x55);
+    CANFrame remote = make_frame(0x555, false, 8, 0x00);
+    CANFrame extended = make_frame(0x555, true, 8, 0x55);
+    remote.is_remote = true;
+
+    // 111 bits without stuffing; 8 data bytes allow at most 24 stuff bits
+    uint32_t worst = can_frame_bits(&zeros, false);
+    uint32_t best = can_frame_bits(&mixed, false);
+    TEST_ASSERT_TRUE(worst > best);
+    TEST_ASSERT_TRUE(best >= 111 && worst <= 135);
+    TEST_ASSERT_TRUE(can_frame_bits(&remote, false) < best);
+    TEST_ASSERT_TRUE(can_frame_bits(&extended, false) >= best + 20);
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)worst * BIT_NS, can_bus_frame_time(bus, &zeros));
+
+    // The data phase of an FD frame runs at the data bitrate
+    CANFrame fd = make_frame(0x123, false, 64, 0xA5);
+    fd.is_fd = true;
+    uint32_t fd_bits = can_frame_bits(&fd, true);
+    TEST_ASSERT_EQUAL_UINT32(fd_bits, can_frame_bits(&fd, false));
+    TEST_ASSERT_TRUE(can_bus_frame_time(bus, &fd) < (uint64_t)fd_bits * BIT_NS / 2);
+}
+
+void test_CANVirtual_ArbitratesById(void) {
+    CANFrame frame;
+    CANBusStats stats;
+
+    nodes[0] = open_node(false);
+    nodes[1] = open_node(false);
+    nodes[2] = open_node(false);
+
+    // All three contend at the same bit; the listener is node 2 too
+    send(nodes[0], 0x300, false, 1);
+    send(nodes[1], 0x100u << 18, true, 2);
+    send(nodes[0], 0x0FF, false, 3);
+    send(nodes[1], 0x100, false, 4);
+    can_bus_advance(bus, 10000000);
+
+    uint8_t order[] = { 3, 4, 2, 1 };
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(can_receive(nodes[2], &frame, 0));
+        TEST_ASSERT_EQUAL_UINT8(order[i], frame.data[0]);
+    }
+    TEST_ASSERT_FALSE(can_receive(nodes[2], &frame, 0));
+
+    can_bus_get_statistics(bus, &stats);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.arbitration_losses);
+    TEST_ASSERT_EQUAL_UINT64(10000000, stats.elapsed_ns);
+}
+
+void test_CANVirtual_FramesTakeTheirBitTime(void) {
+    CANFrame sent = make_frame(0x123, false, 8, 0x00);
+    CANFrame frame;
+    CANBusStats stats;
+
+    nodes[0] = open_node(false);
+    nodes[1] = open_node(false);
+    uint64_t frame_time = can_bus_frame_time(bus, &sent);
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(can_transmit(nodes[0], &sent, 0));
+    }
+
+    // A blocking receive runs the bus until the first frame is in
+    TEST_ASSERT_TRUE(can_receive(nodes[1], &frame, 10));
+    TEST_ASSERT_EQUAL_UINT64(frame_time, frame.timestamp);
+    TEST_ASSERT_EQUAL_UINT64(frame_time, can_bus_now(bus));
+
+    for (uint64_t i = 2; i <= 4; i++) {
+        TEST_ASSERT_TRUE(can_receive(nodes[1], &frame, 10));
+        TEST_ASSERT_EQUAL_UINT64(i * frame_time, frame.timestamp);
+    }
+
+    // Nothing left: the wait runs out on the simulated clock
+    TEST_ASSERT_FALSE(can_receive(nodes[1], &frame, 5));
+    TEST_ASSERT_EQUAL_UINT64(4 * frame_time + 5000000, can_bus_now(bus));
+
+    can_bus_get_statistics(bus, &stats);
+    TEST_ASSERT_EQUAL_UINT64(4 * frame_time, stats.busy_ns);
+
+    CANTxBandStats band;
+    can_get_tx_band_statistics(nodes[0], can_tx_band(&sent), &band);
+    TEST_ASSERT_EQUAL_UINT32(4, band.sent);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(4 * frame_time / 1000), band.max_us);
+}
+
+void test_CANVirtual_LoneNodeGetsAckErrors(void) {
+    CANFrame frame;
+    CANStats stats;
+
+    nodes[0] = open_node(false);
+    send(nodes[0], 0x123, false, 1);
+    can_bus_advance(bus, 20000000);
+
+    // Error passive after 16 attempts, then ACK errors stop counting
+    can_get_statistics(nodes[0], &stats);
+    TEST_ASSERT_EQUAL_INT(CAN_STATE_ERROR_PASSIVE, can_get_state(nodes[0]));
+    TEST_ASSERT_EQUAL_INT(CAN_ERROR_ACK, can_get_last_error(nodes[0]));
+    TEST_ASSERT_EQUAL_UINT8(128, stats.tx_error_counter);
+    TEST_ASSERT_TRUE(stats.error_count > 16);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.tx_count);
+
+    nodes[1] = open_node(false);
+    TEST_ASSERT_TRUE(can_receive(nodes[1], &frame, 10));
+    TEST_ASSERT_EQUAL_HEX32(0x123, frame.id);
+    can_get_statistics(nodes[0], &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.tx_count);
+    TEST_ASSERT_EQUAL_UINT8(127, stats.tx_error_counter);
+    TEST_ASSERT_EQUAL_INT(CAN_STATE_STARTED, can_get_state(nodes[0]));
+}
+
+void test_CANVirtual_InjectedErrorsRetransmit(void) {
+    CANFrame frame;
+    CANStats sender, listener;
+    CANBusStats stats;
+
+    nodes[0] = open_node(false);
+    nodes[1] = open_node(false);
+    TEST_ASSERT_TRUE(can_bus_inject_error(bus, 0x123, false, CAN_ERROR_CRC, 2));
+    TEST_ASSERT_FALSE(can_bus_inject_error(bus, 0x123, false, CAN_ERROR_SOFTWARE, 1));
+
+    send(nodes[0], 0x123, false, 7);
+    TEST_ASSERT_TRUE(can_receive(nodes[1], &frame, 10));
+    TEST_ASSERT_EQUAL_UINT8(7, frame.data[0]);
+    TEST_ASSERT_FALSE(can_receive(nodes[1], &frame, 0));
+
+    can_get_statistics(nodes[0], &sender);
+    can_get_statistics(nodes[1], &listener);
+    TEST_ASSERT_EQUAL_UINT8(15, sender.tx_error_counter);
+    TEST_ASSERT_EQUAL_UINT8(1, listener.rx_error_counter);
+    TEST_ASSERT_EQUAL_INT(CAN_ERROR_CRC, can_get_last_error(nodes[1]));
+
+    // Two error frames, each cut after the ACK delimiter, then the frame
+    can_bus_get_statistics(bus, &stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.error_frames);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.frames);
+    CANFrame sent = make_frame(0x123, false, 8, 7);
+    uint64_t frame_time = can_bus_frame_time(bus, &sent);
+    uint64_t error_time = frame_time - 10 * BIT_NS + 17 * BIT_NS;
+    TEST_ASSERT_EQUAL_UINT64(frame_time + 2 * error_time, frame.timestamp);
+}
+
+void test_CANVirtual_BusOffAndRecovery(void) {
+    CANFrame frame;
+    CANStats stats;
+
+    nodes[0] = open_node(false);
+    nodes[1] = open_node(false);
+    TEST_ASSERT_TRUE(can_bus_inject_error(bus, 0x123, false, CAN_ERROR_BIT0, 32));
+
+    send(nodes[0], 0x123, false, 9);
+    while (can_get_state(nodes[0]) != CAN_STATE_BUS_OFF && can_bus_now(bus) < 50000000) {
+        can_bus_advance(bus, 100000);
+    }
+    uint64_t bus_off_at = can_bus_now(bus);
+    TEST_ASSERT_EQUAL_INT(CAN_STATE_BUS_OFF, can_get_state(nodes[0]));
+    TEST_ASSERT_FALSE(can_transmit(nodes[0], &frame, 0));
+    can_get_statistics(nodes[0], &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.bus_off_count);
+    TEST_ASSERT_EQUAL_UINT32(32, stats.error_count);
+    TEST_ASSERT_EQUAL_INT(CAN_ERROR_STUFF, can_get_last_error(nodes[1]));
+
+    // 128 x 11 bit times later the node is back and the frame goes out
+    TEST_ASSERT_TRUE(can_receive(nodes[1], &frame, 10));
+    TEST_ASSERT_EQUAL_UINT8(9, frame.data[0]);
+    TEST_ASSERT_TRUE(frame.timestamp > bus_off_at + 128 * 11 * BIT_NS - 100000);
+    TEST_ASSERT_EQUAL_INT(CAN_STATE_STARTED, can_get_state(nodes[0]));
+}
+
+void test_CANVirtual_FiltersAndFdFrames(void) {
+    CANFrame frame;
+
+    nodes[0] = open_node(true);
+    nodes[1] = open_node(false);
+    nodes[2] = open_node(true);
+    TEST_ASSERT_TRUE(can_set_filter(nodes[2], 0x7E0, 0x7F0, false));
+
+    CANFrame fd = make_frame(0x7E8, false, 20, 0x11);
+    fd.is_fd = true;
+    TEST_ASSERT_TRUE(can_transmit(nodes[0], &fd, 0));
+    send(nodes[0], 0x100, false, 1);
+    TEST_ASSERT_FALSE(can_transmit(nodes[1], &fd, 0));
+    TEST_ASSERT_EQUAL_INT(CAN_ERROR_SOFTWARE, can_get_last_error(nodes[1]));
+    can_bus_advance(bus, 1000000);
+
+    // The classic node never sees the FD frame; the filter keeps 0x100 out
+    TEST_ASSERT_TRUE(can_receive(nodes[1], &frame, 0));
+    TEST_ASSERT_EQUAL_HEX32(0x100, frame.id);
+    TEST_ASSERT_FALSE(can_receive(nodes[1], &frame, 0));
+
+    TEST_ASSERT_TRUE(can_receive(nodes[2], &frame, 0));
+    TEST_ASSERT_TRUE(frame.is_fd);
+    TEST_ASSERT_EQUAL_UINT8(20, frame.dlc);
+    TEST_ASSERT_EQUAL_HEX8(0x11, frame.data[19]);
+    TEST_ASSERT_FALSE(can_receive(nodes[2], &frame, 0));
+}
+
+void test_CANVirtual_NodesFindTheirBus(void) {
+    CANConfig config = { .interface_name = "vbus1" };
+    TEST_ASSERT_NULL(can_create(&config));
+    TEST_ASSERT_NULL(can_bus_create("vbus0", NULL));
+
+    config.interface_name = "vbus0";
+    config.bitrate = 250000;
+    TEST_ASSERT_NULL(can_create(&config));
+
+    config.bitrate = 500000;
+    nodes[0] = can_create(&config);
+    TEST_ASSERT_NOT_NULL(nodes[0]);
+    TEST_ASSERT_TRUE(can_set_bitrate(nodes[0], 500000, 2000000));
+    TEST_ASSERT_FALSE(can_set_bitrate(nodes[0], 1000000, 0));
+}
@@ -0,0 +1,160 @@
+#include "unity.h"
+#include "memory/memory_manager.h"
+#include "memory/heap_profiler.h"
+#include <stdio.h>
+#include <string.h>
+
+static MemConfig test_config;
+static const uint32_t TEST_HEAP_SIZE = 1024 * 1024;
+static uint32_t POOL_SIZES[] = {64, 128};
+static uint32_t POOL_COUNTS[] = {16, 8};
+
+static void* alloc_site_a(uint32_t size) {
+    return MEMORY_ALLOC(size);
+}
+
+static void* alloc_site_b(uint32_t size) {
+    return MEMORY_ALLOC(size);
+}
+
+void setUp(void) {
+    memset(&test_config, 0, sizeof(MemConfig));
+    test_config.heap_size = TEST_HEAP_SIZE;
+    test_config.pool_sizes = POOL_SIZES;
+    test_config.pool_counts = POOL_COUNTS;
+    test_config.pool_count = 2;
+    test_config.enable_guards = true;
+    test_config.enable_stats = true;
+
+    TEST_ASSERT_TRUE(Memory_Init(&test_config));
+    HeapProfiler_Reset();
+}
+
+void tearDown(void) {
+    HeapProfiler_Stop();
+    HeapProfiler_Reset();
+    Memory_Deinit();
+}
+
+void test_HeapProfiler_InactiveByDefault(void) {
+    void* ptr = MEMORY_ALLOC(4096);
+    TEST_ASSERT_NOT_NULL(ptr);
+
+    HeapProfilerSummary summary;
+    HeapProfiler_GetSummary(&summary);
+    TEST_ASSERT_FALSE(summary.active);
+    TEST_ASSERT_EQUAL_UINT32(0, summary.samples_taken);
+
+    MEMORY_FREE(ptr);
+}
+
+void test_HeapProfiler_PerSiteAggregation(void) {
+    void* a[4];
+    void* b;
+
+    // An interval of one byte samples every allocation at its exact size
+    TEST_ASSERT_TRUE(HeapProfiler_Start(1));
+
+    for (int i = 0; i < 4; i++) {
+        a[i] = alloc_site_a(1000);
+        TEST_ASSERT_NOT_NULL(a[i]);
+    }
+    b = alloc_site_b(100);
+    TEST_ASSERT_NOT_NULL(b);
+
+    HeapSiteStats sites[4];
+    uint32_t count = HeapProfiler_GetSites(sites, 4);
+    TEST_ASSERT_EQUAL_UINT32(2, count);
+    TEST_ASSERT_TRUE(sites[0].live_bytes > sites[1].live_bytes);
+    TEST_ASSERT_EQUAL_UINT32(4, sites[0].live_samples);
+    TEST_ASSERT_EQUAL_UINT32(1, sites[1].live_samples);
+
+    for (int i = 0; i < 4; i++) {
+        MEMORY_FREE(a[i]);
+    }
+
+    count = HeapProfiler_GetSites(sites, 4);
+    TEST_ASSERT_EQUAL_UINT32(2, count);
+    TEST_ASSERT_EQUAL_UINT32(1, sites[0].live_samples);
+    TEST_ASSERT_EQUAL_UINT32(0, sites[1].live_bytes);
+    TEST_ASSERT_EQUAL_UINT32(4, sites[1].total_samples);
+
+    // Every freed sample lands in the lifetime histogram
+    uint32_t lifetimes = 0;
+    for (int i = 0; i < HEAP_PROFILER_HIST_BUCKETS; i++) {
+        lifetimes += sites[1].lifetime_histogram[i];
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, lifetimes);
+
+    MEMORY_FREE(b);
+
+    HeapProfilerSummary summary;
+    HeapProfiler_GetSummary(&summary);
+    TEST_ASSERT_EQUAL_UINT32(0, summary.live_bytes);
+    TEST_ASSERT_EQUAL_UINT32(5, summary.samples_taken);
+}
+
+void test_HeapProfiler_SampledEstimate(void) {
+    static void* ptrs[512];
+
+    TEST_ASSERT_TRUE(HeapProfiler_Start(4096));
+
+    for (int i = 0; i < 512; i++) {
+        ptrs[i] = alloc_site_a(512);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+
+    HeapProfilerSummary summary;
+    HeapProfiler_GetSummary(&summary);
+
+    // 256KB allocated; sampling at 4KB should land within 25%
+    TEST_ASSERT_TRUE(summary.samples_taken < 512);
+    TEST_ASSERT_TRUE(summary.live_bytes > 192 * 1024);
+    TEST_ASSERT_TRUE(summary.live_bytes < 320 * 1024);
+
+    for (int i = 0; i < 512; i++) {
+        MEMORY_FREE(ptrs[i]);
+    }
+
+    HeapProfiler_GetSummary(&summary);
+    TEST_ASSERT_EQUAL_UINT32(0, summary.live_bytes);
+}
+
+void test_HeapProfiler_PoolAllocations(void) {
+    TEST_ASSERT_TRUE(HeapProfiler_Start(1));
+
+    void* ptr = MEMORY_ALLOC(32);
+    TEST_ASSERT_NOT_NULL(ptr);
+
+    HeapProfilerSummary summary;
+    HeapProfiler_GetSummary(&summary);
+    TEST_ASSERT_EQUAL_UINT32(1, summary.samples_taken);
+    TEST_ASSERT_EQUAL_UINT32(32, summary.live_bytes);
+
+    MEMORY_FREE(ptr);
+    HeapProfiler_GetSummary(&summary);
+    TEST_ASSERT_EQUAL_UINT32(0, summary.live_bytes);
+}
+
+void test_HeapProfiler_ExportFolded(void) {
+    const char* path = "heap_profile_test.folded";
+    const char* prefix = "heap;test_heap_profiler.c;test_heap_profiler.c:";
+    char line[256];
+
+    TEST_ASSERT_TRUE(HeapProfiler_Start(1));
+    void* ptr = alloc_site_a(2000);
+    TEST_ASSERT_NOT_NULL(ptr);
+
+    TEST_ASSERT_TRUE(HeapProfiler_ExportFolded(path, HEAP_PROFILE_CUMULATIVE_BYTES));
+
+    FILE* file = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), file));
+    fclose(file);
+    remove(path);
+
+    TEST_ASSERT_EQUAL_INT(0, strncmp(line, prefix, strlen(prefix)));
+    TEST_ASSERT_NOT_NULL(strstr(line, " 2000"));
+
+    MEMORY_FREE(ptr);
+}
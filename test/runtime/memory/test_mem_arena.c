@@ -0,0 +1,109 @@
+#include "unity.h"
+#include "memory/mem_arena.h"
+#include "memory/memory_manager.h"
+#include "diagnostic/diag_arena.h"
+#include <string.h>
+
+static uint8_t buffer[256] __attribute__((aligned(8)));
+static MemArena arena;
+
+void setUp(void) {
+    TEST_ASSERT_TRUE(MemArena_Init(&arena, buffer, sizeof(buffer)));
+}
+
+void tearDown(void) {
+}
+
+void test_MemArena_AlignedBumpAllocation(void) {
+    uint8_t* a = MemArena_Alloc(&arena, 3);
+    uint8_t* b = MemArena_Alloc(&arena, 10);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)a % MEM_ARENA_ALIGNMENT);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)b % MEM_ARENA_ALIGNMENT);
+    TEST_ASSERT_EQUAL_UINT32(8, (uint32_t)(b - a));
+    TEST_ASSERT_EQUAL_UINT32(24, MemArena_GetUsed(&arena));
+
+    // Unaligned backing buffers are trimmed at the front
+    MemArena skewed;
+    TEST_ASSERT_TRUE(MemArena_Init(&skewed, buffer + 1, sizeof(buffer) - 1));
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)MemArena_Alloc(&skewed, 1) % MEM_ARENA_ALIGNMENT);
+}
+
+void test_MemArena_Exhaustion(void) {
+    TEST_ASSERT_NOT_NULL(MemArena_Alloc(&arena, 200));
+    TEST_ASSERT_NULL(MemArena_Alloc(&arena, 100));
+    TEST_ASSERT_NOT_NULL(MemArena_Alloc(&arena, 56));
+    TEST_ASSERT_EQUAL_UINT32(0, MemArena_GetRemaining(&arena));
+    TEST_ASSERT_EQUAL_UINT32(1, arena.failed_allocs);
+    TEST_ASSERT_NULL(MemArena_Calloc(&arena, 0x10000, 0x10000));
+}
+
+void test_MemArena_ScopedRelease(void) {
+    uint8_t* keep = MemArena_Alloc(&arena, 16);
+    memset(keep, 0xAB, 16);
+
+    MemArenaMark mark = MemArena_Mark(&arena);
+    TEST_ASSERT_NOT_NULL(MemArena_Alloc(&arena, 100));
+    TEST_ASSERT_NOT_NULL(MemArena_Calloc(&arena, 4, 8));
+    MemArena_Release(&arena, mark);
+
+    TEST_ASSERT_EQUAL_UINT32(16, MemArena_GetUsed(&arena));
+    TEST_ASSERT_EQUAL_UINT8(0xAB, keep[15]);
+    TEST_ASSERT_EQUAL_UINT32(152, arena.peak);
+
+    MemArena_Reset(&arena);
+    TEST_ASSERT_EQUAL_UINT32(0, MemArena_GetUsed(&arena));
+    TEST_ASSERT_TRUE(MemArena_Alloc(&arena, 8) == (void*)keep);
+}
+
+void test_DiagArena_RequestLifecycle(void) {
+    MemArena* requests[DIAG_ARENA_COUNT];
+    DiagArenaStats stats;
+
+    DiagArena_ResetStats();
+
+    for (int i = 0; i < DIAG_ARENA_COUNT; i++) {
+        requests[i] = DiagArena_Acquire();
+        TEST_ASSERT_NOT_NULL(requests[i]);
+        TEST_ASSERT_NOT_NULL(MemArena_Alloc(requests[i], 64 * (i + 1)));
+    }
+    TEST_ASSERT_NULL(DiagArena_Acquire());
+
+    for (int i = 0; i < DIAG_ARENA_COUNT; i++) {
+        DiagArena_Release(requests[i]);
+    }
+    DiagArena_Release(requests[0]);    // Double release is ignored
+
+    DiagArena_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(DIAG_ARENA_COUNT, stats.requests);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.exhausted);
+    TEST_ASSERT_EQUAL_UINT32(DIAG_ARENA_COUNT, stats.allocs);
+    TEST_ASSERT_EQUAL_UINT32(64 * DIAG_ARENA_COUNT, stats.peak_bytes);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.in_flight);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.heap_allocs);
+}
+
+void test_DiagArena_CountsHeapTrafficDuringRequests(void) {
+    MemConfig config;
+    DiagArenaStats stats;
+
+    memset(&config, 0, sizeof(MemConfig));
+    config.heap_size = 64 * 1024;
+    TEST_ASSERT_TRUE(Memory_Init(&config));
+    DiagArena_ResetStats();
+
+    // Outside a request the heap is not audited
+    void* outside = MEMORY_ALLOC(32);
+
+    MemArena* request = DiagArena_Acquire();
+    void* inside = MEMORY_ALLOC(32);
+    DiagArena_Release(request);
+
+    DiagArena_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.heap_allocs);
+
+    MEMORY_FREE(outside);
+    MEMORY_FREE(inside);
+    Memory_Deinit();
+}
@@ -0,0 +1,110 @@
+#include "unity.h"
+#include "memory/mem_pool.h"
+#include <string.h>
+
+static const MemPoolClass TEST_CLASSES[] = {
+    {16, 40},
+    {64, 70},
+    {256, 10}
+};
+
+static uint32_t expired_count;
+
+static void on_lease_expired(void* block, void* context) {
+    (void)block;
+    (void)context;
+    expired_count++;
+}
+
+static void* sibling;
+
+// Owners of related blocks drop them together
+static void free_sibling(void* block, void* context) {
+    (void)block;
+    (void)context;
+    expired_count++;
+    if(sibling) {
+        MemPool_Free(sibling);
+        sibling = NULL;
+    }
+}
+
+void setUp(void) {
+    MemPoolConfig config = { TEST_CLASSES, 3 };
+    TEST_ASSERT_TRUE(MemPool_InitWithConfig(&config));
+    expired_count = 0;
+}
+
+void tearDown(void) {
+}
+
+void test_MemPool_DefaultInit(void) {
+    MemPool_Init();
+    TEST_ASSERT_EQUAL_UINT32(POOL_NUM_BLOCKS, MemPool_GetTotalBlocks());
+    TEST_ASSERT_EQUAL_UINT32(POOL_NUM_BLOCKS, MemPool_GetFreeBlocks());
+}
+
+void test_MemPool_RejectsInvalidConfig(void) {
+    const MemPoolClass unsorted[] = { {64, 4}, {32, 4} };
+    MemPoolConfig config = { unsorted, 2 };
+    TEST_ASSERT_FALSE(MemPool_InitWithConfig(&config));
+    
+    // Previous configuration stays active
+    TEST_ASSERT_EQUAL_UINT32(120, MemPool_GetTotalBlocks());
+}
+
+void test_MemPool_SizeClasses(void) {
+    uint8_t* small = MemPool_AllocSize(10);
+    uint8_t* large = MemPool_AllocSize(100);
+    TEST_ASSERT_NOT_NULL(small);
+    TEST_ASSERT_NOT_NULL(large);
+    TEST_ASSERT_TRUE(large - small >= 16 * 40);
+    
+    MemPool_Free(small);
+    MemPool_Free(large);
+    TEST_ASSERT_EQUAL_UINT32(120, MemPool_GetFreeBlocks());
+}
+
+void test_MemPool_InvalidFree(void) {
+    uint8_t* block = MemPool_AllocSize(16);
+    MemPool_Free(block + 4);
+    MemPool_Free(block);
+    MemPool_Free(block);
+    
+    MemPoolStats stats;
+    MemPool_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.invalid_frees);
+    TEST_ASSERT_EQUAL_UINT32(120, MemPool_GetFreeBlocks());
+}
+
+void test_MemPool_LeaseExpiry(void) {
+    void* owned = MemPool_AllocSize(64);
+    void* leased = MemPool_AllocLeased(64, 0, on_lease_expired, NULL);
+    TEST_ASSERT_NOT_NULL(owned);
+    TEST_ASSERT_NOT_NULL(leased);
+    
+    // Only the leased block is reclaimed
+    TEST_ASSERT_EQUAL_UINT32(1, MemPool_ExpireLeases());
+    TEST_ASSERT_EQUAL_UINT32(1, expired_count);
+    TEST_ASSERT_FALSE(MemPool_RenewLease(leased, 100));
+    TEST_ASSERT_EQUAL_UINT32(119, MemPool_GetFreeBlocks());
+    
+    MemPool_Free(owned);
+}
+
+void test_MemPool_LeaseCallbackFreesSibling(void) {
+    void* first = MemPool_AllocLeased(64, 0, free_sibling, NULL);
+    sibling = MemPool_AllocLeased(64, 0, on_lease_expired, NULL);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(sibling);
+    
+    // The freed sibling is not reported or released a second time
+    TEST_ASSERT_EQUAL_UINT32(1, MemPool_ExpireLeases());
+    TEST_ASSERT_EQUAL_UINT32(1, expired_count);
+    TEST_ASSERT_NULL(sibling);
+    TEST_ASSERT_EQUAL_UINT32(120, MemPool_GetFreeBlocks());
+    
+    MemPoolStats stats;
+    MemPool_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.invalid_frees);
+}
@@ -139,4 +139,221 @@ void test_Memory_Integrity(void) {
     
     TEST_ASSERT_FALSE(Memory_CheckIntegrity());
     MEMORY_FREE(ptr);
-} 
\ No newline at end of file
+} 
+
+void test_Memory_PoolGuardAfterOddSize(void) {
+    // The back guard follows the requested bytes at an unaligned offset
+    uint8_t* odd = (uint8_t*)MEMORY_ALLOC(13);
+    TEST_ASSERT_TRUE(Memory_CheckIntegrity());
+    odd[13] ^= 0xFF;
+    TEST_ASSERT_FALSE(Memory_CheckIntegrity());
+    odd[13] ^= 0xFF;
+    TEST_ASSERT_TRUE(Memory_CheckIntegrity());
+    MEMORY_FREE(odd);
+} 
+void test_Memory_TLSFStrategy(void) {
+    Memory_Deinit();
+    test_config.heap_strategy = MEM_ALLOC_TLSF;
+    TEST_ASSERT_TRUE(Memory_Init(&test_config));
+    
+    // Heap-sized requests bypass the pools
+    void* a = MEMORY_ALLOC(4000);
+    void* b = MEMORY_ALLOC(4000);
+    void* c = MEMORY_ALLOC(4000);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    
+    // Free neighbours first so b coalesces both ways
+    MEMORY_FREE(a);
+    MEMORY_FREE(c);
+    MEMORY_FREE(b);
+    TEST_ASSERT_TRUE(Memory_CheckIntegrity());
+    
+    MemStats stats;
+    Memory_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.current_usage);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.fragmentation);
+    
+    // Entire heap is one free block again
+    void* big = MEMORY_ALLOC(TEST_HEAP_SIZE / 2);
+    TEST_ASSERT_NOT_NULL(big);
+    MEMORY_FREE(big);
+}
+
+void test_Memory_Handles(void) {
+    Memory_Deinit();
+    test_config.max_handles = 4;
+    TEST_ASSERT_TRUE(Memory_Init(&test_config));
+    
+    MemHandle h = MEMORY_ALLOC_HANDLE(500);
+    TEST_ASSERT_NOT_EQUAL(MEM_INVALID_HANDLE, h);
+    
+    uint8_t* data = (uint8_t*)Memory_Pin(h);
+    TEST_ASSERT_NOT_NULL(data);
+    memset(data, 0x5A, 500);
+    
+    // Pinned handles cannot be freed; raw frees are rejected
+    Memory_FreeHandle(h);
+    TEST_ASSERT_NOT_NULL(Memory_Pin(h));
+    Memory_Unpin(h);
+    Memory_Free(data);
+    TEST_ASSERT_EQUAL_UINT8(0x5A, data[499]);
+    Memory_Unpin(h);
+    
+    Memory_FreeHandle(h);
+    TEST_ASSERT_NULL(Memory_Pin(h));
+    
+    // Stale handles stay invalid after their slot is reused
+    MemHandle h2 = MEMORY_ALLOC_HANDLE(100);
+    TEST_ASSERT_NOT_EQUAL(h, h2);
+    TEST_ASSERT_NULL(Memory_Pin(h));
+    Memory_FreeHandle(h2);
+}
+
+void test_Memory_IncrementalCompaction(void) {
+    MemHandle handles[4];
+    
+    Memory_Deinit();
+    test_config.max_handles = 4;
+    test_config.heap_strategy = MEM_ALLOC_TLSF;
+    TEST_ASSERT_TRUE(Memory_Init(&test_config));
+    
+    void* hole1 = MEMORY_ALLOC(3000);
+    handles[0] = MEMORY_ALLOC_HANDLE(1000);
+    void* hole2 = MEMORY_ALLOC(3000);
+    handles[1] = MEMORY_ALLOC_HANDLE(1000);
+    handles[2] = MEMORY_ALLOC_HANDLE(1000);
+    void* fixed = MEMORY_ALLOC(3000);
+    handles[3] = MEMORY_ALLOC_HANDLE(1000);
+    
+    for (int i = 0; i < 4; i++) {
+        uint8_t* data = (uint8_t*)Memory_Pin(handles[i]);
+        memset(data, 0x10 + i, 1000);
+        Memory_Unpin(handles[i]);
+    }
+    MEMORY_FREE(hole1);
+    MEMORY_FREE(hole2);
+    
+    // A pinned handle stays put while the others move
+    void* pinned = Memory_Pin(handles[2]);
+    
+    uint32_t total = 0;
+    uint32_t moved;
+    while ((moved = Memory_Compact(1024)) > 0) {
+        TEST_ASSERT_TRUE(moved <= 1024);
+        total += moved;
+    }
+    TEST_ASSERT_TRUE(total >= 2000);
+    TEST_ASSERT_TRUE(Memory_CheckIntegrity());
+    TEST_ASSERT_TRUE(Memory_Pin(handles[2]) == pinned);
+    Memory_Unpin(handles[2]);
+    Memory_Unpin(handles[2]);
+    
+    for (int i = 0; i < 4; i++) {
+        uint8_t* data = (uint8_t*)Memory_Pin(handles[i]);
+        TEST_ASSERT_EQUAL_UINT8(0x10 + i, data[0]);
+        TEST_ASSERT_EQUAL_UINT8(0x10 + i, data[999]);
+        Memory_Unpin(handles[i]);
+        Memory_FreeHandle(handles[i]);
+    }
+    
+    MemStats stats;
+    Memory_GetStats(&stats);
+    TEST_ASSERT_TRUE(stats.compacted_blocks >= 2);
+    MEMORY_FREE(fixed);
+}
+
+void test_Memory_IncrementalScan(void) {
+    MemScanBudget budget = { 2, 0 };
+    MemScanStats stats;
+    void* ptrs[6];
+    
+    for (int i = 0; i < 6; i++) {
+        ptrs[i] = MEMORY_ALLOC(400);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    
+    // First pass establishes the block count used for coverage
+    while (true) {
+        TEST_ASSERT_TRUE(Memory_ScanIncremental(&budget));
+        Memory_GetScanStats(&stats);
+        if (stats.passes_completed == 1) {
+            break;
+        }
+    }
+    TEST_ASSERT_TRUE(stats.blocks_last_pass >= 7);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+    
+    TEST_ASSERT_TRUE(Memory_ScanIncremental(&budget));
+    Memory_GetScanStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.blocks_checked);
+    TEST_ASSERT_TRUE(stats.coverage > 0 && stats.coverage < 100);
+    
+    // Overrun one block's back guard; the scanner names its allocation site
+    uint32_t corrupt_line = __LINE__ + 1;
+    void* victim = MEMORY_ALLOC(400);
+    ((uint8_t*)victim)[400] ^= 0xFF;
+    
+    bool clean = true;
+    do {
+        clean &= Memory_ScanIncremental(NULL);
+        Memory_GetScanStats(&stats);
+    } while (stats.passes_completed < 2);
+    
+    TEST_ASSERT_FALSE(clean);
+    TEST_ASSERT_TRUE(stats.errors >= 1);
+    TEST_ASSERT_TRUE(stats.corrupt_block == (uint8_t*)victim - sizeof(MemBlock));
+    TEST_ASSERT_EQUAL_UINT32(corrupt_line, stats.corrupt_line);
+    
+    ((uint8_t*)victim)[400] ^= 0xFF;
+    MEMORY_FREE(victim);
+    for (int i = 0; i < 6; i++) {
+        MEMORY_FREE(ptrs[i]);
+    }
+    Memory_ResetScan();
+}
+
+void test_Memory_ScanAcrossMergeAndCompaction(void) {
+    MemScanBudget budget = { 1, 0 };
+    MemScanStats stats;
+    
+    // A freed block merges into a free one the scan has already counted
+    void* a = MEMORY_ALLOC(400);
+    void* b = MEMORY_ALLOC(400);
+    void* c = MEMORY_ALLOC(400);
+    MEMORY_FREE(a);
+    TEST_ASSERT_TRUE(Memory_ScanIncremental(&budget));
+    MEMORY_FREE(b);
+    while (Memory_ScanIncremental(NULL)) {
+        Memory_GetScanStats(&stats);
+        if (stats.passes_completed == 1) {
+            break;
+        }
+    }
+    Memory_GetScanStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.passes_completed);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+    MEMORY_FREE(c);
+    
+    // A handle block slides down over a hole the scan has already counted
+    Memory_Deinit();
+    test_config.max_handles = 2;
+    TEST_ASSERT_TRUE(Memory_Init(&test_config));
+    
+    void* hole = MEMORY_ALLOC(400);
+    MemHandle h = MEMORY_ALLOC_HANDLE(400);
+    void* fixed = MEMORY_ALLOC(400);
+    MEMORY_FREE(hole);
+    TEST_ASSERT_TRUE(Memory_ScanIncremental(&budget));
+    TEST_ASSERT_TRUE(Memory_Compact(1024) > 0);
+    do {
+        TEST_ASSERT_TRUE(Memory_ScanIncremental(NULL));
+        Memory_GetScanStats(&stats);
+    } while (stats.passes_completed < 1);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+    
+    Memory_FreeHandle(h);
+    MEMORY_FREE(fixed);
+    Memory_ResetScan();
+}
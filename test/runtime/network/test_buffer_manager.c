@@ -0,0 +1,82 @@
+#include "unity.h"
+#include "network/buffer_manager.h"
+#include <string.h>
+
+void setUp(void) {
+    BufferManager_Init();
+}
+
+void tearDown(void) {
+}
+
+void test_BufferManager_LastReleaseFrees(void) {
+    BufferDesc* desc = BufferManager_AllocDesc();
+    TEST_ASSERT_NOT_NULL(desc);
+    TEST_ASSERT_EQUAL_UINT16(1, desc->refcount);
+
+    // Router, recorder and logger each hold the same frame
+    BufferManager_Retain(desc);
+    BufferManager_Retain(desc);
+    TEST_ASSERT_EQUAL_UINT32(1, BufferManager_GetUsage());
+
+    BufferManager_Release(desc);
+    BufferManager_Release(desc);
+    TEST_ASSERT_EQUAL_UINT32(1, BufferManager_GetUsage());
+
+    BufferManager_Release(desc);
+    TEST_ASSERT_EQUAL_UINT32(0, BufferManager_GetUsage());
+
+    BufferStats stats;
+    BufferManager_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.total_allocs);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.total_frees);
+}
+
+void test_BufferManager_ExhaustAndRecover(void) {
+    BufferDesc* descs[BUFFER_COUNT];
+
+    for (uint32_t i = 0; i < BUFFER_COUNT; i++) {
+        descs[i] = BufferManager_AllocDesc();
+        TEST_ASSERT_NOT_NULL(descs[i]);
+    }
+    TEST_ASSERT_NULL(BufferManager_AllocDesc());
+
+    BufferManager_Release(descs[7]);
+    BufferDesc* again = BufferManager_AllocDesc();
+    TEST_ASSERT_EQUAL_PTR(descs[7], again);
+
+    BufferStats stats;
+    BufferManager_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.alloc_failures);
+    TEST_ASSERT_EQUAL_UINT32(BUFFER_COUNT, stats.peak_usage);
+}
+
+void test_BufferManager_ViewAndRawFree(void) {
+    BufferDesc* desc = BufferManager_AllocDesc();
+    memcpy(desc->data, "\x55\x03" "abc", 5);
+    desc->offset = 2;
+    desc->length = 3;
+    TEST_ASSERT_EQUAL_MEMORY("abc", BufferDesc_Data(desc), 3);
+    BufferManager_Release(desc);
+
+    // The raw API maps the pointer back to its descriptor
+    uint8_t* raw = BufferManager_Alloc();
+    TEST_ASSERT_NOT_NULL(raw);
+    TEST_ASSERT_EQUAL_UINT32(1, BufferManager_GetUsage());
+    BufferManager_Free(raw);
+    TEST_ASSERT_EQUAL_UINT32(0, BufferManager_GetUsage());
+
+    // Pointers outside the pool are ignored
+    uint8_t local[4];
+    BufferManager_Free(local);
+    TEST_ASSERT_EQUAL_UINT32(0, BufferManager_GetUsage());
+}
+
+void test_BufferManager_ProcessNeverReclaims(void) {
+    BufferDesc* desc = BufferManager_AllocDesc();
+
+    BufferManager_Process();
+    TEST_ASSERT_EQUAL_UINT32(1, BufferManager_GetUsage());
+    TEST_ASSERT_EQUAL_UINT16(1, desc->refcount);
+    BufferManager_Release(desc);
+}
@@ -0,0 +1,121 @@
+#include "unity.h"
+#include "network/message_handler.h"
+#include <string.h>
+
+// Fake clock and link; the handler reads time and sends only through these
+static uint32_t now_ms;
+static uint32_t send_count;
+
+uint32_t TIMER_GetMs(void) {
+    return now_ms;
+}
+
+bool NetworkHandler_Send(uint8_t* data, uint32_t len) {
+    (void)data;
+    (void)len;
+    send_count++;
+    return true;
+}
+
+static void advance(uint32_t ms) {
+    while (ms--) {
+        now_ms++;
+        MessageHandler_Process();
+    }
+}
+
+void setUp(void) {
+    now_ms = 1000;
+    send_count = 0;
+    TEST_ASSERT_TRUE(MessageHandler_Init());
+}
+
+void tearDown(void) {
+}
+
+void test_MessageHandler_RetriesThenTimesOut(void) {
+    const RetryPolicy policy = { RETRY_BACKOFF_FIXED, 10, 10, 2 };
+    const uint8_t data[] = { 0x22, 0xF1, 0x90 };
+    MessageStats stats;
+
+    TEST_ASSERT_TRUE(MessageHandler_SetRetryPolicy(&policy));
+    TEST_ASSERT_TRUE(MessageHandler_SendTracked(data, sizeof(data), NULL));
+    TEST_ASSERT_EQUAL_UINT32(1, send_count);
+
+    advance(9);
+    TEST_ASSERT_EQUAL_UINT32(1, send_count);
+    advance(1);
+    TEST_ASSERT_EQUAL_UINT32(2, send_count);
+    advance(10);
+    TEST_ASSERT_EQUAL_UINT32(3, send_count);
+
+    // Retries exhausted; the next deadline times the message out
+    advance(10);
+    TEST_ASSERT_EQUAL_UINT32(3, send_count);
+    TEST_ASSERT_EQUAL_UINT32(0, get_msg_count());
+    MessageHandler_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.timeout_count);
+}
+
+void test_MessageHandler_AckStopsRetries(void) {
+    const uint8_t data[] = { 0x10, 0x03 };
+    uint32_t id;
+    MessageStats stats;
+
+    TEST_ASSERT_TRUE(MessageHandler_SendTracked(data, sizeof(data), &id));
+    advance(50);
+    TEST_ASSERT_EQUAL_UINT32(2, send_count);
+
+    TEST_ASSERT_TRUE(MessageHandler_Ack(id));
+    TEST_ASSERT_FALSE(MessageHandler_Ack(id));
+    TEST_ASSERT_EQUAL_UINT32(0, get_msg_count());
+
+    advance(2000);
+    TEST_ASSERT_EQUAL_UINT32(2, send_count);
+    MessageHandler_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.timeout_count);
+}
+
+void test_MessageHandler_ExponentialBackoffSaturates(void) {
+    // base_ms << 2 wraps to 0, which would resend in the same pass
+    const RetryPolicy policy = { RETRY_BACKOFF_EXPONENTIAL, 0x40000000u, 0x7FFFFFFFu, 3 };
+    const uint8_t data[] = { 0x3E, 0x00 };
+
+    TEST_ASSERT_TRUE(MessageHandler_SetRetryPolicy(&policy));
+    TEST_ASSERT_TRUE(MessageHandler_SendTracked(data, sizeof(data), NULL));
+
+    now_ms += 0x40000000u;
+    MessageHandler_Process();
+    TEST_ASSERT_EQUAL_UINT32(2, send_count);
+    now_ms += 0x7FFFFFFFu;
+    MessageHandler_Process();
+    TEST_ASSERT_EQUAL_UINT32(3, send_count);
+
+    advance(100);
+    TEST_ASSERT_EQUAL_UINT32(3, send_count);
+    TEST_ASSERT_EQUAL_UINT32(1, get_msg_count());
+}
+
+void test_MessageHandler_RejectsUnorderableDelay(void) {
+    const RetryPolicy policy = { RETRY_BACKOFF_FIXED, 10, 0x80000000u, 3 };
+
+    TEST_ASSERT_FALSE(MessageHandler_SetRetryPolicy(&policy));
+}
+
+void test_MessageHandler_ExponentialBackoffCapped(void) {
+    const RetryPolicy policy = { RETRY_BACKOFF_EXPONENTIAL, 10, 25, 3 };
+    const uint8_t data[] = { 0x3E, 0x00 };
+
+    TEST_ASSERT_TRUE(MessageHandler_SetRetryPolicy(&policy));
+    TEST_ASSERT_TRUE(MessageHandler_SendTracked(data, sizeof(data), NULL));
+
+    // Delays of 10, 20, then capped at 25
+    advance(10);
+    TEST_ASSERT_EQUAL_UINT32(2, send_count);
+    advance(20);
+    TEST_ASSERT_EQUAL_UINT32(3, send_count);
+    advance(24);
+    TEST_ASSERT_EQUAL_UINT32(3, send_count);
+    advance(1);
+    TEST_ASSERT_EQUAL_UINT32(4, send_count);
+}
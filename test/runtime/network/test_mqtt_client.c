@@ -0,0 +1,385 @@
+#include "unity.h"
+#include "network/mqtt_client.h"
+#include "network/net_core.h"
+#include "network/net_interface.h"
+#include "core/event_bus.h"
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+// Broker stand-in: reads whatever the client wrote on the accepted socket,
+// answers CONNECT, SUBSCRIBE and PINGREQ, and acks QoS 1 publishes unless
+// told to hold them
+typedef struct {
+    int fd;
+    uint8_t buffer[16384];
+    uint32_t length;
+    bool hold_acks;
+    uint16_t held[MQTT_MAX_INFLIGHT];
+    uint32_t held_count;
+    uint32_t connects;
+    uint32_t publishes;
+    uint32_t duplicates;
+    uint16_t keep_alive;
+    char client_id[64];
+    uint8_t last_payload[64];
+    uint32_t last_payload_length;
+    uint16_t last_ack_id;
+} Broker;
+
+static int listener = -1;
+static Broker broker;
+static EthernetConfig eth_config;
+static MQTTConfig mqtt_config;
+static uint16_t delivered[MQTT_MAX_INFLIGHT * 2];
+static uint32_t delivered_count;
+static char message_topic[32];
+static uint8_t message_payload[32];
+static uint32_t message_length;
+
+static void on_delivered(uint16_t packet_id, void* context) {
+    (void)context;
+    delivered[delivered_count++] = packet_id;
+}
+
+static void on_message(const char* topic, uint16_t topic_length,
+                       const uint8_t* payload, uint32_t length, void* context) {
+    (void)context;
+    memcpy(message_topic, topic, topic_length);
+    message_topic[topic_length] = '\0';
+    memcpy(message_payload, payload, length);
+    message_length = length;
+}
+
+static void broker_send(const uint8_t* data, uint32_t length) {
+    TEST_ASSERT_EQUAL_INT((int)length, (int)send(broker.fd, data, length, 0));
+}
+
+static void broker_ack(uint16_t packet_id) {
+    uint8_t ack[] = { 0x40, 2, (uint8_t)(packet_id >> 8), (uint8_t)packet_id };
+    broker_send(ack, sizeof(ack));
+}
+
+static void broker_handle(uint8_t type, const uint8_t* body, uint32_t length) {
+    switch (type & 0xF0) {
+        case 0x10: {
+            TEST_ASSERT_EQUAL_MEMORY("\x00\x04MQTT\x04", body, 7);
+            broker.keep_alive = (uint16_t)((body[8] << 8) | body[9]);
+            uint16_t id_length = (uint16_t)((body[10] << 8) | body[11]);
+            memcpy(broker.client_id, body + 12, id_length);
+            broker.client_id[id_length] = '\0';
+            broker.connects++;
+
+            const uint8_t connack[] = { 0x20, 2, 0, 0 };
+            broker_send(connack, sizeof(connack));
+            break;
+        }
+        case 0x30: {
+            uint8_t qos = (type >> 1) & 3;
+            uint16_t topic_length = (uint16_t)((body[0] << 8) | body[1]);
+            uint32_t offset = 2u + topic_length + (qos ? 2u : 0u);
+
+            broker.publishes++;
+            if (type & 0x08) {
+                broker.duplicates++;
+            }
+            broker.last_payload_length = length - offset;
+            memcpy(broker.last_payload, body + offset, length - offset);
+
+            if (qos == 1) {
+                uint16_t id = (uint16_t)((body[2 + topic_length] << 8) | body[3 + topic_length]);
+                if (broker.hold_acks) {
+                    broker.held[broker.held_count++] = id;
+                } else {
+                    broker_ack(id);
+                }
+            }
+            break;
+        }
+        case 0x40:
+            broker.last_ack_id = (uint16_t)((body[0] << 8) | body[1]);
+            break;
+        case 0x80: {
+            const uint8_t suback[] = { 0x90, 3, body[0], body[1], 1 };
+            const uint8_t publish[] = { 0x32, 11, 0, 5, 'c', 'm', 'd', '/', 'x', 0, 7, 'g', 'o' };
+            broker_send(suback, sizeof(suback));
+            broker_send(publish, sizeof(publish));
+            break;
+        }
+        case 0xC0: {
+            const uint8_t pingresp[] = { 0xD0, 0 };
+            broker_send(pingresp, sizeof(pingresp));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Returns how many packets were handled
+static uint32_t broker_pump(void) {
+    uint32_t handled = 0;
+    ssize_t received;
+
+    while ((received = recv(broker.fd, broker.buffer + broker.length,
+                            sizeof(broker.buffer) - broker.length, MSG_DONTWAIT)) > 0) {
+        broker.length += (uint32_t)received;
+    }
+
+    uint32_t offset = 0;
+    while (broker.length - offset >= 2) {
+        uint32_t remaining = 0;
+        uint32_t used = 0;
+        do {
+            remaining |= (uint32_t)(broker.buffer[offset + 1 + used] & 0x7F) << (7 * used);
+        } while (broker.buffer[offset + 1 + used++] & 0x80);
+
+        uint32_t total = 1 + used + remaining;
+        if (broker.length - offset < total) {
+            break;
+        }
+        broker_handle(broker.buffer[offset], &broker.buffer[offset + 1 + used], remaining);
+        offset += total;
+        handled++;
+    }
+
+    memmove(broker.buffer, broker.buffer + offset, broker.length - offset);
+    broker.length -= offset;
+    return handled;
+}
+
+// One round trip: the broker answers, the client picks the answer up
+static void exchange(void) {
+    broker_pump();
+    Net_Wait(100);
+    MqttClient_Process();
+}
+
+static void start_client(uint8_t window, uint32_t retry_ms) {
+    MqttClientOptions options = {
+        .inflight_window = window,
+        .retry_interval_ms = retry_ms,
+        .on_delivered = on_delivered,
+        .on_message = on_message
+    };
+
+    TEST_ASSERT_TRUE(MqttClient_Init(&mqtt_config, &options));
+    TEST_ASSERT_TRUE(MqttClient_Connect());
+    TEST_ASSERT_EQUAL(MQTT_STATE_CONNECTING, MqttClient_GetState());
+    exchange();
+    TEST_ASSERT_EQUAL(MQTT_STATE_CONNECTED, MqttClient_GetState());
+}
+
+void setUp(void) {
+    struct sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    NetManagerConfig config = {
+        .max_interfaces = 1,
+        .max_connections = 1,
+        .rx_buffer_size = 4096,
+        .tx_buffer_size = 4096
+    };
+
+    memset(&broker, 0, sizeof(broker));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_EQUAL_INT(0, bind(listener, (struct sockaddr*)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL_INT(0, listen(listener, 1));
+    getsockname(listener, (struct sockaddr*)&addr, &length);
+
+    memset(&eth_config, 0, sizeof(eth_config));
+    eth_config.open_tcp = true;
+
+    NetInterfaceConfig if_config = {
+        .type = NET_IF_ETHERNET,
+        .name = "lo",
+        .address = "127.0.0.1",
+        .port = ntohs(addr.sin_port),
+        .interface_config = &eth_config
+    };
+
+    TEST_ASSERT_TRUE(Net_Init(&config));
+    TEST_ASSERT_TRUE(Net_AddInterface(&if_config));
+    TEST_ASSERT_TRUE(Net_Connect(NET_IF_ETHERNET));
+    broker.fd = accept(listener, NULL, NULL);
+    TEST_ASSERT_TRUE(broker.fd >= 0);
+
+    // Each ack is its own write and has to arrive without waiting on Nagle
+    int one = 1;
+    setsockopt(broker.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    memset(&mqtt_config, 0, sizeof(mqtt_config));
+    strcpy(mqtt_config.client_id, "ecu-17");
+    mqtt_config.keep_alive_interval = 30;
+    mqtt_config.clean_session = true;
+
+    delivered_count = 0;
+    message_length = 0;
+}
+
+void tearDown(void) {
+    MqttClient_Deinit();
+    Net_Deinit();
+    EventBus_Deinit();
+    close(broker.fd);
+    close(listener);
+}
+
+void test_MqttClient_Connect(void) {
+    start_client(0, 0);
+    TEST_ASSERT_EQUAL_UINT32(1, broker.connects);
+    TEST_ASSERT_EQUAL_STRING("ecu-17", broker.client_id);
+    TEST_ASSERT_EQUAL_UINT32(30, broker.keep_alive);
+}
+
+void test_MqttClient_BatchesPublishes(void) {
+    static const uint8_t payload[] = "speed=42";
+    MqttStats stats;
+
+    start_client(0, 0);
+    MqttPublish publish = {
+        .topic = "vehicle/telemetry",
+        .payload = payload,
+        .length = sizeof(payload)
+    };
+    for (uint32_t i = 0; i < 20; i++) {
+        TEST_ASSERT_TRUE(MqttClient_Publish(&publish, NULL));
+    }
+
+    // Nothing is written until the queue is flushed
+    TEST_ASSERT_EQUAL_UINT32(0, broker_pump());
+    TEST_ASSERT_TRUE(MqttClient_Flush());
+    TEST_ASSERT_EQUAL_UINT32(20, broker_pump());
+
+    MqttClient_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(20, stats.published);
+    TEST_ASSERT_EQUAL_UINT32((20 + MQTT_BATCH_MAX - 1) / MQTT_BATCH_MAX, stats.batches);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(payload), broker.last_payload_length);
+    TEST_ASSERT_EQUAL_MEMORY(payload, broker.last_payload, sizeof(payload));
+}
+
+void test_MqttClient_InflightWindow(void) {
+    static const uint8_t payload[] = { 1, 2, 3 };
+    uint16_t ids[6];
+    MqttStats stats;
+
+    start_client(4, 0);
+    broker.hold_acks = true;
+
+    MqttPublish publish = { .topic = "dtc", .payload = payload, .length = 3, .qos = 1 };
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(MqttClient_Publish(&publish, &ids[i]));
+        TEST_ASSERT_TRUE(ids[i] != 0);
+    }
+    TEST_ASSERT_FALSE(MqttClient_Publish(&publish, &ids[4]));
+    TEST_ASSERT_EQUAL_UINT32(4, MqttClient_GetInflightCount());
+
+    MqttClient_Process();
+    broker_pump();
+    TEST_ASSERT_EQUAL_UINT32(4, broker.held_count);
+
+    // Acks in any order free their own slots
+    for (int32_t i = 3; i >= 0; i--) {
+        TEST_ASSERT_EQUAL_UINT32(ids[i], broker.held[i]);
+        broker_ack(broker.held[i]);
+    }
+    Net_Wait(100);
+    MqttClient_Process();
+
+    TEST_ASSERT_EQUAL_UINT32(0, MqttClient_GetInflightCount());
+    TEST_ASSERT_EQUAL_UINT32(4, delivered_count);
+    TEST_ASSERT_EQUAL_UINT32(ids[3], delivered[0]);
+    TEST_ASSERT_EQUAL_UINT32(ids[0], delivered[3]);
+
+    MqttClient_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.window_full);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.delivered);
+
+    // Acks for unknown or stale ids are ignored
+    broker_ack(ids[0]);
+    Net_Wait(100);
+    MqttClient_Process();
+    TEST_ASSERT_EQUAL_UINT32(4, delivered_count);
+    TEST_ASSERT_TRUE(MqttClient_Publish(&publish, &ids[5]));
+}
+
+void test_MqttClient_RetransmitsWithDup(void) {
+    static const uint8_t payload[] = "odo=1234";
+    uint16_t id;
+    MqttStats stats;
+
+    start_client(0, 20);
+    broker.hold_acks = true;
+
+    MqttPublish publish = { .topic = "odo", .payload = payload, .length = sizeof(payload), .qos = 1 };
+    TEST_ASSERT_TRUE(MqttClient_Publish(&publish, &id));
+    MqttClient_Process();
+    broker_pump();
+    TEST_ASSERT_EQUAL_UINT32(1, broker.publishes);
+    TEST_ASSERT_EQUAL_UINT32(0, broker.duplicates);
+
+    usleep(30000);
+    MqttClient_Process();
+    broker_pump();
+    TEST_ASSERT_EQUAL_UINT32(2, broker.publishes);
+    TEST_ASSERT_EQUAL_UINT32(1, broker.duplicates);
+    TEST_ASSERT_EQUAL_UINT32(id, broker.held[1]);
+
+    broker_ack(id);
+    Net_Wait(100);
+    MqttClient_Process();
+    TEST_ASSERT_EQUAL_UINT32(1, delivered_count);
+
+    MqttClient_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.retransmits);
+}
+
+void test_MqttClient_ResendsAfterReconnect(void) {
+    static const uint8_t payload[] = "soc=81";
+    uint16_t id;
+
+    start_client(0, 0);
+    broker.hold_acks = true;
+
+    MqttPublish publish = { .topic = "bms", .payload = payload, .length = sizeof(payload), .qos = 1 };
+    TEST_ASSERT_TRUE(MqttClient_Publish(&publish, &id));
+    MqttClient_Process();
+    broker_pump();
+    TEST_ASSERT_EQUAL_UINT32(1, broker.publishes);
+
+    // Same TCP stream, new session: the unacknowledged publish goes again
+    broker.hold_acks = false;
+    TEST_ASSERT_TRUE(MqttClient_Connect());
+    exchange();
+    TEST_ASSERT_EQUAL(MQTT_STATE_CONNECTED, MqttClient_GetState());
+    broker_pump();
+    TEST_ASSERT_EQUAL_UINT32(2, broker.publishes);
+    TEST_ASSERT_EQUAL_UINT32(1, broker.duplicates);
+
+    Net_Wait(100);
+    MqttClient_Process();
+    TEST_ASSERT_EQUAL_UINT32(1, delivered_count);
+    TEST_ASSERT_EQUAL_UINT32(id, delivered[0]);
+}
+
+void test_MqttClient_ReceivesSubscribedMessages(void) {
+    uint16_t id;
+
+    start_client(0, 0);
+    TEST_ASSERT_TRUE(MqttClient_Subscribe("cmd/#", 1, &id));
+    exchange();
+
+    TEST_ASSERT_EQUAL_STRING("cmd/x", message_topic);
+    TEST_ASSERT_EQUAL_UINT32(2, message_length);
+    TEST_ASSERT_EQUAL_MEMORY("go", message_payload, 2);
+
+    // The QoS 1 delivery is acknowledged back to the broker
+    broker_pump();
+    TEST_ASSERT_EQUAL_UINT32(7, broker.last_ack_id);
+}
@@ -1,6 +1,7 @@
 #include "unity.h"
 #include "network/net_buffer.h"
 #include <string.h>
+#include <pthread.h>
 
 static NetBuffer test_buffer;
 static const uint32_t BUFFER_SIZE = 1024;
@@ -49,4 +50,122 @@ void test_NetBuffer_Wrap(void) {
     uint8_t read_data[BUFFER_SIZE/4];
     TEST_ASSERT_TRUE(NetBuffer_Read(&test_buffer, read_data, sizeof(read_data)));
     TEST_ASSERT_EQUAL_MEMORY(data2, read_data, sizeof(data2));
-} 
\ No newline at end of file
+} 
+void test_NetBuffer_SpscRequiresPowerOfTwo(void) {
+    NetBuffer spsc;
+    TEST_ASSERT_FALSE(NetBuffer_InitSpsc(&spsc, 1000));
+    TEST_ASSERT_TRUE(NetBuffer_InitSpsc(&spsc, 1024));
+
+    // The zero-copy API is not available in locked mode
+    uint8_t* region;
+    TEST_ASSERT_EQUAL_UINT32(0, NetBuffer_Reserve(&test_buffer, &region));
+
+    NetBuffer_Deinit(&spsc);
+}
+
+void test_NetBuffer_SpscWrap(void) {
+    NetBuffer spsc;
+    uint8_t data[48];
+    uint8_t read_data[48];
+
+    TEST_ASSERT_TRUE(NetBuffer_InitSpsc(&spsc, 64));
+
+    // Drive the indices around the ring several times
+    for (int round = 0; round < 10; round++) {
+        memset(data, round, sizeof(data));
+        TEST_ASSERT_TRUE(NetBuffer_Write(&spsc, data, sizeof(data)));
+        TEST_ASSERT_FALSE(NetBuffer_Write(&spsc, data, sizeof(data)));
+        TEST_ASSERT_EQUAL_UINT32(16, NetBuffer_GetFree(&spsc));
+        TEST_ASSERT_TRUE(NetBuffer_Read(&spsc, read_data, sizeof(read_data)));
+        TEST_ASSERT_EQUAL_MEMORY(data, read_data, sizeof(data));
+    }
+
+    TEST_ASSERT_TRUE(NetBuffer_HasOverflowed(&spsc));
+    TEST_ASSERT_TRUE(NetBuffer_IsEmpty(&spsc));
+    NetBuffer_Deinit(&spsc);
+}
+
+void test_NetBuffer_SpscZeroCopy(void) {
+    NetBuffer spsc;
+    uint8_t* region;
+    const uint8_t* view;
+    uint8_t data[40];
+
+    TEST_ASSERT_TRUE(NetBuffer_InitSpsc(&spsc, 64));
+
+    // Move head and tail to offset 40 so the free space wraps
+    memset(data, 0x11, sizeof(data));
+    TEST_ASSERT_TRUE(NetBuffer_Write(&spsc, data, sizeof(data)));
+    TEST_ASSERT_TRUE(NetBuffer_Read(&spsc, data, sizeof(data)));
+
+    // Only the span up to the end of the ring is handed out
+    TEST_ASSERT_EQUAL_UINT32(24, NetBuffer_Reserve(&spsc, &region));
+    memset(region, 0xA5, 24);
+    TEST_ASSERT_FALSE(NetBuffer_Commit(&spsc, 25));
+    TEST_ASSERT_TRUE(NetBuffer_Commit(&spsc, 16));
+    TEST_ASSERT_TRUE(NetBuffer_Commit(&spsc, 8));
+    TEST_ASSERT_EQUAL_UINT32(40, NetBuffer_Reserve(&spsc, &region));
+    TEST_ASSERT_EQUAL_PTR(spsc.data, region);
+    memset(region, 0x5A, 8);
+    TEST_ASSERT_TRUE(NetBuffer_Commit(&spsc, 8));
+    TEST_ASSERT_EQUAL_UINT32(32, NetBuffer_GetAvailable(&spsc));
+
+    // The consumer sees the same two spans in place
+    TEST_ASSERT_EQUAL_UINT32(24, NetBuffer_PeekContiguous(&spsc, &view));
+    TEST_ASSERT_EQUAL_HEX8(0xA5, view[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, view[23]);
+    TEST_ASSERT_TRUE(NetBuffer_Release(&spsc, 24));
+    TEST_ASSERT_FALSE(NetBuffer_Release(&spsc, 1));
+    TEST_ASSERT_EQUAL_UINT32(8, NetBuffer_PeekContiguous(&spsc, &view));
+    TEST_ASSERT_EQUAL_HEX8(0x5A, view[7]);
+    TEST_ASSERT_TRUE(NetBuffer_Release(&spsc, 8));
+    TEST_ASSERT_TRUE(NetBuffer_IsEmpty(&spsc));
+
+    NetBuffer_Deinit(&spsc);
+}
+
+#define SPSC_STREAM_BYTES (1u << 20)
+
+static void* spsc_producer(void* arg) {
+    NetBuffer* spsc = (NetBuffer*)arg;
+    uint32_t sent = 0;
+
+    while (sent < SPSC_STREAM_BYTES) {
+        uint8_t* region;
+        uint32_t span = NetBuffer_Reserve(spsc, &region);
+        if (span > SPSC_STREAM_BYTES - sent) {
+            span = SPSC_STREAM_BYTES - sent;
+        }
+        for (uint32_t i = 0; i < span; i++) {
+            region[i] = (uint8_t)(sent + i);
+        }
+        NetBuffer_Commit(spsc, span);
+        sent += span;
+    }
+    return NULL;
+}
+
+void test_NetBuffer_SpscProducerConsumer(void) {
+    NetBuffer spsc;
+    pthread_t producer;
+    uint32_t received = 0;
+    uint32_t mismatches = 0;
+
+    TEST_ASSERT_TRUE(NetBuffer_InitSpsc(&spsc, 256));
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, spsc_producer, &spsc));
+
+    while (received < SPSC_STREAM_BYTES) {
+        const uint8_t* view;
+        uint32_t span = NetBuffer_PeekContiguous(&spsc, &view);
+        for (uint32_t i = 0; i < span; i++) {
+            mismatches += (view[i] != (uint8_t)(received + i));
+        }
+        NetBuffer_Release(&spsc, span);
+        received += span;
+    }
+
+    pthread_join(producer, NULL);
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    TEST_ASSERT_TRUE(NetBuffer_IsEmpty(&spsc));
+    NetBuffer_Deinit(&spsc);
+}
@@ -1,5 +1,6 @@
 #include "unity.h"
 #include "network/net_core.h"
+#include "core/event_bus.h"
 #include <string.h>
 
 static NetManagerConfig test_config;
@@ -29,6 +30,7 @@ void setUp(void) {
 
 void tearDown(void) {
     Net_Deinit();
+    EventBus_Deinit();
 }
 
 void test_Net_AddRemoveInterface(void) {
@@ -76,6 +78,10 @@ void test_Net_SendReceiveMessage(void) {
     
     Net_RegisterCallback(NET_EVENT_DATA_SENT, test_callback, NULL);
     TEST_ASSERT_TRUE(Net_SendMessage(&message));
+    TEST_ASSERT_FALSE(callback_triggered);
+
+    // Callbacks are deferred to the bus dispatcher
+    TEST_ASSERT_EQUAL_UINT32(1, EventBus_Dispatch(0));
     TEST_ASSERT_TRUE(callback_triggered);
     TEST_ASSERT_EQUAL(NET_EVENT_DATA_SENT, last_event);
 } 
\ No newline at end of file
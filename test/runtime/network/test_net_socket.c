@@ -0,0 +1,313 @@
+#include "unity.h"
+#include "network/net_core.h"
+#include "network/net_interface.h"
+#include "core/event_bus.h"
+#include "diagnostic/os/timer.h"
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+static int listener = -1;
+static int peer_tcp = -1;
+static int peer_udp = -1;
+static EthernetConfig eth_config;
+static NetInterfaceConfig if_config;
+static uint32_t received_events;
+static NetProtocolType last_protocol;
+
+static void on_received(NetEventType event, void* data, void* context) {
+    (void)event;
+    (void)context;
+    received_events++;
+    last_protocol = ((NetMessage*)data)->protocol;
+}
+
+static uint16_t open_peers(void) {
+    struct sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_EQUAL_INT(0, bind(listener, (struct sockaddr*)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL_INT(0, listen(listener, 1));
+    getsockname(listener, (struct sockaddr*)&addr, &length);
+
+    // The UDP peer shares the port number so one interface address serves both
+    peer_udp = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_EQUAL_INT(0, bind(peer_udp, (struct sockaddr*)&addr, sizeof(addr)));
+
+    return ntohs(addr.sin_port);
+}
+
+void setUp(void) {
+    NetManagerConfig config = {
+        .max_interfaces = 4,
+        .max_connections = 8,
+        .rx_buffer_size = 1024,
+        .tx_buffer_size = 1024,
+        .enable_statistics = true,
+        .batch_depth = 4
+    };
+
+    memset(&eth_config, 0, sizeof(eth_config));
+    eth_config.open_tcp = true;
+    eth_config.open_udp = true;
+
+    memset(&if_config, 0, sizeof(if_config));
+    if_config.type = NET_IF_ETHERNET;
+    if_config.name = "lo";
+    if_config.address = "127.0.0.1";
+    if_config.port = open_peers();
+    if_config.interface_config = &eth_config;
+
+    received_events = 0;
+
+    TEST_ASSERT_TRUE(Net_Init(&config));
+    TEST_ASSERT_TRUE(Net_AddInterface(&if_config));
+    TEST_ASSERT_TRUE(Net_Connect(NET_IF_ETHERNET));
+    Net_RegisterCallback(NET_EVENT_DATA_RECEIVED, on_received, NULL);
+
+    peer_tcp = accept(listener, NULL, NULL);
+    TEST_ASSERT_TRUE(peer_tcp >= 0);
+}
+
+void tearDown(void) {
+    Net_Deinit();
+    EventBus_Deinit();
+    if (peer_tcp >= 0) close(peer_tcp);
+    close(peer_udp);
+    close(listener);
+    peer_tcp = -1;
+}
+
+void test_NetSocket_TcpLoopback(void) {
+    const uint8_t header[] = { 0x02, 0xFD, 0x80, 0x01 };
+    uint8_t payload[] = "read data by id";
+    uint8_t buffer[64];
+
+    NetMessage message = {
+        .data = payload,
+        .length = sizeof(payload),
+        .protocol = NET_PROTO_TCP
+    };
+    TEST_ASSERT_TRUE(Net_SendMessage(&message));
+    TEST_ASSERT_EQUAL_INT((int)sizeof(payload), (int)recv(peer_tcp, buffer, sizeof(buffer), 0));
+    TEST_ASSERT_EQUAL_MEMORY(payload, buffer, sizeof(payload));
+
+    NetIoVec iov[] = {
+        { header, sizeof(header) },
+        { payload, sizeof(payload) }
+    };
+    NetMessageV vectored = { .iov = iov, .iov_count = 2, .protocol = NET_PROTO_TCP };
+    TEST_ASSERT_TRUE(Net_SendMessageV(&vectored));
+    TEST_ASSERT_EQUAL_INT((int)(sizeof(header) + sizeof(payload)),
+                          (int)recv(peer_tcp, buffer, sizeof(header) + sizeof(payload), MSG_WAITALL));
+    TEST_ASSERT_EQUAL_MEMORY(header, buffer, sizeof(header));
+
+    // Inbound bytes are reported once the socket signals readiness
+    TEST_ASSERT_EQUAL_INT(5, (int)send(peer_tcp, "reply", 5, 0));
+    TEST_ASSERT_TRUE(Net_Wait(1000));
+    EventBus_Dispatch(0);
+    TEST_ASSERT_EQUAL_UINT32(1, received_events);
+    TEST_ASSERT_EQUAL(NET_PROTO_TCP, last_protocol);
+
+    NetMessage reply = { .data = buffer, .length = sizeof(buffer), .protocol = NET_PROTO_TCP };
+    TEST_ASSERT_TRUE(Net_ReceiveMessage(&reply));
+    TEST_ASSERT_EQUAL_UINT32(5, reply.length);
+    TEST_ASSERT_EQUAL_MEMORY("reply", buffer, 5);
+}
+
+void test_NetSocket_UdpLoopback(void) {
+    uint8_t ping[] = "ping";
+    uint8_t buffer[64];
+    struct sockaddr_in from;
+    socklen_t from_length = sizeof(from);
+
+    NetMessage message = { .data = ping, .length = sizeof(ping), .protocol = NET_PROTO_UDP };
+    TEST_ASSERT_TRUE(Net_SendMessage(&message));
+    TEST_ASSERT_EQUAL_INT((int)sizeof(ping),
+                          (int)recvfrom(peer_udp, buffer, sizeof(buffer), 0,
+                                        (struct sockaddr*)&from, &from_length));
+
+    sendto(peer_udp, "pong", 4, 0, (struct sockaddr*)&from, from_length);
+    TEST_ASSERT_TRUE(Net_Wait(1000));
+    EventBus_Dispatch(0);
+    TEST_ASSERT_EQUAL(NET_PROTO_UDP, last_protocol);
+
+    NetMessage reply = { .data = buffer, .length = sizeof(buffer), .protocol = NET_PROTO_UDP };
+    TEST_ASSERT_TRUE(Net_ReceiveMessage(&reply));
+    TEST_ASSERT_EQUAL_UINT32(4, reply.length);
+    TEST_ASSERT_EQUAL_MEMORY("pong", buffer, 4);
+
+    // The socket is drained, so nothing more is reported
+    TEST_ASSERT_FALSE(Net_ReceiveMessage(&reply));
+}
+
+void test_NetSocket_UdpBatch(void) {
+    uint8_t payload[10][16];
+    uint8_t storage[16][32];
+    NetMessage batch[16];
+    struct sockaddr_in from;
+    socklen_t from_length = sizeof(from);
+
+    for (uint32_t i = 0; i < 10; i++) {
+        memset(payload[i], (int)i, sizeof(payload[i]));
+        batch[i].data = payload[i];
+        batch[i].length = i + 1;
+        batch[i].protocol = NET_PROTO_UDP;
+    }
+    TEST_ASSERT_EQUAL_UINT32(10, Net_SendMessages(batch, 10));
+
+    for (uint32_t i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_INT((int)(i + 1),
+                              (int)recvfrom(peer_udp, storage[0], sizeof(storage[0]), 0,
+                                            (struct sockaddr*)&from, &from_length));
+        TEST_ASSERT_EQUAL_HEX8(i, storage[0][0]);
+    }
+
+    // Echo the burst back; datagram boundaries survive the batch read
+    for (uint32_t i = 0; i < 10; i++) {
+        sendto(peer_udp, payload[i], i + 1, 0, (struct sockaddr*)&from, from_length);
+    }
+    TEST_ASSERT_TRUE(Net_Wait(1000));
+
+    for (uint32_t i = 0; i < 16; i++) {
+        batch[i].data = storage[i];
+        batch[i].length = sizeof(storage[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(10, Net_ReceiveMessages(batch, 16));
+    for (uint32_t i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i + 1, batch[i].length);
+        TEST_ASSERT_EQUAL(NET_PROTO_UDP, batch[i].protocol);
+        TEST_ASSERT_EQUAL_MEMORY(payload[i], storage[i], i + 1);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, Net_ReceiveMessages(batch, 16));
+}
+
+void test_NetSocket_StatisticsAndLatency(void) {
+    uint8_t ping[] = "ping";
+    uint8_t buffer[64];
+    struct sockaddr_in from;
+    socklen_t from_length = sizeof(from);
+    NetStatistics stats;
+    NetLatencySummary latency;
+
+    NetMessage message = { .data = ping, .length = sizeof(ping), .protocol = NET_PROTO_UDP };
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(Net_SendMessage(&message));
+        recvfrom(peer_udp, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &from_length);
+    }
+
+    sendto(peer_udp, "pong", 4, 0, (struct sockaddr*)&from, from_length);
+    TEST_ASSERT_TRUE(Net_Wait(1000));
+    NetMessage reply = { .data = buffer, .length = sizeof(buffer), .protocol = NET_PROTO_UDP };
+    TEST_ASSERT_TRUE(Net_ReceiveMessage(&reply));
+
+    Net_GetStatistics(NET_IF_ETHERNET, &stats);
+    TEST_ASSERT_EQUAL_UINT64(3, stats.packets_sent);
+    TEST_ASSERT_EQUAL_UINT64(3 * sizeof(ping), stats.bytes_sent);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.packets_received);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.successful_connections);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.tx_queue_bytes);
+
+    TEST_ASSERT_TRUE(Net_GetLatency(NET_IF_ETHERNET, NET_PROTO_UDP, NET_DIR_TX, &latency));
+    TEST_ASSERT_EQUAL_UINT64(3, latency.count);
+    TEST_ASSERT_TRUE(latency.max_ns > 0 && latency.p50_ns <= latency.max_ns);
+    TEST_ASSERT_TRUE(Net_GetLatency(NET_IF_ETHERNET, NET_PROTO_UDP, NET_DIR_RX, &latency));
+    TEST_ASSERT_EQUAL_UINT64(1, latency.count);
+    TEST_ASSERT_FALSE(Net_GetLatency(NET_IF_WIFI, NET_PROTO_UDP, NET_DIR_TX, &latency));
+
+    Net_ResetStatistics(NET_IF_ETHERNET);
+    Net_GetStatistics(NET_IF_ETHERNET, &stats);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.packets_sent);
+}
+
+void test_NetSocket_IdleWaitSleeps(void) {
+    struct rusage before, after;
+
+    // Consume the writable edge left by the connect
+    Net_Wait(0);
+
+    getrusage(RUSAGE_SELF, &before);
+    uint32_t start = Timer_GetMilliseconds();
+    TEST_ASSERT_FALSE(Net_Wait(200));
+    uint32_t elapsed = Timer_GetMilliseconds() - start;
+    getrusage(RUSAGE_SELF, &after);
+    EventBus_Dispatch(0);
+
+    long cpu_us = (after.ru_utime.tv_sec - before.ru_utime.tv_sec) * 1000000L +
+                  (after.ru_utime.tv_usec - before.ru_utime.tv_usec) +
+                  (after.ru_stime.tv_sec - before.ru_stime.tv_sec) * 1000000L +
+                  (after.ru_stime.tv_usec - before.ru_stime.tv_usec);
+
+    TEST_ASSERT_TRUE(elapsed >= 190);
+    TEST_ASSERT_TRUE(cpu_us < 20000);
+    TEST_ASSERT_EQUAL_UINT32(0, received_events);
+}
+
+static long cpu_time_us(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000L +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+void test_NetSocket_UndrainedSocketsDoNotSpin(void) {
+    uint8_t ping[] = "ping";
+    uint8_t bulk[4096];
+    uint8_t buffer[2048];
+    struct sockaddr_in from;
+    socklen_t from_length = sizeof(from);
+
+    NetMessage message = { .data = ping, .length = sizeof(ping), .protocol = NET_PROTO_UDP };
+    TEST_ASSERT_TRUE(Net_SendMessage(&message));
+    recvfrom(peer_udp, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &from_length);
+
+    // A datagram the application leaves queued and a stream larger than
+    // the 1 KiB RX buffer
+    Net_Wait(0);
+    sendto(peer_udp, "pong", 4, 0, (struct sockaddr*)&from, from_length);
+    memset(bulk, 0xA5, sizeof(bulk));
+    TEST_ASSERT_EQUAL_INT((int)sizeof(bulk), (int)send(peer_tcp, bulk, sizeof(bulk), 0));
+    TEST_ASSERT_TRUE(Net_Wait(1000));
+
+    long cpu_before = cpu_time_us();
+    uint32_t start = Timer_GetMilliseconds();
+    Net_Wait(200);
+    Net_Wait(200);
+    uint32_t elapsed = Timer_GetMilliseconds() - start;
+    TEST_ASSERT_TRUE(elapsed >= 190);
+    TEST_ASSERT_TRUE(cpu_time_us() - cpu_before < 20000);
+
+    // Freeing RX space wakes the poller to drain the rest
+    uint32_t total = 0;
+    while (total < sizeof(bulk)) {
+        NetMessage chunk = { .data = buffer, .length = sizeof(buffer), .protocol = NET_PROTO_TCP };
+        if (Net_ReceiveMessage(&chunk)) {
+            total += chunk.length;
+            continue;
+        }
+        start = Timer_GetMilliseconds();
+        TEST_ASSERT_TRUE(Net_Wait(1000));
+        TEST_ASSERT_TRUE(Timer_GetMilliseconds() - start < 100);
+    }
+    TEST_ASSERT_EQUAL_UINT32(sizeof(bulk), total);
+
+    NetMessage reply = { .data = buffer, .length = sizeof(buffer), .protocol = NET_PROTO_UDP };
+    TEST_ASSERT_TRUE(Net_ReceiveMessage(&reply));
+    TEST_ASSERT_EQUAL_MEMORY("pong", buffer, 4);
+}
+
+void test_NetSocket_PeerCloseDisconnects(void) {
+    close(peer_tcp);
+    peer_tcp = -1;
+
+    TEST_ASSERT_TRUE(Net_Wait(1000));
+    TEST_ASSERT_EQUAL(NET_STATE_DISCONNECTED, Net_GetState(NET_IF_ETHERNET));
+}
@@ -0,0 +1,108 @@
+#include "unity.h"
+#include "network/net_stats.h"
+#include <pthread.h>
+#include <string.h>
+
+#define ADDER_THREADS   4
+#define ADDS_PER_THREAD 100000
+
+static NetCounters counters;
+static NetHistogram histogram;
+
+void setUp(void) {
+    NetCounters_Reset(&counters);
+    NetHistogram_Reset(&histogram);
+}
+
+void tearDown(void) {
+}
+
+void test_NetHistogram_SmallValuesAreExact(void) {
+    for (uint64_t value = 0; value < 2 * NET_HIST_SUB_COUNT; value++) {
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)value, NetHistogram_BucketIndex(value));
+        TEST_ASSERT_EQUAL_UINT64(value, NetHistogram_BucketUpper((uint32_t)value));
+    }
+}
+
+void test_NetHistogram_BucketsAreContiguous(void) {
+    // Every value maps to a bucket whose range contains it, and the buckets
+    // tile the line without gaps
+    uint64_t previous_upper = 0;
+    for (uint32_t index = 1; index < NET_HIST_BUCKETS; index++) {
+        uint64_t upper = NetHistogram_BucketUpper(index);
+        TEST_ASSERT_EQUAL_UINT32(index, NetHistogram_BucketIndex(previous_upper + 1));
+        TEST_ASSERT_EQUAL_UINT32(index, NetHistogram_BucketIndex(upper));
+        previous_upper = upper;
+    }
+    TEST_ASSERT_EQUAL_UINT64((1ull << NET_HIST_MAX_BITS) - 1, previous_upper);
+    TEST_ASSERT_EQUAL_UINT32(NET_HIST_BUCKETS - 1, NetHistogram_BucketIndex(UINT64_MAX));
+}
+
+void test_NetHistogram_RelativeErrorIsBounded(void) {
+    for (uint64_t value = 1; value < (1ull << 30); value = value * 3 + 1) {
+        uint64_t upper = NetHistogram_BucketUpper(NetHistogram_BucketIndex(value));
+        TEST_ASSERT_TRUE(upper >= value);
+        TEST_ASSERT_TRUE((upper - value) * NET_HIST_SUB_COUNT <= value);
+    }
+}
+
+void test_NetHistogram_Percentiles(void) {
+    NetLatencySummary summary;
+
+    // 1..1000 us in ns
+    for (uint64_t i = 1; i <= 1000; i++) {
+        NetHistogram_Record(&histogram, i * 1000);
+    }
+    NetHistogram_Summarize(&histogram, &summary);
+
+    TEST_ASSERT_EQUAL_UINT64(1000, summary.count);
+    TEST_ASSERT_EQUAL_UINT64(500500, summary.mean_ns);
+    TEST_ASSERT_EQUAL_UINT64(1000000, summary.max_ns);
+    TEST_ASSERT_TRUE(summary.p50_ns >= 500000 && summary.p50_ns <= 500000 + 500000 / NET_HIST_SUB_COUNT);
+    TEST_ASSERT_TRUE(summary.p99_ns >= 990000 && summary.p99_ns <= 1000000);
+    TEST_ASSERT_TRUE(summary.p50_ns <= summary.p90_ns && summary.p90_ns <= summary.p99_ns);
+    TEST_ASSERT_EQUAL_UINT64(summary.max_ns, NetHistogram_Percentile(&histogram, 100.0));
+}
+
+void test_NetHistogram_EmptySummary(void) {
+    NetLatencySummary summary;
+    NetHistogram_Summarize(&histogram, &summary);
+    TEST_ASSERT_EQUAL_UINT64(0, summary.count);
+    TEST_ASSERT_EQUAL_UINT64(0, summary.p99_ns);
+}
+
+static void* adder(void* arg) {
+    (void)arg;
+    for (uint32_t i = 0; i < ADDS_PER_THREAD; i++) {
+        NetCounters_Add(&counters, NET_COUNTER_PACKETS_SENT, 1);
+        NetCounters_Add(&counters, NET_COUNTER_BYTES_SENT, 1500);
+    }
+    return NULL;
+}
+
+void test_NetCounters_SumAcrossThreads(void) {
+    pthread_t threads[ADDER_THREADS];
+    uint64_t totals[NET_COUNTER_COUNT];
+
+    for (uint32_t i = 0; i < ADDER_THREADS; i++) {
+        pthread_create(&threads[i], NULL, adder, NULL);
+    }
+    for (uint32_t i = 0; i < ADDER_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    NetCounters_Sum(&counters, totals);
+    TEST_ASSERT_EQUAL_UINT64(ADDER_THREADS * ADDS_PER_THREAD, totals[NET_COUNTER_PACKETS_SENT]);
+    // Past 2^32, where the old 32-bit counters wrapped
+    TEST_ASSERT_EQUAL_UINT64(1500ull * ADDER_THREADS * ADDS_PER_THREAD, totals[NET_COUNTER_BYTES_SENT]);
+    TEST_ASSERT_EQUAL_UINT64(0, totals[NET_COUNTER_ERRORS]);
+}
+
+void test_NetCounters_Wide(void) {
+    uint64_t totals[NET_COUNTER_COUNT];
+
+    NetCounters_Add(&counters, NET_COUNTER_BYTES_RECEIVED, 0xFFFFFFFFull);
+    NetCounters_Add(&counters, NET_COUNTER_BYTES_RECEIVED, 2);
+    NetCounters_Sum(&counters, totals);
+    TEST_ASSERT_EQUAL_UINT64(0x100000001ull, totals[NET_COUNTER_BYTES_RECEIVED]);
+}
@@ -0,0 +1,87 @@
+#include "unity.h"
+#include "platform/hardware/socket_io.h"
+#include <string.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int sockets[2];
+
+void setUp(void) {
+    TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+}
+
+void tearDown(void) {
+    close(sockets[0]);
+    close(sockets[1]);
+}
+
+void test_Socket_SendVHeaderAndPayload(void) {
+    const uint8_t header[] = { 0x02, 0xFD, 0x80, 0x01 };
+    const uint8_t payload[] = "diagnostic payload";
+    IoSegment_t segments[] = {
+        { header, sizeof(header) },
+        { NULL, 0 },
+        { payload, sizeof(payload) }
+    };
+
+    TEST_ASSERT_TRUE(Socket_SendV(sockets[0], segments, 3));
+
+    uint8_t received[64];
+    ssize_t length = recv(sockets[1], received, sizeof(received), 0);
+    TEST_ASSERT_EQUAL_INT((int)(sizeof(header) + sizeof(payload)), (int)length);
+    TEST_ASSERT_EQUAL_MEMORY(header, received, sizeof(header));
+    TEST_ASSERT_EQUAL_MEMORY(payload, received + sizeof(header), sizeof(payload));
+}
+
+#define LARGE_SEGMENT (256 * 1024)
+
+static uint8_t large_a[LARGE_SEGMENT];
+static uint8_t large_b[LARGE_SEGMENT];
+static uint8_t drained[2 * LARGE_SEGMENT + 8];
+
+static void* drain_socket(void* arg) {
+    size_t total = 0;
+    (void)arg;
+    while (total < sizeof(drained)) {
+        ssize_t n = recv(sockets[1], drained + total, sizeof(drained) - total, 0);
+        if (n <= 0) break;
+        total += (size_t)n;
+    }
+    return NULL;
+}
+
+void test_Socket_SendVLargeSegments(void) {
+    const uint8_t header[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    int sndbuf = 4096;
+    pthread_t reader;
+
+    // Segments far larger than the send buffer stream through in order
+    setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    memset(large_a, 0xA1, sizeof(large_a));
+    memset(large_b, 0xB2, sizeof(large_b));
+
+    IoSegment_t segments[] = {
+        { header, sizeof(header) },
+        { large_a, sizeof(large_a) },
+        { large_b, sizeof(large_b) }
+    };
+
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&reader, NULL, drain_socket, NULL));
+    TEST_ASSERT_TRUE(Socket_SendV(sockets[0], segments, 3));
+    pthread_join(reader, NULL);
+
+    TEST_ASSERT_EQUAL_MEMORY(header, drained, sizeof(header));
+    TEST_ASSERT_EQUAL_MEMORY(large_a, drained + 8, LARGE_SEGMENT);
+    TEST_ASSERT_EQUAL_MEMORY(large_b, drained + 8 + LARGE_SEGMENT, LARGE_SEGMENT);
+}
+
+void test_Socket_SendVRejectsBadVectors(void) {
+    const uint8_t byte = 0;
+    IoSegment_t segment = { &byte, 1 };
+
+    TEST_ASSERT_FALSE(Socket_SendV(sockets[0], NULL, 1));
+    TEST_ASSERT_FALSE(Socket_SendV(sockets[0], &segment, 0));
+    TEST_ASSERT_FALSE(Socket_SendV(sockets[0], &segment, IO_MAX_SEGMENTS + 1));
+    TEST_ASSERT_FALSE(Socket_SendV(-1, &segment, 1));
+}
@@ -0,0 +1,125 @@
+#include "unity.h"
+#include "network/stream_framer.h"
+#include <string.h>
+
+static StreamFramer framer;
+static uint8_t last_payload[FRAME_MAX_PAYLOAD];
+static uint16_t last_length;
+static uint32_t frame_count;
+
+static void on_frame(const uint8_t* payload, uint16_t length, void* context) {
+    (void)context;
+    memcpy(last_payload, payload, length);
+    last_length = length;
+    frame_count++;
+}
+
+static uint32_t build_frame(uint8_t* out, const uint8_t* payload, uint8_t length) {
+    out[0] = FRAME_SYNC_BYTE;
+    out[1] = length;
+    memcpy(&out[2], payload, length);
+    out[length + 2] = Framer_Checksum(out, length + 2);
+    out[length + 3] = 0;
+    return length + FRAME_OVERHEAD;
+}
+
+void setUp(void) {
+    Framer_Init(&framer, on_frame, NULL);
+    frame_count = 0;
+    last_length = 0;
+}
+
+void tearDown(void) {
+}
+
+void test_Framer_ChecksumMatchesScalar(void) {
+    uint8_t data[300];
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    // Cover every tail length around the 16-byte vector width
+    for (uint32_t length = 0; length <= sizeof(data); length++) {
+        uint8_t expected = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            expected += data[i];
+        }
+        TEST_ASSERT_EQUAL_HEX8(expected, Framer_Checksum(data, length));
+    }
+}
+
+void test_Framer_SplitAcrossWrites(void) {
+    const uint8_t payload[] = { 0x22, 0xF1, 0x90 };
+    uint8_t frame[16];
+    uint32_t length = build_frame(frame, payload, sizeof(payload));
+
+    for (uint32_t i = 0; i < length; i++) {
+        TEST_ASSERT_EQUAL_UINT32(1, Framer_Write(&framer, &frame[i], 1));
+        Framer_Process(&framer);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(1, frame_count);
+    TEST_ASSERT_EQUAL_UINT16(sizeof(payload), last_length);
+    TEST_ASSERT_EQUAL_MEMORY(payload, last_payload, sizeof(payload));
+}
+
+void test_Framer_ResyncsAfterGarbage(void) {
+    const uint8_t payload[] = { 0x3E, 0x00 };
+    uint8_t stream[128];
+    uint32_t length = 0;
+
+    // Long garbage run, then a sync byte with a bad checksum, then a frame
+    memset(stream, 0xAA, 40);
+    length = 40;
+    stream[length++] = FRAME_SYNC_BYTE;
+    stream[length++] = 2;
+    stream[length++] = 0x00;
+    stream[length++] = 0x00;
+    stream[length++] = 0x00;
+    length += build_frame(&stream[length], payload, sizeof(payload));
+
+    Framer_Write(&framer, stream, length);
+    TEST_ASSERT_EQUAL_UINT32(1, Framer_Process(&framer));
+    TEST_ASSERT_EQUAL_MEMORY(payload, last_payload, sizeof(payload));
+
+    FramerStats stats;
+    Framer_GetStats(&framer, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(45, stats.bytes_skipped);
+}
+
+void test_Framer_WrapsRing(void) {
+    uint8_t payload[200];
+    uint8_t frame[FRAME_MAX_SIZE];
+
+    // 204-byte frames walk the payload across the ring end
+    for (uint32_t round = 0; round < 40; round++) {
+        memset(payload, (int)round, sizeof(payload));
+        uint32_t length = build_frame(frame, payload, sizeof(payload));
+        TEST_ASSERT_EQUAL_UINT32(length, Framer_Write(&framer, frame, length));
+        TEST_ASSERT_EQUAL_UINT32(1, Framer_Process(&framer));
+        TEST_ASSERT_EQUAL_MEMORY(payload, last_payload, sizeof(payload));
+    }
+
+    FramerStats stats;
+    Framer_GetStats(&framer, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.resyncs);
+}
+
+void test_Framer_CountsOverflow(void) {
+    uint8_t chunk[FRAMER_RING_SIZE];
+    memset(chunk, 0xAA, sizeof(chunk));
+
+    TEST_ASSERT_EQUAL_UINT32(sizeof(chunk) - 100, Framer_Write(&framer, chunk, sizeof(chunk) - 100));
+    TEST_ASSERT_EQUAL_UINT32(100, Framer_Write(&framer, chunk, 300));
+
+    FramerStats stats;
+    Framer_GetStats(&framer, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.overflows);
+    TEST_ASSERT_EQUAL_UINT32(200, stats.bytes_dropped);
+
+    // Draining the garbage frees the ring again
+    Framer_Process(&framer);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(chunk) - 3, Framer_Write(&framer, chunk, sizeof(chunk) - 3));
+}
@@ -0,0 +1,83 @@
+#include "unity.h"
+#include "utils/timer_wheel.h"
+#include <stddef.h>
+
+#define ENTRY_COUNT 4096
+
+static TimerWheel wheel;
+static TimerWheelEntry entries[ENTRY_COUNT];
+
+static uint32_t expire_all(uint32_t now_ms) {
+    uint32_t count = 0;
+    while (timer_wheel_expire(&wheel, now_ms) != NULL) {
+        count++;
+    }
+    return count;
+}
+
+void setUp(void) {
+    timer_wheel_init(&wheel, 1, 5000);
+    for (uint32_t i = 0; i < ENTRY_COUNT; i++) {
+        timer_wheel_entry_init(&entries[i]);
+    }
+}
+
+void tearDown(void) {
+}
+
+void test_TimerWheel_FiresAtDeadline(void) {
+    timer_wheel_schedule(&wheel, &entries[0], 5000, 50);
+
+    TEST_ASSERT_NULL(timer_wheel_expire(&wheel, 5049));
+    TEST_ASSERT_EQUAL_PTR(&entries[0], timer_wheel_expire(&wheel, 5050));
+    TEST_ASSERT_FALSE(timer_wheel_is_scheduled(&entries[0]));
+    TEST_ASSERT_NULL(timer_wheel_expire(&wheel, 6000));
+}
+
+void test_TimerWheel_CancelIsImmediate(void) {
+    timer_wheel_schedule(&wheel, &entries[0], 5000, 10);
+    timer_wheel_schedule(&wheel, &entries[1], 5000, 10);
+    timer_wheel_cancel(&wheel, &entries[0]);
+
+    TEST_ASSERT_EQUAL_PTR(&entries[1], timer_wheel_expire(&wheel, 5010));
+    TEST_ASSERT_NULL(timer_wheel_expire(&wheel, 5010));
+    TEST_ASSERT_EQUAL_UINT32(0, wheel.count);
+}
+
+void test_TimerWheel_LongDelaysWaitForTheirRound(void) {
+    // 300 and 300 + TIMER_WHEEL_SLOTS share a bucket
+    timer_wheel_schedule(&wheel, &entries[0], 5000, 300);
+    timer_wheel_schedule(&wheel, &entries[1], 5000, 300 + TIMER_WHEEL_SLOTS);
+
+    for (uint32_t now = 5000; now < 5300; now += 7) {
+        TEST_ASSERT_NULL(timer_wheel_expire(&wheel, now));
+    }
+    TEST_ASSERT_EQUAL_PTR(&entries[0], timer_wheel_expire(&wheel, 5300));
+    TEST_ASSERT_NULL(timer_wheel_expire(&wheel, 5300 + TIMER_WHEEL_SLOTS - 1));
+    TEST_ASSERT_EQUAL_PTR(&entries[1], timer_wheel_expire(&wheel, 5300 + TIMER_WHEEL_SLOTS));
+}
+
+void test_TimerWheel_CatchesUpAfterGap(void) {
+    for (uint32_t i = 0; i < ENTRY_COUNT; i++) {
+        timer_wheel_schedule(&wheel, &entries[i], 5000, 1 + (i * 7) % 1000);
+    }
+
+    // One late call far past every deadline still finds them all
+    TEST_ASSERT_EQUAL_UINT32(ENTRY_COUNT, expire_all(5000 + 100000));
+    TEST_ASSERT_EQUAL_UINT32(0, wheel.count);
+}
+
+void test_TimerWheel_Reschedule(void) {
+    timer_wheel_schedule(&wheel, &entries[0], 5000, 20);
+    timer_wheel_schedule(&wheel, &entries[0], 5000, 40);
+    TEST_ASSERT_EQUAL_UINT32(1, wheel.count);
+
+    TEST_ASSERT_NULL(timer_wheel_expire(&wheel, 5039));
+    TimerWheelEntry* entry = timer_wheel_expire(&wheel, 5040);
+    TEST_ASSERT_EQUAL_PTR(&entries[0], entry);
+
+    // Rescheduling from inside the expiry loop lands in a later tick
+    timer_wheel_schedule(&wheel, entry, 5040, 5);
+    TEST_ASSERT_NULL(timer_wheel_expire(&wheel, 5044));
+    TEST_ASSERT_EQUAL_PTR(&entries[0], timer_wheel_expire(&wheel, 5045));
+}
@@ -0,0 +1,203 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "../../src/runtime/drivers/can_virtual.h"
+#include "../../src/runtime/drivers/can_tx_queue.h"
+
+// Behaviour under bus load on the virtual bus, in simulated time. A
+// traffic node keeps the bus at 30, 60 and 90% with 8-byte frames spread
+// over the 11-bit ID range while a tester reads 128 bytes from an ECU
+// over ISO-TP every 100 ms (request 0x7E0, response 0x7E8, flow control
+// CTS/BS 0/STmin 0). Diagnostic IDs sit at the bottom of the priority
+// order, so their transfers stretch as load rises while urgent traffic
+// stays prompt.
+
+#define BITRATE         500000u
+#define TICK_NS         100000u         // Application task period
+#define RUN_NS          2000000000ull
+#define REQUEST_ID      0x7E0u
+#define RESPONSE_ID     0x7E8u
+#define PAYLOAD         128u
+#define REQUEST_PERIOD  100000000ull
+
+typedef struct {
+    double target;
+    double load;
+    uint32_t transfers;
+    uint64_t mean_ns;
+    uint64_t max_ns;
+    uint32_t urgent_max_us;     // Band 0 of the traffic node
+    uint32_t relaxed_max_us;    // Band 6
+} LoadResult;
+
+static CANFrame make_frame(uint32_t id, uint8_t dlc) {
+    CANFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.dlc = dlc;
+    return frame;
+}
+
+// ECU side: answers a request with a first frame, then sends every
+// consecutive frame once flow control arrives
+static void run_ecu(CANDriver* ecu) {
+    CANFrame frame;
+
+    while (can_receive(ecu, &frame, 0)) {
+        if (frame.id != REQUEST_ID) continue;
+
+        uint8_t pci = frame.data[0] >> 4;
+        if (pci == 0) {
+            CANFrame first = make_frame(RESPONSE_ID, 8);
+            first.data[0] = 0x10 | (PAYLOAD >> 8);
+            first.data[1] = PAYLOAD & 0xFF;
+            bool sent = can_transmit(ecu, &first, 0);
+            assert(sent);
+            (void)sent;
+        } else if (pci == 3) {
+            uint8_t sequence = 1;
+            for (uint32_t offset = 6; offset < PAYLOAD; offset += 7) {
+                uint32_t left = PAYLOAD - offset;
+                CANFrame next = make_frame(RESPONSE_ID, left < 7 ? (uint8_t)(left + 1) : 8);
+                next.data[0] = 0x20 | sequence;
+                sequence = (sequence + 1) & 0x0F;
+                bool sent = can_transmit(ecu, &next, 0);
+                assert(sent);
+                (void)sent;
+            }
+        }
+    }
+}
+
+// Tester side; returns true when the last consecutive frame is in
+static bool run_tester(CANDriver* tester, uint32_t* received) {
+    CANFrame frame;
+    bool done = false;
+
+    while (can_receive(tester, &frame, 0)) {
+        if (frame.id != RESPONSE_ID) continue;
+
+        uint8_t pci = frame.data[0] >> 4;
+        if (pci == 1) {
+            CANFrame flow = make_frame(REQUEST_ID, 3);
+            flow.data[0] = 0x30;
+            bool sent = can_transmit(tester, &flow, 0);
+            assert(sent);
+            (void)sent;
+            *received = 6;
+        } else if (pci == 2) {
+            *received += frame.dlc - 1;
+            done = *received >= PAYLOAD;
+        }
+    }
+    return done;
+}
+
+static LoadResult run_load(double target) {
+    CANBusConfig bus_config = { .bitrate = BITRATE, .seed = 1 };
+    CANBus* bus = can_bus_create("vbus0", &bus_config);
+    CANConfig config = { .interface_name = "vbus0", .tx_mailboxes = 3 };
+    CANDriver* traffic = can_create(&config);
+    CANDriver* tester = can_create(&config);
+    CANDriver* ecu = can_create(&config);
+    LoadResult result = { .target = target };
+    uint32_t state = 0x2545F491u;
+    uint64_t offered_ns = 0;
+    uint64_t request_at = 0 - REQUEST_PERIOD;
+    uint64_t total_ns = 0;
+    uint32_t received = 0;
+    bool waiting = false;
+
+    assert(bus && traffic && tester && ecu);
+    can_start(traffic);
+    can_start(tester);
+    can_start(ecu);
+    can_set_filter(tester, RESPONSE_ID, 0x7FF, false);
+    can_set_filter(ecu, REQUEST_ID, 0x7FF, false);
+
+    while (can_bus_now(bus) < RUN_NS) {
+        uint64_t now = can_bus_now(bus);
+
+        // Offer frames until the wire time handed out matches the target
+        while (offered_ns < (uint64_t)(target * (double)now)) {
+            state = state * 1664525u + 1013904223u;
+            CANFrame frame = make_frame(state >> 21, 8);
+            if (frame.id >= 0x700) {
+                frame.id -= 0x100;      // Keep band 7 for diagnostics
+            }
+            memcpy(frame.data, &state, sizeof(state));
+            if (!can_transmit(traffic, &frame, 0)) break;
+            offered_ns += can_bus_frame_time(bus, &frame);
+        }
+
+        run_ecu(ecu);
+        if (waiting && run_tester(tester, &received)) {
+            uint64_t elapsed = can_bus_now(bus) - request_at;
+            total_ns += elapsed;
+            if (elapsed > result.max_ns) {
+                result.max_ns = elapsed;
+            }
+            result.transfers++;
+            waiting = false;
+        }
+        if (!waiting && now - request_at >= REQUEST_PERIOD) {
+            CANFrame request = make_frame(REQUEST_ID, 3);
+            request.data[0] = 0x02;
+            request.data[1] = 0x22;
+            request.data[2] = 0xF1;
+            waiting = can_transmit(tester, &request, 0);
+            request_at = now;
+            received = 0;
+        }
+
+        can_bus_advance(bus, TICK_NS);
+    }
+
+    CANBusStats stats;
+    CANTxBandStats urgent, relaxed;
+    can_bus_get_statistics(bus, &stats);
+    can_get_tx_band_statistics(traffic, 0, &urgent);
+    can_get_tx_band_statistics(traffic, 6, &relaxed);
+
+    result.load = (double)stats.busy_ns / (double)stats.elapsed_ns;
+    result.mean_ns = result.transfers ? total_ns / result.transfers : 0;
+    result.urgent_max_us = urgent.max_us;
+    result.relaxed_max_us = relaxed.max_us;
+
+    can_destroy(traffic);
+    can_destroy(tester);
+    can_destroy(ecu);
+    can_bus_destroy(bus);
+    return result;
+}
+
+static void test_bus_load(void) {
+    const double targets[] = { 0.3, 0.6, 0.9 };
+    LoadResult results[3];
+
+    printf("target  load    ISO-TP 128 B mean/max (ms)   band 0 max (us)   band 6 max (us)\n");
+    for (int i = 0; i < 3; i++) {
+        results[i] = run_load(targets[i]);
+        printf("%4.0f%%  %5.1f%%   %8.2f %8.2f   %15u   %15u\n",
+               results[i].target * 100, results[i].load * 100,
+               results[i].mean_ns / 1e6, results[i].max_ns / 1e6,
+               results[i].urgent_max_us, results[i].relaxed_max_us);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        // The diagnostic traffic rides on top of the target
+        assert(results[i].load > results[i].target - 0.02);
+        assert(results[i].transfers > 0);
+        // Urgent frames wait for the frame on the wire, not for the load
+        assert(results[i].urgent_max_us < 1000);
+    }
+    assert(results[1].mean_ns > results[0].mean_ns);
+    assert(results[2].mean_ns > results[1].mean_ns);
+    assert(results[2].relaxed_max_us > results[2].urgent_max_us);
+}
+
+int main(void) {
+    test_bus_load();
+    printf("CAN bus load benchmarks passed\n");
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/runtime/common/queue.h"
+#include "../../src/runtime/drivers/can_frame.h"
+
+// Footprint of the frame representation on the two hot paths: moving
+// a burst of frames through the RX queue, and scanning IDs to route a batch
+
+#define FRAMES      (1u << 16)
+#define ROUNDS      64
+#define CHUNK       32
+
+static CANFrame frames[FRAMES];
+static CANClassicFrame compact[FRAMES];
+static CANFrameBatch batch;
+static volatile uint32_t sink;    // Keeps the scans from being optimized out
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Million frames per second through push_n/pop_n
+static double queue_rate(const void* source, size_t elem_size) {
+    Queue queue;
+    uint8_t out[CHUNK * sizeof(CANFrame)];
+
+    bool ready = queue_init(&queue, elem_size, FRAMES);
+    assert(ready);
+    (void)ready;
+
+    uint64_t start = now_ns();
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        // A burst fills the queue before the consumer gets to run
+        for (uint32_t i = 0; i < FRAMES; i += CHUNK) {
+            size_t pushed = queue_push_n(&queue, (const uint8_t*)source + i * elem_size, CHUNK);
+            assert(pushed == CHUNK);
+            (void)pushed;
+        }
+        for (uint32_t i = 0; i < FRAMES; i += CHUNK) {
+            size_t popped = queue_pop_n(&queue, out, CHUNK);
+            assert(popped == CHUNK);
+            (void)popped;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    queue_destroy(&queue);
+    return (double)FRAMES * ROUNDS * 1000.0 / (double)elapsed;
+}
+
+// Million frames per second counting diagnostic IDs
+static double scan_rate(bool soa) {
+    uint32_t matches = 0;
+
+    uint64_t start = now_ns();
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        if (soa) {
+            for (uint32_t i = 0; i < batch.count; i++) {
+                matches += (batch.ids[i] & 0x700) == 0x700;
+            }
+        } else {
+            for (uint32_t i = 0; i < FRAMES; i++) {
+                matches += (frames[i].id & 0x700) == 0x700;
+            }
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    sink = matches;
+    return (double)FRAMES * ROUNDS * 1000.0 / (double)elapsed;
+}
+
+static void test_frame_footprint(void) {
+    uint32_t state = 0x2545F491u;
+
+    bool ready = can_batch_init(&batch, FRAMES, false);
+    assert(ready);
+    (void)ready;
+
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        state = state * 1664525u + 1013904223u;
+        memset(&frames[i], 0, sizeof(CANFrame));
+        frames[i].id = state >> 21;
+        frames[i].dlc = 8;
+        memcpy(frames[i].data, &state, sizeof(state));
+        can_frame_compact(&frames[i], &compact[i]);
+        can_batch_add(&batch, &frames[i]);
+    }
+
+    double full_queue = queue_rate(frames, sizeof(CANFrame));
+    double compact_queue = queue_rate(compact, sizeof(CANClassicFrame));
+    double aos_scan = scan_rate(false);
+    double soa_scan = scan_rate(true);
+
+    printf("path         CANFrame (%zu B)   compact/SoA   Mframes/s\n", sizeof(CANFrame));
+    printf("RX queue     %16.1f %13.1f\n", full_queue, compact_queue);
+    printf("ID scan      %16.1f %13.1f\n", aos_scan, soa_scan);
+
+    assert(compact_queue > full_queue);
+    assert(soa_scan > aos_scan);
+    can_batch_destroy(&batch);
+}
+
+int main(void) {
+    test_frame_footprint();
+    printf("CAN frame benchmarks passed\n");
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include "../../src/runtime/drivers/can_replay.h"
+
+// Trace load throughput at one thread and at every online CPU, then an
+// unpaced replay into vcan0 when the interface exists
+
+#define LINES       (1u << 20)
+#define LINE_BYTES  48
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// A candump -l log of mixed standard and extended traffic
+static size_t write_trace(const char* path) {
+    FILE* file = fopen(path, "w");
+    uint32_t state = 0x2545F491u;
+    size_t bytes = 0;
+
+    assert(file);
+    for (uint32_t i = 0; i < LINES; i++) {
+        state = state * 1664525u + 1013904223u;
+        int written;
+        if (state & 0x80000000u) {
+            written = fprintf(file, "(%u.%06u) can0 %08X#%08X%08X\n", 1000 + i / 4000,
+                              i % 4000 * 250, state & 0x1FFFFFFF, state, i);
+        } else {
+            written = fprintf(file, "(%u.%06u) can0 %03X#%04X\n", 1000 + i / 4000,
+                              i % 4000 * 250, state >> 21, i & 0xFFFF);
+        }
+        bytes += (size_t)written;
+    }
+    fclose(file);
+    return bytes;
+}
+
+// Million lines per second through can_trace_load()
+static double load_rate(const char* path, uint32_t threads, uint32_t* count) {
+    uint64_t start = now_ns();
+    CANTrace* trace = can_trace_load(path, threads);
+    uint64_t elapsed = now_ns() - start;
+
+    assert(trace);
+    *count = can_trace_frames(trace)->count;
+    can_trace_destroy(trace);
+    return (double)LINES * 1000.0 / (double)elapsed;
+}
+
+static void test_trace_load(void) {
+    char path[] = "/tmp/can_replay_perf_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    size_t bytes = write_trace(path);
+    uint32_t cpus = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t serial_count, parallel_count;
+
+    double serial = load_rate(path, 1, &serial_count);
+    double parallel = load_rate(path, 0, &parallel_count);
+    unlink(path);
+
+    printf("trace        %u lines, %.1f MB\n", LINES, (double)bytes / 1e6);
+    printf("threads      Mlines/s\n");
+    printf("1            %8.2f\n", serial);
+    printf("%-12u %8.2f\n", cpus, parallel);
+
+    assert(serial_count == LINES);
+    assert(parallel_count == LINES);
+    if (cpus >= 4) {
+        assert(parallel > serial);
+    }
+}
+
+static void test_unpaced_replay(void) {
+    if (if_nametoindex("vcan0") == 0) {
+        printf("replay       skipped, vcan0 not available\n");
+        return;
+    }
+
+    char text[LINE_BYTES * 1024];
+    size_t length = 0;
+    for (uint32_t i = 0; i < 1024; i++) {
+        length += (size_t)sprintf(text + length, "(%u.000000) can0 %03X#%08X\n", i, i & 0x7FF, i);
+    }
+    CANTrace* trace = can_trace_parse(text, length, 1);
+    assert(trace);
+
+    CANConfig config = { .interface_name = "vcan0" };
+    CANDriver* driver = can_create(&config);
+    assert(driver);
+    bool started = can_start(driver);
+    assert(started);
+    (void)started;
+
+    CANReplayConfig replay = {
+        .mode = CAN_REPLAY_UNPACED,
+        .batch_size = 32,
+        .timeout_ms = 100
+    };
+    CANReplayStats stats;
+    uint64_t total = 0;
+    uint64_t elapsed = 0;
+    for (int round = 0; round < 64; round++) {
+        bool ok = can_replay_run(trace, driver, &replay, &stats);
+        assert(ok);
+        (void)ok;
+        total += stats.frames_sent;
+        elapsed += stats.elapsed_ns;
+    }
+    printf("replay       %.0f frames/s unpaced, %llu dropped\n",
+           (double)total * 1e9 / (double)elapsed, (unsigned long long)stats.frames_dropped);
+    assert(total > 0);
+
+    can_destroy(driver);
+    can_trace_destroy(trace);
+}
+
+int main(void) {
+    test_trace_load();
+    test_unpaced_replay();
+    printf("CAN replay benchmarks passed\n");
+    return 0;
+}
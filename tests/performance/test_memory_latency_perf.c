@@ -0,0 +1,336 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/runtime/memory/memory_manager.h"
+
+#define HEAP_SIZE        (16 * 1024 * 1024)
+#define MAX_LIVE         8192
+#define MEASURED_OPS     50000
+#define MIN_ALLOC        16
+#define MAX_ALLOC        2048
+
+typedef struct {
+    uint64_t max_ns;
+    uint64_t p99_ns;
+    uint64_t avg_ns;
+    uint32_t failures;
+} LatencyResult;
+
+static void* live[MAX_LIVE];
+static uint64_t samples[MEASURED_OPS];
+static uint32_t rng_state;
+
+static uint32_t next_random(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Fill the heap with mixed sizes, then free every other block so the
+// free list holds thousands of holes of varying size.
+static void build_fragmented_heap(void) {
+    for (uint32_t i = 0; i < MAX_LIVE; i++) {
+        live[i] = MEMORY_ALLOC(MIN_ALLOC + next_random() % (MAX_ALLOC - MIN_ALLOC));
+    }
+    for (uint32_t i = 0; i < MAX_LIVE; i += 2) {
+        MEMORY_FREE(live[i]);
+        live[i] = NULL;
+    }
+}
+
+static LatencyResult run_workload(MemAllocStrategy strategy) {
+    MemConfig config;
+    memset(&config, 0, sizeof(config));
+    config.heap_size = HEAP_SIZE;
+    config.enable_guards = true;
+    config.enable_stats = true;
+    config.heap_strategy = strategy;
+
+    assert(Memory_Init(&config));
+    memset(live, 0, sizeof(live));
+    rng_state = 0x12345678u;
+
+    build_fragmented_heap();
+
+    LatencyResult result = {0};
+    uint64_t total = 0;
+
+    for (uint32_t op = 0; op < MEASURED_OPS; op++) {
+        uint32_t slot = next_random() % MAX_LIVE;
+        uint64_t start = now_ns();
+
+        if (live[slot]) {
+            MEMORY_FREE(live[slot]);
+            live[slot] = NULL;
+        } else {
+            live[slot] = MEMORY_ALLOC(MIN_ALLOC + next_random() % (MAX_ALLOC - MIN_ALLOC));
+            if (!live[slot]) {
+                result.failures++;
+            }
+        }
+
+        samples[op] = now_ns() - start;
+        total += samples[op];
+    }
+
+    assert(Memory_CheckIntegrity());
+
+    for (uint32_t i = 0; i < MAX_LIVE; i++) {
+        MEMORY_FREE(live[i]);
+    }
+    Memory_Deinit();
+
+    qsort(samples, MEASURED_OPS, sizeof(samples[0]), compare_u64);
+    result.max_ns = samples[MEASURED_OPS - 1];
+    result.p99_ns = samples[(MEASURED_OPS * 99) / 100];
+    result.avg_ns = total / MEASURED_OPS;
+    return result;
+}
+
+static void test_worst_case_latency(void) {
+    LatencyResult best_fit = run_workload(MEM_ALLOC_BEST_FIT);
+    LatencyResult tlsf = run_workload(MEM_ALLOC_TLSF);
+
+    printf("strategy   avg (ns)  p99 (ns)  max (ns)  failures\n");
+    printf("best-fit  %9llu %9llu %9llu %9u\n",
+           (unsigned long long)best_fit.avg_ns, (unsigned long long)best_fit.p99_ns,
+           (unsigned long long)best_fit.max_ns, best_fit.failures);
+    printf("tlsf      %9llu %9llu %9llu %9u\n",
+           (unsigned long long)tlsf.avg_ns, (unsigned long long)tlsf.p99_ns,
+           (unsigned long long)tlsf.max_ns, tlsf.failures);
+
+    assert(tlsf.failures == 0);
+    assert(tlsf.p99_ns <= best_fit.p99_ns);
+}
+
+static void test_tlsf_coalescing(void) {
+    MemConfig config;
+    memset(&config, 0, sizeof(config));
+    config.heap_size = 64 * 1024;
+    config.enable_guards = true;
+    config.enable_stats = true;
+    config.heap_strategy = MEM_ALLOC_TLSF;
+
+    assert(Memory_Init(&config));
+
+    void* a = MEMORY_ALLOC(1000);
+    void* b = MEMORY_ALLOC(1000);
+    void* c = MEMORY_ALLOC(1000);
+    assert(a && b && c);
+
+    // Freeing the outer blocks first leaves b between two holes
+    MEMORY_FREE(a);
+    MEMORY_FREE(c);
+    MEMORY_FREE(b);
+
+    MemStats stats;
+    Memory_GetStats(&stats);
+    assert(stats.fragmentation == 0);
+    assert(stats.current_usage == 0);
+
+    // The whole heap must be reusable as one block again
+    void* big = MEMORY_ALLOC(60 * 1024);
+    assert(big);
+    assert(Memory_CheckIntegrity());
+
+    void* grown = MEMORY_REALLOC(big, 62 * 1024);
+    assert(grown == big);
+    grown = MEMORY_REALLOC(grown, 128);
+    assert(grown == big);
+    assert(Memory_CheckIntegrity());
+
+    MEMORY_FREE(grown);
+    Memory_Deinit();
+}
+
+// Writes one fresh allocation per 64KB across a 32MB heap, which is
+// where first-touch faults land with malloc backing.
+static uint64_t first_touch_max_ns(MemBackingMode backing, MemStats* stats) {
+    MemConfig config;
+    memset(&config, 0, sizeof(config));
+    config.heap_size = 32 * 1024 * 1024;
+    config.enable_guards = true;
+    config.enable_stats = true;
+    config.heap_strategy = MEM_ALLOC_TLSF;
+    config.backing = backing;
+
+    assert(Memory_Init(&config));
+
+    uint64_t max_ns = 0;
+    uint32_t count = 0;
+    for (; count < 480; count++) {
+        uint64_t start = now_ns();
+        uint8_t* ptr = MEMORY_ALLOC(64 * 1024);
+        assert(ptr);
+        memset(ptr, 0xA5, 64 * 1024);
+        uint64_t elapsed = now_ns() - start;
+        if (elapsed > max_ns) {
+            max_ns = elapsed;
+        }
+        live[count] = ptr;
+    }
+
+    Memory_GetStats(stats);
+    assert(Memory_CheckIntegrity());
+    for (uint32_t i = 0; i < count; i++) {
+        MEMORY_FREE(live[i]);
+    }
+    Memory_Deinit();
+    return max_ns;
+}
+
+static void test_locked_backing(void) {
+    MemStats malloc_stats;
+    MemStats locked_stats;
+
+    uint64_t malloc_ns = first_touch_max_ns(MEM_BACKING_MALLOC, &malloc_stats);
+    uint64_t locked_ns = first_touch_max_ns(MEM_BACKING_LOCKED, &locked_stats);
+
+    printf("backing   max 64KB alloc+touch (ns)  page size  locked\n");
+    printf("malloc   %27llu %10u %7s\n", (unsigned long long)malloc_ns,
+           malloc_stats.page_size, malloc_stats.pages_locked ? "yes" : "no");
+    printf("locked   %27llu %10u %7s\n", (unsigned long long)locked_ns,
+           locked_stats.page_size, locked_stats.pages_locked ? "yes" : "no");
+
+    assert(malloc_stats.page_size == 0 && !malloc_stats.pages_locked);
+#ifdef __linux__
+    // mlock may be refused by RLIMIT_MEMLOCK, but the pages are still prefaulted
+    assert(locked_stats.page_size >= 4096);
+#endif
+}
+
+// Fragments a heap of handle allocations, then compacts it either in
+// budget-sized steps or in one unbounded call. Returns the longest pause.
+static uint64_t compaction_max_pause_ns(uint32_t budget, uint32_t* calls, MemStats* stats) {
+    static MemHandle handles[MAX_LIVE];
+    MemConfig config;
+    memset(&config, 0, sizeof(config));
+    config.heap_size = HEAP_SIZE;
+    config.enable_guards = true;
+    config.enable_stats = true;
+    config.heap_strategy = MEM_ALLOC_TLSF;
+    config.max_handles = MAX_LIVE;
+
+    assert(Memory_Init(&config));
+    rng_state = 0x9E3779B9u;
+
+    for (uint32_t i = 0; i < MAX_LIVE; i++) {
+        handles[i] = MEMORY_ALLOC_HANDLE(MIN_ALLOC + next_random() % (MAX_ALLOC - MIN_ALLOC));
+        assert(handles[i] != MEM_INVALID_HANDLE);
+    }
+    for (uint32_t i = 0; i < MAX_LIVE; i += 2) {
+        Memory_FreeHandle(handles[i]);
+    }
+
+    uint64_t max_ns = 0;
+    uint32_t moved;
+    *calls = 0;
+    do {
+        uint64_t start = now_ns();
+        moved = Memory_Compact(budget);
+        uint64_t elapsed = now_ns() - start;
+        if (elapsed > max_ns) {
+            max_ns = elapsed;
+        }
+        (*calls)++;
+    } while (moved > 0 || *calls < 2);
+
+    Memory_GetStats(stats);
+    assert(Memory_CheckIntegrity());
+
+    for (uint32_t i = 1; i < MAX_LIVE; i += 2) {
+        Memory_FreeHandle(handles[i]);
+    }
+    Memory_Deinit();
+    return max_ns;
+}
+
+static void test_incremental_compaction(void) {
+    uint32_t step_calls;
+    uint32_t full_calls;
+    MemStats step_stats;
+    MemStats full_stats;
+
+    uint64_t step_ns = compaction_max_pause_ns(16 * 1024, &step_calls, &step_stats);
+    uint64_t full_ns = compaction_max_pause_ns(UINT32_MAX, &full_calls, &full_stats);
+
+    printf("compaction   max pause (ns)  calls  moved (bytes)  fragmentation\n");
+    printf("16KB steps %16llu %6u %14u %13u%%\n", (unsigned long long)step_ns, step_calls,
+           step_stats.compacted_bytes, step_stats.fragmentation);
+    printf("unbounded  %16llu %6u %14u %13u%%\n", (unsigned long long)full_ns, full_calls,
+           full_stats.compacted_bytes, full_stats.fragmentation);
+
+    assert(step_stats.fragmentation == 0);
+    assert(step_ns < full_ns);
+}
+
+// Full integrity checks stall allocators for the whole walk; a budgeted
+// scan bounds each slice while still covering the heap every few calls.
+static void test_incremental_scan(void) {
+    MemConfig config;
+    memset(&config, 0, sizeof(config));
+    config.heap_size = HEAP_SIZE;
+    config.enable_guards = true;
+    config.enable_stats = true;
+    config.heap_strategy = MEM_ALLOC_TLSF;
+
+    assert(Memory_Init(&config));
+    memset(live, 0, sizeof(live));
+    rng_state = 0x2545F491u;
+    build_fragmented_heap();
+
+    uint64_t start = now_ns();
+    assert(Memory_CheckIntegrity());
+    uint64_t full_ns = now_ns() - start;
+
+    MemScanBudget budget = { 0, 20 };
+    MemScanStats stats;
+    uint64_t max_slice_ns = 0;
+    uint32_t slices = 0;
+    do {
+        start = now_ns();
+        assert(Memory_ScanIncremental(&budget));
+        uint64_t elapsed = now_ns() - start;
+        if (elapsed > max_slice_ns) {
+            max_slice_ns = elapsed;
+        }
+        slices++;
+        Memory_GetScanStats(&stats);
+    } while (stats.passes_completed == 0);
+
+    printf("integrity      max stall (ns)  slices  blocks\n");
+    printf("full check   %16llu %7u %7u\n", (unsigned long long)full_ns, 1u, stats.blocks_last_pass);
+    printf("20us slices  %16llu %7u %7u\n", (unsigned long long)max_slice_ns, slices,
+           stats.blocks_last_pass);
+
+    assert(stats.errors == 0);
+    assert(slices > 1);
+
+    for (uint32_t i = 0; i < MAX_LIVE; i++) {
+        MEMORY_FREE(live[i]);
+    }
+    Memory_Deinit();
+}
+
+int main(void) {
+    test_tlsf_coalescing();
+    test_locked_backing();
+    test_incremental_compaction();
+    test_incremental_scan();
+    test_worst_case_latency();
+    printf("All memory latency benchmarks passed!\n");
+    return 0;
+}
\ No newline at end of file
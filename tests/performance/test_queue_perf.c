@@ -0,0 +1,157 @@
+#define _GNU_SOURCE
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/runtime/common/queue.h"
+
+#define ITEMS_PER_PRODUCER  2000000u
+#define QUEUE_DEPTH         1024
+#define BATCH               16
+
+typedef enum {
+    MODE_SINGLE = 0,    // queue_push / queue_pop
+    MODE_BATCH,         // queue_push_n / queue_pop_n
+    MODE_SP             // queue_push_sp / queue_pop, one producer only
+} Mode;
+
+typedef struct {
+    uint32_t producer;
+    uint32_t sequence;
+    uint64_t payload;
+} Item;
+
+typedef struct {
+    uint32_t index;
+    Mode mode;
+    uint64_t sum;
+} Worker;
+
+static Queue queue;
+static _Atomic uint32_t started;
+static _Atomic uint64_t consumed;
+static uint64_t total_items;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void wait_start(void) {
+    atomic_fetch_sub(&started, 1);
+    while (atomic_load(&started) != 0) {
+        sched_yield();
+    }
+}
+
+static void* producer(void* arg) {
+    Worker* worker = arg;
+    Item batch[BATCH];
+    uint32_t sent = 0;
+
+    wait_start();
+    while (sent < ITEMS_PER_PRODUCER) {
+        size_t pushed;
+
+        if (worker->mode == MODE_BATCH) {
+            uint32_t n = ITEMS_PER_PRODUCER - sent < BATCH ? ITEMS_PER_PRODUCER - sent : BATCH;
+            for (uint32_t i = 0; i < n; i++) {
+                batch[i] = (Item){ worker->index, sent + i, sent + i };
+            }
+            pushed = queue_push_n(&queue, batch, n);
+        } else {
+            Item item = { worker->index, sent, sent };
+            pushed = worker->mode == MODE_SP ? queue_push_sp(&queue, &item, sizeof(item))
+                                             : queue_push(&queue, &item, sizeof(item));
+        }
+
+        sent += (uint32_t)pushed;
+        if (pushed == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg) {
+    Worker* worker = arg;
+    Item batch[BATCH];
+
+    wait_start();
+    while (atomic_load_explicit(&consumed, memory_order_relaxed) < total_items) {
+        size_t count = worker->mode == MODE_BATCH ? queue_pop_n(&queue, batch, BATCH)
+                                                  : queue_pop(&queue, batch, sizeof(Item));
+        for (size_t i = 0; i < count; i++) {
+            worker->sum += batch[i].payload;
+        }
+        if (count == 0) {
+            sched_yield();
+            continue;
+        }
+        atomic_fetch_add_explicit(&consumed, count, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+// Returns million items per second through the queue
+static double run(uint32_t threads, Mode mode) {
+    pthread_t producers[4];
+    pthread_t consumers[4];
+    Worker workers[8];
+    uint64_t sum = 0;
+
+    assert(threads <= 4);
+    bool ready = queue_init(&queue, sizeof(Item), QUEUE_DEPTH);
+    assert(ready);
+    (void)ready;
+    total_items = (uint64_t)threads * ITEMS_PER_PRODUCER;
+    atomic_store(&consumed, 0);
+    atomic_store(&started, threads * 2 + 1);
+
+    for (uint32_t i = 0; i < threads * 2; i++) {
+        workers[i] = (Worker){ .index = i % threads, .mode = mode };
+    }
+    for (uint32_t i = 0; i < threads; i++) {
+        pthread_create(&consumers[i], NULL, consumer, &workers[threads + i]);
+        pthread_create(&producers[i], NULL, producer, &workers[i]);
+    }
+
+    wait_start();
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < threads; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+        sum += workers[threads + i].sum;
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    // Nothing lost or duplicated
+    assert(sum == threads * ((uint64_t)ITEMS_PER_PRODUCER * (ITEMS_PER_PRODUCER - 1) / 2));
+    queue_destroy(&queue);
+    return (double)total_items * 1000.0 / (double)elapsed;
+}
+
+static void test_queue_throughput(void) {
+    double single_1p1c = run(1, MODE_SINGLE);
+    double sp_1p1c = run(1, MODE_SP);
+    double batch_1p1c = run(1, MODE_BATCH);
+    double single_4p4c = run(4, MODE_SINGLE);
+    double batch_4p4c = run(4, MODE_BATCH);
+
+    printf("threads  mode          Mitems/s\n");
+    printf("1P1C     push/pop      %8.2f\n", single_1p1c);
+    printf("1P1C     push_sp/pop   %8.2f\n", sp_1p1c);
+    printf("1P1C     push_n/pop_n  %8.2f\n", batch_1p1c);
+    printf("4P4C     push/pop      %8.2f\n", single_4p4c);
+    printf("4P4C     push_n/pop_n  %8.2f\n", batch_4p4c);
+}
+
+int main(void) {
+    test_queue_throughput();
+    printf("Queue benchmarks passed\n");
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include "../../src/runtime/memory/rt_memory.h"
+
+#define BLOCK_SIZE        64
+#define BLOCK_COUNT       4096
+#define OPS_PER_THREAD    200000
+#define BURST_SIZE        8
+
+// Reference implementation: the previous single-mutex pool, kept here so the
+// benchmark always compares against the same baseline.
+typedef struct {
+    void* memory;
+    void** free_blocks;
+    size_t free_count;
+    pthread_mutex_t lock;
+} MutexPool;
+
+static MutexPool* mutex_pool_create(size_t block_size, size_t block_count) {
+    MutexPool* pool = malloc(sizeof(MutexPool));
+    pool->memory = aligned_alloc(64, block_size * block_count);
+    pool->free_blocks = malloc(sizeof(void*) * block_count);
+    for (size_t i = 0; i < block_count; i++) {
+        pool->free_blocks[i] = (char*)pool->memory + (i * block_size);
+    }
+    pool->free_count = block_count;
+    pthread_mutex_init(&pool->lock, NULL);
+    return pool;
+}
+
+static void* mutex_pool_alloc(MutexPool* pool) {
+    void* block = NULL;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->free_count > 0) {
+        block = pool->free_blocks[--pool->free_count];
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return block;
+}
+
+static void mutex_pool_free(MutexPool* pool, void* ptr) {
+    pthread_mutex_lock(&pool->lock);
+    pool->free_blocks[pool->free_count++] = ptr;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void mutex_pool_destroy(MutexPool* pool) {
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->free_blocks);
+    free(pool->memory);
+    free(pool);
+}
+
+typedef struct {
+    void* pool;
+    bool use_rt_pool;
+    uint32_t failures;
+} WorkerArgs;
+
+static void* worker(void* arg) {
+    WorkerArgs* args = (WorkerArgs*)arg;
+    void* burst[BURST_SIZE];
+
+    for (int i = 0; i < OPS_PER_THREAD / BURST_SIZE; i++) {
+        for (int j = 0; j < BURST_SIZE; j++) {
+            burst[j] = args->use_rt_pool ?
+                rt_mempool_alloc((RTMemPool*)args->pool) :
+                mutex_pool_alloc((MutexPool*)args->pool);
+            if (burst[j]) {
+                *(volatile uint32_t*)burst[j] = (uint32_t)j;
+            } else {
+                args->failures++;
+            }
+        }
+        for (int j = 0; j < BURST_SIZE; j++) {
+            if (!burst[j]) continue;
+            if (args->use_rt_pool) {
+                rt_mempool_free((RTMemPool*)args->pool, burst[j]);
+            } else {
+                mutex_pool_free((MutexPool*)args->pool, burst[j]);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static double run_benchmark(void* pool, bool use_rt_pool, int thread_count) {
+    pthread_t threads[16];
+    WorkerArgs args[16];
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < thread_count; i++) {
+        args[i].pool = pool;
+        args[i].use_rt_pool = use_rt_pool;
+        args[i].failures = 0;
+        pthread_create(&threads[i], NULL, worker, &args[i]);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+        assert(args[i].failures == 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (end.tv_sec - start.tv_sec) +
+                     (end.tv_nsec - start.tv_nsec) / 1e9;
+    return (2.0 * OPS_PER_THREAD * thread_count) / elapsed;
+}
+
+static void test_contention(void) {
+    const int thread_counts[] = {1, 4, 16};
+
+    printf("threads  mutex pool (Mops/s)  magazine pool (Mops/s)  speedup\n");
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        int threads = thread_counts[i];
+
+        MutexPool* mutex_pool = mutex_pool_create(BLOCK_SIZE, BLOCK_COUNT);
+        double mutex_rate = run_benchmark(mutex_pool, false, threads);
+        mutex_pool_destroy(mutex_pool);
+
+        RTMemPool* rt_pool = rt_mempool_create(BLOCK_SIZE, BLOCK_COUNT);
+        assert(rt_pool);
+        double rt_rate = run_benchmark(rt_pool, true, threads);
+
+        // Every worker has exited, so all magazines are back in the depot
+        assert(rt_mempool_available(rt_pool) == BLOCK_COUNT);
+        rt_mempool_destroy(rt_pool);
+
+        printf("%7d  %19.2f  %22.2f  %6.2fx\n", threads,
+               mutex_rate / 1e6, rt_rate / 1e6, rt_rate / mutex_rate);
+    }
+}
+
+static void test_exhaustion(void) {
+    RTMemPool* pool = rt_mempool_create(BLOCK_SIZE, BLOCK_COUNT);
+    void** blocks = malloc(sizeof(void*) * BLOCK_COUNT);
+
+    for (size_t i = 0; i < BLOCK_COUNT; i++) {
+        blocks[i] = rt_mempool_alloc(pool);
+        assert(blocks[i]);
+    }
+    assert(rt_mempool_alloc(pool) == NULL);
+
+    for (size_t i = 0; i < BLOCK_COUNT; i++) {
+        rt_mempool_free(pool, blocks[i]);
+    }
+    assert(rt_mempool_available(pool) == BLOCK_COUNT);
+
+    rt_mempool_flush_cache(pool);
+    assert(rt_mempool_available(pool) == BLOCK_COUNT);
+
+    free(blocks);
+    rt_mempool_destroy(pool);
+}
+
+int main(void) {
+    test_exhaustion();
+    test_contention();
+    printf("All RT memory pool benchmarks passed!\n");
+    return 0;
+}
\ No newline at end of file
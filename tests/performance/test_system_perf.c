@@ -45,7 +45,7 @@ void test_memory_fragmentation(void) {
         }
         
         if(iter % 100 == 0) {
-            MemPool_GarbageCollect();
+            MemPool_ExpireLeases();
         }
     }
     
@@ -0,0 +1,211 @@
+#define _GNU_SOURCE
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "../../src/runtime/network/net_core.h"
+#include "../../src/runtime/network/net_interface.h"
+
+#define DATAGRAM_SIZE    64
+#define TX_DATAGRAMS     200000
+#define RX_WINDOW_MS     300
+#define BURST            64
+
+typedef struct {
+    uint32_t depth;
+    uint64_t tx_pps;
+    uint64_t rx_pps;
+    uint64_t tx_p50_ns;    // Per batch call
+    uint64_t tx_p99_ns;
+} BatchResult;
+
+static const uint32_t depths[] = { 1, 8, 32, 64 };
+
+static uint8_t tx_payload[BURST][DATAGRAM_SIZE];
+static uint8_t rx_storage[BURST][256];
+static NetMessage messages[BURST];
+static EthernetConfig eth_config;
+static int peer = -1;
+static volatile int blasting;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint16_t open_peer(void) {
+    struct sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    peer = socket(AF_INET, SOCK_DGRAM, 0);
+    assert(peer >= 0);
+    assert(bind(peer, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    getsockname(peer, (struct sockaddr*)&addr, &length);
+    return ntohs(addr.sin_port);
+}
+
+// The stack binds an ephemeral port; learn it from a first datagram and
+// connect the peer back so the blaster can use plain sendmmsg.
+static void handshake(void) {
+    uint8_t hello[] = "hello";
+    uint8_t buffer[16];
+    struct sockaddr_in from;
+    socklen_t from_length = sizeof(from);
+
+    NetMessage message = { .data = hello, .length = sizeof(hello), .protocol = NET_PROTO_UDP };
+    assert(Net_SendMessage(&message));
+    assert(recvfrom(peer, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &from_length) > 0);
+    assert(connect(peer, (struct sockaddr*)&from, from_length) == 0);
+}
+
+static void* blaster(void* arg) {
+    struct mmsghdr headers[BURST];
+    struct iovec iov[BURST];
+
+    (void)arg;
+    memset(headers, 0, sizeof(headers));
+    for (uint32_t i = 0; i < BURST; i++) {
+        iov[i].iov_base = tx_payload[i];
+        iov[i].iov_len = DATAGRAM_SIZE;
+        headers[i].msg_hdr.msg_iov = &iov[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while (__atomic_load_n(&blasting, __ATOMIC_RELAXED)) {
+        sendmmsg(peer, headers, BURST, MSG_DONTWAIT);
+    }
+    return NULL;
+}
+
+// Drops on the loopback receive queue are expected; only datagrams the
+// stack hands back are counted.
+static uint64_t measure_rx(void) {
+    pthread_t thread;
+    uint64_t received = 0;
+
+    blasting = 1;
+    assert(pthread_create(&thread, NULL, blaster, NULL) == 0);
+
+    uint64_t start = now_ns();
+    uint64_t end = start + (uint64_t)RX_WINDOW_MS * 1000000ull;
+    uint64_t now = start;
+
+    while (now < end) {
+        Net_Wait(10);
+        for (uint32_t i = 0; i < BURST; i++) {
+            messages[i].data = rx_storage[i];
+            messages[i].length = sizeof(rx_storage[i]);
+        }
+        uint32_t count = Net_ReceiveMessages(messages, BURST);
+        for (uint32_t i = 0; i < count; i++) {
+            assert(messages[i].length == DATAGRAM_SIZE);
+        }
+        received += count;
+        now = now_ns();
+    }
+
+    __atomic_store_n(&blasting, 0, __ATOMIC_RELAXED);
+    pthread_join(thread, NULL);
+
+    assert(received > 0);
+    return received * 1000000000ull / (now - start);
+}
+
+static uint64_t measure_tx(void) {
+    uint64_t sent = 0;
+
+    for (uint32_t i = 0; i < BURST; i++) {
+        messages[i].data = tx_payload[i];
+        messages[i].length = DATAGRAM_SIZE;
+        messages[i].protocol = NET_PROTO_UDP;
+    }
+
+    uint64_t start = now_ns();
+    while (sent < TX_DATAGRAMS) {
+        sent += Net_SendMessages(messages, BURST);
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    return sent * 1000000000ull / elapsed;
+}
+
+static BatchResult run_depth(uint32_t depth) {
+    NetManagerConfig config = {
+        .max_interfaces = 1,
+        .max_connections = 1,
+        .rx_buffer_size = 4096,
+        .tx_buffer_size = 4096,
+        .enable_statistics = true,
+        .batch_depth = depth
+    };
+
+    memset(&eth_config, 0, sizeof(eth_config));
+    eth_config.open_udp = true;
+
+    NetInterfaceConfig if_config = {
+        .type = NET_IF_ETHERNET,
+        .name = "lo",
+        .address = "127.0.0.1",
+        .port = open_peer(),
+        .interface_config = &eth_config
+    };
+
+    assert(Net_Init(&config));
+    assert(Net_AddInterface(&if_config));
+    assert(Net_Connect(NET_IF_ETHERNET));
+    handshake();
+
+    BatchResult result = { .depth = depth };
+    result.tx_pps = measure_tx();
+    result.rx_pps = measure_rx();
+
+    NetLatencySummary latency;
+    assert(Net_GetLatency(NET_IF_ETHERNET, NET_PROTO_UDP, NET_DIR_TX, &latency));
+    result.tx_p50_ns = latency.p50_ns;
+    result.tx_p99_ns = latency.p99_ns;
+
+    Net_Deinit();
+    close(peer);
+    peer = -1;
+    return result;
+}
+
+static void test_batch_throughput(void) {
+    BatchResult results[sizeof(depths) / sizeof(depths[0])];
+
+    for (uint32_t i = 0; i < BURST; i++) {
+        memset(tx_payload[i], (int)i, DATAGRAM_SIZE);
+    }
+
+    for (uint32_t i = 0; i < sizeof(depths) / sizeof(depths[0]); i++) {
+        results[i] = run_depth(depths[i]);
+    }
+
+    printf("batch   tx (pkt/s)   rx (pkt/s)   tx p50 (ns)   tx p99 (ns)\n");
+    for (uint32_t i = 0; i < sizeof(depths) / sizeof(depths[0]); i++) {
+        printf("%5u %12llu %12llu %13llu %13llu\n", results[i].depth,
+               (unsigned long long)results[i].tx_pps,
+               (unsigned long long)results[i].rx_pps,
+               (unsigned long long)results[i].tx_p50_ns,
+               (unsigned long long)results[i].tx_p99_ns);
+    }
+
+    // Batching must never cost throughput on the send side
+    assert(results[2].tx_pps >= results[0].tx_pps);
+}
+
+int main(void) {
+    test_batch_throughput();
+    printf("UDP batch benchmarks passed\n");
+    return 0;
+}